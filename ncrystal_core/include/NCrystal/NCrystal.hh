@@ -76,6 +76,9 @@
 #ifndef NCrystal_Version_hh
 #  include "NCrystal/interfaces/NCVersion.hh"
 #endif
+#ifndef NCrystal_CacheStats_hh
+#  include "NCrystal/interfaces/NCCacheStats.hh"
+#endif
 #ifndef NCrystal_CompositionUtils_hh
 #  include "NCrystal/misc/NCCompositionUtils.hh"
 #endif
@@ -73,6 +73,18 @@ extern "C" {
 #  undef ncrystal_atomdatadb_getnentries
 #endif
 #define ncrystal_atomdatadb_getnentries NCRYSTAL_APPLY_C_NAMESPACE(atomdatadb_getnentries)
+#ifdef ncrystal_cachestats_enable
+#  undef ncrystal_cachestats_enable
+#endif
+#define ncrystal_cachestats_enable NCRYSTAL_APPLY_C_NAMESPACE(cachestats_enable)
+#ifdef ncrystal_cachestats_json
+#  undef ncrystal_cachestats_json
+#endif
+#define ncrystal_cachestats_json NCRYSTAL_APPLY_C_NAMESPACE(cachestats_json)
+#ifdef ncrystal_cachestats_reset
+#  undef ncrystal_cachestats_reset
+#endif
+#define ncrystal_cachestats_reset NCRYSTAL_APPLY_C_NAMESPACE(cachestats_reset)
 #ifdef ncrystal_cast_abs2proc
 #  undef ncrystal_cast_abs2proc
 #endif
@@ -157,6 +169,14 @@ extern "C" {
 #  undef ncrystal_crosssection
 #endif
 #define ncrystal_crosssection NCRYSTAL_APPLY_C_NAMESPACE(crosssection)
+#ifdef ncrystal_crosssection_and_samplescatter_manystates
+#  undef ncrystal_crosssection_and_samplescatter_manystates
+#endif
+#define ncrystal_crosssection_and_samplescatter_manystates NCRYSTAL_APPLY_C_NAMESPACE(crosssection_and_samplescatter_manystates)
+#ifdef ncrystal_crosssection_many
+#  undef ncrystal_crosssection_many
+#endif
+#define ncrystal_crosssection_many NCRYSTAL_APPLY_C_NAMESPACE(crosssection_many)
 #ifdef ncrystal_crosssection_nonoriented
 #  undef ncrystal_crosssection_nonoriented
 #endif
@@ -557,6 +577,10 @@ extern "C" {
 #  undef ncrystal_samplescatter_many
 #endif
 #define ncrystal_samplescatter_many NCRYSTAL_APPLY_C_NAMESPACE(samplescatter_many)
+#ifdef ncrystal_samplescatter_manystates
+#  undef ncrystal_samplescatter_manystates
+#endif
+#define ncrystal_samplescatter_manystates NCRYSTAL_APPLY_C_NAMESPACE(samplescatter_manystates)
 #ifdef ncrystal_samplescatterisotropic
 #  undef ncrystal_samplescatterisotropic
 #endif
@@ -581,6 +605,10 @@ extern "C" {
 #  undef ncrystal_setbuiltinrandgen_withstate
 #endif
 #define ncrystal_setbuiltinrandgen_withstate NCRYSTAL_APPLY_C_NAMESPACE(setbuiltinrandgen_withstate)
+#ifdef ncrystal_setcounterbasedrandgen_withseed
+#  undef ncrystal_setcounterbasedrandgen_withseed
+#endif
+#define ncrystal_setcounterbasedrandgen_withseed NCRYSTAL_APPLY_C_NAMESPACE(setcounterbasedrandgen_withseed)
 #ifdef ncrystal_seterrhandler
 #  undef ncrystal_seterrhandler
 #endif
@@ -1049,6 +1077,12 @@ extern "C" {
   NCRYSTAL_API void ncrystal_setbuiltinrandgen_withseed(unsigned long seed);
   NCRYSTAL_API void ncrystal_setbuiltinrandgen_withstate(const char*);
 
+  /* Or to the builtin counter-based (Philox) generator, for which streams         */
+  /* created with ncrystal_clone_scatter_rngbyidx only depend on the seed and      */
+  /* the index (and not on thread counts or the order of cloning). Its states      */
+  /* can also be used with ncrystal_setbuiltinrandgen_withstate.                   */
+  NCRYSTAL_API void ncrystal_setcounterbasedrandgen_withseed(unsigned long seed);
+
   /* If supported (which it will NOT be if the RNG was set using the C API and the */
   /* ncrystal_setrandgen function), the state of the RNG stream can be accessed    */
   /* and manipulated via the following functions (returned strings must be free'd  */
@@ -1186,6 +1220,15 @@ extern "C" {
   /* Clear various caches employed inside NCrystal:                                */
   NCRYSTAL_API void ncrystal_clear_caches(void);
 
+  /* Opt-in statistics of cache hits, misses and time spent recalculating cache    */
+  /* contents after misses, for the caches used by physics processes (see         */
+  /* NCCacheStats.hh for details). Collection can also be enabled by setting the   */
+  /* NCRYSTAL_CACHESTATS=1 env var. Results are returned as JSON list, which must  */
+  /* be cleaned up with ncrystal_dealloc_string:                                   */
+  NCRYSTAL_API void ncrystal_cachestats_enable( int );
+  NCRYSTAL_API void ncrystal_cachestats_reset(void);
+  NCRYSTAL_API char* ncrystal_cachestats_json(void);
+
   /* Get list of plugins. Resulting string list must be deallocated by a call to   */
   /* ncrystal_dealloc_stringlist by, and contains entries in the format            */
   /* pluginname0,filename0,plugintype0,pluginname1,filename1,plugintype1,...:      */
@@ -1249,6 +1292,45 @@ extern "C" {
                                                             unsigned long repeat,
                                                             double* results );
 
+  /* Versions for arrays of N independent neutron states, with per-neutron     */
+  /* energies and directions given in structure-of-arrays layout (i.e. separate */
+  /* arrays for ekin, ux, uy and uz). All arrays must have length N and must    */
+  /* not overlap in memory. Neutrons outside the domain of a process are passed */
+  /* through unchanged by the sampling functions. Calling these is much more   */
+  /* efficient than calling the single-neutron functions in a loop:            */
+  NCRYSTAL_API void ncrystal_crosssection_many( ncrystal_process_t,
+                                                const double * ekin,
+                                                const double * dirx,
+                                                const double * diry,
+                                                const double * dirz,
+                                                unsigned long N,
+                                                double* results );
+
+  NCRYSTAL_API void ncrystal_samplescatter_manystates( ncrystal_scatter_t,
+                                                       const double * ekin,
+                                                       const double * dirx,
+                                                       const double * diry,
+                                                       const double * dirz,
+                                                       unsigned long N,
+                                                       double* results_ekin,
+                                                       double* results_dirx,
+                                                       double* results_diry,
+                                                       double* results_dirz );
+
+  /* Combined cross section evaluation and scatter sampling (more efficient    */
+  /* than calling the two functions above separately):                         */
+  NCRYSTAL_API void ncrystal_crosssection_and_samplescatter_manystates( ncrystal_scatter_t,
+                                                                        const double * ekin,
+                                                                        const double * dirx,
+                                                                        const double * diry,
+                                                                        const double * dirz,
+                                                                        unsigned long N,
+                                                                        double* results_xs,
+                                                                        double* results_ekin,
+                                                                        double* results_dirx,
+                                                                        double* results_diry,
+                                                                        double* results_dirz );
+
   /*============================================================================== */
   /*============================================================================== */
   /*==                                                                          == */
@@ -1332,7 +1414,9 @@ extern "C" {
   /* tally_json must be deallocated with ncrystal_dealloc_string if not NULL.  */
   /* tally_exitangle_contents and _errsq must be passed to                     */
   /* ncrystal_dealloc_doubleptr after usage. Set nthreads>=9999 for            */
-  /* auto-detection of a suitable number of threads:                           */
+  /* auto-detection of a suitable number of threads. For layered geometries    */
+  /* (layers separated by '|' in mmc_geomcfg), mat_cfgstr can likewise         */
+  /* contain one cfg-string per layer separated by '|' (or "vacuum"):          */
   NCRYSTAL_API void ncrystal_runmmcsim_stdengine( unsigned nthreads,
                                                   unsigned tally_detail_lvl,
                                                   const char * mat_cfgstr,
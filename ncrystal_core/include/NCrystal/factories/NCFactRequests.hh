@@ -87,6 +87,8 @@ namespace NCRYSTAL_NAMESPACE {
 
       //Parameters (basic):
       int get_vdoslux() const;
+      double get_sabtempstep() const;
+      double get_sabegridtol() const;
       bool get_coh_elas() const;
       bool get_incoh_elas() const;
       bool get_sans() const;
@@ -0,0 +1,125 @@
+#ifndef NCrystal_CacheStats_hh
+#define NCrystal_CacheStats_hh
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/core/NCTypes.hh"
+
+namespace NCRYSTAL_NAMESPACE {
+
+  namespace CacheStats {
+
+    // Opt-in instrumentation of the caches used by physics processes to avoid
+    // recalculations when called repeatedly with the same neutron state
+    // (e.g. SCBragg, LCBragg, PowderBragg, or compositions of several
+    // processes). When enabled, cache hits and misses are counted, and the time
+    // spent on recalculations after misses is measured, allowing one to see if
+    // a given simulation is dominated by cache thrashing.
+    //
+    // Collection is disabled by default, and can be enabled either by setting
+    // the environment variable NCRYSTAL_CACHESTATS=1 or by calling enable(..)
+    // below. When disabled, the only overhead is a single (inlined) load of an
+    // atomic flag per cache access. Counts are collected in per-thread
+    // counters, and are summed over all threads (including those which have
+    // already ended) when extracted.
+
+    NCRYSTAL_API void enable( bool = true );
+    bool isEnabled() noexcept;
+
+    namespace detail {
+      //Flag behind isEnabled(). Initialised from NCRYSTAL_CACHESTATS no later
+      //than when the first Category object is constructed:
+      extern NCRYSTAL_API std::atomic<bool> s_enabled;
+    }
+
+    struct NCRYSTAL_API Entry {
+      std::string name;//name of cache (usually the name of the process type)
+      std::uint64_t hits = 0;
+      std::uint64_t misses = 0;
+      double recalcTime = 0.0;//seconds spent recalculating after misses
+    };
+
+    //Get statistics for all caches which have been registered (sorted by
+    //name), or reset all counters to zero:
+    NCRYSTAL_API std::vector<Entry> getStats();
+    NCRYSTAL_API void reset();
+
+    //Same information as getStats() encoded in a JSON list:
+    NCRYSTAL_API std::string getStatsJSON();
+
+    //Code implementing a cache should create a single (static) Category
+    //object, and use it to record hits and misses:
+    //
+    //   static CacheStats::Category s_cachestats("MyProcess");
+    //   ...
+    //   if ( cache is valid ) {
+    //     s_cachestats.recordHit();
+    //   } else {
+    //     CacheStats::Category::MissScope missrecorder(s_cachestats);
+    //     ... recalculate cache contents ...
+    //   }
+
+    class NCRYSTAL_API Category final : private NoCopyMove {
+    public:
+      explicit Category( const char * name );
+      void recordHit() const noexcept { if ( isEnabled() ) addHit(); }
+
+      //Records a miss, and the time spent until the object goes out of scope:
+      class NCRYSTAL_API MissScope final : private NoCopyMove {
+      public:
+        MissScope( const Category& cat ) noexcept
+          : m_cat( isEnabled() ? &cat : nullptr )
+        {
+          if ( m_cat )
+            m_t0 = nowNanoSeconds();
+        }
+        ~MissScope() { if ( m_cat ) m_cat->addMiss( nowNanoSeconds() - m_t0 ); }
+      private:
+        const Category* m_cat;
+        std::uint64_t m_t0 = 0;
+      };
+
+    private:
+      unsigned m_idx;
+      void addHit() const noexcept;
+      void addMiss( std::uint64_t nanoseconds ) const noexcept;
+      static std::uint64_t nowNanoSeconds() noexcept;
+    };
+
+  }
+
+}
+
+
+////////////////////////////
+// Inline implementations //
+////////////////////////////
+
+namespace NCRYSTAL_NAMESPACE {
+
+  inline bool CacheStats::isEnabled() noexcept
+  {
+    return detail::s_enabled.load( std::memory_order_relaxed );
+  }
+
+}
+
+#endif
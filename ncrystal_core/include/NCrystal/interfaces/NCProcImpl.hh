@@ -151,6 +151,23 @@ namespace NCRYSTAL_NAMESPACE {
       virtual std::pair<CrossSect,ScatterOutcomeIsotropic>
         evalXSAndSampleScatterIsotropic(CachePtr&, RNG&, NeutronEnergy ) const = 0;
 
+      //Batched scattering methods, sampling scatterings for N independent
+      //neutron states provided in structure-of-arrays layout (per-element
+      //energies and directions). As for evalManyXS, all passed arrays are
+      //required to be non-aliasing. Neutrons outside the domain of the process
+      //are passed through unchanged. These can only be called when processType
+      //is Scatter:
+      virtual void sampleScatterMany( CachePtr&, RNG&, const double* ekin,
+                                      const double* ux, const double* uy, const double* uz,
+                                      std::size_t N,
+                                      double* out_ekin, double* out_ux,
+                                      double* out_uy, double* out_uz ) const = 0;
+      virtual void evalXSAndSampleScatterMany( CachePtr&, RNG&, const double* ekin,
+                                               const double* ux, const double* uy, const double* uz,
+                                               std::size_t N, double* out_xs,
+                                               double* out_ekin, double* out_ux,
+                                               double* out_uy, double* out_uz ) const = 0;
+
 #endif
       //Callers who would like to reduce allocations during their event loops,
       //can call the following function which is likely (but not 100%
@@ -213,6 +230,14 @@ namespace NCRYSTAL_NAMESPACE {
         evalXSAndSampleScatter( CachePtr&, RNG&, NeutronEnergy, const NeutronDirection& ) const override;
       std::pair<CrossSect,ScatterOutcomeIsotropic>
         evalXSAndSampleScatterIsotropic(CachePtr&, RNG&, NeutronEnergy ) const override;
+      void sampleScatterMany( CachePtr&, RNG&, const double*,
+                              const double*, const double*, const double*,
+                              std::size_t, double*, double*,
+                              double*, double* ) const override;
+      void evalXSAndSampleScatterMany( CachePtr&, RNG&, const double*,
+                                       const double*, const double*, const double*,
+                                       std::size_t, double*, double*, double*,
+                                       double*, double* ) const override;
 #endif
 
       // NB: Several methods are marked as "override" here instead of "final",
@@ -245,9 +270,16 @@ namespace NCRYSTAL_NAMESPACE {
         evalXSAndSampleScatter( CachePtr&, RNG&, NeutronEnergy, const NeutronDirection& ) const override;
       std::pair<CrossSect,ScatterOutcomeIsotropic>
         evalXSAndSampleScatterIsotropic(CachePtr&, RNG&, NeutronEnergy ) const override;
+      void sampleScatterMany( CachePtr&, RNG&, const double*,
+                              const double*, const double*, const double*,
+                              std::size_t, double*, double*,
+                              double*, double* ) const override;
+      void evalXSAndSampleScatterMany( CachePtr&, RNG&, const double*,
+                                       const double*, const double*, const double*,
+                                       std::size_t, double*, double*, double*,
+                                       double*, double* ) const override;
 #endif
 
-
     };
 
     ///////////////////////////////////////////////////////////////////////////////
@@ -280,6 +312,14 @@ namespace NCRYSTAL_NAMESPACE {
         evalXSAndSampleScatter( CachePtr&, RNG&, NeutronEnergy, const NeutronDirection& ) const final;
       std::pair<CrossSect,ScatterOutcomeIsotropic>
         evalXSAndSampleScatterIsotropic(CachePtr&, RNG&, NeutronEnergy ) const final;
+      void sampleScatterMany( CachePtr&, RNG&, const double*,
+                              const double*, const double*, const double*,
+                              std::size_t, double*, double*,
+                              double*, double* ) const final;
+      void evalXSAndSampleScatterMany( CachePtr&, RNG&, const double*,
+                                       const double*, const double*, const double*,
+                                       std::size_t, double*, double*, double*,
+                                       double*, double* ) const final;
 #endif
     };
 
@@ -357,6 +397,16 @@ namespace NCRYSTAL_NAMESPACE {
                        double* out_xs ) const override;
       void evalManyXSIsotropic( CachePtr&, const double* ekin, std::size_t N,
                                 double* out_xs ) const override;
+      void sampleScatterMany( CachePtr&, RNG&, const double* ekin,
+                              const double* ux, const double* uy, const double* uz,
+                              std::size_t N,
+                              double* out_ekin, double* out_ux,
+                              double* out_uy, double* out_uz ) const override;
+      void evalXSAndSampleScatterMany( CachePtr&, RNG&, const double* ekin,
+                                       const double* ux, const double* uy, const double* uz,
+                                       std::size_t N, double* out_xs,
+                                       double* out_ekin, double* out_ux,
+                                       double* out_uy, double* out_uz ) const override;
 #endif
 
     protected:
@@ -410,6 +460,14 @@ namespace NCRYSTAL_NAMESPACE {
         evalXSAndSampleScatter( CachePtr&, RNG&, NeutronEnergy, const NeutronDirection& ) const override;
       std::pair<CrossSect,ScatterOutcomeIsotropic>
         evalXSAndSampleScatterIsotropic(CachePtr&, RNG&, NeutronEnergy ) const override;
+      void sampleScatterMany( CachePtr&, RNG&, const double*,
+                              const double*, const double*, const double*,
+                              std::size_t, double*, double*,
+                              double*, double* ) const override;
+      void evalXSAndSampleScatterMany( CachePtr&, RNG&, const double*,
+                                       const double*, const double*, const double*,
+                                       std::size_t, double*, double*, double*,
+                                       double*, double* ) const override;
 #endif
     };
 
@@ -423,6 +481,14 @@ namespace NCRYSTAL_NAMESPACE {
         evalXSAndSampleScatter( CachePtr&, RNG&, NeutronEnergy, const NeutronDirection& ) const override;
       std::pair<CrossSect,ScatterOutcomeIsotropic>
         evalXSAndSampleScatterIsotropic(CachePtr&, RNG&, NeutronEnergy ) const override;
+      void sampleScatterMany( CachePtr&, RNG&, const double*,
+                              const double*, const double*, const double*,
+                              std::size_t, double*, double*,
+                              double*, double* ) const override;
+      void evalXSAndSampleScatterMany( CachePtr&, RNG&, const double*,
+                                       const double*, const double*, const double*,
+                                       std::size_t, double*, double*, double*,
+                                       double*, double* ) const override;
 #endif
     };
 
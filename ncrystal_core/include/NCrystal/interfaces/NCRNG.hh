@@ -46,7 +46,17 @@ namespace NCRYSTAL_NAMESPACE {
   NCRYSTAL_API shared_obj<RNGStream> createBuiltinRNG( uint64_t seed = 0 );
   NCRYSTAL_API shared_obj<RNGStream> createBuiltinRNG( const RNGStreamState& state );
 
-  //Check whether a given RNG state is from the builtin RNG:
+  //Alternatively, a builtin counter-based RNG (Philox4x32-10) can be used. Its
+  //streams are identified by a (key,stream id) pair and can be created in O(1)
+  //by index, so when registered with setDefaultRNG(..), streams obtained via
+  //RNGProducer::produceByIdx (e.g. via Scatter::cloneByIdx) only depend on
+  //the seed and the index, and not on thread counts or the order in which
+  //streams were produced. This is useful when splitting a large job over many
+  //processes or threads. Its states can also be passed to
+  //createBuiltinRNG(state):
+  NCRYSTAL_API shared_obj<RNGStream> createCounterBasedRNG( uint64_t seed = 0 );
+
+  //Check whether a given RNG state is from one of the builtin RNGs:
   NCRYSTAL_API bool stateIsFromBuiltinRNG(const RNGStreamState&);
 
   // The RNGStream and RNGProducer classes are most likely to be of interest
@@ -129,7 +139,10 @@ namespace NCRYSTAL_NAMESPACE {
     shared_obj<RNGStream> produce();
 
     //Produce independent stream by index. Calling later with the same index
-    //will return the same stream:
+    //will return the same stream. For counter-based streams (see
+    //createCounterBasedRNG), the stream is a direct function of the original
+    //stream and the index, and is never identical to any of the streams
+    //returned by produce():
     shared_obj<RNGStream> produceByIdx( RNGStreamIndex );
 
     //Produce independent stream for current thread. All calls within a given
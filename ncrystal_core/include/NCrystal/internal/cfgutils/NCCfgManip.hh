@@ -177,6 +177,12 @@ namespace NCRYSTAL_NAMESPACE {
       static int get_vdoslux(const CfgData& data) { return static_cast<int>( getValue<vardef_vdoslux>(data) ); }
       static void set_vdoslux( CfgData& data, int val ) { setValue<vardef_vdoslux>( data, static_cast<std::int64_t>(val) ); }
 
+      static double get_sabtempstep(const CfgData& data) { return getValue<vardef_sabtempstep>(data); }
+      static void set_sabtempstep( CfgData& data, double val ) { setValue<vardef_sabtempstep>(data,val); }
+
+      static double get_sabegridtol(const CfgData& data) { return getValue<vardef_sabegridtol>(data); }
+      static void set_sabegridtol( CfgData& data, double val ) { setValue<vardef_sabegridtol>(data,val); }
+
       static std::int_least32_t get_lcmode(const CfgData& data) { return static_cast<std::int_least32_t>( getValue<vardef_lcmode>(data) ); }
       static void set_lcmode( CfgData& data, std::int_least32_t val ) { setValue<vardef_lcmode>( data,static_cast<std::int_least32_t>(val) ); }
 
@@ -226,6 +226,55 @@ namespace NCRYSTAL_NAMESPACE {
       }
     };
 
+    struct vardef_sabtempstep final : public ValDbl<vardef_sabtempstep> {
+      static constexpr auto name = "sabtempstep";
+      static constexpr auto group = VarGroupId::ScatterBase;
+      static constexpr auto description =
+        "Temperature step (in Kelvin) of a ladder of temperatures at which scattering"
+        " kernels are expanded from phonon spectrums (VDOS). The default value of 0 disables"
+        " this, and kernels are simply expanded at the temperature of the material. For a"
+        " positive value, kernels are instead only ever expanded at integral multiples of the"
+        " step, and scattering at intermediate temperatures is modelled by linearly"
+        " interpolating the cross sections of the two kernels at the bracketing ladder"
+        " temperatures, and by sampling each scattering from one of those two kernels, picked"
+        " randomly in proportion to its contribution to the interpolated cross section."
+        " Since kernels are shared between materials at different temperatures, this can"
+        " drastically reduce initialisation time and memory usage when many different temperatures"
+        " are needed, at the cost of an approximation which is good when the step is small"
+        " compared to the temperature. Temperatures below the first step, as well as directly"
+        " specified kernels which are only available at a single temperature, are not affected.";
+      static constexpr value_type default_value() { return 0.0; }
+      using units = units_purenumberonly;
+      static double value_validate( double value )
+      {
+        if ( !( value >= 0.0 ) || value > 1e4 )
+          NCRYSTAL_THROW2(BadInput,name<<" must be in range [0,1e4]");
+        return value;
+      }
+    };
+
+    struct vardef_sabegridtol final : public ValDbl<vardef_sabegridtol> {
+      static constexpr auto name = "sabegridtol";
+      static constexpr auto group = VarGroupId::ScatterBase;
+      static constexpr auto description =
+        "Relative tolerance for adaptive construction of the energy grids at which"
+        " scattering kernels (S(alpha,beta)) are analysed. The default value of 0 disables"
+        " this, and a fixed grid of energy points is used. For a positive value, the grid"
+        " instead starts out coarse and is only refined in regions where linear interpolation"
+        " of the inelastic cross section between grid points is off by more than the tolerance"
+        " (or where sampling would become inefficient). This reduces initialisation time and"
+        " memory usage for smooth kernels. The adaptive grid is never finer than the fixed grid,"
+        " and energy grids fully specified in the input data are used as they are.";
+      static constexpr value_type default_value() { return 0.0; }
+      using units = units_purenumberonly;
+      static double value_validate( double value )
+      {
+        if ( !( value >= 0.0 ) || value > 0.1 )
+          NCRYSTAL_THROW2(BadInput,name<<" must be in range [0,0.1]");
+        return value;
+      }
+    };
+
     struct vardef_lcaxis final : public ValVector<vardef_lcaxis> {
       static constexpr auto name = "lcaxis";
       static constexpr auto group = VarGroupId::ScatterExtra;
@@ -664,6 +713,8 @@ namespace NCRYSTAL_NAMESPACE {
       make_varinfo<vardef_lcmode>(),
       make_varinfo<vardef_mos>(),
       make_varinfo<vardef_mosprec>(),
+      make_varinfo<vardef_sabegridtol>(),
+      make_varinfo<vardef_sabtempstep>(),
       make_varinfo<vardef_sans>(),
       make_varinfo<vardef_scatfactory>(),
       make_varinfo<vardef_sccutoff>(),
@@ -685,6 +736,8 @@ namespace NCRYSTAL_NAMESPACE {
       dirtol = constexpr_varName2Idx("dirtol"),
       mosprec = constexpr_varName2Idx("mosprec"),
       vdoslux = constexpr_varName2Idx("vdoslux"),
+      sabtempstep = constexpr_varName2Idx("sabtempstep"),
+      sabegridtol = constexpr_varName2Idx("sabegridtol"),
       lcmode = constexpr_varName2Idx("lcmode"),
       lcaxis = constexpr_varName2Idx("lcaxis"),
       ucnmode = constexpr_varName2Idx("ucnmode"),
@@ -46,7 +46,10 @@ namespace NCRYSTAL_NAMESPACE {
   //
   //Unless useCache=false is set, a MT-safe caching mechanism will be employed
   //behind the scene in order to prevent duplication of work in case of repeated
-  //calls. The cache can obviously be cleared with the
+  //calls. For VDOS-based kernels (with vdos2sabExcludeFlag=0), the cache key is
+  //based on the VDOS content and temperature rather than the identity of the
+  //DI_ScatKnl object, so kernels are shared between all materials with the same
+  //VDOS at the same temperature. The cache can obviously be cleared with the
   //clearSABDataFromDynInfoCaches function (automatically invoked by the global
   //clearCaches function):
   shared_obj<const SABData> extractSABDataFromDynInfo( const DI_ScatKnl*,
@@ -54,6 +57,19 @@ namespace NCRYSTAL_NAMESPACE {
                                                        bool useCache = true,
                                                        std::uint32_t vdos2sabExcludeFlag = 0 );
 
+  //Similar to extractSABDataFromDynInfo, but expanding the kernel at a
+  //different temperature than the one of the DI_ScatKnl object itself. This is
+  //only possible for kernels based on a VDOS (or VDOSDebye), and a nullptr is
+  //returned for directly specified kernels. Results are always cached, and
+  //since the cache key is based on the actual VDOS content rather than the
+  //identity of the DI_ScatKnl object, kernels will be shared between different
+  //materials (e.g. the same material at different temperatures). Expanding at
+  //the temperature of the DI_ScatKnl object itself gives the same kernel
+  //object as extractSABDataFromDynInfo:
+  std::shared_ptr<const SABData> extractSABDataFromDynInfoAtTemperature( const DI_ScatKnl*,
+                                                                         Temperature,
+                                                                         unsigned vdoslux = 3 );
+
   shared_obj<const SABData> extractSABDataFromVDOSDebyeModel( DebyeTemperature, Temperature, SigmaBound, AtomMass,
                                                               unsigned vdoslux = 3, bool useCache = true );
   void clearSABDataFromDynInfoCaches();
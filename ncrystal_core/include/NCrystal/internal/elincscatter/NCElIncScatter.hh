@@ -33,6 +33,9 @@ namespace NCRYSTAL_NAMESPACE {
     bool use_sigma_incoherent = true;
     bool use_sigma_coherent = false;
     double scale_factor = 1.0;
+    //Use precomputed cross section tables (see ElIncXS::enableTabulation). This
+    //can also be enabled globally by setting NCRYSTAL_ELINC_TABULATE=1:
+    bool tabulate = false;
   };
 
   class ElIncScatter final : public ProcImpl::ScatterIsotropicMat {
@@ -62,7 +65,9 @@ namespace NCRYSTAL_NAMESPACE {
     //available, otherwise from DynInfo objects. In that case, elements whose
     //DynInfo is unable to provide Debye Waller factors, e.g. sterile/freegas
     //and for now scatknl, will be ignored (if all elements are ignored, an
-    //error is raised).
+    //error is raised). Optionally, cross sections and element selections can
+    //be based on precomputed tables, for faster evaluation in materials with
+    //many elements.
     ElIncScatter( const Info&, const ElIncScatterCfg& cfg = ElIncScatterCfg() );
 
     CrossSect crossSectionIsotropic(CachePtr&, NeutronEnergy ) const override;
@@ -86,6 +91,16 @@ namespace NCRYSTAL_NAMESPACE {
     std::pair<CrossSect,ScatterOutcomeIsotropic>
     evalXSAndSampleScatterIsotropic(CachePtr&, RNG&, NeutronEnergy ) const override;
     void evalManyXSIsotropic( CachePtr&, const double* ekin, std::size_t N, double* out_xs ) const override;
+    void sampleScatterMany( CachePtr&, RNG&, const double* ekin,
+                            const double* ux, const double* uy, const double* uz,
+                            std::size_t N,
+                            double* out_ekin, double* out_ux,
+                            double* out_uy, double* out_uz ) const override;
+    void evalXSAndSampleScatterMany( CachePtr&, RNG&, const double* ekin,
+                                     const double* ux, const double* uy, const double* uz,
+                                     std::size_t N, double* out_xs,
+                                     double* out_ekin, double* out_ux,
+                                     double* out_uy, double* out_uz ) const override;
 #endif
 
   protected:
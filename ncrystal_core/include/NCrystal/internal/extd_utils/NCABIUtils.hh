@@ -128,6 +128,52 @@ namespace NCRYSTAL_NAMESPACE {
           (void)i;
           *out_xs++ = p.crossSectionIsotropic( cp, NeutronEnergy{*ekin++} ).dbl();
         }
+#endif
+      }
+
+      inline void sampleScatterMany( const Process& p, CachePtr& cp, RNG& rng,
+                                     const double* ekin,
+                                     const double* ux, const double* uy, const double* uz,
+                                     std::size_t N,
+                                     double* out_ekin, double* out_ux,
+                                     double* out_uy, double* out_uz )
+      {
+#ifdef NCRYSTAL_ALLOW_ABI_BREAKAGE
+        return p.sampleScatterMany( cp, rng, ekin, ux, uy, uz, N,
+                                    out_ekin, out_ux, out_uy, out_uz );
+#else
+        for ( auto i : ncrange(N) ) {
+          auto outcome = p.sampleScatter( cp, rng, NeutronEnergy{ekin[i]},
+                                          NeutronDirection{ ux[i], uy[i], uz[i] } );
+          out_ekin[i] = outcome.ekin.dbl();
+          out_ux[i] = outcome.direction[0];
+          out_uy[i] = outcome.direction[1];
+          out_uz[i] = outcome.direction[2];
+        }
+#endif
+      }
+
+      inline void evalXSAndSampleScatterMany( const Process& p, CachePtr& cp, RNG& rng,
+                                              const double* ekin,
+                                              const double* ux, const double* uy, const double* uz,
+                                              std::size_t N, double* out_xs,
+                                              double* out_ekin, double* out_ux,
+                                              double* out_uy, double* out_uz )
+      {
+#ifdef NCRYSTAL_ALLOW_ABI_BREAKAGE
+        return p.evalXSAndSampleScatterMany( cp, rng, ekin, ux, uy, uz, N, out_xs,
+                                             out_ekin, out_ux, out_uy, out_uz );
+#else
+        for ( auto i : ncrange(N) ) {
+          NeutronEnergy e{ekin[i]};
+          NeutronDirection d{ ux[i], uy[i], uz[i] };
+          out_xs[i] = p.crossSection( cp, e, d ).dbl();
+          auto outcome = p.sampleScatter( cp, rng, e, d );
+          out_ekin[i] = outcome.ekin.dbl();
+          out_ux[i] = outcome.direction[0];
+          out_uy[i] = outcome.direction[1];
+          out_uz[i] = outcome.direction[2];
+        }
 #endif
       }
     }
@@ -157,7 +157,9 @@ namespace NCRYSTAL_NAMESPACE {
   class LCHelper : private MoveOnly {
     //Class which can provide cross-sections and scatterings for planes with
     //normals not parallel to the lcaxis. Prec and ntrunc parameters will be
-    //passed on directly to the internal GaussMos object.
+    //passed on directly to the internal GaussMos object. The ncacheentries
+    //parameter is the number of recent neutron states for which results are
+    //kept in each Cache object (least recently used states are recycled first).
   public:
     LCHelper( LCAxis lcaxis_crystalframe,
               LCAxis lcaxis_labframe,
@@ -165,7 +167,8 @@ namespace NCRYSTAL_NAMESPACE {
               double unitcell_volume_times_natoms,
               PlaneProvider * pp,
               double prec = 1e-3,
-              double ntrunc = 0.0 );
+              double ntrunc = 0.0,
+              unsigned ncacheentries = 1 );
 
     //Usage happens via Cache objects (allowing users of the class to decide
     //upon caching strategies themselves). One should not share Cache objects
@@ -193,6 +196,7 @@ namespace NCRYSTAL_NAMESPACE {
     std::vector<LCPlaneSet> m_planes;//sorted by dspacing, largest first.
     LCStdFrame m_lcstdframe;
     double m_xsfact;
+    std::size_t m_ncacheentries;
     void forceUpdateCache( Cache&, uint64_t discr_wl, uint64_t discr_c3 ) const;
     struct Overlay : private MoveOnly {
       static constexpr unsigned ndata = 8;
@@ -215,13 +219,22 @@ namespace NCRYSTAL_NAMESPACE {
       void invalidateCache() override { reset(); }
     private:
       friend class LCHelper;
-      std::pair<uint64_t,uint64_t> m_signature;//discretised (wavelength,c3)
-      double m_wl;//<-- Neutron wavelength. Actually dediscretized m_signature.first
-      double m_c3;//<-- dot(indir,lcaxis). Actually dediscretized m_signature.second.
-      double m_s3;//sqrt(1-m_c3*m_c3)
-      std::vector<LCROI> m_roilist;
-      VectD m_roixs_commul;//for selecting
-      std::vector<Overlay> m_roi_overlays;//for selecting
+      struct Entry {
+        Entry();//default constructs invalid entry
+        void reset();
+        std::pair<uint64_t,uint64_t> m_signature;//discretised (wavelength,c3)
+        double m_wl;//<-- Neutron wavelength. Actually dediscretized m_signature.first
+        double m_c3;//<-- dot(indir,lcaxis). Actually dediscretized m_signature.second.
+        double m_s3;//sqrt(1-m_c3*m_c3)
+        std::vector<LCROI> m_roilist;
+        VectD m_roixs_commul;//for selecting
+        std::vector<Overlay> m_roi_overlays;//for selecting
+        std::uint64_t m_lastused = 0;//for LRU bookkeeping
+      };
+      std::vector<Entry> m_entries;//never empty
+      std::size_t m_current = 0;//entry selected in last call to ensureValid
+      std::uint64_t m_usecount = 0;
+      Entry& current() { nc_assert(m_current<m_entries.size()); return m_entries[m_current]; }
     };
   };
 }
@@ -264,9 +277,13 @@ namespace NCRYSTAL_NAMESPACE {
     nc_assert( normal_sign==1. || normal_sign==-1. );
   }
 
-  inline LCHelper::Cache::Cache() : m_signature(std::numeric_limits<uint64_t>::max(),
-                                                std::numeric_limits<uint64_t>::max()),
-                                    m_wl(-99), m_c3(-99), m_s3(-99)
+  inline LCHelper::Cache::Entry::Entry() : m_signature(std::numeric_limits<uint64_t>::max(),
+                                                       std::numeric_limits<uint64_t>::max()),
+                                           m_wl(-99), m_c3(-99), m_s3(-99)
+  {
+    //Starts in same state as after calling Entry::reset()
+  }
+  inline LCHelper::Cache::Cache() : m_entries(1)
   {
     //Starts in same state as after calling Cache::reset()
   }
@@ -24,6 +24,11 @@
 #include "NCrystal/core/NCDefs.hh"
 #include "NCrystal/core/NCSmallVector.hh"
 #include "NCrystal/internal/utils/NCMsg.hh"
+#include <list>
+#include <unordered_map>
+#ifndef NCRYSTAL_DISABLE_THREADS
+#  include <condition_variable>
+#endif
 
 namespace NCRYSTAL_NAMESPACE {
 
@@ -46,6 +51,9 @@ namespace NCRYSTAL_NAMESPACE {
     }
   };
 
+  template<class TKey>
+  std::size_t cachedFactoryShardHash( const TKey& );
+
   template< class TKey,
             class TValue,
             unsigned NStrongRefsKept = 5,
@@ -68,6 +76,15 @@ namespace NCRYSTAL_NAMESPACE {
     // global clearCaches function which will in turn call the cleanup function of
     // all factories.
     //
+    // To reduce lock contention when many threads use the same factory, the
+    // cache is split into a number of shards, each with their own mutex. The
+    // shard of a given key is selected by cachedFactoryShardHash(key), which
+    // will use a key.shardHash() member function if available (keys which are
+    // equivalent after thinning must return the same value). Additionally,
+    // concurrent top-level requests for a key which is currently being
+    // constructed in another thread will wait for that construction to finish,
+    // rather than needlessly constructing the same object again.
+    //
     /////////////////////////////////////////////////////////////////////////////////
 
     using key_type = TKey;
@@ -101,19 +118,36 @@ namespace NCRYSTAL_NAMESPACE {
   protected:
     virtual ShPtr actualCreate(const key_type&) const = 0;
   private:
+    struct InFlight;
     struct CacheEntry {
       WeakPtr weakPtr;
       unsigned nwork = 0;
       unsigned ncleanup = 0;
+      std::shared_ptr<InFlight> inflight;//set while a top-level construction is ongoing
     };
     using CacheMap = std::map<thinned_key_type,CacheEntry>;
-    CacheMap m_cache;
-    std::mutex m_mutex;
-    unsigned m_ncleanup = 0;
+    static constexpr unsigned nshards = 16;
+    struct Shard {
+      std::mutex mutex;
+      CacheMap cache;
+    };
+    Shard m_shards[nshards];
+    Shard& shardFor( const key_type& key )
+    {
+      std::size_t h = cachedFactoryShardHash( key );
+      h ^= ( h >> 29 );
+      h *= static_cast<std::size_t>(0xbf58476d1ce4e5b9ull);
+      return m_shards[ ( h >> 17 ) % nshards ];
+    }
+    unsigned m_ncleanup = 0;//modified only with all shard mutexes locked
     class StrongRefKeeper;
-    StrongRefKeeper m_strongRefs;
-    bool m_cleanupNeedsRegistry = true;
+    StrongRefKeeper m_strongRefs;//has its own mutex, always locked after shard mutexes
+    std::mutex m_cbmutex;
+    std::atomic<bool> m_cleanupNeedsRegistry{true};
     SmallVector<voidfct_t,1,SVMode::LOWFOOTPRINT> m_cleanupCallbacks;
+    void ensureCleanupRegistered();
+    void finishInFlight( Shard&, const key_type&, Optional<thinned_key_type>&,
+                         const std::shared_ptr<InFlight>& );
   };
 
   ///////////////////////////////////////////////////////////////////////////
@@ -135,80 +169,212 @@ namespace NCRYSTAL_NAMESPACE {
 
   namespace thread_details {
     std::string currentThreadIDForPrint();
+
+    //Number of factory constructions (or factory jobs) currently ongoing in
+    //the calling thread:
+    unsigned& factoryConstructionDepth();
+    class FactoryConstructionScope final : private NoCopyMove {
+    public:
+      FactoryConstructionScope() { ++factoryConstructionDepth(); }
+      ~FactoryConstructionScope() { --factoryConstructionDepth(); }
+    };
   }
 
+  namespace detail_cfb {
+    template<unsigned N> struct prio : prio<N-1> {};
+    template<> struct prio<0> {};
+
+    template<class T>
+    inline auto shardHash( const T& k, prio<3> ) -> decltype(static_cast<std::size_t>(k.shardHash()))
+    {
+      return static_cast<std::size_t>(k.shardHash());
+    }
+
+    template<class T>
+    inline typename std::enable_if<std::is_integral<T>::value||std::is_enum<T>::value,std::size_t>::type
+    shardHash( const T& k, prio<2> )
+    {
+      return static_cast<std::size_t>(k);
+    }
+
+    inline std::size_t shardHash( const std::string& k, prio<2> )
+    {
+      return std::hash<std::string>()(k);
+    }
+
+    inline std::size_t shardHash( const UniqueIDValue& k, prio<2> )
+    {
+      return static_cast<std::size_t>(k.value);
+    }
+
+    template<class T>
+    inline std::size_t shardHash( const T&, prio<0> )
+    {
+      //No suitable hash available, all keys will end up in the same shard.
+      return 0;
+    }
+
+    template<class T0, class T1>
+    inline std::size_t shardHash( const std::pair<T0,T1>& k, prio<1> )
+    {
+      return shardHash( k.first, prio<3>() );
+    }
+
+    template<class T0, class... TOthers>
+    inline std::size_t shardHash( const std::tuple<T0,TOthers...>& k, prio<1> )
+    {
+      return shardHash( std::get<0>(k), prio<3>() );
+    }
+  }
+
+  template<class TKey>
+  inline std::size_t cachedFactoryShardHash( const TKey& key )
+  {
+    return detail_cfb::shardHash( key, detail_cfb::prio<3>() );
+  }
+
+  template<class TKey, class TValue, unsigned NStrongRefsKept,class TKT>
+  struct CachedFactoryBase<TKey,TValue,NStrongRefsKept,TKT>::InFlight {
+#ifndef NCRYSTAL_DISABLE_THREADS
+    std::mutex mutex;
+    std::condition_variable condvar;
+    bool done = false;
+    void wait()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condvar.wait( lock, [this](){ return this->done; } );
+    }
+    void markDone()
+    {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        done = true;
+      }
+      condvar.notify_all();
+    }
+#else
+    void wait() { nc_assert_always(false); }
+    void markDone() {}
+#endif
+  };
+
   template<class TKey, class TValue, unsigned NStrongRefsKept,class TKT>
   class CachedFactoryBase<TKey,TValue,NStrongRefsKept,TKT>::StrongRefKeeper {
 
-    std::vector<ShPtr> m_v;
+    //Keeps the strong refs ordered by access (most recent last), with an index
+    //into the list, so that all operations are O(1). Functions which might
+    //release a strong ref return it, so the caller can release it after
+    //unlocking any mutexes (in case the destructor of the object invokes other
+    //factories).
 
-    static void reserveCapacity( std::vector<ShPtr>& v )
+    using List = std::list<ShPtr>;
+    List m_list;
+    std::unordered_map<const value_type*,typename List::iterator> m_index;
+    std::mutex m_mutex;
+
+    static constexpr bool keepNone = ( NStrongRefsKept == 0 );
+    static constexpr bool keepAll = ( NStrongRefsKept == CachedFactory_KeepAllStrongRefs );
+
+    ShPtr addUnlocked( const ShPtr& sp )
     {
-      if (NStrongRefsKept>0)
-        v.reserve(NStrongRefsKept > 512 ? 512 : NStrongRefsKept);
+      ShPtr evicted;
+      if ( m_list.size() >= NStrongRefsKept ) {
+        //make room, discard first entry (was accessed longest ago).
+        evicted = std::move( m_list.front() );
+        m_index.erase( evicted.get() );
+        m_list.pop_front();
+      }
+      m_list.push_back( sp );
+      m_index[sp.get()] = std::prev( m_list.end() );
+      return evicted;
     }
 
   public:
-    StrongRefKeeper()  { reserveCapacity(m_v); }
-    void clear() { m_v.clear(); }
-    bool empty() const { return m_v.empty(); }
-    std::size_t size() const { return static_cast<std::size_t>(m_v.size()); }
-    void wasAccessedAndIsNotInList( const ShPtr& sp ) {
+    void clear( List& discarded )
+    {
+      NCRYSTAL_LOCK_GUARD(m_mutex);
+      discarded.splice( discarded.end(), m_list );
+      m_index.clear();
+    }
+
+    std::size_t size()
+    {
+      NCRYSTAL_LOCK_GUARD(m_mutex);
+      return static_cast<std::size_t>(m_list.size());
+    }
+
+    ShPtr wasAccessedAndIsNotInList( const ShPtr& sp ) {
       //was just created, so we know it is not already in the list.
-      if (NStrongRefsKept==0)
-        return;
-      if (NStrongRefsKept==CachedFactory_KeepAllStrongRefs) {
-        m_v.push_back( sp );
-        return;
-      }
-      if ( m_v.size()==NStrongRefsKept ) {
-        //make room, discard first entry (was accessed longest ago).
-        for ( auto i : ncrange(typename decltype(m_v)::size_type(1),m_v.size() ) )
-          m_v[i-1] = std::move(m_v[i]);
-        m_v.pop_back();
+      if ( keepNone || sp == nullptr )
+        return nullptr;
+      NCRYSTAL_LOCK_GUARD(m_mutex);
+      if ( keepAll ) {
+        m_list.push_back( sp );
+        return nullptr;
       }
-      m_v.push_back( sp );
+      return addUnlocked( sp );
     }
 
-    void wasAccessed( const ShPtr& sp ) {
-      //was accessed, might (or might not) already be in the list.
-      //NStrongRefsKept==CachedFactory_KeepAllStrongRefs
-      if (NStrongRefsKept==0)
-        return;
-      //Check if we already have it:
-      auto it = m_v.begin();
-      auto itE = m_v.end();
-      for (;it!=itE;++it) {
-        if ( *it == sp ) {
-          //Already there! Shuffle it to the end:
-          if ( std::next(it) == itE )
-            return;//already at end
-          auto itLast = std::prev(itE);
-          for ( ;it!=itLast; ++it)
-            *it = std::move(*std::next(it));
-          *itLast = sp;
-          return;
-        }
+    ShPtr wasAccessed( const ShPtr& sp ) {
+      //was accessed, might (or might not) already be in the list. When keeping
+      //all refs, any object in the cache is already in the list.
+      if ( keepNone || keepAll )
+        return nullptr;
+      NCRYSTAL_LOCK_GUARD(m_mutex);
+      auto it = m_index.find( sp.get() );
+      if ( it != m_index.end() ) {
+        //Already there! Move it to the end:
+        m_list.splice( m_list.end(), m_list, it->second );
+        return nullptr;
       }
       //was not already in the list:
-      wasAccessedAndIsNotInList(sp);
+      return addUnlocked( sp );
     }
   };
 
   template<class TKey,class TValue,unsigned N,class TKT>
   inline void CachedFactoryBase<TKey,TValue,N,TKT>::registerCleanupCallback(voidfct_t fn)
   {
-    NCRYSTAL_LOCK_GUARD(m_mutex);
+    NCRYSTAL_LOCK_GUARD(m_cbmutex);
     m_cleanupCallbacks.push_back(fn);
   }
 
+  template<class TKey,class TValue,unsigned N,class TKT>
+  inline void CachedFactoryBase<TKey,TValue,N,TKT>::ensureCleanupRegistered()
+  {
+    if ( !m_cleanupNeedsRegistry.load() )
+      return;
+    {
+      NCRYSTAL_LOCK_GUARD(m_cbmutex);
+      if ( !m_cleanupNeedsRegistry.load() )
+        return;
+      m_cleanupNeedsRegistry = false;
+    }
+    voidfct_t fct_cleanup = [this](){ this->cleanup(); };
+    registerCacheCleanupFunction(fct_cleanup);
+  }
+
   template<class TKey,class TValue,unsigned N,class TKT>
   inline void CachedFactoryBase<TKey,TValue,N,TKT>::cleanup()
   {
-    NCRYSTAL_LOCK_GUARD(m_mutex);
-    ++m_ncleanup;
-    m_strongRefs.clear();
-    m_cache.clear();
+    //Objects are released only after all mutexes are unlocked:
+    std::vector<CacheMap> discarded_maps;
+    discarded_maps.reserve( nshards );
+    std::list<ShPtr> discarded_refs;
+    {
+      //Lock all shards (always in the same order):
+      for ( auto& shard : m_shards )
+        NCRYSTAL_LOCK_MUTEX(shard.mutex);
+      ++m_ncleanup;
+      for ( auto& shard : m_shards ) {
+        discarded_maps.emplace_back();
+        discarded_maps.back().swap( shard.cache );
+      }
+      m_strongRefs.clear( discarded_refs );
+      for ( auto& shard : m_shards )
+        NCRYSTAL_UNLOCK_MUTEX(shard.mutex);
+    }
+    NCRYSTAL_LOCK_GUARD(m_cbmutex);
     for ( const auto& fn : m_cleanupCallbacks )
       fn();
   }
@@ -216,66 +382,125 @@ namespace NCRYSTAL_NAMESPACE {
   template<class TKey,class TValue,unsigned N,class TKT>
   inline typename CachedFactoryBase<TKey,TValue,N,TKT>::Stats CachedFactoryBase<TKey,TValue,N,TKT>::currentStats()
   {
-    NCRYSTAL_LOCK_GUARD(m_mutex);
     Stats s;
     s.nstrongrefs = m_strongRefs.size();
-    s.nweakrefs = static_cast<std::size_t>(m_cache.size());
+    s.nweakrefs = 0;
+    for ( auto& shard : m_shards ) {
+      NCRYSTAL_LOCK_GUARD(shard.mutex);
+      s.nweakrefs += static_cast<std::size_t>(shard.cache.size());
+    }
     return s;
   }
 
+  template<class TKey,class TValue,unsigned N,class TKT>
+  inline void CachedFactoryBase<TKey,TValue,N,TKT>::finishInFlight( Shard& shard,
+                                                                     const key_type& key,
+                                                                     Optional<thinned_key_type>& thinned_key,
+                                                                     const std::shared_ptr<InFlight>& inflight )
+  {
+    //Construction failed with an exception, no longer work on the key:
+    {
+      NCRYSTAL_LOCK_GUARD(shard.mutex);
+      auto& cache_entry = TKT::cacheMapLookup( shard.cache, key, thinned_key );
+      if ( cache_entry.nwork > 0 )
+        --cache_entry.nwork;
+      if ( inflight != nullptr && cache_entry.inflight == inflight )
+        cache_entry.inflight.reset();
+    }
+    if ( inflight != nullptr )
+      inflight->markDone();
+  }
+
   template<class TKey,class TValue,unsigned NStrongRefsKept,class TKT>
   inline std::shared_ptr<const TValue> CachedFactoryBase<TKey,TValue,NStrongRefsKept,TKT>::create(const TKey& key)
   {
+    ensureCleanupRegistered();
+
     const bool verbose = getFactoryVerbosity();
     const std::string keystr = ( verbose ? keyToString(key) : std::string() );
     Optional<thinned_key_type> thinned_key;
+    Shard& shard = shardFor( key );
+
+    //Only top-level requests (i.e. those not made during another factory
+    //construction or factory job in the same thread) will wait for ongoing
+    //constructions in other threads. Nested requests never wait, which rules
+    //out dead-locks from cyclic or interdependent requests:
+#ifndef NCRYSTAL_DISABLE_THREADS
+    const bool may_wait = ( thread_details::factoryConstructionDepth() == 0 );
+#else
+    constexpr bool may_wait = false;
+#endif
 
-    {
-      NCRYSTAL_LOCK_GUARD(m_mutex);
-
-      if ( m_cleanupNeedsRegistry ) {
-        //Unrelated, but needs to be done while m_mutex is locked.
-        m_cleanupNeedsRegistry = false;
-        voidfct_t fct_cleanup = [this](){ this->cleanup(); };
-        registerCacheCleanupFunction(fct_cleanup);
-      }
+    //In-flight marker of the construction we are responsible for (if any):
+    std::shared_ptr<InFlight> inflight;
 
-      if ( verbose )
-        NCRYSTAL_MSG(this->factoryName()
-                     <<" (thread_"<<thread_details::currentThreadIDForPrint()<<")"
-                     <<" : Request to provide object for key "<<keystr);
+    while ( true ) {
+      ShPtr evicted;//must be released after the lock
+      std::shared_ptr<InFlight> waitfor;
+      {
+        NCRYSTAL_LOCK_GUARD(shard.mutex);
 
-      auto& cache_entry = TKT::cacheMapLookup( m_cache, key, thinned_key );
-      ShPtr res_existing = cache_entry.weakPtr.lock();
-      if ( res_existing != nullptr ) {
-        //Already there!
         if ( verbose )
           NCRYSTAL_MSG(this->factoryName()
                        <<" (thread_"<<thread_details::currentThreadIDForPrint()<<")"
-                       <<" : Return pre-existing cached object for key "<<keystr);
-        //Record access:
-        m_strongRefs.wasAccessed( res_existing );
-        return res_existing;
-      }
+                       <<" : Request to provide object for key "<<keystr);
+
+        auto& cache_entry = TKT::cacheMapLookup( shard.cache, key, thinned_key );
+        ShPtr res_existing = cache_entry.weakPtr.lock();
+        if ( res_existing != nullptr ) {
+          //Already there!
+          if ( verbose )
+            NCRYSTAL_MSG(this->factoryName()
+                         <<" (thread_"<<thread_details::currentThreadIDForPrint()<<")"
+                         <<" : Return pre-existing cached object for key "<<keystr);
+          //Record access:
+          evicted = m_strongRefs.wasAccessed( res_existing );
+          return res_existing;
+        }
 
-      cache_entry.ncleanup = m_ncleanup;
-      cache_entry.nwork += 1;
-
-      //guard against cyclic dependencies:
-      constexpr unsigned nwork_limit = 50;
-      if ( cache_entry.nwork > nwork_limit ) {
-        //Almost certainly a cyclic dependency. We could in principle get a
-        //false positive in case a user would use a huge amount of threads to
-        //simultaneously make the same request. For now we simply ignore that
-        //possibility.
-        //
-        //NB: Tried nwork_limit=1000 but it resulted in segfaults. So lowered it
-        //drastically.
-        NCRYSTAL_THROW(BadInput,"Cyclic dependency in factory request"
-                       " detected (check your input configurations"
-                       " and data for cyclic references)!");
-      }
-    }//release m_mutex lock
+        if ( may_wait && cache_entry.inflight != nullptr ) {
+          waitfor = cache_entry.inflight;
+        } else {
+          cache_entry.ncleanup = m_ncleanup;
+          cache_entry.nwork += 1;
+
+          //guard against cyclic dependencies:
+          constexpr unsigned nwork_limit = 50;
+          if ( cache_entry.nwork > nwork_limit ) {
+            //Almost certainly a cyclic dependency. We could in principle get a
+            //false positive in case a user would use a huge amount of threads
+            //to simultaneously make the same request from within other factory
+            //constructions. For now we simply ignore that possibility.
+            //
+            //NB: Tried nwork_limit=1000 but it resulted in segfaults. So lowered it
+            //drastically.
+            --cache_entry.nwork;
+            NCRYSTAL_THROW(BadInput,"Cyclic dependency in factory request"
+                           " detected (check your input configurations"
+                           " and data for cyclic references)!");
+          }
+#ifndef NCRYSTAL_DISABLE_THREADS
+          if ( cache_entry.inflight == nullptr ) {
+            cache_entry.inflight = std::make_shared<InFlight>();
+            inflight = cache_entry.inflight;
+          }
+#endif
+        }
+      }//release shard lock
+
+      if ( waitfor == nullptr )
+        break;
+
+      //Another thread is already constructing the object, wait for it to
+      //finish and then try again (normally the object will then be in the
+      //cache, but the construction might also have failed or been intercepted
+      //by a cleanup() call):
+      if ( verbose )
+        NCRYSTAL_MSG(this->factoryName()
+                     <<" (thread_"<<thread_details::currentThreadIDForPrint()<<")"
+                     <<" : Waiting for construction in other thread of object for key "<<keystr);
+      waitfor->wait();
+    }
 
     //Not in cache already, go ahead and construct it (without holding any
     //lock):
@@ -285,42 +510,58 @@ namespace NCRYSTAL_NAMESPACE {
                    <<" (thread_"<<thread_details::currentThreadIDForPrint()<<")"
                    << " : Creating (from scratch) object for key " << keystr);
 
-    ShPtr res = actualCreate(key);
+    ShPtr res;
+    try {
+      thread_details::FactoryConstructionScope construction_scope;
+      res = actualCreate(key);
+    } catch ( ... ) {
+      finishInFlight( shard, key, thinned_key, inflight );
+      throw;
+    }
 
     {
-      //reaquire lock, and populate result (or discard if another thread beat us
-      //to it):
-      NCRYSTAL_LOCK_GUARD(m_mutex);
-
-      if ( verbose )
-        NCRYSTAL_MSG(this->factoryName()
-                     <<" (thread_"<<thread_details::currentThreadIDForPrint()<<")"
-                     <<" : Finished construction");
-
-      auto& cache_entry = TKT::cacheMapLookup( m_cache, key, thinned_key );
-      --cache_entry.nwork;//no matter what, we no longer work on it.
+      ShPtr evicted;//must be released after the lock
+      bool intercepted = false;
+      {
+        //reaquire lock, and populate result (or discard if another thread beat
+        //us to it):
+        NCRYSTAL_LOCK_GUARD(shard.mutex);
 
-      //Populate cache unless we were beaten to it:
-      ShPtr res_existing = cache_entry.weakPtr.lock();
-      if ( res_existing != nullptr ) {
         if ( verbose )
           NCRYSTAL_MSG(this->factoryName()
                        <<" (thread_"<<thread_details::currentThreadIDForPrint()<<")"
-                       <<" : Finished construction but another thread beat us to it.");
-        res.reset();//discard our own result, always return the first recorded
-        m_strongRefs.wasAccessed( res_existing );
-        return res_existing;
+                       <<" : Finished construction");
+
+        auto& cache_entry = TKT::cacheMapLookup( shard.cache, key, thinned_key );
+        if ( cache_entry.nwork > 0 )
+          --cache_entry.nwork;//no matter what, we no longer work on it.
+        if ( inflight != nullptr && cache_entry.inflight == inflight )
+          cache_entry.inflight.reset();
+
+        //Populate cache unless we were beaten to it:
+        ShPtr res_existing = cache_entry.weakPtr.lock();
+        if ( res_existing != nullptr ) {
+          if ( verbose )
+            NCRYSTAL_MSG(this->factoryName()
+                         <<" (thread_"<<thread_details::currentThreadIDForPrint()<<")"
+                         <<" : Finished construction but another thread beat us to it.");
+          res = std::move(res_existing);//discard our own result, always return the first recorded
+          evicted = m_strongRefs.wasAccessed( res );
+        } else if ( cache_entry.ncleanup == m_ncleanup ) {
+          //Record out result, unless we got intercepted by a cleanup() call:
+          cache_entry.weakPtr = res;
+          evicted = m_strongRefs.wasAccessedAndIsNotInList( res );
+        } else {
+          intercepted = true;
+        }
       }
-
-      //Record out result, unless we got intercepted by a cleanup() call:
-      if ( cache_entry.ncleanup == m_ncleanup ) {
-        cache_entry.weakPtr = res;
-        m_strongRefs.wasAccessedAndIsNotInList( res );
+      if ( inflight != nullptr )
+        inflight->markDone();
+      if ( !intercepted )
         return res;
-      }
     }
     //We must have gotten intercepted by a cleanup() call, so let us try again:
-    return this->create( std::move(key) );
+    return this->create( key );
   }
 }
 
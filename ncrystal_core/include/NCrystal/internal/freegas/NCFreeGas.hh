@@ -50,6 +50,19 @@ namespace NCRYSTAL_NAMESPACE {
     CrossSect crossSectionIsotropic(CachePtr&, NeutronEnergy ) const override;
     ScatterOutcomeIsotropic sampleScatterIsotropic(CachePtr&, RNG&, NeutronEnergy ) const override;
 
+#ifdef NCRYSTAL_ALLOW_ABI_BREAKAGE
+    void sampleScatterMany( CachePtr&, RNG&, const double* ekin,
+                            const double* ux, const double* uy, const double* uz,
+                            std::size_t N,
+                            double* out_ekin, double* out_ux,
+                            double* out_uy, double* out_uz ) const override;
+    void evalXSAndSampleScatterMany( CachePtr&, RNG&, const double* ekin,
+                                     const double* ux, const double* uy, const double* uz,
+                                     std::size_t N, double* out_xs,
+                                     double* out_ekin, double* out_ux,
+                                     double* out_uy, double* out_uz ) const override;
+#endif
+
     virtual ~FreeGas();
 
   protected:
@@ -43,7 +43,9 @@ namespace NCRYSTAL_NAMESPACE {
     //     mode>0: LCBraggRef(nsample=mode)
     //     mode<0: LCBraggRndmRef(nsample=-mode)
     //
-    //For a description of the prec and ntrunc parameters, see NCGaussMos.hh.
+    //For a description of the prec and ntrunc parameters, see NCGaussMos.hh. The
+    //ncacheentries parameter is passed on to the internal LCHelper or SCBragg
+    //instance (see NCLCUtils.hh and NCSCBragg.hh).
     LCBragg( const Info&,
              const SCOrientation&,
              MosaicityFWHM,
@@ -52,7 +54,8 @@ namespace NCRYSTAL_NAMESPACE {
              double delta_d = 0,
              PlaneProvider * plane_provider = 0,
              double prec=1e-3,
-             double ntrunc=0.0 );
+             double ntrunc=0.0,
+             unsigned ncacheentries = 1 );
 
     const char * name() const noexcept override { return "LCBragg"; }
 
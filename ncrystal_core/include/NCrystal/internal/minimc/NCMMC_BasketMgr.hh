@@ -170,6 +170,8 @@ namespace NCRYSTAL_NAMESPACE {
         if ( o.data() && m_pool.size() < N_MAX_KEEP ) {
           // m_pool.reserve(N_MAX_KEEP);
           m_pool.push_back( std::move(o) );
+        } else {
+          o.deallocate();
         }
       }
 
@@ -188,6 +190,18 @@ namespace NCRYSTAL_NAMESPACE {
       SmallVector<heapmem_t,N_MAX_KEEP> m_pool;
     };
 
+    namespace detail {
+      //Small per-thread slot number, handed out round-robin the first time a
+      //given thread asks for it. Used to spread threads over the shards of the
+      //BasketMgr below.
+      inline unsigned basketMgrThreadSlot()
+      {
+        static std::atomic<unsigned> s_next_slot = {0};
+        static thread_local unsigned s_slot = s_next_slot.fetch_add(1);
+        return s_slot;
+      }
+    }
+
     template<class TBasket>
     class BasketMgr : NoCopyMove {
     public:
@@ -195,23 +209,35 @@ namespace NCRYSTAL_NAMESPACE {
       using basket_holder_t = BasketHolder<TBasket>;
       static_assert(std::is_nothrow_move_constructible<basket_holder_t>::value,"");
       using heapmem_t = typename basket_holder_t::heapmem_t;
-      using heapmempool_t = HeapMemPool<heapmem_t,16>;
+      using heapmempool_t = HeapMemPool<heapmem_t,4>;
+
+      //Pending baskets and recycled memory are kept in a number of shards, each
+      //protected by its own mutex. Each thread adds pending baskets to (and
+      //recycles memory via) its "own" shard, and takes pending baskets from
+      //that shard first, only stealing work from other shards when its own
+      //shard is empty. Thus, threads only contend for the same mutex when
+      //stealing work or when there are more threads than shards.
+      static constexpr unsigned nshards = 8;
 
       basket_holder_t allocateBasket()
       {
-        NCRYSTAL_LOCK_GUARD(m_mutex);
-        return { m_mempool.allocate() };
+        Shard& shard = ownShard();
+        NCRYSTAL_LOCK_GUARD(shard.mutex);
+        return { shard.mempool.allocate() };
       }
 
       void addPendingBasket( basket_holder_t&& o )
       {
         nc_assert(o.valid());
-        NCRYSTAL_LOCK_GUARD(m_mutex);
+        Shard& shard = ownShard();
+        NCRYSTAL_LOCK_GUARD(shard.mutex);
         NCRYSTAL_DEBUGMMCMSG("Got pending basket with size "<<o.basket().size());
-        if ( o.basket().empty() )
-          m_mempool.deallocate( o.stealMemory() );
-        else
-          m_pending_baskets.push_back( std::move(o) );
+        if ( o.basket().empty() ) {
+          shard.mempool.deallocate( o.stealMemory() );
+        } else {
+          shard.pending.push_back( std::move(o) );
+          ++m_npending;
+        }
       }
 
       //Will return invalid basket_holder_t object if no more pending baskets
@@ -219,78 +245,40 @@ namespace NCRYSTAL_NAMESPACE {
       basket_holder_t getPendingBasket()
       {
         basket_holder_t bh{ no_init };
-        NCRYSTAL_LOCK_GUARD(m_mutex);
-        if ( !m_pending_baskets.empty() ) {
-          bh = std::move( m_pending_baskets.back() );
-          m_pending_baskets.pop_back();
+        const unsigned ishard_own = ownShardIndex();
+        for ( unsigned k = 0; k < nshards && m_npending.load() > 0; ++k ) {
+          Shard& shard = m_shards[ ( ishard_own + k ) % nshards ];
+          NCRYSTAL_LOCK_GUARD(shard.mutex);
+          if ( !shard.pending.empty() ) {
+            bh = std::move( shard.pending.back() );
+            shard.pending.pop_back();
+            --m_npending;
+            break;
+          }
         }
         return bh;
       }
 
       basket_holder_t getPendingBasketOrAllocateEmpty( ThreadCount nthreads )
       {
+        //Look in our own shard first, and then try to steal from the other
+        //shards. Baskets are only ever merged with other baskets from the same
+        //shard:
         SmallVector<basket_holder_t,8> bhs_to_merge;
-        {
-          //Return one basket or move baskets to merge from m_pending_baskets to
-          //bhs_to_merge, all while the mutex is locked:
-          NCRYSTAL_LOCK_GUARD(m_mutex);
-          if ( m_pending_baskets.empty() )
-            return { m_mempool.allocate() };
-
-          if ( m_pending_baskets.size()+1 <= static_cast<std::size_t>(nthreads.get()) ) {
-            //We have more worker threads than remaining baskets (+1 to avoid
-            //spuriously triggering this). So just take one easily accessible
-            //basket (better to have N threads with 1000 neutrons each, than N-1
-            //idling threads and 1 thread with N*1000 events). The +1 is to
-            //avoid triggering this too early or when nthreads=1. However, we do
-            //not do this if it would result in ridiculously small amount of
-            //particles in the returned basket, since then other per-basket
-            //overhead might dominate.
-            nc_assert(!m_pending_baskets.empty());
-            if ( m_pending_baskets.back().basket().size() >= 32 ) {
-              basket_holder_t res = std::move(m_pending_baskets.back());
-              m_pending_baskets.pop_back();
+        const unsigned ishard_own = ownShardIndex();
+        Shard * src_shard = nullptr;
+        for ( unsigned k = 0; k < nshards && m_npending.load() > 0; ++k ) {
+          Shard& shard = m_shards[ ( ishard_own + k ) % nshards ];
+          basket_holder_t res{ no_init };
+          if ( takeFromShard( shard, nthreads, res, bhs_to_merge ) ) {
+            if ( res.valid() )
               return res;
-            }
-          }
-
-          //TODO: Now we gave up on the FIFO requirement, we could simplify +
-          //optimise the code below somewhat.
-
-          std::size_t ntot = 0;
-          auto it = m_pending_baskets.begin();
-          auto itE = m_pending_baskets.end();
-          while( it!=itE && ntot + it->basket().size() <= basket_N ) {
-            ntot += it->basket().size();
-            bhs_to_merge.push_back(std::move(*it));
-            ++it;
+            src_shard = &shard;
+            break;
           }
-          nc_assert_always(!bhs_to_merge.empty());
-          auto nconsumed = bhs_to_merge.size();
-          nc_assert_always( nconsumed >= 1 );
-          it = m_pending_baskets.begin();
-          //itE_consumed = std::next(it,nconsumed);
-          for ( it = std::next(m_pending_baskets.begin(),nconsumed);
-                it != itE; ++it )
-            *std::prev(it,nconsumed) = std::move(*it);
-          m_pending_baskets.resize( m_pending_baskets.size() - nconsumed );
-          if ( !m_pending_baskets.empty() && ntot < basket_N / 2 ) {
-            //TODO: If we have small baskets in front of an almost full basket,
-            //we might end up with very few particles to return. So already here
-            //(under the lock) we move over some particles from that first
-            //basket:
-            nc_assert_always(!bhs_to_merge.empty());
-            auto& tgt_basket = bhs_to_merge.back().basket();
-            auto& src_basket = m_pending_baskets.front().basket();
-            std::size_t n_move = basket_N/2 - tgt_basket.size();
-            NCRYSTAL_DEBUGMMCMSG("Split-off "<<n_move<<" neutrons from first remaining basket");
-            nc_assert_always( src_basket.size() > n_move );//won't become empty
-            nc_assert_always( tgt_basket.size()+n_move <= basket_N );
-            tgt_basket.appendEntriesFromOther( src_basket, src_basket.size()-n_move, n_move );
-            src_basket.neutrons.nused -= n_move;
-            nc_assert_always(src_basket.size()>0);
-          }
-        }//release lock!
+        }
+        if ( !src_shard )
+          return allocateBasket();
 
         //Merging is performed without a lock:
         nc_assert_always(!bhs_to_merge.empty());
@@ -322,16 +310,17 @@ namespace NCRYSTAL_NAMESPACE {
           it->basket().neutrons.nused = o_new_size;//"pop off" copied entries
         }
         //Ready to return bh, but first properly deal with other baskets in
-        //[itB,itE] range:
+        //[itB,itE] range (giving them back to the shard they came from):
         {
-          NCRYSTAL_LOCK_GUARD(m_mutex);
+          NCRYSTAL_LOCK_GUARD(src_shard->mutex);
           unsigned n_returned(0);
           for (auto it = itB; it!=itE; ++it ) {
             nc_assert(it->valid());
             if ( it->basket().empty() ) {
-              m_mempool.deallocate( it->stealMemory() );
+              src_shard->mempool.deallocate( it->stealMemory() );
             } else {
-              m_pending_baskets.push_back( std::move(*it) );
+              src_shard->pending.push_back( std::move(*it) );
+              ++m_npending;
               ++n_returned;
             }
           }
@@ -344,14 +333,84 @@ namespace NCRYSTAL_NAMESPACE {
       //with them:
       void deallocateBasket( basket_holder_t&& bh )
       {
-        NCRYSTAL_LOCK_GUARD(m_mutex);
-        m_mempool.deallocate( bh.stealMemory() );
+        Shard& shard = ownShard();
+        NCRYSTAL_LOCK_GUARD(shard.mutex);
+        shard.mempool.deallocate( bh.stealMemory() );
       }
 
     private:
-      heapmempool_t m_mempool;
-      std::vector<basket_holder_t> m_pending_baskets;
-      std::mutex m_mutex;//for m_mempool and m_pending_baskets
+      struct Shard {
+        std::mutex mutex;//for mempool and pending
+        heapmempool_t mempool;
+        std::vector<basket_holder_t> pending;
+      };
+      Shard m_shards[nshards];
+      //Total number of baskets pending in all shards (only modified while
+      //holding the mutex of the affected shard, but read without locks to
+      //quickly skip searches when nothing is pending):
+      std::atomic<std::size_t> m_npending = {0};
+
+      static unsigned ownShardIndex() { return detail::basketMgrThreadSlot() % nshards; }
+      Shard& ownShard() { return m_shards[ownShardIndex()]; }
+
+      //Either take a single basket (res) from the shard, or move a number of
+      //baskets for merging into bhs_to_merge. Returns false if the shard had no
+      //pending baskets:
+      bool takeFromShard( Shard& shard, ThreadCount nthreads,
+                          basket_holder_t& res,
+                          SmallVector<basket_holder_t,8>& bhs_to_merge )
+      {
+        NCRYSTAL_LOCK_GUARD(shard.mutex);
+        auto& pending = shard.pending;
+        if ( pending.empty() )
+          return false;
+
+        if ( m_npending.load()+1 <= static_cast<std::size_t>(nthreads.get()) ) {
+          //We have more worker threads than remaining baskets (+1 to avoid
+          //spuriously triggering this). So just take one easily accessible
+          //basket (better to have N threads with 1000 neutrons each, than N-1
+          //idling threads and 1 thread with N*1000 events). The +1 is to
+          //avoid triggering this too early or when nthreads=1. However, we do
+          //not do this if it would result in ridiculously small amount of
+          //particles in the returned basket, since then other per-basket
+          //overhead might dominate.
+          if ( pending.back().basket().size() >= 32 ) {
+            res = std::move(pending.back());
+            pending.pop_back();
+            --m_npending;
+            return true;
+          }
+        }
+
+        std::size_t ntot = 0;
+        auto it = pending.begin();
+        auto itE = pending.end();
+        while( it!=itE && ntot + it->basket().size() <= basket_N ) {
+          ntot += it->basket().size();
+          bhs_to_merge.push_back(std::move(*it));
+          ++it;
+        }
+        nc_assert_always(!bhs_to_merge.empty());
+        const auto nconsumed = bhs_to_merge.size();
+        pending.erase( pending.begin(), std::next( pending.begin(), nconsumed ) );
+        m_npending -= nconsumed;
+        if ( !pending.empty() && ntot < basket_N / 2 ) {
+          //If we have small baskets in front of an almost full basket, we
+          //might end up with very few particles to return. So already here
+          //(under the lock) we move over some particles from that first
+          //basket:
+          auto& tgt_basket = bhs_to_merge.back().basket();
+          auto& src_basket = pending.front().basket();
+          std::size_t n_move = basket_N/2 - tgt_basket.size();
+          NCRYSTAL_DEBUGMMCMSG("Split-off "<<n_move<<" neutrons from first remaining basket");
+          nc_assert_always( src_basket.size() > n_move );//won't become empty
+          nc_assert_always( tgt_basket.size()+n_move <= basket_N );
+          tgt_basket.appendEntriesFromOther( src_basket, src_basket.size()-n_move, n_move );
+          src_basket.neutrons.nused -= n_move;
+          nc_assert_always(src_basket.size()>0);
+        }
+        return true;
+      }
     };
   }
 }
@@ -120,8 +120,11 @@ namespace NCRYSTAL_NAMESPACE {
           b.neutrons.nused = i_first_hole;
 
         //Now we should propagate all the neutrons that were not already inside
-        //the volume:
-        detail::propagateDistance( b.neutrons, dist_results, offset );
+        //the volume (only the freshly added ones, from offset and onwards):
+        detail::propagateDistance( b.neutrons,
+                                   Span<const double>( dist_results + offset,
+                                                       dist_results + b.size() ),
+                                   offset );
 
         //And finally, return any neutrons that missed as a result, after
         //marking them as having missed the target.
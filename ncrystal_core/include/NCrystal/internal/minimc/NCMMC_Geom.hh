@@ -22,12 +22,42 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "NCrystal/internal/minimc/NCMMC_Basket.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
 #include "NCrystal/internal/utils/NCSpan.hh"
 #include "NCrystal/internal/utils/NCVector.hh"
 
 namespace NCRYSTAL_NAMESPACE {
   namespace MiniMC {
 
+    //Comparison used when validating the placement of volumes, with a tiny
+    //relative tolerance so that touching boundaries are accepted despite
+    //floating point rounding:
+    inline bool geomLessOrEqual( double a, double b ) noexcept
+    {
+      return a <= b + 1e-12 * ncmax( ncabs( a ), ncabs( b ) );
+    }
+
+    struct BoundingBox {
+      Vector lower, upper;
+      bool contains( const BoundingBox& o ) const noexcept
+      {
+        for ( unsigned i = 0; i < 3; ++i )
+          if ( !geomLessOrEqual( lower[i], o.lower[i] )
+               || !geomLessOrEqual( o.upper[i], upper[i] ) )
+            return false;
+        return true;
+      }
+      bool overlaps( const BoundingBox& o ) const noexcept
+      {
+        //Touching boxes do not overlap:
+        for ( unsigned i = 0; i < 3; ++i )
+          if ( geomLessOrEqual( upper[i], o.lower[i] )
+               || geomLessOrEqual( o.upper[i], lower[i] ) )
+            return false;
+        return true;
+      }
+    };
+
     class Geometry : NoCopyMove {
     public:
       //Geometry interface works on entire NeutronBasket's for efficiency,
@@ -49,14 +79,69 @@ namespace NCRYSTAL_NAMESPACE {
       //source-geometry checks, not neutron baskets):
       virtual bool pointIsInside( const Vector& ) const = 0;
 
+      //Queries used to validate the placement of volumes in layered
+      //geometries (cf. createLayeredGeometry below). All volumes are convex
+      //and axis-aligned. The maxDistance methods return the largest distance
+      //from the given point (or from the line through (x,0,z) parallel to the
+      //y-axis) to any point inside the volume:
+      virtual BoundingBox boundingBox() const = 0;
+      virtual double maxDistanceFromPoint( const Vector& ) const = 0;
+      virtual double maxDistanceFromYAxisLine( double x, double z ) const = 0;
+
+      //Check if another volume is completely inside this one (touching
+      //boundaries are allowed):
+      virtual bool containsVolume( const Geometry& ) const = 0;
+
+      //Geometries can consist of several volumes ("layers"), each to be filled
+      //with its own material. Each layer covers the region inside its own
+      //boundary, but outside the boundaries of any volumes placed inside it
+      //(its "daughters"). Volumes placed inside the same volume can be nested
+      //or be side-by-side (adjacent). Layers are numbered so that daughters
+      //always come before the volume they are placed in, and the last layer
+      //(nLayers()-1) is the outermost volume containing all others. The
+      //methods above always refer to the outer boundary of the complete
+      //geometry. Simple geometries have just a single layer.
+      virtual unsigned nLayers() const { return 1; }
+
+      //Find the layer containing each neutron. It is undefined behaviour to
+      //invoke this function unless all neutrons in the basket are inside the
+      //outer boundary.
+      virtual void locateLayers( const NeutronBasket&, Span<unsigned> ) const;
+
+      //Finds the distance out of the given layer (either out through its outer
+      //boundary or into one of its daughters), for neutrons which are all
+      //inside that layer. Also provides the index of the layer entered at that
+      //point, or nLayers() for neutrons leaving the geometry.
+      virtual void distToLayerExit( unsigned ilayer,
+                                    const NeutronBasket&,
+                                    Span<double> tgt_dist,
+                                    Span<unsigned> tgt_nextlayer ) const;
+
     };
 
     using GeometryPtr = shared_obj<const Geometry>;
 
     //For convenience + abstraction, the following function is used to transform
-    //a geometry description string into an actual geometry object.
+    //a geometry description string into an actual geometry object. Volumes
+    //are centered at (0,0,0) unless placed elsewhere with the x, y and z
+    //parameters. Layered geometries are described by separating the
+    //descriptions of each volume with a '|' character, listing volumes before
+    //the volume they are placed inside and ending with the outermost. For
+    //instance, "sphere;r=0.005|cylinder;r=0.006;dy=0.05" describes a 5mm
+    //radius sphere inside a cylinder, and
+    //"sphere;r=0.005;x=-0.01|sphere;r=0.005;x=0.01|box" two adjacent spheres
+    //inside a box.
     GeometryPtr createGeometry( const char * );
 
+    //Create layered geometry directly from its volumes (see createGeometry for
+    //the ordering). Each volume is placed inside the first volume listed after
+    //it which completely contains it, and the last volume must contain all
+    //others. Volumes placed inside the same volume must not overlap, which is
+    //verified by requiring that their bounding boxes do not overlap. A
+    //BadInput exception is thrown for invalid layouts. Partially overlapping
+    //volumes and rotated volumes are not supported.
+    GeometryPtr createLayeredGeometry( std::vector<GeometryPtr> );
+
   }
 }
 
@@ -45,6 +45,12 @@ namespace NCRYSTAL_NAMESPACE {
       MatDef( const MatCfg& cfg );
     };
 
+    //Materials for layered geometries (cf. NCMMC_Geom.hh) are described by
+    //separating the cfg-strings of each material with a '|' character, in the
+    //same order as the volumes in the geometry description. The special string
+    //"vacuum" can be used for empty layers:
+    std::vector<MatDef> createMatDefs( const char * );
+
     struct StdEngineOptions {
       //TODO: The values here are mostly guesses, and assumes initial unit
       //weights of the source particles.
@@ -63,6 +69,15 @@ namespace NCRYSTAL_NAMESPACE {
                            MatDef,
                            StdEngineOptions = {} );
 
+    //Launch simulations in a layered geometry, with one material per layer (a
+    //single material will be used for all layers):
+    void runSim_StdEngine( ThreadCount,
+                           GeometryPtr,
+                           SourcePtr,
+                           TallyPtr,
+                           std::vector<MatDef>,
+                           StdEngineOptions = {} );
+
   }
 }
 
@@ -50,6 +50,7 @@ namespace NCRYSTAL_NAMESPACE {
       int nscat[NeutronBasket::N];
       bool sawinelas[NeutronBasket::N];
       double scatxsval[NeutronBasket::N];//if we already know scat-xs (<0.0 means unknown)
+      int layer[NeutronBasket::N];//geometry layer (<0 means unknown)
 
       void markAsMissedTarget( std::size_t i ) noexcept { this->nscat[i] = -1; }
 
@@ -68,6 +69,7 @@ namespace NCRYSTAL_NAMESPACE {
         nscat[i] = 0;
         sawinelas[i] = false;
         scatxsval[i] = -1.0;
+        layer[i] = -1;
       }
 
       void copyEntryFromOther( const data_t& o, std::size_t i_o, std::size_t i ) noexcept
@@ -75,7 +77,7 @@ namespace NCRYSTAL_NAMESPACE {
         nscat[i] = o.nscat[i_o];
         sawinelas[i] = o.sawinelas[i_o];
         scatxsval[i] = o.scatxsval[i_o];
-
+        layer[i] = o.layer[i_o];
       }
       void copyEntriesFromOther( const data_t& o, std::size_t i,
                                  std::size_t i_o, std::size_t n ) ncnoexceptndebug
@@ -86,6 +88,7 @@ namespace NCRYSTAL_NAMESPACE {
         detail::memcpydata<int>( nscat + i,o.nscat + i_o,n );
         detail::memcpydata<bool>( sawinelas + i, o.sawinelas + i_o, n );
         detail::memcpydata<double>( scatxsval + i, o.scatxsval + i_o, n );
+        detail::memcpydata<int>( layer + i, o.layer + i_o, n );
       }
 
     };
@@ -106,9 +109,9 @@ namespace NCRYSTAL_NAMESPACE {
     private:
       StdEngineOptions m_opt;
       double m_opt_roulette_survivor_boost;
-      matdef_t m_mat;
-      CachePtr m_sct_cacheptr;
-      CachePtr m_abs_cacheptr;
+      std::vector<matdef_t> m_mats;//one per geometry layer
+      std::vector<CachePtr> m_sct_cacheptrs;
+      std::vector<CachePtr> m_abs_cacheptrs;
 
       heapmempool_t m_mempool;
       basket_holder_t allocateBasket( basketmgr_t& mgr )
@@ -130,14 +133,22 @@ namespace NCRYSTAL_NAMESPACE {
       double m_buf_xs_abs[basket_N];
       double m_buf_ptransm[basket_N];
       double m_buf_disttoscat[basket_N];
+      double m_buf_scat_ekin[basket_N];
+      double m_buf_scat_ux[basket_N];
+      double m_buf_scat_uy[basket_N];
+      double m_buf_scat_uz[basket_N];
+      unsigned m_buf_nextlayer[basket_N];
 
     public:
 
       StdEngine( matdef_t md, StdEngineOptions opts = {} );
 
+      //For layered geometries, provide one material per layer:
+      StdEngine( std::vector<matdef_t> mds, StdEngineOptions opts = {} );
+
       shared_obj<StdEngine> clone_so()
       {
-        return makeSO<StdEngine>( m_mat, m_opt );
+        return makeSO<StdEngine>( m_mats, m_opt );
       }
 
       using resultfct_t = std::function<void(const basket_t&)>;
@@ -146,6 +157,18 @@ namespace NCRYSTAL_NAMESPACE {
                               basket_holder_t&& inbasket_holder,
                               basketmgr_t& mgr,
                               const resultfct_t& resultFct );
+
+    private:
+      void advanceInLayer( RNG& rng,
+                           const Geometry& geom,
+                           unsigned ilayer,
+                           basket_holder_t&& inbasket_holder,
+                           basketmgr_t& mgr,
+                           const resultfct_t& resultFct );
+      void handleTransmitted( unsigned nlayers,
+                              basket_holder_t&& inbasket_holder,
+                              basketmgr_t& mgr,
+                              const resultfct_t& resultFct );
     };
 
   }
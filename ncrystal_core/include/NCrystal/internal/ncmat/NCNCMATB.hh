@@ -0,0 +1,73 @@
+#ifndef NCrystal_NCMATB_hh
+#define NCrystal_NCMATB_hh
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/internal/ncmat/NCNCMATData.hh"
+#include "NCrystal/text/NCTextData.hh"
+
+namespace NCRYSTAL_NAMESPACE {
+
+  // Pre-parsed representation of NCMATData (the NCMATB format, data type
+  // "ncmatb"), intended for materials with large @DYNINFO sections (scattering
+  // kernels, VDOS curves) whose text parsing would otherwise dominate load
+  // times. All numbers are serialised as raw little-endian IEEE doubles (and
+  // 64 bit integers), so loading involves no tokenisation or number parsing
+  // and the data is portable between platforms.
+  //
+  // Note that this is still a text format and NOT a memory mapped or zero-copy
+  // format: since TextData objects must hold null-free text, the serialised
+  // data is base64 encoded (making files about 4/3 the size of the raw
+  // numbers), and it is decoded into a temporary buffer before the numbers are
+  // copied into the vectors of a new NCMATData object. The only gain is
+  // therefore the avoided parsing (memory usage is not reduced). The data is
+  // stored on a single line after a short header:
+  //
+  //   NCMATB v1
+  //   # <comments>
+  //   <base64 payload>
+  //
+  // Any lines with NCRYSTALMATCFG[..] specifications in the original NCMAT data
+  // are retained as comments in the header, preserving embedded cfg-strings.
+  // The data includes a checksum, and problems like data corruption are
+  // reported with BadInput exceptions.
+  //
+  // As the format does not provide any memory savings, conversion is so far
+  // only available through the C++ functions below, and not through the C or
+  // Python APIs or command line tools.
+
+  //Convert NCMAT text data (throws BadInput if it is not valid NCMAT data):
+  NCRYSTAL_API std::string convertNCMATToNCMATB( const TextData& );
+
+  //Encode already parsed data (optionally adding NCRYSTALMATCFG lines):
+  NCRYSTAL_API std::string encodeNCMATB( const NCMATData&,
+                                        const VectS& embeddedCfgLines = {} );
+
+  //Check for the "NCMATB" magic at the beginning of the data:
+  NCRYSTAL_API bool isNCMATB( const RawStrData& );
+
+  //Decode, with same semantics as parseNCMATData from NCParseNCMAT.hh:
+  NCRYSTAL_API NCMATData parseNCMATBData( const TextData&,
+                                          bool doFinalValidation = true );
+
+}
+
+#endif
@@ -86,6 +86,17 @@ namespace NCRYSTAL_NAMESPACE {
     };
     EPointAnalysis analyseEnergyPoint( NeutronEnergy ekin ) const { return { evalXSContribsCommul(ekin), ekin }; };
 
+    //Optional tabulated mode, in which the total and per-element cumulative
+    //cross sections are precomputed on a grid uniform in log(ekin). Cross
+    //section evaluations and element selections are then table lookups with
+    //linear interpolation. The grid is refined until the interpolated values
+    //at all bin midpoints are within rel_tolerance (relative to the total
+    //cross section) of the exact results. Energies outside the tabulated
+    //range, where the exact evaluation is anyway cheap, are not affected. Any
+    //subsequent call to set(..) disables the tabulated mode again:
+    void enableTabulation( double rel_tolerance = 1e-6 );
+    bool isTabulated() const { return m_tab != nullptr; }
+
     ////////////////////////////////////////////////////////////////////////////////////
     //
     // Theoretical background of implemented model:
@@ -128,6 +139,9 @@ namespace NCRYSTAL_NAMESPACE {
     static double eval_1mexpmtdivt(double t);//safe/fast eval of (1-exp(-t))/t for t>=0.0 with >10 sign. digits
 
     SmallVector<double,32> evalXSContribsCommul( NeutronEnergy ) const;
+    void evalXSContribsCommulExact( NeutronEnergy, double* tgt ) const;
+    struct TabData;
+    std::shared_ptr<const TabData> m_tab;
     friend struct EPointAnalysis;
   };
 }
@@ -24,6 +24,7 @@
 #include "NCrystal/core/NCTypes.hh"
 #include "NCrystal/internal/phys_utils/NCGaussOnSphere.hh"
 #include "NCrystal/internal/utils/NCVector.hh"
+#include "NCrystal/internal/utils/NCSpan.hh"
 
 namespace NCRYSTAL_NAMESPACE {
 
@@ -95,14 +96,46 @@ namespace NCRYSTAL_NAMESPACE {
     //setup allows the caller to subsequently select a plane to scatter on with
     //a binary search in the xs_commul vector, and subsequently use the
     //ScatCache object at the same index in the cache vector, to generate
-    //scatterings:
+    //scatterings. The demi-normals are kept in structure-of-arrays layout (see
+    //DemiNormals class below), which allows the cheap initial truncation test
+    //to be carried out for blocks of normals in auto-vectorisable loops:
     class ScatCache;
+    class DemiNormals;
     double calcCrossSections( InteractionPars& ip,
                               const Vector& neutron_indir,
-                              const std::vector<Vector>& deminormals,
+                              const DemiNormals& deminormals,
                               std::vector<ScatCache>& cache,
                               VectD& xs_commul ) const;
 
+    //Same as above, but only considering the subset of deminormals at the
+    //provided indices (which should be in increasing order, if results are to
+    //be identical to those of the method above). It is the responsibility of
+    //the caller to make sure that the indices of all deminormals which could
+    //possibly contribute are included:
+    double calcCrossSections( InteractionPars& ip,
+                              const Vector& neutron_indir,
+                              const DemiNormals& deminormals,
+                              Span<const std::uint32_t> indices,
+                              std::vector<ScatCache>& cache,
+                              VectD& xs_commul ) const;
+
+    //Container for demi-normals, storing the x, y and z coordinates in
+    //separate arrays:
+    class DemiNormals {
+    public:
+      DemiNormals() = default;
+      void reserve( std::size_t n ) { m_x.reserve(n); m_y.reserve(n); m_z.reserve(n); }
+      void push_back( const Vector& );
+      std::size_t size() const noexcept { return m_x.size(); }
+      bool empty() const noexcept { return m_x.empty(); }
+      Vector operator[]( std::size_t i ) const;
+      const double * xData() const noexcept { return m_x.data(); }
+      const double * yData() const noexcept { return m_y.data(); }
+      const double * zData() const noexcept { return m_z.data(); }
+    private:
+      VectD m_x, m_y, m_z;
+    };
+
     //Scatterings can only be generated once appropriate info has been found via
     //previous calls to cross-section methods, and with relevant info embedded
     //into ScatCache objects (of course, they will only be relevant for the
@@ -138,6 +171,13 @@ namespace NCRYSTAL_NAMESPACE {
     double m_delta_d = 0.0;
     void updateDerivedValues();
     double calcRawCrossSectionValueInit( InteractionPars&, double ) const;
+    void addNormalContribs( InteractionPars&, double dot_indir_normal, const Vector& normal,
+                            double xsoffset, double& xssum,
+                            std::vector<ScatCache>&, VectD& xs_commul ) const;
+    void addBlockContribs( InteractionPars&, const Vector& indir, std::size_t n,
+                           const double * x, const double * y, const double * z,
+                           double xsoffset, double& xssum,
+                           std::vector<ScatCache>&, VectD& xs_commul ) const;
   };
 
   class GaussMos::InteractionPars {
@@ -201,6 +241,20 @@ namespace NCRYSTAL_NAMESPACE {
   inline const Vector& GaussMos::ScatCache::plane_normal() const { nc_assert(isValid()); return m_plane_normal; }
   inline double GaussMos::ScatCache::plane_inv2d() const { nc_assert(isValid()); return m_plane_inv2d; }
 
+  inline void GaussMos::DemiNormals::push_back( const Vector& v )
+  {
+    nc_assert(v.isUnitVector());
+    m_x.push_back(v[0]);
+    m_y.push_back(v[1]);
+    m_z.push_back(v[2]);
+  }
+
+  inline Vector GaussMos::DemiNormals::operator[]( std::size_t i ) const
+  {
+    nc_assert(i<m_x.size());
+    return { m_x[i], m_y[i], m_z[i] };
+  }
+
   inline double GaussMos::calcRawCrossSectionValue( InteractionPars& ip, double cos_angle_indir_normal ) const
   {
     nc_assert(ip.isValid());
@@ -79,6 +79,16 @@ namespace NCRYSTAL_NAMESPACE {
                               const double* ekin,
                               std::size_t N,
                               double* out_xs ) const override;
+    void sampleScatterMany( CachePtr&, RNG&, const double* ekin,
+                            const double* ux, const double* uy, const double* uz,
+                            std::size_t N,
+                            double* out_ekin, double* out_ux,
+                            double* out_uy, double* out_uz ) const override;
+    void evalXSAndSampleScatterMany( CachePtr&, RNG&, const double* ekin,
+                                     const double* ux, const double* uy, const double* uz,
+                                     std::size_t N, double* out_xs,
+                                     double* out_ekin, double* out_ux,
+                                     double* out_uy, double* out_uz ) const override;
 #endif
 
   protected:
@@ -91,8 +101,13 @@ namespace NCRYSTAL_NAMESPACE {
     NeutronEnergy m_threshold = NeutronEnergy{kInfinity};
     VectD m_2dE;
     VectD m_fdm_commul;
+    //Guide table for O(1) average lookups in m_fdm_commul in genScatterMu
+    //(empty when there are too few planes for it to be worth it):
+    std::vector<std::uint32_t> m_fdm_guide;
+    double m_fdm_guide_scale = 0.0;
     void init( const StructureInfo&, VectDFM&& );
     void init( double v0_times_natoms, VectDFM&& );
+    void initGuideTable();
   };
 
 }
@@ -28,14 +28,17 @@ namespace NCRYSTAL_NAMESPACE {
 
   namespace SAB {
 
-    //Direct factory function with no caching:
+    //Direct factory function with no caching. A positive egridTolerance
+    //enables adaptive energy grid construction (cf. SABIntegrator):
     std::unique_ptr<const SABScatterHelper> createScatterHelper( shared_obj<const SABData>,
-                                                                 std::shared_ptr<const VectD> energyGrid = nullptr );
+                                                                 std::shared_ptr<const VectD> energyGrid = nullptr,
+                                                                 double egridTolerance = 0.0 );
 
     //Same with caching:
     void clearScatterHelperCache();
     shared_obj<const SABScatterHelper> createScatterHelperWithCache( shared_obj<const SABData>,
-                                                                     std::shared_ptr<const VectD> energyGrid = nullptr );
+                                                                     std::shared_ptr<const VectD> energyGrid = nullptr,
+                                                                     double egridTolerance = 0.0 );
 
     //For caching reasons, we keep a database of energy grid's and an associated
     //unique id. Note that it is expected that most energy grids specified will
@@ -47,6 +47,20 @@ namespace NCRYSTAL_NAMESPACE {
       //the desired createXXX method has been called. SABIntegrators are not
       //MT-safe, so should not be shared between threads.
       //
+      //If the NCRYSTAL_SAB_COMPACT environment variable is set (or
+      //setCompactSamplers(true) is called), the sampling tables at each energy
+      //grid point are stored in a compact form requiring less than half of the
+      //memory (see SABSamplerAtE_Alg1::compactify for details and the accuracy
+      //implications). Setting NCRYSTAL_DEBUG_SAB will print the memory used by
+      //the sampling tables.
+      //
+      //If setEGridTolerance is called with a positive value, energy grids which
+      //are not fully specified will be constructed adaptively: starting from a
+      //coarse grid, intervals are only bisected where linear interpolation of
+      //the cross section at the (geometric) midpoint or quarter points deviates
+      //by more than the given relative tolerance, or where sampling at the
+      //lower edge with the tables from the upper edge would be inefficient. The
+      //grid will never be finer than the non-adaptive one.
 
     public:
       ~SABIntegrator();
@@ -54,6 +68,9 @@ namespace NCRYSTAL_NAMESPACE {
                      const VectD* egrid = nullptr,
                      std::shared_ptr<const SABExtender> sabextender = nullptr );
 
+      void setCompactSamplers( bool );
+      void setEGridTolerance( double );
+
       SABXSProvider createXSProvider() { SABXSProvider o; doit(&o,nullptr); return o; }
       SABSampler createSampler() { SABSampler o; doit(nullptr,&o); return o; }
       SABScatterHelper createScatterHelper()
@@ -23,6 +23,7 @@
 
 #include "NCrystal/interfaces/NCSABData.hh"
 #include "NCrystal/internal/sab/NCSABExtender.hh"
+#include "NCrystal/internal/utils/NCLogGridIndex.hh"
 
 namespace NCRYSTAL_NAMESPACE {
 
@@ -38,6 +39,10 @@ namespace NCRYSTAL_NAMESPACE {
   public:
     virtual PairDD sampleAlphaBeta(double ekin_div_kT, RNG&) const = 0;
     virtual ~SABSamplerAtE() = default;
+
+    //Approximate number of bytes of memory owned by this instance (not
+    //including data shared with other instances):
+    virtual std::size_t memoryUsage() const = 0;
   };
 
   class SABSampler final : private MoveOnly {
@@ -82,12 +87,18 @@ namespace NCRYSTAL_NAMESPACE {
     //Convenience (calls sampleAlphaBeta, then converts):
     PairDD sampleDeltaEMu( NeutronEnergy, RNG& rng) const;
 
+    //Approximate number of bytes of memory owned by this instance and its
+    //SABSamplerAtE instances (not including data shared with other instances,
+    //like the SABData itself):
+    std::size_t memoryUsage() const;
+
     //Move ok:
     SABSampler( SABSampler&& ) = default;
     SABSampler& operator=( SABSampler&& ) = default;
 
   private:
     VectD m_egrid;
+    LogGridIndex m_egridIndex;
     SABSamplerAtEList m_samplers;
     double m_kT = 0.0;
     std::shared_ptr<const SAB::SABExtender> m_extender;
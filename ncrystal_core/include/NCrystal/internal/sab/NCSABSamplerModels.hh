@@ -62,16 +62,78 @@ namespace NCRYSTAL_NAMESPACE {
                           std::size_t ibetaOffset,
                           double firstBinKinematicEndpointValue = 1.0 );
 
+      //Constructor taking an already prepared beta sampler, and access to the
+      //internal state (for usage in the persistent cache):
+      SABSamplerAtE_Alg1( std::shared_ptr<const CommonCache>,
+                          PointwiseDist&& betaSampler,
+                          std::vector<AlphaSampleInfo>&&,
+                          std::size_t ibetaOffset,
+                          double firstBinKinematicEndpointValue );
+      //NB: The next two methods must not be used after compactify() was called:
+      const PointwiseDist& betaSampler() const { nc_assert(!m_compact); return m_betaSampler.value(); }
+      const std::vector<AlphaSampleInfo>& alphaSampleInfos() const { nc_assert(!m_compact); return m_alphaSamplerInfos; }
+      std::size_t ibetaOffset() const { return m_ibetaOffset; }
+      double firstBinKinematicEndpointValue() const { return m_firstBinKinematicEndpointValue; }
+
+      //Replace the sampling tables with a compact representation, which
+      //requires less than half of the memory. In this representation, the
+      //beta-values of the beta sampler are shared with the beta grid of the
+      //SABData (only the lower edge, which depends on the energy, is kept),
+      //the CDF and density values of the beta sampler are stored as float32,
+      //and the AlphaSampleInfo objects are stored with float32 values of
+      //log(S) and of the front and back tail probabilities (S itself is
+      //reconstructed in double precision from log(S), and the alpha values of
+      //the tail points are kept in double precision since they must match the
+      //kinematic limits precisely). CDF values above 0.5 are stored as 1-CDF,
+      //so the absolute error of a CDF value is at most 3e-8 (near CDF=0.5),
+      //decreasing to a relative error of 6e-8 of min(CDF,1-CDF) towards both
+      //ends. Thus, the probabilities of low-probability bins in the tails of
+      //the beta distribution are preserved, while only bins with probabilities
+      //below ~1e-7 in the bulk of the distribution might be affected. The
+      //alpha tail probabilities have relative errors of 6e-8, and the S values
+      //at the tail points relative errors of 6e-8*|log(S)|. Sampling is
+      //slightly slower, due to the additional exp() calls. Returns false (and
+      //leaves the instance unchanged) if the tables could not be
+      //compactified:
+      bool compactify();
+      bool isCompact() const { return m_compact != nullptr; }
+
+      std::size_t memoryUsage() const final;
+
     private:
       // Sample alpha from F(alpha|beta_j,Ei) (line 7-8 of Alg. 1 in the sampling
       // paper). NB: this needs to work with a single random number, the
       // percentile, for purposes of interpolating between two beta-rows:
       double sampleAlpha(std::size_t ibeta, double rand_percentile) const;
 
+      //Access to the beta sampler, valid with or without compact tables:
+      std::pair<double,unsigned> sampleBetaWithIndex( double rand ) const;
+      double betaSamplerXVal( std::size_t i ) const;
+      std::size_t betaSamplerNVals() const;
+
+      //Compact tables (see compactify()):
+      struct CompactAlphaSampleInfo {
+        double alpha_front, alpha_back;
+        float logsval_front, logsval_back;//-inf indicates sval=0
+        float prob_front, prob_back;//prob_back=1-prob_notback
+        std::uint32_t alpha_idx_front, alpha_idx_back;
+      };
+      struct CompactTables {
+        double beta_first;//other beta values are shared with betaGrid
+        std::vector<float> cdf, y;//cdf values encoded with encodeCDF
+        std::vector<CompactAlphaSampleInfo> infos;
+        AlphaSampleInfo expand( std::size_t ) const;
+        //CDF values >=0.5 are stored as -(1-CDF) (with -0.0f for CDF=1), to
+        //preserve precision near CDF=1:
+        static float encodeCDF( double );
+        static double decodeCDF( float );
+      };
+
       //Data:
       std::shared_ptr<const CommonCache> m_common;
-      PointwiseDist m_betaSampler;
+      Optional<PointwiseDist> m_betaSampler;
       std::vector<AlphaSampleInfo> m_alphaSamplerInfos;
+      std::unique_ptr<const CompactTables> m_compact;
       std::size_t m_ibetaOffset;
       double m_firstBinKinematicEndpointValue;//if <=0, lowest beta value in
                                               //m_betaSampler has been moved
@@ -86,6 +148,7 @@ namespace NCRYSTAL_NAMESPACE {
       //alpha=beta=0). For usage of edge-cases with vanishing cross-section.
     public:
       PairDD sampleAlphaBeta(double, RNG&) const final { return {0.0,0.0}; }
+      std::size_t memoryUsage() const final { return sizeof(*this); }
     };
 
 #if 0
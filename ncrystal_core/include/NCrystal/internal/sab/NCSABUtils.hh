@@ -25,6 +25,7 @@
 #include "NCrystal/internal/phys_utils/NCKinUtils.hh"
 #include "NCrystal/interfaces/NCSABData.hh"
 #include "NCrystal/internal/sab/NCScatKnlData.hh"
+#include "NCrystal/internal/utils/NCPersistentCache.hh"
 
 namespace NCRYSTAL_NAMESPACE {
 
@@ -44,6 +45,12 @@ namespace NCRYSTAL_NAMESPACE {
     //case anything is trimmed.
     SABData transformKernelToStdFormat(ScatKnlData&&);
 
+    //Support for storing SABData objects in the persistent cache (cf.
+    //NCPersistentCache.hh):
+    void addToPersistentCacheKey( PersistentCache::Key&, const SABData& );
+    void serialiseSABData( PersistentCache::Writer&, const SABData& );
+    SABData deserialiseSABData( PersistentCache::Reader& );
+
     //If beta grid is defined as [0,b1,b2,..,bn] it is assumed that it is a
     //space-saving shorthand for [-bn,...,-b2,-b1,0,b1,b2,..,bn]. Expand, using
     //S(alpha,-beta)=S(alpha,beta):
@@ -23,6 +23,8 @@
 
 #include "NCrystal/core/NCDefs.hh"
 #include "NCrystal/internal/sab/NCSABExtender.hh"
+#include "NCrystal/internal/utils/NCSpan.hh"
+#include "NCrystal/internal/utils/NCLogGridIndex.hh"
 
 namespace NCRYSTAL_NAMESPACE {
 
@@ -36,6 +38,11 @@ namespace NCRYSTAL_NAMESPACE {
     ~SABXSProvider();
     CrossSect crossSection(NeutronEnergy) const;
 
+    //Evaluate many cross sections at once. The grid interval of the previous
+    //point is reused when possible, so sorted energies (or repeated energies)
+    //avoid most grid lookups:
+    void evaluateMany( Span<const double> ekin, Span<double> tgt ) const;
+
     //Move ok:
     SABXSProvider( SABXSProvider&& ) = default;
     SABXSProvider& operator=( SABXSProvider&& ) = default;
@@ -44,7 +51,9 @@ namespace NCRYSTAL_NAMESPACE {
     const VectD & internalEGrid() const { return m_egrid; }
     const VectD & internalXSGrid() const { return m_xs; }
   private:
+    double evalAt( VectD::const_iterator itEkinUpper, double ekin ) const;
     VectD m_egrid, m_xs;
+    LogGridIndex m_egridIndex;
     std::shared_ptr<const SAB::SABExtender> m_extender;
     double m_kExtension;
   };
@@ -49,7 +49,8 @@ namespace NCRYSTAL_NAMESPACE {
     //
     //The vdoslux parameter has no effect if input is not a VDOS. The same goes
     //for the special vdos2sabExcludeFlag parameter (the meaning of which is
-    //documented in NCDynInfoUtils.hh).
+    //documented in NCDynInfoUtils.hh). A positive egridTolerance enables
+    //adaptive construction of the energy grid (see SABIntegrator).
     SABScatter( const DI_ScatKnl&,
                 unsigned vdoslux = 3,
                 bool useCache = true,
@@ -57,7 +58,8 @@ namespace NCRYSTAL_NAMESPACE {
     SABScatter( SABData &&,
                 const VectD& energyGrid = VectD() );
     SABScatter( shared_obj<const SABData>,
-                std::shared_ptr<const VectD> energyGrid = nullptr );
+                std::shared_ptr<const VectD> energyGrid = nullptr,
+                double egridTolerance = 0.0 );
     explicit SABScatter( shared_obj<const SAB::SABScatterHelper> );
     explicit SABScatter( std::unique_ptr<const SAB::SABScatterHelper> );
     SABScatter( SAB::SABScatterHelper&& );
@@ -67,6 +69,20 @@ namespace NCRYSTAL_NAMESPACE {
     CrossSect crossSectionIsotropic(CachePtr&, NeutronEnergy ) const final;
     ScatterOutcomeIsotropic sampleScatterIsotropic(CachePtr&, RNG&, NeutronEnergy ) const final;
 
+#ifdef NCRYSTAL_ALLOW_ABI_BREAKAGE
+    void evalManyXSIsotropic( CachePtr&, const double* ekin, std::size_t N, double* out_xs ) const override;
+    void sampleScatterMany( CachePtr&, RNG&, const double* ekin,
+                            const double* ux, const double* uy, const double* uz,
+                            std::size_t N,
+                            double* out_ekin, double* out_ux,
+                            double* out_uy, double* out_uz ) const override;
+    void evalXSAndSampleScatterMany( CachePtr&, RNG&, const double* ekin,
+                                     const double* ux, const double* uy, const double* uz,
+                                     std::size_t N, double* out_xs,
+                                     double* out_ekin, double* out_ux,
+                                     double* out_uy, double* out_uz ) const override;
+#endif
+
   protected:
     Optional<std::string> specificJSONDescription() const override;
     struct Impl;
@@ -74,6 +90,36 @@ namespace NCRYSTAL_NAMESPACE {
     const SAB::SABScatterHelper * m_sh;
   };
 
+  class SABTempInterpScatter final : public ProcImpl::ScatterIsotropicMat {
+  public:
+
+    //Approximates scattering at a temperature T, based on two S(alpha,beta)
+    //scattering kernels prepared at bracketing temperatures T_lo<=T<=T_hi.
+    //Cross sections are linearly interpolated in temperature as
+    //xs(T)=w_lo*xs(T_lo)+w_hi*xs(T_hi), and each scattering event is sampled
+    //from one of the two kernels, picked randomly with probabilities
+    //w_lo*xs(T_lo)/xs(T) and w_hi*xs(T_hi)/xs(T) respectively. This is mainly
+    //useful since the (expensive) kernels at the bracketing temperatures can
+    //be shared between many materials at different temperatures.
+
+    const char * name() const noexcept final { return "SABTempInterpScatter"; }
+
+    SABTempInterpScatter( Temperature T,
+                          Temperature T_lo, shared_obj<const SAB::SABScatterHelper> sh_lo,
+                          Temperature T_hi, shared_obj<const SAB::SABScatterHelper> sh_hi );
+    virtual ~SABTempInterpScatter();
+
+    CrossSect crossSectionIsotropic(CachePtr&, NeutronEnergy ) const final;
+    ScatterOutcomeIsotropic sampleScatterIsotropic(CachePtr&, RNG&, NeutronEnergy ) const final;
+
+  protected:
+    Optional<std::string> specificJSONDescription() const override;
+  private:
+    Temperature m_temp, m_temp_lo, m_temp_hi;
+    double m_w_lo, m_w_hi;
+    shared_obj<const SAB::SABScatterHelper> m_sh_lo, m_sh_hi;
+  };
+
 }
 
 #endif
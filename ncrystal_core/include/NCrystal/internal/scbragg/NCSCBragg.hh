@@ -44,12 +44,20 @@ namespace NCRYSTAL_NAMESPACE {
     //assume ownership of it.
     //
     //For a description of the prec and ntrunc parameters, see NCGaussMos.hh.
+    //
+    //Parameter ncacheentries is the number of recent neutron states (energy
+    //and direction) for which results are kept in each cache object. Values
+    //larger than 1 can speed up applications which interleave calls for a
+    //handful of different neutron states. Objects created by the standard
+    //scatter factory take the value from the NCRYSTAL_BRAGG_CACHE_SIZE
+    //environment variable (see NCStdScatFact.cc).
     SCBragg( const Info&,
              const SCOrientation&,
              MosaicityFWHM,
              double delta_d = 0,
              PlaneProvider * plane_provider = nullptr,
-             double prec = 1e-3, double ntrunc = 0.0 );
+             double prec = 1e-3, double ntrunc = 0.0,
+             unsigned ncacheentries = 1 );
 
     const char * name() const noexcept override { return "SCBragg"; }
 
@@ -0,0 +1,94 @@
+#ifndef NCrystal_LogGridIndex_hh
+#define NCrystal_LogGridIndex_hh
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/core/NCDefs.hh"
+#include "NCrystal/internal/utils/NCSpan.hh"
+
+namespace NCRYSTAL_NAMESPACE {
+
+  class LogGridIndex final {
+  public:
+
+    //Index for fast lookups in a sorted grid of positive values spanning many
+    //orders of magnitude (e.g. energy grids). The interval between the first
+    //and last grid points is split into buckets which are (approximately)
+    //equidistant in log(x), and for each bucket the range of grid points it
+    //contains is recorded. The buckets are defined directly from the bit
+    //patterns of the IEEE754 floating point values (which are ordered like the
+    //values themselves and approximately linear in log2(x)), so no calls to
+    //std::log are needed and results are exact.
+    //
+    //Note that the index does not keep a reference to the grid, which must be
+    //passed in again (unchanged) for each lookup.
+
+    LogGridIndex() = default;//invalid instance
+    explicit LogGridIndex( Span<const double> grid );
+
+    //Same as std::upper_bound(grid.begin(),grid.end(),x)-grid.begin():
+    std::size_t upperBoundIdx( Span<const double> grid, double x ) const;
+
+    bool isValid() const noexcept { return !m_bucketStart.empty(); }
+
+  private:
+    static std::uint64_t bits( double ) noexcept;
+    std::uint64_t m_bitsLow = 0;
+    unsigned m_shift = 0;
+    std::vector<std::uint32_t> m_bucketStart;
+  };
+
+}
+
+
+////////////////////////////
+// Inline implementations //
+////////////////////////////
+
+namespace NCRYSTAL_NAMESPACE {
+
+  inline std::uint64_t LogGridIndex::bits( double x ) noexcept
+  {
+    std::uint64_t res;
+    std::memcpy( &res, &x, sizeof(res) );
+    return res;
+  }
+
+  inline std::size_t LogGridIndex::upperBoundIdx( Span<const double> grid, double x ) const
+  {
+    nc_assert( isValid() );
+    nc_assert( !grid.empty() );
+    if ( x < grid.front() )
+      return 0;
+    if ( !( x < grid.back() ) )
+      return grid.size();//NB: also for NaN, like std::upper_bound
+    //Now grid.front() <= x < grid.back(), so x is positive and bucket is valid:
+    const std::size_t ibucket = static_cast<std::size_t>( ( bits(x) - m_bitsLow ) >> m_shift );
+    nc_assert( ibucket + 1 < m_bucketStart.size() );
+    const double * itB = grid.data();
+    return static_cast<std::size_t>( std::upper_bound( itB + m_bucketStart[ibucket],
+                                                       itB + m_bucketStart[ibucket+1],
+                                                       x ) - itB );
+  }
+
+}
+
+#endif
@@ -212,6 +212,14 @@ namespace NCRYSTAL_NAMESPACE {
 
   VectD::const_iterator findClosestValInSortedVector(const VectD& v, double value);
 
+  //Equivalent to std::upper_bound(itB,itE,value), but starting the search at
+  //the provided hint (which must be in [itB,itE]) and searching outwards
+  //exponentially. Passing the previous result as hint when querying a sorted
+  //sequence of values thus walks the range monotonically rather than doing a
+  //full binary search for each value:
+  template<class TIter, class TValue>
+  TIter upperBoundWithHint( TIter itB, TIter itE, TIter hint, const TValue& value );
+
   //Test equality of floating point numbers, within relative and absolute tolerances:
   bool floateq(double a, double b, double rtol=1.0e-6, double atol=1.0e-6);
 
@@ -296,6 +304,27 @@ constexpr TInt NCrystal::ncconstexpr_roundupnextpow2( TInt a )
   return ncconstexpr_ispow2(a) ? a : ncconstexpr_roundupnextpow2( a + 1 );
 }
 
+template<class TIter, class TValue>
+inline TIter NCrystal::upperBoundWithHint( TIter itB, TIter itE, TIter hint, const TValue& value )
+{
+  nc_assert( itB <= hint && hint <= itE );
+  if ( hint != itB && value < *std::prev(hint) ) {
+    //Result is before the hint:
+    return std::upper_bound( itB, hint, value );
+  }
+  //All elements before hint are <= value, gallop forward:
+  std::size_t step = 1;
+  while ( true ) {
+    if ( step >= static_cast<std::size_t>( std::distance(hint,itE) ) )
+      return std::upper_bound( hint, itE, value );
+    TIter probe = std::next( hint, step );
+    if ( value < *probe )
+      return std::upper_bound( hint, probe, value );
+    hint = std::next(probe);
+    step *= 2;
+  }
+}
+
 inline double NCrystal::ncabs(double a) { return std::abs(a); }
 inline bool NCrystal::ncisnan(double a) { return std::isnan(a); }
 inline bool NCrystal::ncisinf(double a) { return std::isinf(a); }
@@ -0,0 +1,136 @@
+#ifndef NCrystal_PersistentCache_hh
+#define NCrystal_PersistentCache_hh
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/core/NCDefs.hh"
+#include "NCrystal/internal/utils/NCSpan.hh"
+
+namespace NCRYSTAL_NAMESPACE {
+
+  namespace PersistentCache {
+
+    // Opt-in persistent on-disk cache for expensive derived objects (HKL
+    // lists, expanded scattering kernels, SAB cross section and sampling
+    // tables), allowing them to be reused between processes. The cache is
+    // enabled by setting the NCRYSTAL_CACHE_DIR environment variable to a
+    // directory (which will be created if missing), or by calling setCacheDir.
+    //
+    // Each entry is identified by a 128 bit hash of all inputs affecting the
+    // result, along with the NCrystal version and the version of the file
+    // format. Files are memory mapped (where supported) and fully validated
+    // when loaded, and any sort of missing, invalid or inaccessible entry is
+    // simply treated as a cache miss (in which case the object is calculated
+    // and stored as usual). Entries are written to temporary files which are
+    // then renamed, so a cache directory can be shared by concurrent processes.
+    // Note that entries are never removed automatically, so the directory
+    // grows without bound as new materials, configurations or NCrystal versions
+    // are used (entries from other NCrystal versions are simply ignored). It
+    // can safely be cleaned up by deleting the directory (or files in it) when
+    // no processes are using it.
+
+    //Current cache directory (empty when the cache is disabled):
+    std::string cacheDir();
+    bool isEnabled();
+
+    //Override the value of NCRYSTAL_CACHE_DIR (empty string disables the cache):
+    void setCacheDir( std::string );
+
+    class Key {
+    public:
+      //Category is a short identifier (e.g. "hkl") which is also used in the
+      //file names of the cache entries:
+      explicit Key( const char * category );
+      Key& addU64( std::uint64_t );
+      Key& addDbl( double );
+      Key& addStr( const std::string& );
+      Key& addVect( Span<const double> );
+
+      const char * category() const { return m_category; }
+      std::string hexDigest() const;
+      std::pair<std::uint64_t,std::uint64_t> digest() const;
+    private:
+      const char * m_category;
+      std::uint64_t m_h1, m_h2, m_n = 0;
+      void absorb( std::uint64_t );
+    };
+
+    //Simple binary serialisation (also used for other purposes than the
+    //persistent cache, like the NCMATB format). All numbers are written in
+    //little-endian byte order regardless of the platform, so the serialised
+    //data can be exchanged between platforms:
+    class Writer : private MoveOnly {
+    public:
+      Writer() = default;
+      void addU64( std::uint64_t );
+      void addDbl( double );
+      void addVect( Span<const double> );
+      void addStr( const std::string& );
+      const std::string& data() const { return m_data; }
+    private:
+      std::string m_data;
+    };
+
+    class Reader {
+    public:
+      //Reads data written by a Writer. Reading beyond the end of the data
+      //results in a DataLoadError exception:
+      Reader( const char * data, std::size_t size ) : m_data(data), m_size(size) {}
+      std::uint64_t getU64();
+      double getDbl();
+      VectD getVect();
+      std::string getStr();
+      bool atEnd() const { return m_pos == m_size; }
+      //Read size of an array with elements of a given byte size, throwing if
+      //the remaining data is not large enough to contain it:
+      std::size_t getSize( std::size_t elementsize );
+    private:
+      const char * m_data;
+      std::size_t m_size;
+      std::size_t m_pos = 0;
+      const char * consume( std::size_t );
+    };
+
+    //Checksum of raw data (depends on both content and size, and is the same
+    //on all platforms):
+    std::uint64_t checksum( const char * data, std::size_t n );
+
+    //Load entry. Returns false if the cache is disabled, or if the entry is not
+    //available or is invalid. The deserialisation function must consume all
+    //the data, and should throw DataLoadError exceptions for invalid data:
+    bool load( const Key&, const std::function<void(Reader&)>& );
+
+    //Store entry (problems are reported as warnings, but otherwise ignored):
+    void store( const Key&, const Writer& );
+
+    //Statistics about load and store calls in the current process, while the
+    //cache was enabled (mostly for testing and debugging):
+    struct Stats {
+      std::uint64_t nhits = 0;
+      std::uint64_t nmisses = 0;
+      std::uint64_t nstores = 0;
+    };
+    Stats getStats();
+
+  }
+}
+
+#endif
@@ -44,6 +44,12 @@ namespace NCRYSTAL_NAMESPACE {
     const VectD& getXVals() const { return m_x; }
     const VectD& getYVals() const { return m_y; }
 
+    //Recreate from the internal (already normalised) state of another
+    //instance, as returned by getXVals(), getYVals() and getCDF(). This is
+    //intended for deserialisation, and results in an identical instance:
+    struct internal_state_t {};
+    PointwiseDist( internal_state_t, VectD&& x, VectD&& y, VectD&& cdf );
+
     //Convenience constructor (would not be needed if we had C++17's std::make_from_tuple):
     PointwiseDist(const std::pair<VectD,VectD>& xy ) : PointwiseDist(xy.first,xy.second) {}
     PointwiseDist(std::pair<VectD,VectD>&& xy ) : PointwiseDist(std::move(xy.first),std::move(xy.second)) {}
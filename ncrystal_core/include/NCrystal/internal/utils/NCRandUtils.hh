@@ -34,6 +34,14 @@ namespace NCRYSTAL_NAMESPACE {
   Vector randIsotropicDirection( RNG& );
   Vector randDirectionGivenScatterMu( RNG&, double mu, const Vector& in );
 
+  //Batched version of randDirectionGivenScatterMu, for N independent entries
+  //in structure-of-arrays layout (output arrays must not overlap the input
+  //arrays). Entries with mu=1 are passed through unchanged. Note that this
+  //consumes random numbers differently than the single-entry version:
+  void randDirectionsGivenScatterMu( RNG&, std::size_t N, const double* mu,
+                                     const double* ux, const double* uy, const double* uz,
+                                     double* out_ux, double* out_uy, double* out_uz );
+
   NeutronDirection randIsotropicNeutronDirection( RNG& );
   NeutronDirection randNeutronDirectionGivenScatterMu( RNG&, double mu, const Vector& in );
   inline NeutronDirection randNeutronDirectionGivenScatterMu( RNG& rng, CosineScatAngle mu, const NeutronDirection& in )
@@ -97,7 +105,16 @@ namespace NCRYSTAL_NAMESPACE {
 #endif
 
     double generate() noexcept;// uniformly in ]0,1]
+
+    //Generate n numbers at once. This gives exactly the same numbers, in the
+    //same order, as n calls to generate() would (and leaves the same state
+    //behind). Internally, complete blocks of
+    //genmany_nlanes*genmany_lanelength numbers are produced by genmany_nlanes
+    //lanes running in parallel, lane k producing the genmany_lanelength
+    //consecutive numbers starting at tgt[k*genmany_lanelength]:
     void generateMany(std::size_t n, double* tgt)  ncnoexceptndebug;
+    static constexpr unsigned genmany_nlanes = 8;
+    static constexpr unsigned genmany_lanelength = 256;
 
     uint64_t genUInt64() noexcept;//uniformly over 0..uint64max (i.e. all bits randomised)
     uint32_t genUInt32() noexcept;//uniformly over 0..uint32max (i.e. all bits randomised)
@@ -114,7 +131,57 @@ namespace NCRYSTAL_NAMESPACE {
   private:
     state_t m_s;
     void genmanyimpl(int n, double* tgt)  ncnoexceptndebug;
+    void genmanylanes(double* tgt)  ncnoexceptndebug;
+
+  };
+
+  class RandPhiloxImpl final : private MoveOnly {
+    //Counter-based generator implementing Philox4x32-10 due to John Salmon,
+    //Mark Moraes, Ron Dror and David Shaw ("Parallel random numbers: as easy
+    //as 1, 2, 3", SC11, doi:10.1145/2063384.2063405). Each 128 bit output
+    //block is a pure function of a 64 bit key and a 128 bit counter, which we
+    //split into a 64 bit stream id and a 64 bit block index. Any stream and
+    //any position within it can thus be reached in O(1), and the complete
+    //state is simply (key,streamid,position), with the position counted in
+    //64 bit words (two per block). Unlike xoroshiro128+, all output bits are of
+    //good quality.
+  public:
+    using state_t = std::array<uint64_t,3>;//key, stream id, position
+    RandPhiloxImpl( uint64_t seed = 0 );//NB: seed = 0 is not a special seed value.
+    RandPhiloxImpl( const state_t& );
+
+    double generate() noexcept;// uniformly in ]0,1]
+    void generateMany(std::size_t n, double* tgt)  ncnoexceptndebug;
+
+    uint64_t genUInt64() noexcept;//uniformly over 0..uint64max
+    uint32_t genUInt32() noexcept;//uniformly over 0..uint32max
+    bool coinflip() noexcept;
+
+    const state_t& state() const noexcept  { return m_s; }
+    void setState( const state_t& );
+
+    //State of an independent stream derived from the current key and stream
+    //id (but not the position), for a given index. Different indices, or
+    //different (key,streamid) pairs, give different streams (barring hash
+    //collisions in a 128 bit space). Position of new state is 0:
+    state_t deriveStreamState( uint64_t idx ) const noexcept;
+
+    //State of an independent stream to be used for "jumping". It is derived
+    //in the same manner, but with a separate domain tag and with the highest
+    //bit of the stream id set (it is always cleared for streams derived by
+    //index), so jumped streams can never coincide with streams derived by
+    //index:
+    state_t deriveJumpedState() const noexcept;
+
+    //Internal functions, exposed solely for the purpose of unit tests:
+    using block_t = std::array<uint32_t,4>;
+    static block_t philox4x32_10( block_t ctr, uint64_t key ) noexcept;
 
+  private:
+    state_t m_s;
+    uint64_t m_buf[2];//output of block m_s[2]/2 (only valid when m_s[2] is odd)
+    void fillBuffer() noexcept;
+    uint64_t genWord() noexcept;
   };
 
 }
@@ -201,6 +268,33 @@ inline double NCrystal::randExpInterval( RNG& rng, double a, double b, double c
   return RandExpIntervalSampler(a,b,c).sample(rng);
 }
 
+inline uint64_t NCrystal::RandPhiloxImpl::genWord() noexcept
+{
+  if ( !( m_s[2] & 1 ) )
+    fillBuffer();
+  return m_buf[ m_s[2]++ & 1 ];
+}
+
+inline double NCrystal::RandPhiloxImpl::generate() noexcept
+{
+  return randUInt64ToFP01( genWord() );
+}
+
+inline uint64_t NCrystal::RandPhiloxImpl::genUInt64() noexcept
+{
+  return genWord();
+}
+
+inline uint32_t NCrystal::RandPhiloxImpl::genUInt32() noexcept
+{
+  return static_cast<uint32_t>( genWord() >> 32 );
+}
+
+inline bool NCrystal::RandPhiloxImpl::coinflip() noexcept
+{
+  return genWord() & 0x8000000000000000ull;
+}
+
 inline uint64_t NCrystal::RandXRSRImpl::genUInt64WithBadLowerBits() noexcept
 {
   const uint64_t s0 = m_s[0];
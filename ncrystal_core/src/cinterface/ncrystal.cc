@@ -20,6 +20,7 @@
 
 #include "NCrystal/cinterface/ncrystal.h"
 #include "NCrystal/interfaces/NCRNG.hh"
+#include "NCrystal/interfaces/NCCacheStats.hh"
 #include "NCrystal/misc/NCMsgCtrl.hh"
 #include "NCrystal/internal/utils/NCMsg.hh"
 #include "NCrystal/internal/infobld/NCInfoBuilder.hh"
@@ -1207,6 +1208,35 @@ void ncrystal_samplescatter_many( ncrystal_scatter_t o,
   try {
     NC::NeutronDirection dir{ *direction };
     auto& sc = ncc::extract(o);
+#ifdef NCRYSTAL_ALLOW_ABI_BREAKAGE
+    //Forward in chunks to the batched interface:
+    constexpr std::size_t nchunk = 1024;
+    double buf_ekin[nchunk];
+    double buf_ux[nchunk];
+    double buf_uy[nchunk];
+    double buf_uz[nchunk];
+    std::size_t nfilled = std::min<std::size_t>(repeat,nchunk);
+    for ( std::size_t i = 0; i < nfilled; ++i ) {
+      buf_ekin[i] = ekin;
+      buf_ux[i] = dir[0];
+      buf_uy[i] = dir[1];
+      buf_uz[i] = dir[2];
+    }
+    auto& theCachePtr = sc.underlyingCachePtr();
+    auto& underlyingProcess = sc.underlying();
+    while ( repeat ) {
+      std::size_t n = std::min<std::size_t>(repeat,nchunk);
+      NC::ProcImpl::NewABI::sampleScatterMany( underlyingProcess, theCachePtr, sc.rng(),
+                                               buf_ekin, buf_ux, buf_uy, buf_uz, n,
+                                               results_ekin, results_dirx,
+                                               results_diry, results_dirz );
+      results_ekin += n;
+      results_dirx += n;
+      results_diry += n;
+      results_dirz += n;
+      repeat -= n;
+    }
+#else
     while (repeat--) {
       auto outcome = sc.sampleScatter(NC::NeutronEnergy{ekin}, dir);
       *results_ekin++ = outcome.ekin.dbl();
@@ -1214,6 +1244,7 @@ void ncrystal_samplescatter_many( ncrystal_scatter_t o,
       *results_diry++ = outcome.direction[1];
       *results_dirz++ = outcome.direction[2];
     }
+#endif
     return;
   } NCCATCH;
   //non-halting-error, invalidate all output:
@@ -1226,6 +1257,108 @@ void ncrystal_samplescatter_many( ncrystal_scatter_t o,
 
 }
 
+void ncrystal_crosssection_many( ncrystal_process_t o,
+                                 const double * ekin,
+                                 const double * dirx,
+                                 const double * diry,
+                                 const double * dirz,
+                                 unsigned long N,
+                                 double* results )
+{
+  try {
+    auto& process = ncc::extractProcess(o);
+#ifdef NCRYSTAL_ALLOW_ABI_BREAKAGE
+    NC::ProcImpl::NewABI::evalManyXS( process.underlying(), process.underlyingCachePtr(),
+                                      ekin, dirx, diry, dirz, N, results );
+#else
+    for (unsigned long i = 0; i < N; ++i)
+      results[i] = process.crossSection( NC::NeutronEnergy{ekin[i]},
+                                         NC::NeutronDirection{ dirx[i], diry[i], dirz[i] } ).get();
+#endif
+    return;
+  } NCCATCH;
+  //non-halting-error, invalidate all output:
+  for (unsigned long i = 0; i < N; ++i)
+    results[i] = -1.0;
+}
+
+void ncrystal_samplescatter_manystates( ncrystal_scatter_t o,
+                                        const double * ekin,
+                                        const double * dirx,
+                                        const double * diry,
+                                        const double * dirz,
+                                        unsigned long N,
+                                        double* results_ekin,
+                                        double* results_dirx,
+                                        double* results_diry,
+                                        double* results_dirz )
+{
+  try {
+    auto& sc = ncc::extract(o);
+#ifdef NCRYSTAL_ALLOW_ABI_BREAKAGE
+    NC::ProcImpl::NewABI::sampleScatterMany( sc.underlying(), sc.underlyingCachePtr(), sc.rng(),
+                                             ekin, dirx, diry, dirz, N,
+                                             results_ekin, results_dirx,
+                                             results_diry, results_dirz );
+#else
+    for (unsigned long i = 0; i < N; ++i) {
+      auto outcome = sc.sampleScatter( NC::NeutronEnergy{ekin[i]},
+                                       NC::NeutronDirection{ dirx[i], diry[i], dirz[i] } );
+      results_ekin[i] = outcome.ekin.dbl();
+      results_dirx[i] = outcome.direction[0];
+      results_diry[i] = outcome.direction[1];
+      results_dirz[i] = outcome.direction[2];
+    }
+#endif
+    return;
+  } NCCATCH;
+  //non-halting-error, invalidate all output:
+  for (unsigned long i = 0; i < N; ++i) {
+    results_ekin[i] = -1.0;
+    results_dirx[i] = results_diry[i] = results_dirz[i] = 0.0;
+  }
+}
+
+void ncrystal_crosssection_and_samplescatter_manystates( ncrystal_scatter_t o,
+                                                         const double * ekin,
+                                                         const double * dirx,
+                                                         const double * diry,
+                                                         const double * dirz,
+                                                         unsigned long N,
+                                                         double* results_xs,
+                                                         double* results_ekin,
+                                                         double* results_dirx,
+                                                         double* results_diry,
+                                                         double* results_dirz )
+{
+  try {
+    auto& sc = ncc::extract(o);
+#ifdef NCRYSTAL_ALLOW_ABI_BREAKAGE
+    NC::ProcImpl::NewABI::evalXSAndSampleScatterMany( sc.underlying(), sc.underlyingCachePtr(), sc.rng(),
+                                                      ekin, dirx, diry, dirz, N, results_xs,
+                                                      results_ekin, results_dirx,
+                                                      results_diry, results_dirz );
+#else
+    for (unsigned long i = 0; i < N; ++i) {
+      NC::NeutronEnergy e{ekin[i]};
+      NC::NeutronDirection d{ dirx[i], diry[i], dirz[i] };
+      results_xs[i] = sc.crossSection( e, d ).get();
+      auto outcome = sc.sampleScatter( e, d );
+      results_ekin[i] = outcome.ekin.dbl();
+      results_dirx[i] = outcome.direction[0];
+      results_diry[i] = outcome.direction[1];
+      results_dirz[i] = outcome.direction[2];
+    }
+#endif
+    return;
+  } NCCATCH;
+  //non-halting-error, invalidate all output:
+  for (unsigned long i = 0; i < N; ++i) {
+    results_xs[i] = results_ekin[i] = -1.0;
+    results_dirx[i] = results_diry[i] = results_dirz[i] = 0.0;
+  }
+}
+
 void ncrystal_genscatter_nonoriented( ncrystal_scatter_t o, double ekin, double* result_angle, double* result_dekin )
 {
   //obsolete fct:
@@ -1904,6 +2037,13 @@ void ncrystal_setbuiltinrandgen_withstate(const char* state)
   } NCCATCH;
 }
 
+void ncrystal_setcounterbasedrandgen_withseed(unsigned long seed)
+{
+  try {
+    NC::setDefaultRNG( NC::createCounterBasedRNG( static_cast<uint64_t>(seed) ) );
+  } NCCATCH;
+}
+
 int ncrystal_rngsupportsstatemanip_ofscatter( ncrystal_scatter_t sh )
 {
   try {
@@ -1941,6 +2081,28 @@ char * ncrystal_dbg_process( ncrystal_process_t o )
   return nullptr;
 }
 
+void ncrystal_cachestats_enable( int flag )
+{
+  try {
+    NC::CacheStats::enable( flag != 0 );
+  } NCCATCH;
+}
+
+void ncrystal_cachestats_reset(void)
+{
+  try {
+    NC::CacheStats::reset();
+  } NCCATCH;
+}
+
+char* ncrystal_cachestats_json(void)
+{
+  try {
+    return ncc::createString( NC::CacheStats::getStatsJSON() );
+  } NCCATCH;
+  return nullptr;
+}
+
 char* ncrystal_normalisecfg( const char * cfgstr )
 {
   try {
@@ -2343,7 +2505,7 @@ void ncrystal_runmmcsim_stdengine( unsigned nthreads,
   *tally_exitangle_nbins = 0;
 
   try {
-    NCMMC::MatDef matdef( mat_cfgstr );
+    auto matdefs = NCMMC::createMatDefs( mat_cfgstr );
     auto geom = NCMMC::createGeometry( mmc_geomcfg );
     auto src = NCMMC::createSource( mmc_srccfg );
 
@@ -2358,7 +2520,7 @@ void ncrystal_runmmcsim_stdengine( unsigned nthreads,
                              geom,
                              src,
                              tally,
-                             matdef );
+                             std::move( matdefs ) );
 
     auto copySpan2Array = [](NC::Span<const double> in)
     {
@@ -21,8 +21,10 @@
 #include "NCrystal/internal/dyninfoutils/NCDynInfoUtils.hh"
 #include "NCrystal/internal/fact_utils/NCFactoryUtils.hh"
 #include "NCrystal/internal/utils/NCMath.hh"
+#include "NCrystal/internal/utils/NCString.hh"
 #include "NCrystal/internal/vdos/NCVDOSToScatKnl.hh"
 #include "NCrystal/internal/sab/NCSABUtils.hh"
+#include <cstring>
 namespace NC = NCrystal;
 
 namespace NCRYSTAL_NAMESPACE {
@@ -31,6 +33,29 @@ namespace NCRYSTAL_NAMESPACE {
     using VDOSKey = std::tuple<uint64_t,unsigned,uint32_t,const DI_VDOS*>;//(DI unique id, vdoslux 0..5,vdos2sabExcludeFlag,DI object)
     using VDOSDebyeKey = std::tuple<unsigned,uint64_t,uint64_t,uint64_t,uint64_t>;//(reduced vdoslux 0..2 + rounded: elementMass, boundXS, T, TDebye)
 
+    //For DI_VDOS kernels (unless contributions are excluded via
+    //vdos2sabExcludeFlag), the key is based on a digest of the VDOS content and
+    //the exact temperature, so kernels can be shared between different DI_VDOS
+    //objects (e.g. from Info objects differing only in parameters unrelated to
+    //the dynamics, or for temperatures which are revisited). The DI_VDOS
+    //pointer is only used during creation and is thinned away for cache
+    //lookups:
+    using VDOSAtTThinKey = std::tuple<uint64_t,uint64_t,unsigned,uint64_t>;//(content digest, vdoslux 0..5, T bits)
+    struct VDOSAtTKey {
+      VDOSAtTThinKey thinkey;
+      const DI_VDOS* di;
+      std::size_t shardHash() const { return static_cast<std::size_t>(std::get<0>(thinkey)); }
+    };
+    struct VDOSAtTKeyThinner {
+      using key_type = VDOSAtTKey;
+      using thinned_key_type = VDOSAtTThinKey;
+      template <class TMap>
+      static typename TMap::mapped_type& cacheMapLookup( TMap& map, const key_type& key, Optional<thinned_key_type>& )
+      {
+        return map[key.thinkey];
+      }
+    };
+
     //For VDOS Debye we can potentially share work between different Info
     //objects, since the number of dependent parameters is very low. Thus, we
     //base the key on the rounded values of those parameters, and make sure we
@@ -74,9 +99,51 @@ namespace NCRYSTAL_NAMESPACE {
                SigmaBound{std::get<2>(key)*1e-7} };
     }
 
+    uint64_t temperatureBits( Temperature t )
+    {
+      t.validate();
+      nc_assert_always(t.get()>0.0&&t.get()<1.0e11);
+      const double val = t.get();
+      uint64_t bits;
+      std::memcpy( &bits, &val, sizeof(bits) );
+      return bits;
+    }
+
+    Temperature temperatureFromBits( uint64_t bits )
+    {
+      double val;
+      std::memcpy( &val, &bits, sizeof(val) );
+      return Temperature{ val };
+    }
+
+    //Wrap creation of SABData via the persistent cache (if enabled):
+    shared_obj<const SABData> viaPersistentCache( PersistentCache::Key key,
+                                                  const std::function<SABData()>& createFct )
+    {
+      if ( !PersistentCache::isEnabled() )
+        return std::make_shared<const SABData>( createFct() );
+      //Also include the (unofficial) environment variables affecting the
+      //kernel expansion in the key:
+      for ( auto envvar : { "HACK_MAXORDER", "HACK_ALPHAMAX", "HACK_BETAMAX",
+                            "HACK_NBINS", "SAB_BETATHICKENING_MINNBETA" } )
+        key.addStr( ncgetenv( envvar ) );
+      std::shared_ptr<const SABData> res;
+      if ( PersistentCache::load( key, [&res]( PersistentCache::Reader& r )
+                                  { res = std::make_shared<const SABData>( SABUtils::deserialiseSABData( r ) ); } ) )
+        return res;
+      res = std::make_shared<const SABData>( createFct() );
+      PersistentCache::Writer w;
+      SABUtils::serialiseSABData( w, *res );
+      PersistentCache::store( key, w );
+      return res;
+    }
+
+    double requestedEmax( const DI_VDOS& );
+
     //Actual worker functions producing results:
     shared_obj<const SABData> extractFromDIVDOSNoCache( unsigned vdoslux, uint32_t vdos2sabExcludeFlag, const DI_VDOS& );
     shared_obj<const SABData> extractFromDIVDOSDebyeNoCache( const VDOSDebyeKey& );
+    shared_obj<const SABData> extractFromDIVDOSAtTNoCache( const VDOSAtTKey& );
 
     //Factories:
     class VDOS2SABFactory : public NC::CachedFactoryBase<VDOSKey,SABData,10> {
@@ -124,8 +191,28 @@ namespace NCRYSTAL_NAMESPACE {
       }
     };
 
+    class VDOSAtT2SABFactory : public NC::CachedFactoryBase<VDOSAtTKey,SABData,20,VDOSAtTKeyThinner> {
+    public:
+      const char* factoryName() const final { return "VDOSAtT2SABFactory"; }
+      std::string keyToString( const VDOSAtTKey& key ) const final
+      {
+        std::ostringstream ss;
+        ss<<"(VDOS digest="<<std::hex<<std::get<0>(key.thinkey)<<std::get<1>(key.thinkey)<<std::dec
+          <<";vdoslux="<<std::get<2>(key.thinkey)
+          <<";T="<<temperatureFromBits(std::get<3>(key.thinkey))<<")";
+        return ss.str();
+      }
+    protected:
+      virtual ShPtr actualCreate( const VDOSAtTKey& key ) const final
+      {
+        nc_assert_always( key.di != nullptr );
+        return extractFromDIVDOSAtTNoCache( key );
+      }
+    };
+
     static VDOS2SABFactory s_vdos2sabfactory;
     static VDOSDebye2SABFactory s_vdosdebye2sabfactory;
+    static VDOSAtT2SABFactory s_vdosatt2sabfactory;
 
     shared_obj<const SABData> extractFromDIVDOS( unsigned vdoslux, uint32_t vdos2sabExcludeFlag, const DI_VDOS& di )
     {
@@ -138,6 +225,23 @@ namespace NCRYSTAL_NAMESPACE {
       return s_vdosdebye2sabfactory.create(key);
     }
 
+    shared_obj<const SABData> extractFromDIVDOSAtT( unsigned vdoslux, Temperature temperature, const DI_VDOS& di )
+    {
+      const auto& vd = di.vdosData();
+      PersistentCache::Key ckey("vdoscontent");
+      ckey.addDbl( vd.vdos_egrid().first )
+        .addDbl( vd.vdos_egrid().second )
+        .addVect( vd.vdos_density() )
+        .addDbl( vd.boundXS().dbl() )
+        .addDbl( vd.elementMassAMU().dbl() )
+        .addDbl( requestedEmax( di ) );
+      auto digest = ckey.digest();
+      VDOSAtTKey key{ VDOSAtTThinKey( digest.first, digest.second, vdoslux,
+                                      temperatureBits( temperature ) ),
+                      &di };
+      return s_vdosatt2sabfactory.create(key);
+    }
+
   }
 }
 
@@ -185,6 +289,8 @@ NC::shared_obj<const NC::SABData> NC::extractSABDataFromDynInfo( const NC::DI_Sc
   if (di_vdos) {
     if (!useCache)
       return DICache::extractFromDIVDOSNoCache(vdoslux,vdos2sabExcludeFlag,*di_vdos);
+    if ( vdos2sabExcludeFlag == 0 )
+      return DICache::extractFromDIVDOSAtT(vdoslux,di_vdos->vdosData().temperature(),*di_vdos);
     return DICache::extractFromDIVDOS(vdoslux,vdos2sabExcludeFlag,*di_vdos);
   }
 
@@ -193,13 +299,48 @@ NC::shared_obj<const NC::SABData> NC::extractSABDataFromDynInfo( const NC::DI_Sc
   return std::shared_ptr<const SABData>{nullptr};
 }
 
+std::shared_ptr<const NC::SABData> NC::extractSABDataFromDynInfoAtTemperature( const NC::DI_ScatKnl* di,
+                                                                               Temperature temperature,
+                                                                               unsigned vdoslux )
+{
+  nc_assert( di );
+  nc_assert( vdoslux <= 5 );
+  temperature.validate();
+
+  //==> VDOSDebye (key is already content based):
+  auto di_vdosdebye = dynamic_cast<const DI_VDOSDebye*>(di);
+  if (di_vdosdebye) {
+    unsigned reduced_vdoslux = static_cast<unsigned>(std::max<int>(0,static_cast<int>(vdoslux)-3));//nb: replicated above
+    auto key = DICache::getKey( reduced_vdoslux,
+                                temperature,
+                                di_vdosdebye->debyeTemperature(),
+                                di_vdosdebye->atomData().scatteringXS(),
+                                di_vdosdebye->atomData().averageMassAMU() );
+    return DICache::extractFromDIVDOSDebye(key);
+  }
+
+  //==> Directly specified kernels can not be expanded at other temperatures:
+  if ( dynamic_cast<const DI_ScatKnlDirect*>(di) )
+    return nullptr;
+
+  //==> VDOS:
+  auto di_vdos = dynamic_cast<const DI_VDOS*>(di);
+  if (di_vdos)
+    return DICache::extractFromDIVDOSAtT( vdoslux, temperature, *di_vdos );
+
+  //==> Unknown:
+  NCRYSTAL_THROW(LogicError,"Unknown DI_ScatKnl sub class");
+  return std::shared_ptr<const SABData>{nullptr};
+}
+
 void NC::clearSABDataFromDynInfoCaches()
 {
   DICache::s_vdos2sabfactory.cleanup();
   DICache::s_vdosdebye2sabfactory.cleanup();
+  DICache::s_vdosatt2sabfactory.cleanup();
 }
 
-NC::shared_obj<const NC::SABData> NC::DICache::extractFromDIVDOSNoCache( unsigned vdoslux, uint32_t vdos2sabExcludeFlag, const DI_VDOS& di  )
+double NC::DICache::requestedEmax( const DI_VDOS& di )
 {
   //If user specified an energy-grid with a specific upper energy, Emax,
   //this is essentially a request to expand the vdos out to that energy:
@@ -211,9 +352,49 @@ NC::shared_obj<const NC::SABData> NC::DICache::extractFromDIVDOSNoCache( unsigne
     nc_assert_always(egrid->size()>=3);
     requested_Emax = egrid->size()==3 ? egrid->at(1) : egrid->back();
   }
+  return requested_Emax;
+}
+
+NC::shared_obj<const NC::SABData> NC::DICache::extractFromDIVDOSAtTNoCache( const VDOSAtTKey& key )
+{
+  //Always base calculations only on the VDOS content and temperature in the
+  //key (the DI_VDOS object is only one of possibly many with that content):
+  const DI_VDOS& di = *key.di;
+  const unsigned vdoslux = std::get<2>(key.thinkey);
+  const Temperature temperature = temperatureFromBits( std::get<3>(key.thinkey) );
+  const double requested_Emax = requestedEmax( di );
+  const auto& vd_orig = di.vdosData();
+  VDOSData vd( vd_orig.vdos_egrid(),
+               VectD( vd_orig.vdos_density() ),
+               temperature,
+               vd_orig.boundXS(),
+               vd_orig.elementMassAMU() );
+  //Same layout as the key in extractFromDIVDOSNoCache, so both can share
+  //persistently cached kernels:
+  PersistentCache::Key pckey("vdos2sab");
+  pckey.addDbl( vd.vdos_egrid().first )
+    .addDbl( vd.vdos_egrid().second )
+    .addVect( vd.vdos_density() )
+    .addDbl( vd.temperature().dbl() )
+    .addDbl( vd.boundXS().dbl() )
+    .addDbl( vd.elementMassAMU().dbl() )
+    .addU64( vdoslux )
+    .addDbl( requested_Emax )
+    .addU64( 0 )
+    .addDbl( 1.0 );
+  return viaPersistentCache( pckey, [&vd,vdoslux,requested_Emax]()
+  {
+    return SABUtils::transformKernelToStdFormat( createScatteringKernel( vd, vdoslux, requested_Emax ) );
+  } );
+}
+
+NC::shared_obj<const NC::SABData> NC::DICache::extractFromDIVDOSNoCache( unsigned vdoslux, uint32_t vdos2sabExcludeFlag, const DI_VDOS& di  )
+{
+  const double requested_Emax = requestedEmax( di );
   const auto& vd = di.vdosData();
 
   ScaleGnContributionFct scaleGnFct = nullptr;
+  double gnScaleFactor = 1.0;
   if ( vdos2sabExcludeFlag > 0 ) {
     //vdos2sabExcludeFlag = MODE + 4*LOW + 40000*HIGH
     unsigned high = vdos2sabExcludeFlag / 40000;
@@ -242,13 +423,27 @@ NC::shared_obj<const NC::SABData> NC::DICache::extractFromDIVDOSNoCache( unsigne
         scalefact = 0.0;//exclude both sigma_coh and sigma_incoh
       }
       nc_assert_always( scalefact>=0.0 && scalefact<=1.0 );
+      gnScaleFactor = scalefact;
       scaleGnFct = [scalefact,low,high](unsigned n) { return ( n >= low && n<= high ) ? scalefact : 1.0; };
     }
   }
-  SABData sabdata = SABUtils::transformKernelToStdFormat( createScatteringKernel( vd, vdoslux, requested_Emax,
-                                                                                  VDOSGn::TruncAndThinningChoices::Default,
-                                                                                  scaleGnFct ) );
-  return std::make_shared<const SABData>(std::move(sabdata));
+  PersistentCache::Key key("vdos2sab");
+  key.addDbl( vd.vdos_egrid().first )
+    .addDbl( vd.vdos_egrid().second )
+    .addVect( vd.vdos_density() )
+    .addDbl( vd.temperature().dbl() )
+    .addDbl( vd.boundXS().dbl() )
+    .addDbl( vd.elementMassAMU().dbl() )
+    .addU64( vdoslux )
+    .addDbl( requested_Emax )
+    .addU64( vdos2sabExcludeFlag )
+    .addDbl( gnScaleFactor );
+  return viaPersistentCache( key, [&vd,vdoslux,requested_Emax,&scaleGnFct]()
+  {
+    return SABUtils::transformKernelToStdFormat( createScatteringKernel( vd, vdoslux, requested_Emax,
+                                                                         VDOSGn::TruncAndThinningChoices::Default,
+                                                                         scaleGnFct ) );
+  } );
 }
 
 NC::shared_obj<const NC::SABData> NC::DICache::extractFromDIVDOSDebyeNoCache( const VDOSDebyeKey& key )
@@ -259,9 +454,17 @@ NC::shared_obj<const NC::SABData> NC::DICache::extractFromDIVDOSDebyeNoCache( co
   //[0,debye_energy], to benefit from the quadratic scaling below the first grid
   //point implemented in VDOSEval (i.e. we get a more precise G1 function
   //constructed):
-  auto vdosdata = createVDOSDebye( param.debyeTemperature, param.temperature, param.boundXS, param.elementMass );
-  SABData sabdata = SABUtils::transformKernelToStdFormat( createScatteringKernel( vdosdata, param.reduced_vdoslux ) );
-  return std::make_shared<const SABData>(std::move(sabdata));
+  PersistentCache::Key pckey("vdosdebye2sab");
+  pckey.addU64( std::get<0>(key) )
+    .addU64( std::get<1>(key) )
+    .addU64( std::get<2>(key) )
+    .addU64( std::get<3>(key) )
+    .addU64( std::get<4>(key) );
+  return viaPersistentCache( pckey, [&param]()
+  {
+    auto vdosdata = createVDOSDebye( param.debyeTemperature, param.temperature, param.boundXS, param.elementMass );
+    return SABUtils::transformKernelToStdFormat( createScatteringKernel( vdosdata, param.reduced_vdoslux ) );
+  } );
 }
 
 
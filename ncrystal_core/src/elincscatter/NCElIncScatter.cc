@@ -176,6 +176,8 @@ NC::ElIncScatter::ElIncScatter( const Info& info, const ElIncScatterCfg& cfg )
   m_elincxs = std::make_unique<ElIncXS>( std::move(res.value().msd),
                                          std::move(res.value().bixs),
                                          std::move(res.value().scale) );
+  if ( cfg.tabulate || ncgetenv_bool("ELINC_TABULATE") )
+    m_elincxs->enableTabulation();
 }
 
 NC::ElIncScatter::ElIncScatter( const VectD& elements_meanSqDisp,
@@ -218,8 +220,11 @@ std::shared_ptr<NC::ProcImpl::Process> NC::ElIncScatter::createMerged( const Pro
   auto& o = *optr;
   nc_assert( m_elincxs != nullptr );
   nc_assert( o.m_elincxs != nullptr );
-  return std::make_shared<ElIncScatter>(std::make_unique<ElIncXS>( *m_elincxs, scale_self,
-                                                                   *o.m_elincxs, scale_other ));
+  auto merged = std::make_unique<ElIncXS>( *m_elincxs, scale_self,
+                                          *o.m_elincxs, scale_other );
+  if ( m_elincxs->isTabulated() || o.m_elincxs->isTabulated() )
+    merged->enableTabulation();
+  return std::make_shared<ElIncScatter>( std::move(merged) );
 }
 
 NC::Optional<std::string> NC::ElIncScatter::specificJSONDescription() const
@@ -231,6 +236,8 @@ NC::Optional<std::string> NC::ElIncScatter::specificJSONDescription() const
     std::ostringstream tmp;
     tmp << "nelements="<<nelem;
     tmp << ";max_contrib="<<xs_lowE;
+    if ( m_elincxs->isTabulated() )
+      tmp << ";tabulated";
     streamJSONDictEntry( ss, "summarystr", tmp.str(), JSONDictPos::FIRST );
   }
   streamJSONDictEntry( ss, "sigma_lowE_limit", xs_lowE.dbl() );
@@ -257,4 +264,38 @@ NC::ElIncScatter::evalXSAndSampleScatterIsotropic( CachePtr& cp, RNG& rng, Neutr
   };
 }
 
+void NC::ElIncScatter::sampleScatterMany( CachePtr& cp, RNG& rng, const double* ekin,
+                                          const double* ux, const double* uy, const double* uz,
+                                          std::size_t N,
+                                          double* out_ekin, double* out_ux,
+                                          double* out_uy, double* out_uz ) const
+{
+  //Sample scattering angles in chunks, then rotate all directions at once:
+  auto& cache = accessCache<CacheElInc>(cp);
+  constexpr std::size_t nbuf = 256;
+  double mu[nbuf];
+  for ( std::size_t i0 = 0; i0 < N; i0 += nbuf ) {
+    const std::size_t n = std::min<std::size_t>( nbuf, N - i0 );
+    for ( std::size_t j = 0; j < n; ++j ) {
+      NeutronEnergy e{ ekin[i0+j] };
+      if ( cache.data.ekin != e )
+        cache.data = m_elincxs->analyseEnergyPoint( e );
+      mu[j] = cache.data.sampleMu( *m_elincxs, rng ).dbl();
+      out_ekin[i0+j] = e.dbl();
+    }
+    randDirectionsGivenScatterMu( rng, n, mu, ux + i0, uy + i0, uz + i0,
+                                  out_ux + i0, out_uy + i0, out_uz + i0 );
+  }
+}
+
+void NC::ElIncScatter::evalXSAndSampleScatterMany( CachePtr& cp, RNG& rng, const double* ekin,
+                                                   const double* ux, const double* uy, const double* uz,
+                                                   std::size_t N, double* out_xs,
+                                                   double* out_ekin, double* out_ux,
+                                                   double* out_uy, double* out_uz ) const
+{
+  evalManyXSIsotropic( cp, ekin, N, out_xs );
+  sampleScatterMany( cp, rng, ekin, ux, uy, uz, N, out_ekin, out_ux, out_uy, out_uz );
+}
+
 #endif
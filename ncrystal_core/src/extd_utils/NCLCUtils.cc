@@ -26,10 +26,17 @@
 #include "NCrystal/internal/utils/NCRandUtils.hh"
 #include "NCrystal/internal/utils/NCRotMatrix.hh"
 #include "NCrystal/internal/utils/NCMsg.hh"
+#include "NCrystal/interfaces/NCCacheStats.hh"
 #include <functional>//std::greater
 
 namespace NC = NCrystal;
 
+namespace NCRYSTAL_NAMESPACE {
+  namespace {
+    static CacheStats::Category s_lchelper_cachestats("LCBragg");
+  }
+}
+
 //uncomment to generate special data files for debugging the overlay functions:
 //#define NCRYSTAL_LCHELPER_WRITE_OVERLAYS
 #ifdef NCRYSTAL_LCHELPER_WRITE_OVERLAYS
@@ -61,11 +68,15 @@ NC::LCHelper::LCHelper( NC::LCAxis lcaxis,
                         double unitcell_volume_times_natoms,
                         PlaneProvider* pp,
                         double prec,
-                        double ntrunc )
+                        double ntrunc,
+                        unsigned ncacheentries )
   : m_lcaxislab(lcaxis_labframe.as<Vector>().unit()),
     m_lcstdframe(mosaicity_fwhm,prec,ntrunc),
-    m_xsfact( 1.0 / unitcell_volume_times_natoms )
+    m_xsfact( 1.0 / unitcell_volume_times_natoms ),
+    m_ncacheentries( ncacheentries )
 {
+  if ( !( m_ncacheentries >= 1 && m_ncacheentries <= 1024 ) )
+    NCRYSTAL_THROW2(BadInput,"LCHelper: invalid number of cache entries requested: "<<m_ncacheentries);
   nc_assert(pp);
   nc_assert_always(unitcell_volume_times_natoms>0);
   nc_assert_always(m_xsfact>0);
@@ -318,8 +329,12 @@ bool NC::LCHelper::isValid(NC::LCHelper::Cache& cache, double wl, double c3 ) co
 {
   //ncabs, to ensure alpha_neutron <= pi/2 (rotation symmetry guarantees same results)
   nc_assert(wl>=0&&wl<1e7&&c3>=-1.0&&c3<=1.0);
-  return cache.m_signature.first == LCdiscretizeValue(wl)
-    && cache.m_signature.second == LCdiscretizeValue(ncabs(c3));
+  const std::pair<uint64_t,uint64_t> signature( LCdiscretizeValue(wl),
+                                                LCdiscretizeValue(ncabs(c3)) );
+  for ( auto& e : cache.m_entries )
+    if ( e.m_signature == signature )
+      return true;
+  return false;
 }
 
 bool NC::LCHelper::isValid(NC::LCHelper::Cache& cache, double wl, const NC::Vector& indir) const
@@ -337,25 +352,44 @@ void NC::LCHelper::ensureValid(NC::LCHelper::Cache& cache, double wl, const NC::
   nc_assert(wl>=0&&wl<1e7&&c3>=-1.0&&c3<=1.0);
   uint64_t discrwl = LCdiscretizeValue(wl);
   uint64_t discrc3 = LCdiscretizeValue(ncabs(c3));
-  if ( cache.m_signature.first == discrwl && cache.m_signature.second == discrc3 )
-    return;
+  const std::uint64_t usecount = ++cache.m_usecount;
+  for ( auto i : ncrange( cache.m_entries.size() ) ) {
+    auto& e = cache.m_entries[i];
+    if ( e.m_signature.first == discrwl && e.m_signature.second == discrc3 ) {
+      s_lchelper_cachestats.recordHit();
+      e.m_lastused = usecount;
+      cache.m_current = i;
+      return;
+    }
+  }
+  CacheStats::Category::MissScope missrecorder( s_lchelper_cachestats );
+  //Add new entry if there is still room, otherwise recycle the least recently
+  //used one (invalidated entries have m_lastused=0):
+  if ( cache.m_entries.size() < m_ncacheentries )
+    cache.m_entries.emplace_back();
+  auto itEntry = std::min_element( cache.m_entries.begin(), cache.m_entries.end(),
+                                   []( const Cache::Entry& a, const Cache::Entry& b )
+                                   { return a.m_lastused < b.m_lastused; } );
+  itEntry->m_lastused = usecount;
+  cache.m_current = static_cast<std::size_t>( std::distance( cache.m_entries.begin(), itEntry ) );
   forceUpdateCache(cache,discrwl,discrc3);
 }
 
 
 void NC::LCHelper::forceUpdateCache( NC::LCHelper::Cache& cache, uint64_t discr_wl, uint64_t discr_c3 ) const
 {
-  cache.m_signature.first = discr_wl;
-  cache.m_signature.second = discr_c3;
-  cache.m_wl = LCdediscretizeValue(discr_wl);
-  cache.m_c3 = LCdediscretizeValue(discr_c3);
-  nc_assert(cache.m_c3>=0&&cache.m_c3<=1.0+1e-6);
-  cache.m_c3 = ncmin(cache.m_c3,1.0);
-  cache.m_s3 = std::sqrt(ncabs(1.0-cache.m_c3*cache.m_c3));
-  cache.m_roilist.clear();
-  cache.m_roixs_commul.clear();
-  cache.m_roi_overlays.clear();
-  const double wl(cache.m_wl), c3(cache.m_c3), s3(cache.m_s3);
+  Cache::Entry& entry = cache.current();
+  entry.m_signature.first = discr_wl;
+  entry.m_signature.second = discr_c3;
+  entry.m_wl = LCdediscretizeValue(discr_wl);
+  entry.m_c3 = LCdediscretizeValue(discr_c3);
+  nc_assert(entry.m_c3>=0&&entry.m_c3<=1.0+1e-6);
+  entry.m_c3 = ncmin(entry.m_c3,1.0);
+  entry.m_s3 = std::sqrt(ncabs(1.0-entry.m_c3*entry.m_c3));
+  entry.m_roilist.clear();
+  entry.m_roixs_commul.clear();
+  entry.m_roi_overlays.clear();
+  const double wl(entry.m_wl), c3(entry.m_c3), s3(entry.m_s3);
 
   const double cta = m_lcstdframe.gaussMos().mosaicityCosTruncationAngle();
   const double sta = m_lcstdframe.gaussMos().mosaicitySinTruncationAngle();
@@ -365,15 +399,15 @@ void NC::LCHelper::forceUpdateCache( NC::LCHelper::Cache& cache, uint64_t discr_
     if ( wl > it->twodsp )
       break;//done, no other planes can contribute, since m_planes is sorted by dspacing
 #ifndef NDEBUG
-    std::size_t nold = cache.m_roilist.size();
+    std::size_t nold = entry.m_roilist.size();
 #endif
-    roifinder.findROIs(&(*it),cache.m_roilist);
+    roifinder.findROIs(&(*it),entry.m_roilist);
 #ifndef NDEBUG
     {
       //sanity check of ROI ranges:
       Vector vneutron(s3,0.,c3);
-      for (std::size_t ii = nold; ii<cache.m_roilist.size(); ++ii) {
-        LCROI & roi = cache.m_roilist.at(ii);
+      for (std::size_t ii = nold; ii<entry.m_roilist.size(); ++ii) {
+        LCROI & roi = entry.m_roilist.at(ii);
         if (roi.isDegenerate())
           continue;
         LCStdFrame::NormalPars normal(roi.planeset,roi.normal_sign);
@@ -387,28 +421,28 @@ void NC::LCHelper::forceUpdateCache( NC::LCHelper::Cache& cache, uint64_t discr_
 #endif
 #if defined(NCRYSTAL_LCUTILS_ANTINORMALS_ONLY) || defined(NCRYSTAL_LCUTILS_ANTINORMALS_EXCLUDED)
     {
-      decltype(cache.m_roilist) modified_roilist;
+      decltype(entry.m_roilist) modified_roilist;
       //    double normal_sign;//1.0 for normal(s), -1.0 for anti-normal(s).
 #  ifdef NCRYSTAL_LCUTILS_ANTINORMALS_ONLY
       constexpr double modify_target_normsign = -1.0;
 #  else
       constexpr double modify_target_normsign = 1.0;
 #  endif
-      for (const auto& e: cache.m_roilist) {
+      for (const auto& e: entry.m_roilist) {
         if (e.normal_sign == modify_target_normsign)
           modified_roilist.emplace_back(e);
       }
-      cache.m_roilist.swap(modified_roilist);
+      entry.m_roilist.swap(modified_roilist);
     }
 #endif
   }
 
-  if (cache.m_roilist.empty())
+  if (entry.m_roilist.empty())
     return;
 
-  cache.m_roixs_commul.reserve(cache.m_roilist.size());
+  entry.m_roixs_commul.reserve(entry.m_roilist.size());
   double sumxs = 0.0;
-  std::vector<LCROI>::const_iterator itROI(cache.m_roilist.begin()),itROIE(cache.m_roilist.end());
+  std::vector<LCROI>::const_iterator itROI(entry.m_roilist.begin()),itROIE(entry.m_roilist.end());
 
   LCStdFrame::NeutronPars neutron(wl,c3,s3);
 
@@ -432,25 +466,36 @@ void NC::LCHelper::forceUpdateCache( NC::LCHelper::Cache& cache, uint64_t discr_
       roi_xs = m_lcstdframe.calcXSIntegral(neutron,normal,itROI->rotmin,itROI->rotmax) * kInvPi;
     }
     nc_assert(roi_xs>0);//otherwise it should not have been a ROI!
-    cache.m_roixs_commul.push_back(sumxs += roi_xs);
+    entry.m_roixs_commul.push_back(sumxs += roi_xs);
   }
 
-  nc_assert(cache.m_roixs_commul.size()==cache.m_roilist.size());
+  nc_assert(entry.m_roixs_commul.size()==entry.m_roilist.size());
 }
 
 double NC::LCHelper::crossSection( NC::LCHelper::Cache& cache, double wl, const NC::Vector& indir ) const
 {
   ensureValid(cache,wl,indir);
-  return cache.m_roixs_commul.empty() ? 0.0 : (m_xsfact * cache.m_roixs_commul.back());
+  const Cache::Entry& entry = cache.current();
+  return entry.m_roixs_commul.empty() ? 0.0 : (m_xsfact * entry.m_roixs_commul.back());
 }
 
 void NC::LCHelper::Cache::reset()
 {
-  //same result as Cache() constructor
+  //same result as Cache() constructor, except that memory in all entries is
+  //retained.
+  for ( auto& e : m_entries )
+    e.reset();
+  m_current = 0;
+}
+
+void NC::LCHelper::Cache::Entry::reset()
+{
+  //same result as Entry() constructor
   m_signature.first = m_signature.second = std::numeric_limits<uint64_t>::max();
   m_wl = m_c3 = m_s3 = -99.0;
   m_roilist.clear();
   m_roixs_commul.clear();
+  m_lastused = 0;
 }
 
 namespace NCRYSTAL_NAMESPACE {
@@ -528,8 +573,9 @@ void NC::LCHelper::genScatter( LCHelper::Cache& cache, RNG& rng, double wl, cons
 {
 
   ensureValid(cache,wl,indir);
+  Cache::Entry& entry = cache.current();
 
-  double roixssum = cache.m_roixs_commul.empty() ? 0.0 : cache.m_roixs_commul.back();
+  double roixssum = entry.m_roixs_commul.empty() ? 0.0 : entry.m_roixs_commul.back();
   if (!roixssum) {
     //scattering not possible here.
     outdir = indir;
@@ -537,16 +583,16 @@ void NC::LCHelper::genScatter( LCHelper::Cache& cache, RNG& rng, double wl, cons
   }
 
   //Choose ROI, according to cross-section of each ROI:
-  std::size_t idx = pickRandIdxByWeight(rng,cache.m_roixs_commul);
-  nc_assert(idx<cache.m_roilist.size());
-  const LCROI& roi = cache.m_roilist[idx];
+  std::size_t idx = pickRandIdxByWeight(rng,entry.m_roixs_commul);
+  nc_assert(idx<entry.m_roilist.size());
+  const LCROI& roi = entry.m_roilist[idx];
 
   //Now, generate the scattering in the chosen ROI. In case of on-Axis ROI, this
   //can go straight ahead. In case of off-Axis, one must first decide upon the
   //exact rotation of the crystallite in which the scattering occurs.
 
 
-  LCStdFrame::NeutronPars neutron(cache.m_wl,cache.m_c3,cache.m_s3);
+  LCStdFrame::NeutronPars neutron(entry.m_wl,entry.m_c3,entry.m_s3);
   LCStdFrame::NormalPars normal(roi.planeset,roi.normal_sign);
 
   if ( roi.normalIsOnAxis() ) {
@@ -562,10 +608,10 @@ void NC::LCHelper::genScatter( LCHelper::Cache& cache, RNG& rng, double wl, cons
     } else {
 
       //Find overlay object:
-      if (cache.m_roi_overlays.empty())
-        cache.m_roi_overlays.resize(cache.m_roilist.size());
-      nc_assert(idx<cache.m_roi_overlays.size());
-      Overlay& overlay = cache.m_roi_overlays[idx];
+      if (entry.m_roi_overlays.empty())
+        entry.m_roi_overlays.resize(entry.m_roilist.size());
+      nc_assert(idx<entry.m_roi_overlays.size());
+      Overlay& overlay = entry.m_roi_overlays[idx];
 
       if (!overlay.data) {
 
@@ -604,7 +650,7 @@ void NC::LCHelper::genScatter( LCHelper::Cache& cache, RNG& rng, double wl, cons
       std::string written_name;
       {
         static std::set<std::tuple<const LCPlaneSet *,double,double,double> > written;
-        auto key = std::make_tuple(roi.planeset,cache.m_wl,roi.rotmin,roi.rotmax);
+        auto key = std::make_tuple(roi.planeset,entry.m_wl,roi.rotmin,roi.rotmax);
         if (!written.count(key)) {
           written.insert(key);
           std::stringstream s; s<<"phi_overlay_roi"<<written.size()<<".txt";
@@ -679,7 +725,7 @@ void NC::LCHelper::genScatter( LCHelper::Cache& cache, RNG& rng, double wl, cons
   //description of LCStdFrame). Here, the lcaxis was aligned with the z-axis
   //while indir=(s3,0,c3). We rotate outdir from this frame to the lab frame:
   double indirsign = m_lcaxislab.dot(indir) >= 0.0 ? 1.0 : -1.0;
-  rotateToFrame( cache.m_s3, cache.m_c3, indir, m_lcaxislab*indirsign, outdir, &rng );
+  rotateToFrame( entry.m_s3, entry.m_c3, indir, m_lcaxislab*indirsign, outdir, &rng );
 
   //Throughout LCUtils internals we have for (misguided attempts at?) clarity,
   //employed a sign convention for the neutron direction vector which is
@@ -21,6 +21,7 @@
 #include "NCrystal/internal/fact_utils/NCFactoryJobs.hh"
 #ifndef NCRYSTAL_DISABLE_THREADS
 #  include "NCrystal/threads/NCFactThreads.hh"
+#  include "NCrystal/internal/fact_utils/NCFactoryUtils.hh"
 #  include <condition_variable>
 #  include <chrono>
 #endif
@@ -77,7 +78,12 @@ void NC::FactoryJobs::queueMT( voidfct_t job )
   MTImpl * mt = m_mt;
   m_mt->m_job_queuefct( [mt,job]()
   {
-    job();
+    {
+      //Jobs are considered part of a factory construction, so any factory
+      //requests they make will not wait for constructions in other threads:
+      thread_details::FactoryConstructionScope construction_scope;
+      job();
+    }
     std::unique_lock<std::mutex> lock(mt->m_mutex);
     --(mt->m_unfinishedjobs);
     mt->m_condvar.notify_one();
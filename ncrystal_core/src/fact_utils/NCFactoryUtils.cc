@@ -51,9 +51,19 @@ std::string NC::thread_details::currentThreadIDForPrint()
   ss << std::this_thread::get_id();
   return ss.str();
 }
+unsigned& NC::thread_details::factoryConstructionDepth()
+{
+  static thread_local unsigned s_depth = 0;
+  return s_depth;
+}
 #else
 std::string NC::thread_details::currentThreadIDForPrint()
 {
   return "<thread-id-unavailable>";
 }
+unsigned& NC::thread_details::factoryConstructionDepth()
+{
+  static unsigned s_depth = 0;
+  return s_depth;
+}
 #endif
@@ -269,6 +269,13 @@ namespace NCRYSTAL_NAMESPACE {
         bool operator<(const DBKey_TextDataPath&o) const { return m_path < o.m_path; }
       };
 
+      //Hashes for CachedFactoryBase sharding, based on the UIDs which are the
+      //first things compared by the operator< of the requests (and which are
+      //kept when thinning):
+      inline std::size_t shardHashImpl( const InfoRequest& r ) { return static_cast<std::size_t>(r.textDataUID().value()); }
+      inline std::size_t shardHashImpl( const ScatterRequest& r ) { return static_cast<std::size_t>(r.infoUID().value); }
+      inline std::size_t shardHashImpl( const AbsorptionRequest& r ) { return static_cast<std::size_t>(r.infoUID().value); }
+
       template<class TXXXRequest>
       class DBKey_XXXRequest {
         TXXXRequest m_cfg;
@@ -278,6 +285,7 @@ namespace NCRYSTAL_NAMESPACE {
         const TXXXRequest& getUserFactoryKey() const { return m_cfg; }
         std::string toString() const { std::ostringstream ss; m_cfg.stream(ss); return ss.str(); }
         bool operator<(const DBKey_XXXRequest&o) const { return m_cfg < o.m_cfg; }
+        std::size_t shardHash() const { return shardHashImpl( m_cfg ); }
         DBKey_XXXRequest cloneThinned() const { return m_cfg.cloneThinned(); }
       };
 
@@ -549,6 +557,11 @@ namespace NCRYSTAL_NAMESPACE {
           return m_data.at(0).isThinned();
         }
 
+        std::size_t shardHash() const
+        {
+          return m_data.empty() ? 0 : static_cast<std::size_t>(m_data.front().second.infoUID().value);
+        }
+
         CfgLvlMPProc_Key cloneThinned() const
         {
           CfgLvlMPProc_Key res;
@@ -987,8 +1000,10 @@ NC::ProcImpl::ProcPtr NCF::ScatterFactory::globalCreateScatter( const ScatterReq
 std::string NCF::guessDataType( const RawStrData& data,
                                 const std::string& filename )
 {
-  //Figure out data type. We are able to recognise NCMAT content from the
-  //data itself, and otherwise we look at the file extension.
+  //Figure out data type. We are able to recognise NCMAT (and pre-parsed NCMATB)
+  //content from the data itself, and otherwise we look at the file extension.
+  if ( 0 == std::strncmp( data.begin(), "NCMATB", 6 ) )
+    return "ncmatb"_s;
   if ( 0 == std::strncmp( data.begin(), "NCMAT", 5 ) )
     return "ncmat"_s;
   auto ext = getfileext(filename);
@@ -88,3 +88,42 @@ NC::Optional<std::string> NC::FreeGas::specificJSONDescription() const
   streamJSONDictEntry( ss, "atom_mass", m_impl->m_target_mass_amu.dbl(), JSONDictPos::LAST );
   return ss.str();
 }
+
+#ifdef NCRYSTAL_ALLOW_ABI_BREAKAGE
+void NC::FreeGas::sampleScatterMany( CachePtr&, RNG& rng, const double* ekin,
+                                     const double* ux, const double* uy, const double* uz,
+                                     std::size_t N,
+                                     double* out_ekin, double* out_ux,
+                                     double* out_uy, double* out_uz ) const
+{
+  //Sample energy transfers and scattering angles in chunks, then rotate all
+  //directions at once:
+  const auto temperature = m_impl->m_temperature;
+  const auto target_mass_amu = m_impl->m_target_mass_amu;
+  constexpr std::size_t nbuf = 256;
+  double mu[nbuf];
+  for ( std::size_t i0 = 0; i0 < N; i0 += nbuf ) {
+    const std::size_t n = std::min<std::size_t>( nbuf, N - i0 );
+    for ( std::size_t j = 0; j < n; ++j ) {
+      const double e = ekin[i0+j];
+      double delta_ekin;
+      std::tie(delta_ekin,mu[j]) = FreeGasSampler(NeutronEnergy{e},temperature,target_mass_amu).sampleDeltaEMu(rng);
+      out_ekin[i0+j] = ncmax(0.0,e+delta_ekin);
+    }
+    randDirectionsGivenScatterMu( rng, n, mu, ux + i0, uy + i0, uz + i0,
+                                  out_ux + i0, out_uy + i0, out_uz + i0 );
+  }
+}
+
+void NC::FreeGas::evalXSAndSampleScatterMany( CachePtr& cp, RNG& rng, const double* ekin,
+                                              const double* ux, const double* uy, const double* uz,
+                                              std::size_t N, double* out_xs,
+                                              double* out_ekin, double* out_ux,
+                                              double* out_uy, double* out_uz ) const
+{
+  const auto& xsprovider = m_impl->m_xsprovider;
+  for ( std::size_t i = 0; i < N; ++i )
+    out_xs[i] = xsprovider.crossSection(NeutronEnergy{ekin[i]}).dbl();
+  sampleScatterMany( cp, rng, ekin, ux, uy, uz, N, out_ekin, out_ux, out_uy, out_uz );
+}
+#endif
@@ -0,0 +1,222 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/interfaces/NCCacheStats.hh"
+#include "NCrystal/internal/utils/NCString.hh"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+namespace NC = NCrystal;
+
+namespace NCRYSTAL_NAMESPACE {
+  namespace CacheStats {
+    namespace {
+
+      //Fixed maximum number of categories, so per-thread counters can be kept
+      //in a plain array. Any categories beyond this will share the last slot:
+      constexpr unsigned kMaxCategories = 64;
+
+      void initEnabledFlagFromEnv()
+      {
+        //Only done once, and never overriding a flag already set via enable():
+        static bool s_dummy = []()
+        {
+          if ( ncgetenv_bool("CACHESTATS") )
+            detail::s_enabled.store( true );
+          return true;
+        }();
+        (void)s_dummy;
+      }
+
+      //Also pick up the environment variable at load time, in case
+      //isEnabled() is queried before any Category has been constructed:
+      const bool s_envinit = ( initEnabledFlagFromEnv(), true );
+
+      struct Counters {
+        std::atomic<std::uint64_t> hits;
+        std::atomic<std::uint64_t> misses;
+        std::atomic<std::uint64_t> nanoseconds;
+        Counters() : hits(0), misses(0), nanoseconds(0) {}
+        void zero()
+        {
+          hits.store( 0, std::memory_order_relaxed );
+          misses.store( 0, std::memory_order_relaxed );
+          nanoseconds.store( 0, std::memory_order_relaxed );
+        }
+      };
+
+      struct ThreadCounters;
+
+      struct Registry {
+        std::mutex mtx;
+        std::vector<std::string> names;
+        std::set<ThreadCounters*> threads;
+        //Counts from threads which have ended:
+        std::array<std::uint64_t,kMaxCategories> retired_hits = {};
+        std::array<std::uint64_t,kMaxCategories> retired_misses = {};
+        std::array<std::uint64_t,kMaxCategories> retired_nanoseconds = {};
+      };
+
+      Registry& getRegistry()
+      {
+        static Registry reg;
+        return reg;
+      }
+
+      struct ThreadCounters : private NoCopyMove {
+        std::array<Counters,kMaxCategories> counters;
+        ThreadCounters()
+        {
+          auto& reg = getRegistry();
+          NCRYSTAL_LOCK_GUARD(reg.mtx);
+          reg.threads.insert(this);
+        }
+        ~ThreadCounters()
+        {
+          auto& reg = getRegistry();
+          NCRYSTAL_LOCK_GUARD(reg.mtx);
+          for ( auto i : ncrange(kMaxCategories) ) {
+            reg.retired_hits[i] += counters[i].hits.load( std::memory_order_relaxed );
+            reg.retired_misses[i] += counters[i].misses.load( std::memory_order_relaxed );
+            reg.retired_nanoseconds[i] += counters[i].nanoseconds.load( std::memory_order_relaxed );
+          }
+          reg.threads.erase(this);
+        }
+      };
+
+      Counters& threadCounters( unsigned idx ) noexcept
+      {
+        //NB: idx<kMaxCategories is guaranteed by Category constructor.
+        static thread_local ThreadCounters tc;
+        return tc.counters[idx];
+      }
+    }
+  }
+}
+
+//Constant-initialised (so usable from other static initialisers):
+std::atomic<bool> NC::CacheStats::detail::s_enabled( false );
+
+void NC::CacheStats::enable( bool flag )
+{
+  initEnabledFlagFromEnv();
+  detail::s_enabled.store( flag );
+}
+
+NC::CacheStats::Category::Category( const char * name )
+{
+  initEnabledFlagFromEnv();
+  auto& reg = getRegistry();
+  NCRYSTAL_LOCK_GUARD(reg.mtx);
+  //Several Category objects might share the same name:
+  for ( auto i : ncrange( reg.names.size() ) ) {
+    if ( reg.names.at(i) == name ) {
+      m_idx = static_cast<unsigned>( i );
+      return;
+    }
+  }
+  if ( reg.names.size() + 1 < kMaxCategories ) {
+    m_idx = static_cast<unsigned>( reg.names.size() );
+    reg.names.emplace_back( name );
+  } else {
+    m_idx = kMaxCategories - 1;
+    reg.names.resize( kMaxCategories );
+    reg.names.back() = "Other";
+  }
+}
+
+void NC::CacheStats::Category::addHit() const noexcept
+{
+  threadCounters( m_idx ).hits.fetch_add( 1, std::memory_order_relaxed );
+}
+
+void NC::CacheStats::Category::addMiss( std::uint64_t nanoseconds ) const noexcept
+{
+  auto& c = threadCounters( m_idx );
+  c.misses.fetch_add( 1, std::memory_order_relaxed );
+  c.nanoseconds.fetch_add( nanoseconds, std::memory_order_relaxed );
+}
+
+std::uint64_t NC::CacheStats::Category::nowNanoSeconds() noexcept
+{
+  using clock_t = std::chrono::steady_clock;
+  return static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>
+                                     ( clock_t::now().time_since_epoch() ).count() );
+}
+
+std::vector<NC::CacheStats::Entry> NC::CacheStats::getStats()
+{
+  std::vector<Entry> res;
+  auto& reg = getRegistry();
+  NCRYSTAL_LOCK_GUARD(reg.mtx);
+  res.reserve( reg.names.size() );
+  for ( auto i : ncrange( reg.names.size() ) ) {
+    std::uint64_t hits( reg.retired_hits.at(i) );
+    std::uint64_t misses( reg.retired_misses.at(i) );
+    std::uint64_t ns( reg.retired_nanoseconds.at(i) );
+    for ( auto tc : reg.threads ) {
+      auto& c = tc->counters.at(i);
+      hits += c.hits.load( std::memory_order_relaxed );
+      misses += c.misses.load( std::memory_order_relaxed );
+      ns += c.nanoseconds.load( std::memory_order_relaxed );
+    }
+    res.emplace_back();
+    auto& e = res.back();
+    e.name = reg.names.at(i);
+    e.hits = hits;
+    e.misses = misses;
+    e.recalcTime = ns * 1e-9;
+  }
+  std::sort( res.begin(), res.end(),
+             []( const Entry& a, const Entry& b ) { return a.name < b.name; } );
+  return res;
+}
+
+void NC::CacheStats::reset()
+{
+  auto& reg = getRegistry();
+  NCRYSTAL_LOCK_GUARD(reg.mtx);
+  reg.retired_hits.fill(0);
+  reg.retired_misses.fill(0);
+  reg.retired_nanoseconds.fill(0);
+  for ( auto tc : reg.threads )
+    for ( auto& c : tc->counters )
+      c.zero();
+}
+
+std::string NC::CacheStats::getStatsJSON()
+{
+  auto stats = getStats();
+  std::ostringstream ss;
+  ss << '[';
+  for ( auto i : ncrange( stats.size() ) ) {
+    auto& e = stats.at(i);
+    if ( i )
+      ss << ',';
+    streamJSONDictEntry( ss, "name", e.name, JSONDictPos::FIRST );
+    streamJSONDictEntry( ss, "hits", e.hits );
+    streamJSONDictEntry( ss, "misses", e.misses );
+    streamJSONDictEntry( ss, "recalc_time", e.recalcTime, JSONDictPos::LAST );
+  }
+  ss << ']';
+  return ss.str();
+}
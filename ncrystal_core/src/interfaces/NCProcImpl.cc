@@ -19,6 +19,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "NCrystal/interfaces/NCProcImpl.hh"
+#include "NCrystal/interfaces/NCCacheStats.hh"
 #include "NCrystal/internal/utils/NCRandUtils.hh"
 #include "NCrystal/internal/utils/NCString.hh"
 #include "NCrystal/internal/utils/NCMath.hh"
@@ -107,6 +108,10 @@ NC::ScatterOutcome NCPI::NullProcess::sampleScatter( CachePtr&,
 namespace NCRYSTAL_NAMESPACE {
   namespace ProcImpl {
 
+    namespace {
+      static CacheStats::Category s_cachestats_proccomp("ProcComposition");
+    }
+
     class CacheProcComp final : public CacheBase {
     public:
       void invalidateCache() override { key_ekin = NeutronEnergy{-1.0}; }
@@ -121,6 +126,11 @@ namespace NCRYSTAL_NAMESPACE {
       };
       SmallVector<ComponentCache,6> componentCache;
       SmallVector<double,6> componentXSectCommul;
+#ifdef NCRYSTAL_ALLOW_ABI_BREAKAGE
+      //Work buffers for batched scatterings (kept here to avoid reallocations):
+      VectD manyBuf;
+      std::vector<std::size_t> manyIdx;
+#endif
 
       void reset(unsigned nhist,const ProcComposition::ComponentList& comps) {
         nHistory = nhist;
@@ -166,16 +176,21 @@ namespace NCRYSTAL_NAMESPACE {
         nc_assert(cache.key_dir.as<Vector>().isStrictNullVector());//no mixing between anisotropic and isotropic cache.
 
         //Compare cached ekin to provided value.
-        if ( cache.key_ekin == ekin )
+        if ( cache.key_ekin == ekin ) {
+          s_cachestats_proccomp.recordHit();
           return cache;
+        }
 
         //Try a bit more FP-sensible cache checking, in case 80-bit registers
         //are somehow messing up stuff (although it is rather unlikely that they
         //will given the non-inlined source of ekin):
-        if ( floateq(cache.key_ekin.dbl(),ekin.dbl(),1e-15,0.0) )
+        if ( floateq(cache.key_ekin.dbl(),ekin.dbl(),1e-15,0.0) ) {
+          s_cachestats_proccomp.recordHit();
           return cache;
+        }
 
         //Ok, cache was not valid!
+        CacheStats::Category::MissScope missrecorder( s_cachestats_proccomp );
         cache.key_ekin = NeutronEnergy{-1.0};//put to invalid value while
                                              //updating for exception safety.
 
@@ -206,8 +221,10 @@ namespace NCRYSTAL_NAMESPACE {
         auto& cache = initAndAccessCache(THIS,cacheptr);
 
         //Compare cached ekin to provided value.
-        if ( cache.key_ekin == ekin && cache.key_dir == dir )
+        if ( cache.key_ekin == ekin && cache.key_dir == dir ) {
+          s_cachestats_proccomp.recordHit();
           return cache;
+        }
 
         //Try a bit more FP-sensible cache checking, in case 80-bit registers
         //are somehow messing up stuff (although it is rather unlikely that they
@@ -216,10 +233,13 @@ namespace NCRYSTAL_NAMESPACE {
         if ( cmpfloat( cache.key_ekin.dbl(),ekin.dbl() )
              && cmpfloat( cache.key_dir[0],dir[0] )
              && cmpfloat( cache.key_dir[1],dir[1] )
-             && cmpfloat( cache.key_dir[2],dir[2] ) )
+             && cmpfloat( cache.key_dir[2],dir[2] ) ) {
+          s_cachestats_proccomp.recordHit();
           return cache;
+        }
 
         //Ok, cache was not valid!
+        CacheStats::Category::MissScope missrecorder( s_cachestats_proccomp );
         cache.key_ekin = NeutronEnergy{-1.0};//put to invalid value while
                                              //updating for exception safety.
 
@@ -240,6 +260,158 @@ namespace NCRYSTAL_NAMESPACE {
         return cache;
       }
 
+#ifdef NCRYSTAL_ALLOW_ABI_BREAKAGE
+      static void sampleScatterMany( const ProcComposition* THIS,
+                                     CachePtr& cacheptr, RNG& rng,
+                                     const double* ekin, const double* ux,
+                                     const double* uy, const double* uz,
+                                     std::size_t N,
+                                     double* out_xs,//nullptr if not needed
+                                     double* out_ekin, double* out_ux,
+                                     double* out_uy, double* out_uz )
+      {
+        nc_assert( THIS->m_processType == ProcessType::Scatter );
+        auto& cache = initAndAccessCache(THIS,cacheptr);
+        const std::size_t ncomp = THIS->m_components.size();
+
+        if ( ncomp == 1 ) {
+          //Simply forward:
+          auto& comp = THIS->m_components.front();
+          auto& compCachePtr = cache.componentCache.front().cachePtr;
+          if ( !out_xs ) {
+            comp.process->sampleScatterMany( compCachePtr, rng, ekin, ux, uy, uz, N,
+                                             out_ekin, out_ux, out_uy, out_uz );
+            return;
+          }
+          comp.process->evalXSAndSampleScatterMany( compCachePtr, rng, ekin, ux, uy, uz, N,
+                                                    out_xs, out_ekin, out_ux, out_uy, out_uz );
+          if ( comp.scale != 1.0 )
+            for ( auto i : ncrange(N) )
+              out_xs[i] *= comp.scale;
+          return;
+        }
+
+        //Process in chunks. For each chunk we first evaluate the (batched)
+        //cross sections of all components, and select a component for each
+        //neutron. The neutrons are then grouped by component, and each group
+        //is forwarded in one batch to the selected component:
+        constexpr std::size_t nchunk = 1024;
+        const std::size_t nbuf_commul = nchunk * ncomp;
+        auto& buf = cache.manyBuf;
+        buf.resize( nbuf_commul + 10 * nchunk );
+        double * buf_commul = buf.data();//commul xs, indexed [ineutron*ncomp+icomp]
+        double * buf_xs = buf_commul + nbuf_commul;
+        double * buf_rand = buf_xs + nchunk;
+        double * buf_in_ekin = buf_rand + nchunk;
+        double * buf_in_ux = buf_in_ekin + nchunk;
+        double * buf_in_uy = buf_in_ux + nchunk;
+        double * buf_in_uz = buf_in_uy + nchunk;
+        double * buf_out_ekin = buf_in_uz + nchunk;
+        double * buf_out_ux = buf_out_ekin + nchunk;
+        double * buf_out_uy = buf_out_ux + nchunk;
+        double * buf_out_uz = buf_out_uy + nchunk;
+        auto& idxbuf = cache.manyIdx;
+        idxbuf.resize( 2 * nchunk + ncomp + 3 );
+        std::size_t * buf_choice = idxbuf.data();
+        std::size_t * buf_order = buf_choice + nchunk;
+        std::size_t * buf_offsets = buf_order + nchunk;//ncomp+3 entries
+        const std::size_t ichoice_none = ncomp;//neutrons with vanishing xs
+
+        while ( N > 0 ) {
+          const std::size_t n = std::min<std::size_t>(N,nchunk);
+
+          //Cross sections:
+          for ( auto icomp : ncrange(ncomp) ) {
+            auto& comp = THIS->m_components[icomp];
+            comp.process->evalManyXS( cache.componentCache[icomp].cachePtr,
+                                      ekin, ux, uy, uz, n, buf_xs );
+            const double scale = comp.scale;
+            if ( icomp == 0 ) {
+              for ( std::size_t j = 0; j < n; ++j )
+                buf_commul[j*ncomp] = scale * buf_xs[j];
+            } else {
+              for ( std::size_t j = 0; j < n; ++j )
+                buf_commul[j*ncomp+icomp] = buf_commul[j*ncomp+icomp-1] + scale * buf_xs[j];
+            }
+          }
+          if ( out_xs ) {
+            for ( std::size_t j = 0; j < n; ++j )
+              out_xs[j] = buf_commul[j*ncomp+ncomp-1];
+          }
+
+          //Select components:
+          rng.generateMany( n, buf_rand );
+          for ( auto ic : ncrange(ncomp+3) )
+            buf_offsets[ic] = 0;
+          for ( std::size_t j = 0; j < n; ++j ) {
+            const double * commul = buf_commul + j*ncomp;
+            const std::size_t ic = ( commul[ncomp-1] > 0.0
+                                     ? pickRandIdxByWeight( buf_rand[j], Span<const double>( commul, commul + ncomp ) )
+                                     : ichoice_none );
+            buf_choice[j] = ic;
+            ++buf_offsets[ic+2];
+          }
+          //Counting sort (buf_offsets[ic+1] becomes start index of group ic):
+          for ( auto ic : ncrange(std::size_t(2),ncomp+3) )
+            buf_offsets[ic] += buf_offsets[ic-1];
+          for ( std::size_t j = 0; j < n; ++j )
+            buf_order[buf_offsets[buf_choice[j]+1]++] = j;
+          //Now buf_offsets[ic] is the start index of group ic.
+
+          //Neutrons which can not scatter are passed through unchanged:
+          for ( auto k : ncrange(buf_offsets[ichoice_none],n) ) {
+            const std::size_t j = buf_order[k];
+            out_ekin[j] = ekin[j];
+            out_ux[j] = ux[j];
+            out_uy[j] = uy[j];
+            out_uz[j] = uz[j];
+          }
+
+          //Forward each group to the selected component:
+          for ( auto icomp : ncrange(ncomp) ) {
+            const std::size_t kbegin = buf_offsets[icomp];
+            const std::size_t ngroup = buf_offsets[icomp+1] - kbegin;
+            if ( !ngroup )
+              continue;
+            const std::size_t * order = buf_order + kbegin;
+            for ( std::size_t k = 0; k < ngroup; ++k ) {
+              const std::size_t j = order[k];
+              buf_in_ekin[k] = ekin[j];
+              buf_in_ux[k] = ux[j];
+              buf_in_uy[k] = uy[j];
+              buf_in_uz[k] = uz[j];
+            }
+            THIS->m_components[icomp].process->sampleScatterMany( cache.componentCache[icomp].cachePtr,
+                                                                  rng,
+                                                                  buf_in_ekin, buf_in_ux,
+                                                                  buf_in_uy, buf_in_uz,
+                                                                  ngroup,
+                                                                  buf_out_ekin, buf_out_ux,
+                                                                  buf_out_uy, buf_out_uz );
+            for ( std::size_t k = 0; k < ngroup; ++k ) {
+              const std::size_t j = order[k];
+              out_ekin[j] = buf_out_ekin[k];
+              out_ux[j] = buf_out_ux[k];
+              out_uy[j] = buf_out_uy[k];
+              out_uz[j] = buf_out_uz[k];
+            }
+          }
+
+          ekin += n;
+          ux += n;
+          uy += n;
+          uz += n;
+          if ( out_xs )
+            out_xs += n;
+          out_ekin += n;
+          out_ux += n;
+          out_uy += n;
+          out_uz += n;
+          N -= n;
+        }
+      }
+#endif
+
     };
   }
 }
@@ -717,15 +889,68 @@ void NCPI::ProcComposition::evalManyXSIsotropic( CachePtr& cachePtr,
   constexpr std::size_t nbuf = 4096;
   double buf[nbuf];
 
+  //Components are only evaluated for energies inside their domain. When the
+  //energies are sorted (e.g. when tabulating cross sections on a grid), these
+  //form a contiguous range which can be located by binary search. Sorted input
+  //also allows components to walk their internal grids monotonically. For
+  //unsorted input, the in-domain energies are instead gathered into a
+  //contiguous buffer, and the results scattered back afterwards:
+  const bool is_sorted = std::is_sorted( ekin, ekin + N );
+  double buf_gathered[ nbuf ];
+  std::uint16_t buf_idx[ nbuf ];
+  static_assert( nbuf <= std::numeric_limits<std::uint16_t>::max(), "" );
+
   while ( N > 0 ) {
     std::size_t nstep = std::min<std::size_t>(N,nbuf);
+    double chunk_emin, chunk_emax;
+    if ( is_sorted ) {
+      chunk_emin = ekin[0];
+      chunk_emax = ekin[nstep-1];
+    } else {
+      auto mm = std::minmax_element( ekin, ekin + nstep );
+      chunk_emin = *mm.first;
+      chunk_emax = *mm.second;
+    }
     for ( auto icomp : ncrange(m_components.size()) ) {
       auto& comp = m_components[icomp];
-      comp.process->evalManyXSIsotropic( cache.componentCache[icomp].cachePtr,
-                                         ekin, nstep, buf );
-      double scale = comp.scale;
-      for ( std::size_t j = 0; j<nstep; ++j )
-        out_xs[j] += scale * buf[j];
+      const EnergyDomain& domain = cache.componentCache[icomp].domain;
+      if ( domain.isNull() || chunk_emax < domain.elow.dbl() || chunk_emin > domain.ehigh.dbl() )
+        continue;//no overlap with domain
+      const double scale = comp.scale;
+      if ( is_sorted ) {
+        const double * ekin_begin = std::lower_bound( ekin, ekin + nstep, domain.elow.dbl() );
+        std::size_t n = std::upper_bound( ekin_begin, ekin + nstep, domain.ehigh.dbl() ) - ekin_begin;
+        if ( !n )
+          continue;
+        comp.process->evalManyXSIsotropic( cache.componentCache[icomp].cachePtr,
+                                           ekin_begin, n, buf );
+        double * out = out_xs + ( ekin_begin - ekin );
+        for ( std::size_t j = 0; j<n; ++j )
+          out[j] += scale * buf[j];
+      } else if ( chunk_emin >= domain.elow.dbl() && chunk_emax <= domain.ehigh.dbl() ) {
+        //Entire chunk inside domain:
+        comp.process->evalManyXSIsotropic( cache.componentCache[icomp].cachePtr,
+                                           ekin, nstep, buf );
+        for ( std::size_t j = 0; j<nstep; ++j )
+          out_xs[j] += scale * buf[j];
+      } else {
+        //Gather in-domain energies:
+        std::size_t n = 0;
+        const double elow = domain.elow.dbl();
+        const double ehigh = domain.ehigh.dbl();
+        for ( std::size_t j = 0; j<nstep; ++j ) {
+          if ( ekin[j] >= elow && ekin[j] <= ehigh ) {
+            buf_gathered[n] = ekin[j];
+            buf_idx[n++] = static_cast<std::uint16_t>( j );
+          }
+        }
+        if ( !n )
+          continue;
+        comp.process->evalManyXSIsotropic( cache.componentCache[icomp].cachePtr,
+                                           buf_gathered, n, buf );
+        for ( std::size_t k = 0; k<n; ++k )
+          out_xs[buf_idx[k]] += scale * buf[k];
+      }
     }
     ekin += nstep;
     out_xs += nstep;
@@ -733,6 +958,112 @@ void NCPI::ProcComposition::evalManyXSIsotropic( CachePtr& cachePtr,
   }
 }
 
+namespace NCRYSTAL_NAMESPACE {
+  namespace ProcImpl {
+    namespace {
+      //Default implementation of the batched scattering methods for both
+      //ScatterIsotropicMat and ScatterAnisotropicMat, which simply serialises
+      //(out_xs may be null if cross sections are not needed):
+      void serialiseScatterMany( const Process& proc, CachePtr& cp, RNG& rng,
+                                 const double* ekin,
+                                 const double* ux, const double* uy, const double* uz,
+                                 std::size_t N, double* out_xs,
+                                 double* out_ekin, double* out_ux,
+                                 double* out_uy, double* out_uz )
+      {
+        auto setOutcome = [out_ekin,out_ux,out_uy,out_uz]( std::size_t i, const ScatterOutcome& outcome )
+        {
+          out_ekin[i] = outcome.ekin.dbl();
+          out_ux[i] = outcome.direction[0];
+          out_uy[i] = outcome.direction[1];
+          out_uz[i] = outcome.direction[2];
+        };
+        for ( std::size_t i = 0; i < N; ++i ) {
+          NeutronEnergy e{ ekin[i] };
+          NeutronDirection indir{ ux[i], uy[i], uz[i] };
+          if ( out_xs ) {
+            auto res = proc.evalXSAndSampleScatter( cp, rng, e, indir );
+            out_xs[i] = res.first.dbl();
+            setOutcome( i, res.second );
+          } else {
+            setOutcome( i, proc.sampleScatter( cp, rng, e, indir ) );
+          }
+        }
+      }
+    }
+  }
+}
+
+void NCPI::ScatterIsotropicMat::sampleScatterMany( CachePtr& cp, RNG& rng,
+                                                   const double* ekin,
+                                                   const double* ux, const double* uy, const double* uz,
+                                                   std::size_t N,
+                                                   double* out_ekin, double* out_ux,
+                                                   double* out_uy, double* out_uz ) const
+{
+  serialiseScatterMany( *this, cp, rng, ekin, ux, uy, uz, N, nullptr,
+                        out_ekin, out_ux, out_uy, out_uz );
+}
+
+void NCPI::ScatterIsotropicMat::evalXSAndSampleScatterMany( CachePtr& cp, RNG& rng,
+                                                            const double* ekin,
+                                                            const double* ux, const double* uy, const double* uz,
+                                                            std::size_t N, double* out_xs,
+                                                            double* out_ekin, double* out_ux,
+                                                            double* out_uy, double* out_uz ) const
+{
+  serialiseScatterMany( *this, cp, rng, ekin, ux, uy, uz, N, out_xs,
+                        out_ekin, out_ux, out_uy, out_uz );
+}
+
+void NCPI::ScatterAnisotropicMat::sampleScatterMany( CachePtr& cp, RNG& rng,
+                                                     const double* ekin,
+                                                     const double* ux, const double* uy, const double* uz,
+                                                     std::size_t N,
+                                                     double* out_ekin, double* out_ux,
+                                                     double* out_uy, double* out_uz ) const
+{
+  serialiseScatterMany( *this, cp, rng, ekin, ux, uy, uz, N, nullptr,
+                        out_ekin, out_ux, out_uy, out_uz );
+}
+
+void NCPI::ScatterAnisotropicMat::evalXSAndSampleScatterMany( CachePtr& cp, RNG& rng,
+                                                              const double* ekin,
+                                                              const double* ux, const double* uy, const double* uz,
+                                                              std::size_t N, double* out_xs,
+                                                              double* out_ekin, double* out_ux,
+                                                              double* out_uy, double* out_uz ) const
+{
+  serialiseScatterMany( *this, cp, rng, ekin, ux, uy, uz, N, out_xs,
+                        out_ekin, out_ux, out_uy, out_uz );
+}
+
+void NCPI::ProcComposition::sampleScatterMany( CachePtr& cachePtr, RNG& rng,
+                                               const double* ekin,
+                                               const double* ux, const double* uy, const double* uz,
+                                               std::size_t N,
+                                               double* out_ekin, double* out_ux,
+                                               double* out_uy, double* out_uz ) const
+{
+  if ( m_processType != ProcessType::Scatter )
+    NCRYSTAL_THROW(LogicError,"Process::sampleScatterMany can not be called for an absorption process.");
+  Impl::sampleScatterMany( this, cachePtr, rng, ekin, ux, uy, uz, N,
+                           nullptr, out_ekin, out_ux, out_uy, out_uz );
+}
+
+void NCPI::ProcComposition::evalXSAndSampleScatterMany( CachePtr& cachePtr, RNG& rng,
+                                                        const double* ekin,
+                                                        const double* ux, const double* uy, const double* uz,
+                                                        std::size_t N, double* out_xs,
+                                                        double* out_ekin, double* out_ux,
+                                                        double* out_uy, double* out_uz ) const
+{
+  if ( m_processType != ProcessType::Scatter )
+    NCRYSTAL_THROW(LogicError,"Process::evalXSAndSampleScatterMany can not be called for an absorption process.");
+  Impl::sampleScatterMany( this, cachePtr, rng, ekin, ux, uy, uz, N,
+                           out_xs, out_ekin, out_ux, out_uy, out_uz );
+}
+
 void NCPI::NullProcess::evalManyXS( CachePtr&, const double*,
                                     const double*, const double*, const double*,
                                     std::size_t N, double* out_xs ) const
@@ -765,6 +1096,46 @@ NCPI::NullAbsorption::evalXSAndSampleScatterIsotropic(CachePtr&, RNG&, NeutronEn
   return { CrossSect{0.0}, { NeutronEnergy{0.0}, CosineScatAngle{0.0} } };
 }
 
+void NCPI::NullAbsorption::sampleScatterMany( CachePtr&, RNG&, const double*,
+                                              const double*, const double*, const double*,
+                                              std::size_t, double*, double*,
+                                              double*, double* ) const
+{
+  NCRYSTAL_THROW(LogicError,"Process::sampleScatterMany can not be called for an absorption process.");
+}
+
+void NCPI::NullAbsorption::evalXSAndSampleScatterMany( CachePtr&, RNG&, const double*,
+                                                       const double*, const double*, const double*,
+                                                       std::size_t, double*, double*, double*,
+                                                       double*, double* ) const
+{
+  NCRYSTAL_THROW(LogicError,"Process::evalXSAndSampleScatterMany can not be called for an absorption process.");
+}
+
+void NCPI::NullScatter::sampleScatterMany( CachePtr&, RNG&, const double* ekin,
+                                           const double* ux, const double* uy, const double* uz,
+                                           std::size_t N, double* out_ekin, double* out_ux,
+                                           double* out_uy, double* out_uz ) const
+{
+  for ( std::size_t i = 0; i < N; ++i ) {
+    out_ekin[i] = ekin[i];
+    out_ux[i] = ux[i];
+    out_uy[i] = uy[i];
+    out_uz[i] = uz[i];
+  }
+}
+
+void NCPI::NullScatter::evalXSAndSampleScatterMany( CachePtr& cp, RNG& rng, const double* ekin,
+                                                    const double* ux, const double* uy, const double* uz,
+                                                    std::size_t N, double* out_xs,
+                                                    double* out_ekin, double* out_ux,
+                                                    double* out_uy, double* out_uz ) const
+{
+  for ( std::size_t i = 0; i < N; ++i )
+    out_xs[i] = 0.0;
+  sampleScatterMany( cp, rng, ekin, ux, uy, uz, N, out_ekin, out_ux, out_uy, out_uz );
+}
+
 std::pair<NC::CrossSect,NC::ScatterOutcome>
 NCPI::NullScatter::evalXSAndSampleScatter( CachePtr&, RNG&, NeutronEnergy ekin, const NeutronDirection& dir ) const
 {
@@ -793,5 +1164,21 @@ void NCPI::AbsorptionIsotropicMat::evalManyXSIsotropic( CachePtr& cp, const doub
     *out_xs++ = this->crossSectionIsotropic( cp, NeutronEnergy{*ekin++} ).dbl();
 }
 
+void NCPI::AbsorptionIsotropicMat::sampleScatterMany( CachePtr&, RNG&, const double*,
+                                                      const double*, const double*, const double*,
+                                                      std::size_t, double*, double*,
+                                                      double*, double* ) const
+{
+  NCRYSTAL_THROW(LogicError,"Process::sampleScatterMany can not be called for an absorption process.");
+}
+
+void NCPI::AbsorptionIsotropicMat::evalXSAndSampleScatterMany( CachePtr&, RNG&, const double*,
+                                                               const double*, const double*, const double*,
+                                                               std::size_t, double*, double*, double*,
+                                                               double*, double* ) const
+{
+  NCRYSTAL_THROW(LogicError,"Process::evalXSAndSampleScatterMany can not be called for an absorption process.");
+}
+
 
 #endif
@@ -86,6 +86,7 @@ namespace NCRYSTAL_NAMESPACE {
   namespace RNGStream_detail {
 
     constexpr uint32_t builtinRNGStateTypeUID = 0xb067bd44;//randomly generated
+    constexpr uint32_t builtinPhiloxRNGStateTypeUID = 0x6e1a52f3;//randomly generated
 
     uint32_t extractStateUID( const char * fullfct, const std::string& state )
     {
@@ -133,7 +134,9 @@ NC::shared_obj<NC::RNGStream> NC::RNGStream::createJumped() const
 
 bool NC::stateIsFromBuiltinRNG( const RNGStreamState& state )
 {
-  return RNGStream_detail::extractStateUID( "NCrystal::stateIsFromBuiltinRNG", state.get() ) == RNGStream_detail::builtinRNGStateTypeUID;
+  const auto uid = RNGStream_detail::extractStateUID( "NCrystal::stateIsFromBuiltinRNG", state.get() );
+  return ( uid == RNGStream_detail::builtinRNGStateTypeUID
+           || uid == RNGStream_detail::builtinPhiloxRNGStateTypeUID );
 }
 
 namespace NCRYSTAL_NAMESPACE {
@@ -208,6 +211,85 @@ namespace NCRYSTAL_NAMESPACE {
     RandXRSRImpl m_impl;
   };
 
+  class RNG_Philox final : public RNGStream {
+  public:
+
+    RNG_Philox( uint64_t seed ) : m_impl{seed} {}
+    RNG_Philox( const RandPhiloxImpl::state_t& st ) : m_impl{st} {}
+
+    bool coinflip() override { return m_impl.coinflip(); }
+    uint64_t generate64RndmBits() override { return m_impl.genUInt64(); }
+    uint32_t generate32RndmBits() override { return m_impl.genUInt32(); }
+
+#ifdef NCRYSTAL_ALLOW_ABI_BREAKAGE
+    void generateMany( std::size_t n, double* tgt ) override
+    {
+      return m_impl.generateMany(n,tgt);
+    }
+#endif
+
+    //Independent stream for a given index (only depends on the key and stream
+    //id of this stream, not on the current position):
+    shared_obj<RNGStream> createByIdx( RNGStreamIndex idx ) const
+    {
+      return makeSO<RNG_Philox>( m_impl.deriveStreamState( idx.get() ) );
+    }
+
+    const RandPhiloxImpl& impl() const { return m_impl; }
+
+  protected:
+
+    double actualGenerate() override { return m_impl.generate(); }
+
+    uint32_t stateTypeUID() const noexcept override {
+      return RNGStream_detail::builtinPhiloxRNGStateTypeUID;
+    }
+
+    static RandPhiloxImpl::state_t detail_convstate(std::vector<uint8_t>&& v)
+    {
+      RandPhiloxImpl::state_t newstate;
+      nc_assert_always( v.size() == 3*sizeof(uint64_t) );
+      newstate[2] = popFromStateVector<uint64_t>(v);
+      newstate[1] = popFromStateVector<uint64_t>(v);
+      newstate[0] = popFromStateVector<uint64_t>(v);
+      nc_assert(v.empty());
+      return newstate;
+    }
+    void actualSetState( std::vector<uint8_t>&& v ) override
+    {
+      m_impl.setState( detail_convstate(std::move(v)) );
+    }
+    std::vector<uint8_t> actualGetState() const override
+    {
+      std::vector<uint8_t> v;
+      v.reserve( 3*sizeof(uint64_t) );
+      for ( auto e : m_impl.state() )
+        appendToStateVector<uint64_t>(v,e);
+      nc_assert( v.size() == 3*sizeof(uint64_t) );
+      return v;
+    }
+
+    shared_obj<RNGStream> actualCloneWithNewState( std::vector<uint8_t>&& v ) const override
+    {
+      return makeSO<RNG_Philox>( detail_convstate(std::move(v)) );
+    }
+
+    bool isJumpCapable() const override
+    {
+      return true;
+    }
+
+    shared_obj<RNGStream> createJumped() const override
+    {
+      //Rather than advancing the counter, we move to a different stream. This
+      //is kept disjoint from the streams provided by createByIdx:
+      return makeSO<RNG_Philox>( m_impl.deriveJumpedState() );
+    }
+
+  private:
+    RandPhiloxImpl m_impl;
+  };
+
   class RNG_OneFctForAllThreads final : public RNGStream {
   public:
     RNG_OneFctForAllThreads( std::function<double()> fct ) : m_fct{std::move(fct)} {}
@@ -226,11 +308,22 @@ NC::shared_obj<NC::RNGStream> NC::createBuiltinRNG( uint64_t seed )
 
 NC::shared_obj<NC::RNGStream> NC::createBuiltinRNG( const RNGStreamState& state )
 {
+  const auto uid = RNGStream_detail::extractStateUID( "NCrystal::createBuiltinRNG", state.get() );
+  if ( uid == RNGStream_detail::builtinPhiloxRNGStateTypeUID ) {
+    auto rng = makeSO<RNG_Philox>( RandPhiloxImpl::state_t{ 0, 0, 0 } );
+    rng->setState(state);
+    return rng;
+  }
   auto rng = makeSO<RNG_XRSR>( no_init );
   rng->setState(state);
   return rng;
 }
 
+NC::shared_obj<NC::RNGStream> NC::createCounterBasedRNG( uint64_t seed )
+{
+  return makeSO<RNG_Philox>(seed);
+}
+
 namespace NCRYSTAL_NAMESPACE {
   namespace {
     struct DefRNGProd {
@@ -279,6 +372,7 @@ namespace NCRYSTAL_NAMESPACE {
     Impl( no_init_t ) {}
     optional_shared_obj<RNGStream> m_nextproduct;
     optional_shared_obj<RNGStream> m_nextnextproduct;
+    optional_shared_obj<RNG_Philox> m_idxroot;//for O(1) produceByIdx if counter-based
     std::map<RNGStreamIndex,optional_shared_obj<RNGStream>> m_idxdb;
     std::map<ThreadID,optional_shared_obj<RNGStream>> m_thread_idxdb;
     std::mutex m_mtx;
@@ -317,7 +411,7 @@ NC::shared_obj<NC::RNGStream> NC::RNGProducer::Impl::produceByIdxUnlocked( RNGSt
 {
   optional_shared_obj<RNGStream>& entry = m_idxdb[idx];
   if ( entry == nullptr )
-    entry = produceUnlocked();
+    entry = ( m_idxroot != nullptr ? m_idxroot->createByIdx( idx ) : produceUnlocked() );
   return entry;
 }
 
@@ -367,6 +461,12 @@ NC::shared_obj<NC::RNGProducer> NC::RNGProducer::getNullProducer()
 NC::RNGProducer::RNGProducer( shared_obj<RNGStream> rng, SkipOriginal skip_orig )
   : m_impl( std::move(rng) )
 {
+  //Counter-based streams can produce streams by index directly, based on the
+  //key and stream id of the original stream:
+  auto philox = std::dynamic_pointer_cast<RNG_Philox>( m_impl->m_nextproduct );
+  if ( philox != nullptr )
+    m_impl->m_idxroot = makeSO<RNG_Philox>( philox->impl().state() );
+
   //Create jumped state immediately if possible (before anyone consumes
   //numbers from m_nextproduct, thereby modifying the state):
   m_impl->jumpFillNextNextIfAppropriate();
@@ -36,7 +36,8 @@ namespace NCRYSTAL_NAMESPACE {
 
     pimpl(LCBragg * lcbragg, LCAxis lcaxis, int mode,
           SCOrientation sco, const Info& cinfo, PlaneProvider * plane_provider,
-          MosaicityFWHM mosaicity, double delta_d, double prec,double ntrunc)
+          MosaicityFWHM mosaicity, double delta_d, double prec,double ntrunc,
+          unsigned ncacheentries)
       : m_ekin_low(-1)
     {
       nc_assert_always(lcbragg);
@@ -63,12 +64,13 @@ namespace NCRYSTAL_NAMESPACE {
                                                  mosaicity,
                                                  si.volume * si.n_atoms,
                                                  plane_provider,
-                                                 prec, ntrunc);
+                                                 prec, ntrunc, ncacheentries );
 
         m_ekin_low = wl2ekin( m_lchelper->braggThreshold() );
 
       } else {
-        auto scbragg = makeSO<SCBragg>(cinfo,sco,mosaicity,delta_d,plane_provider,prec, ntrunc);
+        auto scbragg = makeSO<SCBragg>(cinfo,sco,mosaicity,delta_d,plane_provider,prec, ntrunc,
+                                       ncacheentries);
         if (mode>0) {
           m_scmodel = std::make_shared<LCBraggRef>(scbragg, lcaxis_labframe, mode);
         } else {
@@ -94,8 +96,8 @@ namespace NCRYSTAL_NAMESPACE {
 
 NC::LCBragg::LCBragg( const Info& ci, const SCOrientation& sco, MosaicityFWHM mosaicity,
                       const LCAxis& lcaxis, int mode, double delta_d, PlaneProvider * plane_provider,
-                      double prec, double ntrunc)
-  : m_pimpl(std::make_unique<pimpl>(this,lcaxis,mode,sco,ci,plane_provider,mosaicity,delta_d,prec,ntrunc))
+                      double prec, double ntrunc, unsigned ncacheentries)
+  : m_pimpl(std::make_unique<pimpl>(this,lcaxis,mode,sco,ci,plane_provider,mosaicity,delta_d,prec,ntrunc,ncacheentries))
 {
   nc_assert_always(bool(m_pimpl->m_lchelper)!=bool(m_pimpl->m_scmodel!=nullptr));
 }
@@ -64,5 +64,5 @@ void NC::MiniMC::detail::propagateDistance( NeutronBasket& nb, Span<const double
                          nb.uy + offset,
                          nb.uz + offset,
                          distances.data(),
-                         nb.size()- + offset );
+                         nb.size() - offset );
 }
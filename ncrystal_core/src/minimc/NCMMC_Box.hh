@@ -0,0 +1,248 @@
+#ifndef NCrystal_MMC_Box_hh
+#define NCrystal_MMC_Box_hh
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/core/NCTypes.hh"
+#include "NCrystal/internal/utils/NCVector.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
+#include "NCrystal/internal/minimc/NCMMC_Basket.hh"
+#include "NCrystal/internal/minimc/NCMMC_Defs.hh"
+#include "NCrystal/internal/minimc/NCMMC_Geom.hh"
+
+namespace NCRYSTAL_NAMESPACE {
+  namespace MiniMC {
+
+    namespace detail {
+      //Distance along a single axis to reach the plane at +h (for positive u)
+      //or -h (for negative u). Infinite if the direction is parallel to the
+      //planes:
+      inline double boxAxisDistToExit( double p, double u, double h ) noexcept
+      {
+        return ( u > 0.0
+                 ? ( h - p ) / u
+                 : ( u < 0.0 ? ( -h - p ) / u : kInfinity ) );
+      }
+
+      //Narrow the [tnear,tfar] interval of path lengths, by the constraint that
+      //the path must be between the planes at -h and +h:
+      inline void boxAxisClipInterval( double p, double u, double h,
+                                       double& tnear, double& tfar ) noexcept
+      {
+        if ( u == 0.0 ) {
+          if ( ncabs( p ) > h ) {
+            //parallel to planes and outside, never hits:
+            tnear = kInfinity;
+            tfar = -kInfinity;
+          }
+          return;
+        }
+        const double t1 = ( -h - p ) / u;
+        const double t2 = ( h - p ) / u;
+        tnear = ncmax( tnear, ncmin( t1, t2 ) );
+        tfar = ncmin( tfar, ncmax( t1, t2 ) );
+      }
+    }
+
+    //Axis-aligned box (centered at (0,0,0) by default). A "slab" geometry is
+    //simply a box with very large extent in the x and y directions.
+    class Box {
+      double m_hx, m_hy, m_hz;//half-widths
+      double m_cx, m_cy, m_cz;//center
+    public:
+      Box( Length dx, Length dy, Length dz,
+           const Vector& center = Vector( 0.0, 0.0, 0.0 ) )
+        : m_hx( 0.5 * dx.dbl() ),
+          m_hy( 0.5 * dy.dbl() ),
+          m_hz( 0.5 * dz.dbl() ),
+          m_cx( center[0] ),
+          m_cy( center[1] ),
+          m_cz( center[2] )
+      {
+        nc_assert_always( m_hx > 0.0 && m_hx < 1e99 );
+        nc_assert_always( m_hy > 0.0 && m_hy < 1e99 );
+        nc_assert_always( m_hz > 0.0 && m_hz < 1e99 );
+      }
+
+      Vector center() const { return { m_cx, m_cy, m_cz }; }
+
+      bool pointIsInside( const Vector& v ) const
+      {
+        return ( ncabs( v[0] - m_cx ) <= m_hx
+                 && ncabs( v[1] - m_cy ) <= m_hy
+                 && ncabs( v[2] - m_cz ) <= m_hz );
+      }
+
+      //See Geometry::boundingBox etc.:
+      BoundingBox boundingBox() const
+      {
+        const Vector h( m_hx, m_hy, m_hz );
+        return { center() - h, center() + h };
+      }
+
+      double maxDistanceFromPoint( const Vector& p ) const
+      {
+        //Distance to the farthest corner:
+        return std::sqrt( ncsquare( ncabs( p[0] - m_cx ) + m_hx )
+                          + ncsquare( ncabs( p[1] - m_cy ) + m_hy )
+                          + ncsquare( ncabs( p[2] - m_cz ) + m_hz ) );
+      }
+
+      double maxDistanceFromYAxisLine( double x, double z ) const
+      {
+        return std::sqrt( ncsquare( ncabs( x - m_cx ) + m_hx )
+                          + ncsquare( ncabs( z - m_cz ) + m_hz ) );
+      }
+
+      bool containsVolume( const Geometry& other ) const
+      {
+        return boundingBox().contains( other.boundingBox() );
+      }
+
+      void distToVolumeEntry( const NeutronBasket& nb,
+                              Span<double> tgt ) const
+      {
+        nc_assert( tgt.size() >= nb.nused);
+        distToVolumeEntryImpl( nb.x, nb.y, nb.z,
+                               nb.ux, nb.uy, nb.uz,
+                               tgt.data(), nb.nused );
+      }
+
+      void distToVolumeExit( const NeutronBasket& nb,
+                             Span<double> tgt ) const
+      {
+        nc_assert( tgt.size() >= nb.nused);
+        distToVolumeExitImpl( nb.x, nb.y, nb.z,
+                              nb.ux, nb.uy, nb.uz,
+                              tgt.data(), nb.nused );
+      }
+
+      static void unit_test()
+      {
+        {
+          const double x[]  = { -30.0, -30.0, 30.0, 0.0,  0.0, 10.0,   -20.0 };
+          const double y[]  = {   0.0,   0.0,  0.0, 0.0,  0.0, 0.0,     0.0 };
+          const double z[]  = {   0.0,   0.0,  0.0, 0.0, 50.0, 0.0,   -20.0 };
+          const double ux[] = {   1.0,   0.0,  1.0, 0.0,  0.0, 1.0, kInvSqrt2 };
+          const double uy[] = {   0.0,  -1.0,  0.0, 1.0,  0.0, 0.0,     0.0 };
+          const double uz[] = {   0.0,   0.0,  0.0, 0.0, -1.0, 0.0, kInvSqrt2 };
+          const double dist_to_entry[] = { 20.0, -1.0, -1.0, 0.0, 30.0, 0.0,
+                                           10.0*kSqrt2 };
+          constexpr std::size_t n = sizeof(x) / sizeof(*x);
+          double buf[n];
+          Box(Length{20.0},Length{30.0},Length{40.0}).distToVolumeEntryImpl( x,y,z,ux,uy,uz,buf,n);
+          for ( std::size_t i = 0; i < n; ++i ) {
+            nc_assert_always(floateq(buf[i],dist_to_entry[i]));
+          }
+          //Same results for a displaced volume and correspondingly displaced
+          //positions:
+          double xs[n], ys[n], zs[n];
+          for ( std::size_t i = 0; i < n; ++i ) {
+            xs[i] = x[i] + 1.0;
+            ys[i] = y[i] - 2.0;
+            zs[i] = z[i] + 3.0;
+          }
+          Box(Length{20.0},Length{30.0},Length{40.0},Vector(1.0,-2.0,3.0)).distToVolumeEntryImpl( xs,ys,zs,ux,uy,uz,buf,n);
+          for ( std::size_t i = 0; i < n; ++i ) {
+            nc_assert_always(floateq(buf[i],dist_to_entry[i]));
+          }
+        }
+        {
+          const double x[]  = { -9.999,  0.0,  5.0, 9.999, 0.0, 0.0,       0.0 };
+          const double y[]  = {   0.0,   0.0,  0.0, 0.0, 0.0, 15.0,       0.0 };
+          const double z[]  = {   0.0,   0.0,  0.0, 0.0, 20.0, 0.0,       0.0 };
+          const double ux[] = {   1.0,   0.0,  1.0, 1.0, 0.0, 0.0, kInvSqrt2 };
+          const double uy[] = {   0.0,  -1.0,  0.0, 0.0, 0.0, 1.0,       0.0 };
+          const double uz[] = {   0.0,   0.0,  0.0, 0.0, 1.0, 0.0, kInvSqrt2 };
+          const double dist_to_exit[] = { 19.999, 15.0, 5.0, 0.001, 0.0, 0.0,
+                                          10.0*kSqrt2 };
+          constexpr std::size_t n = sizeof(x)/sizeof(*x);
+          double buf[n];
+          Box(Length{20.0},Length{30.0},Length{40.0}).distToVolumeExitImpl( x,y,z,ux,uy,uz,buf,n);
+          for ( std::size_t i = 0; i < n; ++i ) {
+            nc_assert_always(floateq(buf[i],dist_to_exit[i]));
+          }
+          //Same results for a displaced volume and correspondingly displaced
+          //positions:
+          double xs[n], ys[n], zs[n];
+          for ( std::size_t i = 0; i < n; ++i ) {
+            xs[i] = x[i] + 1.0;
+            ys[i] = y[i] - 2.0;
+            zs[i] = z[i] + 3.0;
+          }
+          Box(Length{20.0},Length{30.0},Length{40.0},Vector(1.0,-2.0,3.0)).distToVolumeExitImpl( xs,ys,zs,ux,uy,uz,buf,n);
+          for ( std::size_t i = 0; i < n; ++i ) {
+            nc_assert_always(floateq(buf[i],dist_to_exit[i]));
+          }
+        }
+      }
+
+    private:
+      void distToVolumeEntryImpl( const double * ncrestrict x,
+                                  const double * ncrestrict y,
+                                  const double * ncrestrict z,
+                                  const double * ncrestrict ux,
+                                  const double * ncrestrict uy,
+                                  const double * ncrestrict uz,
+                                  double * ncrestrict tgt,
+                                  std::size_t n ) const ncnoexceptndebug
+      {
+        for ( std::size_t i = 0; i < n; ++i ) {
+          const double px = x[i] - m_cx;
+          const double py = y[i] - m_cy;
+          const double pz = z[i] - m_cz;
+          if ( ncabs(px) <= m_hx && ncabs(py) <= m_hy && ncabs(pz) <= m_hz ) {
+            tgt[i] = 0.0;
+            continue;
+          }
+          double tnear = -kInfinity;
+          double tfar = kInfinity;
+          detail::boxAxisClipInterval( px, ux[i], m_hx, tnear, tfar );
+          detail::boxAxisClipInterval( py, uy[i], m_hy, tnear, tfar );
+          detail::boxAxisClipInterval( pz, uz[i], m_hz, tnear, tfar );
+          tgt[i] = ( tnear <= tfar && tnear > 0.0 ) ? tnear : -1.0;
+        }
+      }
+
+      void distToVolumeExitImpl( const double * ncrestrict x,
+                                 const double * ncrestrict y,
+                                 const double * ncrestrict z,
+                                 const double * ncrestrict ux,
+                                 const double * ncrestrict uy,
+                                 const double * ncrestrict uz,
+                                 double * ncrestrict tgt,
+                                 std::size_t n ) const ncnoexceptndebug
+      {
+        //One pass per axis, for efficient loop auto-vectorisation:
+        const double cx( m_cx ), cy( m_cy ), cz( m_cz );
+        for ( std::size_t i = 0; i < n; ++i )
+          tgt[i] = detail::boxAxisDistToExit( x[i] - cx, ux[i], m_hx );
+        for ( std::size_t i = 0; i < n; ++i )
+          tgt[i] = ncmin( tgt[i], detail::boxAxisDistToExit( y[i] - cy, uy[i], m_hy ) );
+        for ( std::size_t i = 0; i < n; ++i )
+          tgt[i] = ncmax( 0.0, ncmin( tgt[i], detail::boxAxisDistToExit( z[i] - cz, uz[i], m_hz ) ) );
+      }
+    };
+
+  }
+}
+
+#endif
@@ -0,0 +1,245 @@
+#ifndef NCrystal_MMC_Cylinder_hh
+#define NCrystal_MMC_Cylinder_hh
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCMMC_Box.hh"
+
+namespace NCRYSTAL_NAMESPACE {
+  namespace MiniMC {
+
+    //Cylinder (centered at (0,0,0) by default), with its axis along the y-axis
+    //(i.e. the usual orientation of a sample can with a beam in the
+    //z-direction). Other orientations are not supported.
+    class Cylinder {
+      double m_radius;
+      double m_radiusSq;
+      double m_hy;//half-height
+      double m_cx, m_cy, m_cz;//center
+    public:
+      Cylinder( Length radius, Length dy,
+                const Vector& center = Vector( 0.0, 0.0, 0.0 ) )
+        : m_radius( radius.dbl() ),
+          m_radiusSq( ncsquare( radius.dbl() ) ),
+          m_hy( 0.5 * dy.dbl() ),
+          m_cx( center[0] ),
+          m_cy( center[1] ),
+          m_cz( center[2] )
+      {
+        nc_assert_always( radius.dbl() > 0.0 );
+        nc_assert_always( m_radiusSq < 1e199 );
+        nc_assert_always( m_radiusSq > 0.0 );
+        nc_assert_always( m_hy > 0.0 && m_hy < 1e99 );
+      }
+
+      Vector center() const { return { m_cx, m_cy, m_cz }; }
+
+      bool pointIsInside( const Vector& v ) const
+      {
+        return ( ncsquare( v[0] - m_cx ) + ncsquare( v[2] - m_cz ) <= m_radiusSq
+                 && ncabs( v[1] - m_cy ) <= m_hy );
+      }
+
+      //See Geometry::boundingBox etc.:
+      BoundingBox boundingBox() const
+      {
+        const Vector h( m_radius, m_hy, m_radius );
+        return { center() - h, center() + h };
+      }
+
+      double maxDistanceFromPoint( const Vector& p ) const
+      {
+        const double rho = std::sqrt( ncsquare( p[0] - m_cx ) + ncsquare( p[2] - m_cz ) );
+        return std::sqrt( ncsquare( rho + m_radius )
+                          + ncsquare( ncabs( p[1] - m_cy ) + m_hy ) );
+      }
+
+      double maxDistanceFromYAxisLine( double x, double z ) const
+      {
+        return std::sqrt( ncsquare( m_cx - x ) + ncsquare( m_cz - z ) ) + m_radius;
+      }
+
+      bool containsVolume( const Geometry& other ) const
+      {
+        const auto bb = other.boundingBox();
+        return ( geomLessOrEqual( m_cy - m_hy, bb.lower[1] )
+                 && geomLessOrEqual( bb.upper[1], m_cy + m_hy )
+                 && geomLessOrEqual( other.maxDistanceFromYAxisLine( m_cx, m_cz ),
+                                     m_radius ) );
+      }
+
+      void distToVolumeEntry( const NeutronBasket& nb,
+                              Span<double> tgt ) const
+      {
+        nc_assert( tgt.size() >= nb.nused);
+        distToVolumeEntryImpl( nb.x, nb.y, nb.z,
+                               nb.ux, nb.uy, nb.uz,
+                               tgt.data(), nb.nused );
+      }
+
+      void distToVolumeExit( const NeutronBasket& nb,
+                             Span<double> tgt ) const
+      {
+        nc_assert( tgt.size() >= nb.nused);
+        distToVolumeExitImpl( nb.x, nb.y, nb.z,
+                              nb.ux, nb.uy, nb.uz,
+                              tgt.data(), nb.nused );
+      }
+
+      static void unit_test()
+      {
+        {
+          const double x[]  = { -30.0, -30.0, 0.0, 0.0,   0.0, 10.0,  -5.0 };
+          const double y[]  = {   0.0,   0.0, 0.0, 50.0, 50.0, 0.0,  -20.0 };
+          const double z[]  = {   0.0,  20.0, 0.0, 0.0,   0.0, 0.0,    0.0 };
+          const double ux[] = {   1.0,   1.0, 0.0, 0.0,   1.0, 1.0,    0.0 };
+          const double uy[] = {   0.0,   0.0, 1.0, -1.0,  0.0, 0.0, kInvSqrt2 };
+          const double uz[] = {   0.0,   0.0, 0.0, 0.0,   0.0, 0.0, kInvSqrt2 };
+          const double dist_to_entry[] = { 20.0, -1.0, 0.0, 35.0, -1.0, 0.0,
+                                           5.0*kSqrt2 };
+          constexpr std::size_t n = sizeof(x) / sizeof(*x);
+          double buf[n];
+          Cylinder(Length{10.0},Length{30.0}).distToVolumeEntryImpl( x,y,z,ux,uy,uz,buf,n);
+          for ( std::size_t i = 0; i < n; ++i ) {
+            nc_assert_always(floateq(buf[i],dist_to_entry[i]));
+          }
+          //Same results for a displaced volume and correspondingly displaced
+          //positions:
+          double xs[n], ys[n], zs[n];
+          for ( std::size_t i = 0; i < n; ++i ) {
+            xs[i] = x[i] + 1.0;
+            ys[i] = y[i] - 2.0;
+            zs[i] = z[i] + 3.0;
+          }
+          Cylinder(Length{10.0},Length{30.0},Vector(1.0,-2.0,3.0)).distToVolumeEntryImpl( xs,ys,zs,ux,uy,uz,buf,n);
+          for ( std::size_t i = 0; i < n; ++i ) {
+            nc_assert_always(floateq(buf[i],dist_to_entry[i]));
+          }
+        }
+        {
+          const double x[]  = { -9.999,  0.0,  5.0, 0.0, 0.0,  0.0,       0.0 };
+          const double y[]  = {   0.0,   0.0,  0.0, 0.0, 15.0, 0.0,       0.0 };
+          const double z[]  = {   0.0,   0.0,  0.0, 0.0, 0.0, 10.0,       0.0 };
+          const double ux[] = {   1.0,   0.0, -1.0, 0.0, 0.0,  0.0, kInvSqrt2 };
+          const double uy[] = {   0.0,  -1.0,  0.0, 0.0, 1.0,  0.0, kInvSqrt2 };
+          const double uz[] = {   0.0,   0.0,  0.0, 1.0, 0.0,  1.0,       0.0 };
+          const double dist_to_exit[] = { 19.999, 15.0, 15.0, 10.0, 0.0, 0.0,
+                                          10.0*kSqrt2 };
+          constexpr std::size_t n = sizeof(x)/sizeof(*x);
+          double buf[n];
+          Cylinder(Length{10.0},Length{30.0}).distToVolumeExitImpl( x,y,z,ux,uy,uz,buf,n);
+          for ( std::size_t i = 0; i < n; ++i ) {
+            nc_assert_always(floateq(buf[i],dist_to_exit[i]));
+          }
+          //Same results for a displaced volume and correspondingly displaced
+          //positions:
+          double xs[n], ys[n], zs[n];
+          for ( std::size_t i = 0; i < n; ++i ) {
+            xs[i] = x[i] + 1.0;
+            ys[i] = y[i] - 2.0;
+            zs[i] = z[i] + 3.0;
+          }
+          Cylinder(Length{10.0},Length{30.0},Vector(1.0,-2.0,3.0)).distToVolumeExitImpl( xs,ys,zs,ux,uy,uz,buf,n);
+          for ( std::size_t i = 0; i < n; ++i ) {
+            nc_assert_always(floateq(buf[i],dist_to_exit[i]));
+          }
+        }
+      }
+
+    private:
+      void distToVolumeEntryImpl( const double * ncrestrict x,
+                                  const double * ncrestrict y,
+                                  const double * ncrestrict z,
+                                  const double * ncrestrict ux,
+                                  const double * ncrestrict uy,
+                                  const double * ncrestrict uz,
+                                  double * ncrestrict tgt,
+                                  std::size_t n ) const ncnoexceptndebug
+      {
+        for ( std::size_t i = 0; i < n; ++i ) {
+          const double px = x[i] - m_cx;
+          const double py = y[i] - m_cy;
+          const double pz = z[i] - m_cz;
+          const double c = ncsquare(px) + ncsquare(pz) - m_radiusSq;
+          if ( c <= 0.0 && ncabs(py) <= m_hy ) {
+            tgt[i] = 0.0;
+            continue;
+          }
+          double tnear = -kInfinity;
+          double tfar = kInfinity;
+          //Curved surface:
+          const double a = ncsquare(ux[i]) + ncsquare(uz[i]);
+          if ( a == 0.0 ) {
+            if ( c > 0.0 ) {
+              tgt[i] = -1.0;//parallel to axis and outside
+              continue;
+            }
+          } else {
+            const double b = px * ux[i] + pz * uz[i];
+            const double D = ncsquare( b ) - a * c;
+            if ( D < 0.0 ) {
+              tgt[i] = -1.0;
+              continue;
+            }
+            const double sqrtD = std::sqrt( D );
+            tnear = ( -b - sqrtD ) / a;
+            tfar = ( -b + sqrtD ) / a;
+          }
+          //End caps:
+          detail::boxAxisClipInterval( py, uy[i], m_hy, tnear, tfar );
+          tgt[i] = ( tnear <= tfar && tnear > 0.0 ) ? tnear : -1.0;
+        }
+      }
+
+      void distToVolumeExitImpl( const double * ncrestrict x,
+                                 const double * ncrestrict y,
+                                 const double * ncrestrict z,
+                                 const double * ncrestrict ux,
+                                 const double * ncrestrict uy,
+                                 const double * ncrestrict uz,
+                                 double * ncrestrict tgt,
+                                 std::size_t n ) const ncnoexceptndebug
+      {
+        //Curved surface. We are inside, so c = x^2+z^2-r^2 <= 0 and the
+        //discriminant b^2-a*c is non-negative (apart from FP instabilities at
+        //the edge). Using the numerically stable form of the positive root:
+        const double cx( m_cx ), cy( m_cy ), cz( m_cz );
+        for ( std::size_t i = 0; i < n; ++i ) {
+          const double px = x[i] - cx;
+          const double pz = z[i] - cz;
+          const double a = ncsquare(ux[i]) + ncsquare(uz[i]);
+          const double b = px * ux[i] + pz * uz[i];
+          const double c = ncsquare(px) + ncsquare(pz) - m_radiusSq;
+          const double sqrtD = std::sqrt( ncmax( 0.0, ncsquare( b ) - a * c ) );
+          tgt[i] = ( a == 0.0
+                     ? kInfinity
+                     : ( b > 0.0 ? -c / ( b + sqrtD ) : ( sqrtD - b ) / a ) );
+        }
+        //End caps:
+        for ( std::size_t i = 0; i < n; ++i )
+          tgt[i] = ncmax( 0.0, ncmin( tgt[i], detail::boxAxisDistToExit( y[i] - cy, uy[i], m_hy ) ) );
+      }
+    };
+
+  }
+}
+
+#endif
@@ -20,6 +20,8 @@
 
 #include "NCrystal/internal/minimc/NCMMC_Geom.hh"
 #include "NCMMC_Sphere.hh"
+#include "NCMMC_Box.hh"
+#include "NCMMC_Cylinder.hh"
 #include "NCMMC_ParseCfg.hh"
 
 namespace NC = NCrystal;
@@ -57,9 +59,170 @@ namespace NCRYSTAL_NAMESPACE {
           return m_vol.pointIsInside(v);
         }
 
+        BoundingBox boundingBox() const override
+        {
+          return m_vol.boundingBox();
+        }
+
+        double maxDistanceFromPoint( const Vector& p ) const override
+        {
+          return m_vol.maxDistanceFromPoint(p);
+        }
+
+        double maxDistanceFromYAxisLine( double x, double z ) const override
+        {
+          return m_vol.maxDistanceFromYAxisLine(x,z);
+        }
+
+        bool containsVolume( const Geometry& o ) const override
+        {
+          return m_vol.containsVolume(o);
+        }
+
       };
 
-      GeometryPtr createGeometryImpl( const char * raw_geomstr )
+      class LayeredGeometry final : public Geometry {
+        std::vector<GeometryPtr> m_layers;//daughters before mothers, outermost last
+        std::vector<unsigned> m_mother;//index of volume containing each layer
+        std::vector<std::vector<unsigned>> m_daughters;//volumes placed in each layer
+      public:
+
+        LayeredGeometry( std::vector<GeometryPtr> layers )
+          : m_layers( std::move(layers) )
+        {
+          if ( m_layers.empty() )
+            NCRYSTAL_THROW(BadInput,"Layered geometry must have at least one layer");
+          if ( m_layers.size() > 255 )
+            NCRYSTAL_THROW(BadInput,"Too many layers in layered geometry");
+          for ( auto& l : m_layers )
+            if ( l->nLayers() != 1 )
+              NCRYSTAL_THROW(BadInput,"Layered geometries can not be nested");
+          const unsigned nl = nLayers();
+          m_mother.resize( nl, nl );
+          m_daughters.resize( nl );
+          //Each volume is placed in the first volume after it which contains it:
+          for ( unsigned il = 0; il + 1 < nl; ++il ) {
+            for ( unsigned im = il + 1; im < nl; ++im ) {
+              if ( m_layers[im]->containsVolume( *m_layers[il] ) ) {
+                m_mother[il] = im;
+                m_daughters[im].push_back( il );
+                break;
+              }
+            }
+            if ( m_mother[il] == nl )
+              NCRYSTAL_THROW2(BadInput,"Invalid layered geometry: volume #"<<il
+                              <<" (counting from 0) is not completely contained"
+                              " inside any of the volumes listed after it"
+                              " (partially overlapping volumes are not"
+                              " supported)");
+          }
+          //Volumes placed in the same volume must not overlap each other:
+          for ( unsigned im = 0; im < nl; ++im ) {
+            const auto& dl = m_daughters[im];
+            for ( std::size_t i = 0; i < dl.size(); ++i ) {
+              for ( std::size_t j = i + 1; j < dl.size(); ++j ) {
+                if ( m_layers[dl[i]]->boundingBox().overlaps( m_layers[dl[j]]->boundingBox() ) )
+                  NCRYSTAL_THROW2(BadInput,"Invalid layered geometry: volumes #"
+                                  <<dl[i]<<" and #"<<dl[j]<<" (counting from 0)"
+                                  " are both placed inside volume #"<<im<<", but"
+                                  " their bounding boxes overlap (volumes must"
+                                  " be listed before the volume they are placed"
+                                  " inside, and side-by-side volumes must not"
+                                  " overlap)");
+              }
+            }
+          }
+        }
+
+        void distToVolumeEntry( const NeutronBasket& nb,
+                                Span<double> tgt ) const override
+        {
+          m_layers.back()->distToVolumeEntry(nb,tgt);
+        }
+
+        void distToVolumeExit( const NeutronBasket& nb,
+                               Span<double> tgt ) const override
+        {
+          m_layers.back()->distToVolumeExit(nb,tgt);
+        }
+
+        bool pointIsInside( const Vector& v ) const override
+        {
+          return m_layers.back()->pointIsInside(v);
+        }
+
+        BoundingBox boundingBox() const override
+        {
+          return m_layers.back()->boundingBox();
+        }
+
+        double maxDistanceFromPoint( const Vector& p ) const override
+        {
+          return m_layers.back()->maxDistanceFromPoint(p);
+        }
+
+        double maxDistanceFromYAxisLine( double x, double z ) const override
+        {
+          return m_layers.back()->maxDistanceFromYAxisLine(x,z);
+        }
+
+        bool containsVolume( const Geometry& o ) const override
+        {
+          return m_layers.back()->containsVolume(o);
+        }
+
+        unsigned nLayers() const override
+        {
+          return static_cast<unsigned>( m_layers.size() );
+        }
+
+        void locateLayers( const NeutronBasket& nb,
+                           Span<unsigned> tgt ) const override
+        {
+          nc_assert( tgt.size() >= nb.nused );
+          const std::size_t n = nb.nused;
+          const unsigned nl = nLayers();
+          std::fill_n( tgt.data(), n, nl - 1 );
+          //Daughters are always listed before their mothers, and daughters of
+          //the same mother do not overlap. Thus, checking volumes in reverse
+          //order assigns each neutron to the innermost volume containing it:
+          double buf[NeutronBasket::N];
+          for ( unsigned il = nl - 1; il-- > 0; ) {
+            m_layers[il]->distToVolumeEntry( nb, buf );
+            for ( std::size_t i = 0; i < n; ++i )
+              if ( buf[i] == 0.0 )
+                tgt[i] = il;
+          }
+        }
+
+        void distToLayerExit( unsigned ilayer,
+                              const NeutronBasket& nb,
+                              Span<double> tgt_dist,
+                              Span<unsigned> tgt_nextlayer ) const override
+        {
+          nc_assert( ilayer < m_layers.size() );
+          nc_assert( tgt_dist.size() >= nb.nused );
+          nc_assert( tgt_nextlayer.size() >= nb.nused );
+          const std::size_t n = nb.nused;
+          //Distance out through the outer boundary of the layer:
+          m_layers[ilayer]->distToVolumeExit( nb, tgt_dist );
+          std::fill_n( tgt_nextlayer.data(), n, m_mother[ilayer] );
+          //Distance into any of the daughter volumes, if closer:
+          double buf[NeutronBasket::N];
+          for ( unsigned id : m_daughters[ilayer] ) {
+            m_layers[id]->distToVolumeEntry( nb, buf );
+            for ( std::size_t i = 0; i < n; ++i ) {
+              if ( buf[i] >= 0.0 && buf[i] < tgt_dist[i] ) {
+                tgt_dist[i] = buf[i];
+                tgt_nextlayer[i] = id;
+              }
+            }
+          }
+        }
+
+      };
+
+      GeometryPtr createSingleGeometry( StrView raw_geomstr )
       {
         namespace PMC = parseMMCCfg;
 
@@ -68,20 +231,93 @@ namespace NCRYSTAL_NAMESPACE {
         if ( !geom_name.has_value() )
           NCRYSTAL_THROW2(BadInput,"Invalid geom cfg: \""<<raw_geomstr<<"\"");
 
+        //Position of the volume center:
+        PMC::applyDefaults( tokens, "x=0;y=0;z=0" );
+        const Vector center( PMC::getValue_dbl(tokens,"x"),
+                             PMC::getValue_dbl(tokens,"y"),
+                             PMC::getValue_dbl(tokens,"z") );
+        if ( !( ncmax( ncabs( center[0] ),
+                       ncmax( ncabs( center[1] ), ncabs( center[2] ) ) ) < 1e9 ) )
+          NCRYSTAL_THROW2(BadInput,"Invalid position in geom cfg: \""<<raw_geomstr<<"\"");
+
         if ( geom_name == "sphere" ) {
           PMC::applyDefaults( tokens, "r=0.01" );//0.01m = 1cm
-          PMC::checkNoUnknown(tokens,"r","geometry");
+          PMC::checkNoUnknown(tokens,"r;x;y;z","geometry");
           static const int dummy = [](){ Sphere::unit_test(); return 1; }();
           (void)dummy;
-          return makeSO<GeometryImpl<Sphere>>( Length{ PMC::getValue_dbl(tokens,"r") } );
+          return makeSO<GeometryImpl<Sphere>>( Length{ PMC::getValue_dbl(tokens,"r") },
+                                               center );
+        } else if ( geom_name == "box" || geom_name == "slab" ) {
+          //A slab is simply a box with a default extent of 1km in the x and y
+          //directions:
+          PMC::applyDefaults( tokens, ( geom_name == "box"
+                                        ? "dx=0.02;dy=0.02;dz=0.02"
+                                        : "dx=1e3;dy=1e3;dz=0.01" ) );
+          PMC::checkNoUnknown(tokens,"dx;dy;dz;x;y;z","geometry");
+          static const int dummy = [](){ Box::unit_test(); return 1; }();
+          (void)dummy;
+          const double dx = PMC::getValue_dbl(tokens,"dx");
+          const double dy = PMC::getValue_dbl(tokens,"dy");
+          const double dz = PMC::getValue_dbl(tokens,"dz");
+          if ( !( dx > 0.0 && dy > 0.0 && dz > 0.0 ) || ncmax(dx,ncmax(dy,dz)) > 1e9 )
+            NCRYSTAL_THROW2(BadInput,"Invalid box dimensions in geom cfg: \""<<raw_geomstr<<"\"");
+          return makeSO<GeometryImpl<Box>>( Length{ dx }, Length{ dy }, Length{ dz }, center );
+        } else if ( geom_name == "cylinder" ) {
+          PMC::applyDefaults( tokens, "r=0.01;dy=0.05" );
+          PMC::checkNoUnknown(tokens,"r;dy;x;y;z","geometry");
+          static const int dummy = [](){ Cylinder::unit_test(); return 1; }();
+          (void)dummy;
+          const double r = PMC::getValue_dbl(tokens,"r");
+          const double dy = PMC::getValue_dbl(tokens,"dy");
+          if ( !( r > 0.0 && dy > 0.0 ) || ncmax(r,dy) > 1e9 )
+            NCRYSTAL_THROW2(BadInput,"Invalid cylinder dimensions in geom cfg: \""<<raw_geomstr<<"\"");
+          return makeSO<GeometryImpl<Cylinder>>( Length{ r }, Length{ dy }, center );
         } else {
           NCRYSTAL_THROW2(BadInput,"Unknown geometry type requested: \""<<geom_name<<"\"");
         }
       }
+
+      GeometryPtr createGeometryImpl( const char * raw_geomstr )
+      {
+        auto parts = StrView(raw_geomstr).splitTrimmedNoEmpty('|');
+        if ( parts.size() <= 1 )
+          return createSingleGeometry( raw_geomstr );
+        std::vector<GeometryPtr> layers;
+        layers.reserve( parts.size() );
+        for ( auto& p : parts )
+          layers.push_back( createSingleGeometry( p ) );
+        return createLayeredGeometry( std::move(layers) );
+      }
     }
   }
 }
 
+void NCMMC::Geometry::locateLayers( const NeutronBasket& nb,
+                                    Span<unsigned> tgt ) const
+{
+  nc_assert( tgt.size() >= nb.nused );
+  std::fill_n( tgt.data(), nb.nused, 0u );
+}
+
+void NCMMC::Geometry::distToLayerExit( unsigned ilayer,
+                                       const NeutronBasket& nb,
+                                       Span<double> tgt_dist,
+                                       Span<unsigned> tgt_nextlayer ) const
+{
+  nc_assert( ilayer == 0 );
+  nc_assert( tgt_nextlayer.size() >= nb.nused );
+  (void)ilayer;
+  distToVolumeExit( nb, tgt_dist );
+  std::fill_n( tgt_nextlayer.data(), nb.nused, 1u );
+}
+
+NCMMC::GeometryPtr NCMMC::createLayeredGeometry( std::vector<GeometryPtr> layers )
+{
+  if ( layers.size() == 1 )
+    return std::move( layers.front() );
+  return makeSO<LayeredGeometry>( std::move(layers) );
+}
+
 NCMMC::GeometryPtr NCMMC::createGeometry( const char * raw_geomstr )
 {
   return createGeometryImpl( raw_geomstr );
@@ -22,6 +22,7 @@
 #include "NCrystal/internal/minimc/NCMMC_StdEngine.hh"
 #include "NCrystal/internal/minimc/NCMMC_SimMgrMT.hh"
 #include "NCrystal/factories/NCFactImpl.hh"
+#include "NCrystal/internal/utils/NCStrView.hh"
 
 namespace NC = NCrystal;
 namespace NCMMC = NCrystal::MiniMC;
@@ -33,8 +34,31 @@ void NCMMC::runSim_StdEngine( ThreadCount nthreads,
                               MatDef matdef,
                               StdEngineOptions engine_options )
 {
+  std::vector<MatDef> matdefs;
+  matdefs.push_back( std::move( matdef ) );
+  runSim_StdEngine( nthreads, std::move( geom ), std::move( src ),
+                    std::move( tally ), std::move( matdefs ),
+                    std::move( engine_options ) );
+}
+
+void NCMMC::runSim_StdEngine( ThreadCount nthreads,
+                              GeometryPtr geom,
+                              SourcePtr src,
+                              TallyPtr tally,
+                              std::vector<MatDef> matdefs,
+                              StdEngineOptions engine_options )
+{
+  const std::size_t nlayers = geom->nLayers();
+  if ( matdefs.size() == 1 && nlayers > 1 ) {
+    while ( matdefs.size() < nlayers )
+      matdefs.push_back( matdefs.front() );
+  }
+  if ( matdefs.size() != nlayers )
+    NCRYSTAL_THROW2(BadInput,"Number of materials ("<<matdefs.size()
+                    <<") does not match the number of layers in the"
+                    " geometry ("<<nlayers<<")");
   using SimClass = NCMMC::StdEngine;
-  auto sim_engine = NC::makeSO<SimClass>( std::move( matdef ),
+  auto sim_engine = NC::makeSO<SimClass>( std::move( matdefs ),
                                           std::move( engine_options ) );
   auto tallymgr = makeSO<TallyMgr>( tally->clone() );
   NCMMC::SimMgrMT<SimClass> mgr(geom,src,sim_engine,tallymgr);
@@ -72,3 +96,19 @@ NCMMC::MatDef::MatDef( const MatCfg& cfg )
   : MatDef( cfg2MatDef( cfg ) )
 {
 }
+
+std::vector<NCMMC::MatDef> NCMMC::createMatDefs( const char * raw_cfgstrs )
+{
+  std::vector<MatDef> res;
+  for ( auto& e : StrView( raw_cfgstrs ).splitTrimmedNoEmpty('|') ) {
+    if ( e == "vacuum" )
+      res.emplace_back( ProcImpl::getGlobalNullScatter(),
+                        ProcImpl::getGlobalNullAbsorption(),
+                        NumberDensity{ 0.0 } );
+    else
+      res.emplace_back( MatCfg( e.to_string() ) );
+  }
+  if ( res.empty() )
+    NCRYSTAL_THROW2(BadInput,"No materials specified: \""<<raw_cfgstrs<<"\"");
+  return res;
+}
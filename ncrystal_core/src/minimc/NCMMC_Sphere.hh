@@ -26,6 +26,7 @@
 #include "NCrystal/internal/utils/NCMath.hh"
 #include "NCrystal/internal/minimc/NCMMC_Basket.hh"
 #include "NCrystal/internal/minimc/NCMMC_Defs.hh"
+#include "NCrystal/internal/minimc/NCMMC_Geom.hh"
 
 namespace NCRYSTAL_NAMESPACE {
   namespace {
@@ -45,23 +46,50 @@ namespace NCRYSTAL_NAMESPACE {
 
   namespace MiniMC {
 
-    constexpr double geom_tolerance_factor = 1e-12;
-
     class Sphere {
-      //double m_radius;
+      double m_radius;
       double m_radiusSq;
+      double m_cx, m_cy, m_cz;//center
     public:
-      Sphere( Length radius )
-        : m_radiusSq( ncsquare( radius.dbl() ) )
+      Sphere( Length radius, const Vector& center = Vector( 0.0, 0.0, 0.0 ) )
+        : m_radius( radius.dbl() ),
+          m_radiusSq( ncsquare( radius.dbl() ) ),
+          m_cx( center[0] ),
+          m_cy( center[1] ),
+          m_cz( center[2] )
       {
         nc_assert_always( radius.dbl() > 0.0 );
         nc_assert_always( m_radiusSq < 1e199 );
         nc_assert_always( m_radiusSq > 0.0 );
       }
 
+      Vector center() const { return { m_cx, m_cy, m_cz }; }
+
       bool pointIsInside( const Vector& v ) const
       {
-        return v.mag2() <= m_radiusSq;
+        return ( v - center() ).mag2() <= m_radiusSq;
+      }
+
+      //See Geometry::boundingBox etc.:
+      BoundingBox boundingBox() const
+      {
+        const Vector r( m_radius, m_radius, m_radius );
+        return { center() - r, center() + r };
+      }
+
+      double maxDistanceFromPoint( const Vector& p ) const
+      {
+        return ( p - center() ).mag() + m_radius;
+      }
+
+      double maxDistanceFromYAxisLine( double x, double z ) const
+      {
+        return std::sqrt( ncsquare( m_cx - x ) + ncsquare( m_cz - z ) ) + m_radius;
+      }
+
+      bool containsVolume( const Geometry& other ) const
+      {
+        return geomLessOrEqual( other.maxDistanceFromPoint( center() ), m_radius );
       }
 
       void distToVolumeEntry( const NeutronBasket& nb,
@@ -98,6 +126,18 @@ namespace NCRYSTAL_NAMESPACE {
           for ( std::size_t i = 0; i < n; ++i ) {
             nc_assert_always(floateq(buf[i],dist_to_entry[i]));
           }
+          //Same results for a displaced volume and correspondingly displaced
+          //positions:
+          double xs[n], ys[n], zs[n];
+          for ( std::size_t i = 0; i < n; ++i ) {
+            xs[i] = x[i] + 1.0;
+            ys[i] = y[i] - 2.0;
+            zs[i] = z[i] + 3.0;
+          }
+          Sphere(Length{10.0},Vector(1.0,-2.0,3.0)).distToVolumeEntryImpl( xs,ys,zs,ux,uy,uz,buf,n);
+          for ( std::size_t i = 0; i < n; ++i ) {
+            nc_assert_always(floateq(buf[i],dist_to_entry[i]));
+          }
         }
         {
           const double x[]  = { -9.999,  0.0,  5.0, 9.999, 0.0, -10.0, -10.0, -10.0, -10.0 };
@@ -113,6 +153,18 @@ namespace NCRYSTAL_NAMESPACE {
           for ( std::size_t i = 0; i < n; ++i ) {
             nc_assert_always(floateq(buf[i],dist_to_exit[i]));
           }
+          //Same results for a displaced volume and correspondingly displaced
+          //positions:
+          double xs[n], ys[n], zs[n];
+          for ( std::size_t i = 0; i < n; ++i ) {
+            xs[i] = x[i] + 1.0;
+            ys[i] = y[i] - 2.0;
+            zs[i] = z[i] + 3.0;
+          }
+          Sphere(Length{10.0},Vector(1.0,-2.0,3.0)).distToVolumeExitImpl( xs,ys,zs,ux,uy,uz,buf,n);
+          for ( std::size_t i = 0; i < n; ++i ) {
+            nc_assert_always(floateq(buf[i],dist_to_exit[i]));
+          }
         }
       }
 
@@ -136,11 +188,14 @@ namespace NCRYSTAL_NAMESPACE {
         }
 #endif
         for ( std::size_t i = 0; i < n; ++i ) {
-          const double psq_mr2 = ncsquare(x[i])+ncsquare(y[i])+ncsquare(z[i]) - m_radiusSq;
+          const double px = x[i] - m_cx;
+          const double py = y[i] - m_cy;
+          const double pz = z[i] - m_cz;
+          const double psq_mr2 = ncsquare(px)+ncsquare(py)+ncsquare(pz) - m_radiusSq;
           if ( psq_mr2 <= 0.0 ) {
             tgt[i] = 0.0;
           } else {
-            const double pd = (x[i]) * (ux[i]) + (y[i]) * (uy[i]) +(z[i]) * (uz[i]);
+            const double pd = px * ux[i] + py * uy[i] + pz * uz[i];
             const double D = ncsquare( pd ) - psq_mr2;
             if ( D < 0 ) {
               tgt[i] = -1.0;
@@ -173,12 +228,13 @@ namespace NCRYSTAL_NAMESPACE {
 #endif
         //Split into a pre-loop, using tgt as temporary cache area, for
         //efficient loop auto-vectorisation:
+        const double cx( m_cx ), cy( m_cy ), cz( m_cz );
         for ( std::size_t i = 0; i < n; ++i )
-          tgt[i] = m_radiusSq - (x[i]*x[i]+y[i]*y[i]+z[i]*z[i]);//-psq_mr2 = r^2-p^2, since inside tgt[i]>=0
+          tgt[i] = m_radiusSq - ( ncsquare(x[i]-cx) + ncsquare(y[i]-cy) + ncsquare(z[i]-cz) );//-psq_mr2 = r^2-p^2, since inside tgt[i]>=0
 
         double buf_pd[NeutronBasket::N];
         for ( std::size_t i = 0; i < n; ++i )
-          buf_pd[i] = x[i]*ux[i]+y[i]*uy[i]+z[i]*uz[i];
+          buf_pd[i] = (x[i]-cx)*ux[i]+(y[i]-cy)*uy[i]+(z[i]-cz)*uz[i];
 
         //discriminant (should be non-negative since we can't miss the sphere from inside it.
         for ( std::size_t i = 0; i < n; ++i )
@@ -26,10 +26,29 @@
 namespace NC = NCrystal;
 namespace NCMMC = NCrystal::MiniMC;
 
+namespace NCRYSTAL_NAMESPACE {
+  namespace MiniMC {
+    namespace {
+      //Distance by which neutrons are moved past the boundary between two
+      //layers when entering a new layer (1nm), to ensure that they are
+      //unambiguously inside the new layer:
+      constexpr double layer_crossing_step = 1e-9;
+    }
+  }
+}
+
 NCMMC::StdEngine::StdEngine( matdef_t md, StdEngineOptions opts )
+  : StdEngine( std::vector<matdef_t>{ std::move(md) }, std::move(opts) )
+{
+}
+
+NCMMC::StdEngine::StdEngine( std::vector<matdef_t> mds, StdEngineOptions opts )
   : m_opt( std::move(opts) ),
-    m_mat( std::move(md) )
+    m_mats( std::move(mds) )
 {
+  if ( m_mats.empty() )
+    NCRYSTAL_THROW(BadInput,"StdEngine requires at least one material");
+
   if ( ! ( m_opt.roulette_survival_probability > 1e-20 ) )
     NCRYSTAL_THROW(BadInput,"roulette_survival_probability must be >1e-20");
 
@@ -41,6 +60,9 @@ NCMMC::StdEngine::StdEngine( matdef_t md, StdEngineOptions opts )
 
   //derived values:
   m_opt_roulette_survivor_boost = 1.0 / m_opt.roulette_survival_probability;
+
+  m_sct_cacheptrs.resize( m_mats.size() );
+  m_abs_cacheptrs.resize( m_mats.size() );
 }
 
 void NCMMC::StdEngine::advanceSimulation( RNG& rng,
@@ -53,30 +75,86 @@ void NCMMC::StdEngine::advanceSimulation( RNG& rng,
 
   nc_assert( inbasket_holder.valid() );
   nc_assert( !inbasket_holder.basket().empty() );
+  const unsigned nlayers = geom.nLayers();
+  nc_assert_always( nlayers == m_mats.size() );
+  if ( nlayers == 1 ) {
+    advanceInLayer( rng, geom, 0, std::move(inbasket_holder), mgr, resultFct );
+    return;
+  }
+
+  //Neutrons fresh from the source do not yet know which layer they are in:
+  auto& inb = inbasket_holder.basket();
+  const std::size_t n = inb.size();
+  const int * layers = inb.cache.layer;
+  if ( std::any_of( layers, layers + n, [](int l){ return l < 0; } ) ) {
+    geom.locateLayers( inb.neutrons, m_buf_nextlayer );
+    for ( auto i : ncrange( n ) )
+      if ( inb.cache.layer[i] < 0 )
+        inb.cache.layer[i] = static_cast<int>( m_buf_nextlayer[i] );
+  }
+
+  //Each layer has its own material, so unless all neutrons are in the same
+  //layer, we must split up the basket:
+  const int layer0 = layers[0];
+  if ( std::all_of( layers, layers + n, [layer0](int l){ return l == layer0; } ) ) {
+    advanceInLayer( rng, geom, static_cast<unsigned>( layer0 ),
+                    std::move(inbasket_holder), mgr, resultFct );
+    return;
+  }
+  for ( unsigned il = 0; il < nlayers; ++il ) {
+    basket_holder_t sub{ no_init };
+    for ( auto i : ncrange( n ) ) {
+      if ( layers[i] == static_cast<int>( il ) ) {
+        if ( !sub.valid() )
+          sub = allocateBasket( mgr );
+        sub.basket().appendEntryFromOther( inb, i );
+      }
+    }
+    if ( sub.valid() )
+      advanceInLayer( rng, geom, il, std::move(sub), mgr, resultFct );
+  }
+  deallocateBasket( mgr, std::move(inbasket_holder) );
+}
+
+void NCMMC::StdEngine::advanceInLayer( RNG& rng,
+                                      const Geometry& geom,
+                                      unsigned ilayer,
+                                      basket_holder_t&& inbasket_holder,
+                                      basketmgr_t& mgr,
+                                      const resultfct_t& resultFct )
+{
+  nc_assert( inbasket_holder.valid() );
+  nc_assert( !inbasket_holder.basket().empty() );
+  nc_assert( ilayer < m_mats.size() );
   auto& inbasket = inbasket_holder.basket();//Not const, since we will update
                                             //xsects in-place.
-  const bool has_scat = !m_mat.scatter->isNull();
-  const bool has_abs = !m_mat.absorption->isNull();
-  const bool scatter_is_isotropic = !m_mat.scatter->isOriented();
-  const bool absorption_is_isotropic = !m_mat.absorption->isOriented();
+  const matdef_t& mat = m_mats[ilayer];
+  CachePtr& sct_cacheptr = m_sct_cacheptrs[ilayer];
+  CachePtr& abs_cacheptr = m_abs_cacheptrs[ilayer];
+  const unsigned nlayers = static_cast<unsigned>( m_mats.size() );
+  const bool has_scat = !mat.scatter->isNull();
+  const bool has_abs = !mat.absorption->isNull();
+  const bool scatter_is_isotropic = !mat.scatter->isOriented();
+  const bool absorption_is_isotropic = !mat.absorption->isOriented();
 
 
-  //Get distances out for all the particles:
-  geom.distToVolumeExit( inbasket.neutrons, m_buf_disttoexit );
+  //Get distances out of the layer for all the particles:
+  geom.distToLayerExit( ilayer, inbasket.neutrons,
+                        m_buf_disttoexit, m_buf_nextlayer );
 
   //Get absorption cross sections:
   const double * values_abs_xs_or_nullptr = nullptr;
   if ( has_abs ) {
     if ( absorption_is_isotropic ) {
-      ProcImpl::NewABI::evalManyXSIsotropic( m_mat.absorption,
-                                             m_abs_cacheptr,
+      ProcImpl::NewABI::evalManyXSIsotropic( mat.absorption,
+                                             abs_cacheptr,
                                              inbasket.neutrons.ekin,
                                              inbasket.size(),
                                              m_buf_xs_abs );
     } else {
       for ( auto i : ncrange( inbasket.size() ) ) {
         m_buf_xs_abs[i]
-          = m_mat.absorption->crossSection( m_abs_cacheptr,
+          = mat.absorption->crossSection( abs_cacheptr,
                                             inbasket.neutrons.ekin_obj(i),
                                             inbasket.neutrons.dir_obj(i) ).dbl();
       }
@@ -87,12 +165,11 @@ void NCMMC::StdEngine::advanceSimulation( RNG& rng,
   if (!has_scat) {
     //Special case of no scattering, just transmit (in-place) and return:
     MiniMC::Utils::propagateAndAttenuate( inbasket_holder.basket().neutrons,
-                                          m_mat.numDens,
+                                          mat.numDens,
                                           m_buf_disttoexit,
                                           values_abs_xs_or_nullptr );
 
-    resultFct( inbasket_holder.basket() );
-    deallocateBasket( mgr, std::move(inbasket_holder) );
+    handleTransmitted( nlayers, std::move(inbasket_holder), mgr, resultFct );
     return;
   }
 
@@ -101,21 +178,21 @@ void NCMMC::StdEngine::advanceSimulation( RNG& rng,
     for ( auto i : ncrange( inbasket.size() ) ) {
       if ( inbasket.cache.scatxsval[i] < 0.0 )
         inbasket.cache.scatxsval[i]
-          = m_mat.scatter->crossSectionIsotropic( m_sct_cacheptr,
+          = mat.scatter->crossSectionIsotropic( sct_cacheptr,
                                                   inbasket.neutrons.ekin_obj(i) ).dbl();
     }
   } else {
     //not isotropic, always recalculate all xs values:
     for ( auto i : ncrange( inbasket.size() ) ) {
       inbasket.cache.scatxsval[i]
-        = m_mat.scatter->crossSection( m_sct_cacheptr,
+        = mat.scatter->crossSection( sct_cacheptr,
                                        inbasket.neutrons.ekin_obj(i),
                                        inbasket.neutrons.dir_obj(i) ).dbl();
     }
   }
 
   //Transmission probability:
-  MiniMC::Utils::calcProbTransm( m_mat.numDens,
+  MiniMC::Utils::calcProbTransm( mat.numDens,
                                  inbasket.size(),
                                  inbasket.cache.scatxsval,
                                  m_buf_disttoexit,
@@ -123,7 +200,7 @@ void NCMMC::StdEngine::advanceSimulation( RNG& rng,
 
   //Pick scattering points:
   MiniMC::Utils::sampleRandDists(rng,
-                                 m_mat.numDens,
+                                 mat.numDens,
                                  m_buf_disttoexit,
                                  inbasket.cache.scatxsval,
                                  inbasket.size(),
@@ -158,7 +235,7 @@ void NCMMC::StdEngine::advanceSimulation( RNG& rng,
       }
 
       //Process this particle further, i.e. copy it to the pending
-      //basket and update the weight (and then scatter it below):
+      //basket and update the weight (it will be scattered below):
       nc_assert( outb.size() < basket_N );
       std::size_t j = outb.appendEntryFromOther( inbasket, i );
       outb.neutrons.w[j] *= roulette_weight_factor;
@@ -171,21 +248,34 @@ void NCMMC::StdEngine::advanceSimulation( RNG& rng,
         outb.neutrons.z[j] += disttoscat * outb.neutrons.uz[j];
         if ( values_abs_xs_or_nullptr ) {
           const double xsval_abs = values_abs_xs_or_nullptr[i];
-          outb.neutrons.w[j] *= std::exp( -macroXS( m_mat.numDens, CrossSect{ xsval_abs } ) * disttoscat );
+          outb.neutrons.w[j] *= std::exp( -macroXS( mat.numDens, CrossSect{ xsval_abs } ) * disttoscat );
         }
       }
 
-      //Scatter:
-      nc_assert( has_scat );
-      auto outcome = m_mat.scatter->sampleScatter( m_sct_cacheptr,
-                                                   rng,
-                                                   outb.neutrons.ekin_obj(j),
-                                                   outb.neutrons.dir_obj(j));
-      outb.neutrons.ux[j] = outcome.direction[0];
-      outb.neutrons.uy[j] = outcome.direction[1];
-      outb.neutrons.uz[j] = outcome.direction[2];
-      bool was_elastic = (outb.neutrons.ekin[j] == outcome.ekin.dbl());
-      outb.neutrons.ekin[j] = outcome.ekin.dbl();
+      //Fix weights for the forced collision:
+      outb.neutrons.w[j] *= ( 1.0 - m_buf_ptransm[i] );
+
+    }
+
+    //Scatter all surviving particles in one batch. Note that this consumes
+    //random numbers in a different order than scattering each particle right
+    //after its russian-roulette decision (as was done in NCrystal releases
+    //before the batched methods were introduced). Results for a given seed are
+    //therefore statistically equivalent to, but not identical with, those of
+    //earlier releases:
+    nc_assert( has_scat );
+    ProcImpl::NewABI::sampleScatterMany( mat.scatter, sct_cacheptr, rng,
+                                         outb.neutrons.ekin, outb.neutrons.ux,
+                                         outb.neutrons.uy, outb.neutrons.uz,
+                                         outb.size(),
+                                         m_buf_scat_ekin, m_buf_scat_ux,
+                                         m_buf_scat_uy, m_buf_scat_uz );
+    for ( auto j : ncrange( outb.size() ) ) {
+      outb.neutrons.ux[j] = m_buf_scat_ux[j];
+      outb.neutrons.uy[j] = m_buf_scat_uy[j];
+      outb.neutrons.uz[j] = m_buf_scat_uz[j];
+      bool was_elastic = ( outb.neutrons.ekin[j] == m_buf_scat_ekin[j] );
+      outb.neutrons.ekin[j] = m_buf_scat_ekin[j];
       if ( was_elastic ) {
         outb.cache.markScatteredElastic(j);
       } else {
@@ -195,11 +285,8 @@ void NCMMC::StdEngine::advanceSimulation( RNG& rng,
       //Needless since we never use the cached xs in case of oriented materials:
       //if (!scatter_is_isotropic)
       //  outb.cache.scatxsval[j] = -1.0;
-
-      //Fix weights for the forced collision:
-      outb.neutrons.w[j] *= ( 1.0 - m_buf_ptransm[i] );
-
     }
+
     if ( !outb.empty() ) {
       mgr.addPendingBasket( std::move(pending) );
     } else {
@@ -212,7 +299,7 @@ void NCMMC::StdEngine::advanceSimulation( RNG& rng,
     //efficiency, we simply reuse the input basket:
     auto& outb = inbasket_holder.basket();
     MiniMC::Utils::propagateAndAttenuate( outb.neutrons,
-                                          m_mat.numDens,
+                                          mat.numDens,
                                           m_buf_disttoexit,
                                           values_abs_xs_or_nullptr );
     //We also reduce with the transmission probability (i.e. scatter-process
@@ -221,8 +308,65 @@ void NCMMC::StdEngine::advanceSimulation( RNG& rng,
     for ( auto i : ncrange(outb.size()) )
       outb.neutrons.w[i] *= m_buf_ptransm[i];
 
-    resultFct( inbasket_holder.basket() );
+    handleTransmitted( nlayers, std::move(inbasket_holder), mgr, resultFct );
+    return;
+  }
+}
+
+void NCMMC::StdEngine::handleTransmitted( unsigned nlayers,
+                                         basket_holder_t&& inbasket_holder,
+                                         basketmgr_t& mgr,
+                                         const resultfct_t& resultFct )
+{
+  //The neutrons have been transported to the boundary of their layer, and
+  //m_buf_nextlayer indicates the layers they are now entering. Neutrons
+  //leaving the geometry are final results, while the rest must be simulated
+  //further in their new layers.
+  auto& b = inbasket_holder.basket();
+  const std::size_t n = b.size();
+  std::size_t nleaving = 0;
+  for ( auto i : ncrange( n ) )
+    if ( m_buf_nextlayer[i] >= nlayers )
+      ++nleaving;
+
+  if ( nleaving == n ) {
+    resultFct( b );
     deallocateBasket( mgr, std::move(inbasket_holder) );
     return;
   }
+
+  auto enterNextLayer = [this]( basket_t& bb )
+  {
+    for ( auto i : ncrange( bb.size() ) ) {
+      bb.neutrons.x[i] += layer_crossing_step * bb.neutrons.ux[i];
+      bb.neutrons.y[i] += layer_crossing_step * bb.neutrons.uy[i];
+      bb.neutrons.z[i] += layer_crossing_step * bb.neutrons.uz[i];
+      bb.cache.layer[i] = static_cast<int>( m_buf_nextlayer[i] );
+      bb.cache.scatxsval[i] = -1.0;//different material
+    }
+  };
+
+  if ( nleaving == 0 ) {
+    enterNextLayer( b );
+    mgr.addPendingBasket( std::move(inbasket_holder) );
+    return;
+  }
+
+  //Mixed case, split into two baskets:
+  basket_holder_t leaving = allocateBasket( mgr );
+  basket_holder_t crossing = allocateBasket( mgr );
+  for ( auto i : ncrange( n ) ) {
+    if ( m_buf_nextlayer[i] >= nlayers ) {
+      leaving.basket().appendEntryFromOther( b, i );
+    } else {
+      //NB: j<=i, so we can safely update m_buf_nextlayer in-place:
+      std::size_t j = crossing.basket().appendEntryFromOther( b, i );
+      m_buf_nextlayer[j] = m_buf_nextlayer[i];
+    }
+  }
+  deallocateBasket( mgr, std::move(inbasket_holder) );
+  resultFct( leaving.basket() );
+  deallocateBasket( mgr, std::move(leaving) );
+  enterNextLayer( crossing.basket() );
+  mgr.addPendingBasket( std::move(crossing) );
 }
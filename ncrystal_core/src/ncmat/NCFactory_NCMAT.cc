@@ -31,7 +31,8 @@ namespace NCRYSTAL_NAMESPACE {
 
     Priority query( const FactImpl::InfoRequest& cfg ) const final
     {
-      return cfg.getDataType()=="ncmat" ? Priority{100} : Priority{Priority::Unable};
+      return ( cfg.getDataType()=="ncmat" || cfg.getDataType()=="ncmatb" )
+        ? Priority{100} : Priority{Priority::Unable};
     }
 
     shared_obj<const Info> produce( const FactImpl::InfoRequest& cfg ) const final
@@ -50,4 +51,5 @@ extern "C" void NCRYSTAL_APPLY_C_NAMESPACE(register_stdncmat_factory)()
 {
   NC::FactImpl::registerFactory( std::make_unique<NC::NCMATFactory>() );
   NC::DataSources::addRecognisedFileExtensions("ncmat");
+  NC::DataSources::addRecognisedFileExtensions("ncmatb");
 }
@@ -20,6 +20,7 @@
 
 #include "NCrystal/internal/ncmat/NCLoadNCMAT.hh"
 #include "NCrystal/internal/ncmat/NCParseNCMAT.hh"
+#include "NCrystal/internal/ncmat/NCNCMATB.hh"
 #include "NCrystal/internal/ncmat/NCNCMATData.hh"
 #include "NCrystal/factories/NCFactImpl.hh"
 #include "NCrystal/internal/infobld/NCInfoBuilder.hh"
@@ -147,7 +148,9 @@ NC::Info NC::loadNCMAT( const TextData& inputText,
   const bool doFinalValidation = false;
   //don't validate at end of the parseNCMATData call, since the loadNCMAT call
   //anyway validates.
-  NCMATData data = parseNCMATData( inputText, doFinalValidation);
+  NCMATData data = ( inputText.dataType() == "ncmatb"
+                     ? parseNCMATBData( inputText, doFinalValidation )
+                     : parseNCMATData( inputText, doFinalValidation ) );
   return loadNCMAT( std::move(data), std::move(cfgvars) );
 }
 
@@ -0,0 +1,388 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/internal/ncmat/NCNCMATB.hh"
+#include "NCrystal/internal/ncmat/NCParseNCMAT.hh"
+#include "NCrystal/internal/utils/NCPersistentCache.hh"
+#include "NCrystal/internal/utils/NCString.hh"
+#include <cstring>
+
+namespace NC = NCrystal;
+
+namespace NCRYSTAL_NAMESPACE {
+  namespace {
+
+    constexpr const char * ncmatb_magic = "NCMATB";
+    constexpr const char * ncmatb_firstline = "NCMATB v1";
+
+    constexpr const char * b64chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string base64Encode( const std::string& in )
+    {
+      std::string out;
+      out.reserve( 4 * ( ( in.size() + 2 ) / 3 ) );
+      const auto * p = reinterpret_cast<const unsigned char*>( in.data() );
+      const std::size_t n = in.size();
+      std::size_t i = 0;
+      for ( ; i + 3 <= n; i += 3 ) {
+        const std::uint32_t v = ( std::uint32_t(p[i]) << 16 ) | ( std::uint32_t(p[i+1]) << 8 ) | p[i+2];
+        out += b64chars[ ( v >> 18 ) & 0x3F ];
+        out += b64chars[ ( v >> 12 ) & 0x3F ];
+        out += b64chars[ ( v >> 6 ) & 0x3F ];
+        out += b64chars[ v & 0x3F ];
+      }
+      if ( i < n ) {
+        const bool two = ( i + 2 == n );
+        const std::uint32_t v = ( std::uint32_t(p[i]) << 16 ) | ( two ? ( std::uint32_t(p[i+1]) << 8 ) : 0u );
+        out += b64chars[ ( v >> 18 ) & 0x3F ];
+        out += b64chars[ ( v >> 12 ) & 0x3F ];
+        out += ( two ? b64chars[ ( v >> 6 ) & 0x3F ] : '=' );
+        out += '=';
+      }
+      return out;
+    }
+
+    //Returns false in case of invalid input:
+    bool base64Decode( const char * b, const char * e, std::string& out )
+    {
+      static const std::array<signed char,256> table = []()
+      {
+        std::array<signed char,256> t;
+        t.fill( -1 );
+        for ( int i = 0; i < 64; ++i )
+          t[ static_cast<unsigned char>( b64chars[i] ) ] = static_cast<signed char>( i );
+        return t;
+      }();
+      const std::size_t n = static_cast<std::size_t>( e - b );
+      if ( n % 4 != 0 )
+        return false;
+      std::size_t npad = 0;
+      if ( n && e[-1] == '=' )
+        npad = ( e[-2] == '=' ? 2 : 1 );
+      out.clear();
+      out.resize( 3 * ( n / 4 ) - npad );
+      auto * o = &out[0];
+      auto * oEnd = o + out.size();
+      for ( std::size_t i = 0; i < n; i += 4 ) {
+        std::uint32_t v = 0;
+        for ( std::size_t j = 0; j < 4; ++j ) {
+          const char c = b[i+j];
+          if ( c == '=' && i + 4 == n && j >= 4 - npad ) {
+            v <<= 6;
+            continue;
+          }
+          const signed char d = table[ static_cast<unsigned char>( c ) ];
+          if ( d < 0 )
+            return false;
+          v = ( v << 6 ) | static_cast<std::uint32_t>( d );
+        }
+        *o++ = static_cast<char>( ( v >> 16 ) & 0xFF );
+        if ( o != oEnd )
+          *o++ = static_cast<char>( ( v >> 8 ) & 0xFF );
+        if ( o != oEnd )
+          *o++ = static_cast<char>( v & 0xFF );
+      }
+      return true;
+    }
+
+    using Writer = PersistentCache::Writer;
+    using Reader = PersistentCache::Reader;
+
+    void writeStrings( Writer& w, const VectS& v )
+    {
+      w.addU64( v.size() );
+      for ( auto& s : v )
+        w.addStr( s );
+    }
+
+    VectS readStrings( Reader& r )
+    {
+      VectS v;
+      v.resize( r.getSize( sizeof(std::uint64_t) ) );
+      for ( auto& s : v )
+        s = r.getStr();
+      return v;
+    }
+
+    void serialise( Writer& w, const NCMATData& data )
+    {
+      w.addU64( static_cast<std::uint64_t>( data.version ) );
+      w.addU64( data.stateOfMatter.has_value()
+                ? 1 + static_cast<std::uint64_t>( data.stateOfMatter.value() )
+                : 0 );
+      for ( auto v : data.cell.lengths )
+        w.addDbl( v );
+      for ( auto v : data.cell.angles )
+        w.addDbl( v );
+      w.addU64( data.atompos.size() );
+      for ( auto& e : data.atompos ) {
+        w.addStr( e.first );
+        for ( auto v : e.second )
+          w.addDbl( v );
+      }
+      w.addU64( data.temperature.has_value()
+                ? 1 + static_cast<std::uint64_t>( data.temperature.value().second )
+                : 0 );
+      w.addDbl( data.temperature.has_value() ? data.temperature.value().first.dbl() : 0.0 );
+      w.addU64( static_cast<std::uint64_t>( data.spacegroup ) );
+      w.addU64( data.debyetemp_global.has_value() ? 1 : 0 );
+      w.addDbl( data.debyetemp_global.has_value() ? data.debyetemp_global.value().dbl() : 0.0 );
+      w.addU64( data.debyetemp_perelement.size() );
+      for ( auto& e : data.debyetemp_perelement ) {
+        w.addStr( e.first );
+        w.addDbl( e.second.dbl() );
+      }
+      w.addU64( data.dyninfos.size() );
+      for ( auto& di : data.dyninfos ) {
+        w.addU64( static_cast<std::uint64_t>( di.dyninfo_type ) );
+        w.addStr( di.element_name );
+        w.addDbl( di.fraction );
+        w.addU64( di.fields.size() );
+        for ( auto& f : di.fields ) {
+          w.addStr( f.first );
+          w.addVect( f.second );
+        }
+      }
+      w.addU64( static_cast<std::uint64_t>( data.density_unit ) );
+      w.addDbl( data.density );
+      w.addU64( data.atomDBLines.size() );
+      for ( auto& line : data.atomDBLines )
+        writeStrings( w, line );
+      w.addU64( data.otherPhases.size() );
+      for ( auto& e : data.otherPhases ) {
+        w.addDbl( e.first );
+        w.addStr( e.second );
+      }
+      w.addU64( data.customSections.size() );
+      for ( auto& e : data.customSections ) {
+        w.addStr( e.first );
+        w.addU64( e.second.size() );
+        for ( auto& line : e.second )
+          writeStrings( w, line );
+      }
+    }
+
+    NCMATData deserialise( Reader& r )
+    {
+      auto invalid = []( const char * what )
+      {
+        NCRYSTAL_THROW2(DataLoadError,"invalid "<<what);
+      };
+      NCMATData data;
+      const std::uint64_t version = r.getU64();
+      if ( version > static_cast<std::uint64_t>( NCMATData::latest_version ) )
+        invalid("NCMAT version");
+      data.version = static_cast<int>( version );
+
+      const std::uint64_t som = r.getU64();
+      if ( som > 3 )
+        invalid("state of matter");
+      if ( som )
+        data.stateOfMatter = static_cast<NCMATData::StateOfMatter>( som - 1 );
+
+      for ( auto& v : data.cell.lengths )
+        v = r.getDbl();
+      for ( auto& v : data.cell.angles )
+        v = r.getDbl();
+
+      data.atompos.resize( r.getSize( 4 * sizeof(std::uint64_t) ) );
+      for ( auto& e : data.atompos ) {
+        e.first = r.getStr();
+        for ( auto& v : e.second )
+          v = r.getDbl();
+      }
+
+      const std::uint64_t ttype = r.getU64();
+      const double tval = r.getDbl();
+      if ( ttype > 2 )
+        invalid("temperature type");
+      if ( ttype )
+        data.temperature.emplace( Temperature{ tval },
+                                  static_cast<NCMATData::TemperatureType>( ttype - 1 ) );
+
+      const std::uint64_t sg = r.getU64();
+      if ( sg > 230 )
+        invalid("space group");
+      data.spacegroup = static_cast<int>( sg );
+
+      const std::uint64_t hasdtglobal = r.getU64();
+      const double dtglobal = r.getDbl();
+      if ( hasdtglobal > 1 )
+        invalid("Debye temperature flag");
+      if ( hasdtglobal )
+        data.debyetemp_global = DebyeTemperature{ dtglobal };
+      data.debyetemp_perelement.resize( r.getSize( 2 * sizeof(std::uint64_t) ) );
+      for ( auto& e : data.debyetemp_perelement ) {
+        e.first = r.getStr();
+        e.second = DebyeTemperature{ r.getDbl() };
+      }
+
+      data.dyninfos.resize( r.getSize( 4 * sizeof(std::uint64_t) ) );
+      for ( auto& di : data.dyninfos ) {
+        const std::uint64_t ditype = r.getU64();
+        if ( ditype > static_cast<std::uint64_t>( NCMATData::DynInfo::Undefined ) )
+          invalid("dynamic info type");
+        di.dyninfo_type = static_cast<NCMATData::DynInfo::DynInfoType>( ditype );
+        di.element_name = r.getStr();
+        di.fraction = r.getDbl();
+        const std::size_t nfields = r.getSize( 2 * sizeof(std::uint64_t) );
+        for ( std::size_t i = 0; i < nfields; ++i ) {
+          std::string key = r.getStr();
+          VectD values = r.getVect();
+          if ( !di.fields.emplace( std::move(key), std::move(values) ).second )
+            invalid("dynamic info fields");
+        }
+      }
+
+      const std::uint64_t densunit = r.getU64();
+      if ( densunit > static_cast<std::uint64_t>( NCMATData::KG_PER_M3 ) )
+        invalid("density unit");
+      data.density_unit = static_cast<NCMATData::DensityUnit>( densunit );
+      data.density = r.getDbl();
+
+      data.atomDBLines.resize( r.getSize( sizeof(std::uint64_t) ) );
+      for ( auto& line : data.atomDBLines )
+        line = readStrings( r );
+
+      data.otherPhases.resize( r.getSize( 2 * sizeof(std::uint64_t) ) );
+      for ( auto& e : data.otherPhases ) {
+        e.first = r.getDbl();
+        e.second = r.getStr();
+      }
+
+      data.customSections.resize( r.getSize( 2 * sizeof(std::uint64_t) ) );
+      for ( auto& e : data.customSections ) {
+        e.first = r.getStr();
+        e.second.resize( r.getSize( sizeof(std::uint64_t) ) );
+        for ( auto& line : e.second )
+          line = readStrings( r );
+      }
+
+      if ( !r.atEnd() )
+        invalid("trailing data");
+      return data;
+    }
+
+    std::string singleLine( std::string s )
+    {
+      for ( auto& c : s )
+        if ( c == '\n' || c == '\r' )
+          c = ' ';
+      return s;
+    }
+
+  }
+}
+
+bool NC::isNCMATB( const RawStrData& data )
+{
+  return 0 == std::strncmp( data.begin(), ncmatb_magic, std::strlen(ncmatb_magic) );
+}
+
+std::string NC::encodeNCMATB( const NCMATData& data, const VectS& embeddedCfgLines )
+{
+  Writer w;
+  serialise( w, data );
+  const auto& payload = w.data();
+  Writer w_checksum;
+  w_checksum.addU64( PersistentCache::checksum( payload.data(), payload.size() ) );
+  std::string buf;
+  buf.reserve( w_checksum.data().size() + payload.size() );
+  buf.append( w_checksum.data() );
+  buf.append( payload );
+
+  std::ostringstream ss;
+  ss << ncmatb_firstline << '\n'
+     << "# Pre-parsed NCMAT v" << data.version << " data converted from "
+     << singleLine( data.sourceDescription.str() )
+     << " (NCrystal v" << NCRYSTAL_VERSION_STR << ")\n";
+  for ( auto& line : embeddedCfgLines )
+    ss << "# " << singleLine( line ) << '\n';
+  ss << base64Encode( buf ) << '\n';
+  return ss.str();
+}
+
+std::string NC::convertNCMATToNCMATB( const TextData& input )
+{
+  if ( isNCMATB( input.rawData() ) )
+    NCRYSTAL_THROW2(BadInput,"Input is already in NCMATB format: "<<input.dataSourceName());
+  NCMATData data = parseNCMATData( input, true );
+  VectS cfglines;
+  for ( const std::string& line : input ) {
+    if ( line.find("NCRYSTALMATCFG") != std::string::npos )
+      cfglines.push_back( trim2( line ) );
+  }
+  return encodeNCMATB( data, cfglines );
+}
+
+NC::NCMATData NC::parseNCMATBData( const TextData& input, bool doFinalValidation )
+{
+  const auto& dsn = input.dataSourceName();
+  const char * it = input.rawData().begin();
+  const char * itEnd = input.rawData().end();
+  auto nextLine = [&it,itEnd]()
+  {
+    const char * b = it;
+    const char * e = static_cast<const char*>( std::memchr( b, '\n', static_cast<std::size_t>( itEnd - b ) ) );
+    it = ( e ? e + 1 : itEnd );
+    if ( !e )
+      e = itEnd;
+    if ( e != b && *std::prev(e) == '\r' )
+      --e;
+    return std::make_pair( b, e );
+  };
+
+  auto line = nextLine();
+  const std::size_t nfirst = std::strlen( ncmatb_firstline );
+  if ( static_cast<std::size_t>( line.second - line.first ) != nfirst
+       || 0 != std::strncmp( line.first, ncmatb_firstline, nfirst ) ) {
+    if ( isNCMATB( input.rawData() ) )
+      NCRYSTAL_THROW2(BadInput,"Unsupported NCMATB format version in "<<dsn
+                      <<" (perhaps it was created by a newer NCrystal release)");
+    NCRYSTAL_THROW2(BadInput,"Not NCMATB data: "<<dsn);
+  }
+  do {
+    line = nextLine();
+  } while ( it != itEnd && line.first != line.second && *line.first == '#' );
+  for ( const char * c = it; c != itEnd; ++c )
+    if ( !isWhiteSpace( *c ) )
+      NCRYSTAL_THROW2(BadInput,"Unexpected content after data in "<<dsn);
+
+  std::string buf;
+  if ( !base64Decode( line.first, line.second, buf ) || buf.size() < sizeof(std::uint64_t) )
+    NCRYSTAL_THROW2(BadInput,"Invalid encoding of NCMATB data in "<<dsn);
+  const std::uint64_t checksum = Reader( buf.data(), sizeof(std::uint64_t) ).getU64();
+  const char * payload = buf.data() + sizeof(checksum);
+  const std::size_t npayload = buf.size() - sizeof(checksum);
+  if ( checksum != PersistentCache::checksum( payload, npayload ) )
+    NCRYSTAL_THROW2(BadInput,"Checksum mismatch in NCMATB data in "<<dsn);
+
+  NCMATData data;
+  try {
+    Reader r( payload, npayload );
+    data = deserialise( r );
+  } catch ( Error::DataLoadError& e ) {
+    NCRYSTAL_THROW2(BadInput,"Problems decoding NCMATB data in "<<dsn<<": "<<e.what());
+  }
+  data.sourceDescription = dsn;
+  if ( doFinalValidation )
+    data.validate();
+  return data;
+}
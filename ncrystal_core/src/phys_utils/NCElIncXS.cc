@@ -24,6 +24,31 @@
 
 namespace NC = NCrystal;
 
+struct NC::ElIncXS::TabData {
+  //Total and per-element cumulative cross sections on a grid uniform in
+  //log(ekin), stored with the nelem values of each grid point contiguously:
+  double emin, emax, logemin, invdu;
+  std::size_t nelem;
+  VectD values;
+
+  bool inRange( NeutronEnergy ekin ) const
+  {
+    return ekin.dbl() >= emin && ekin.dbl() < emax;
+  }
+
+  //Returns pointer to values at the lower grid point and sets f to the
+  //interpolation fraction between it and the next grid point:
+  const double * locate( NeutronEnergy ekin, double& f ) const
+  {
+    nc_assert( inRange( ekin ) );
+    const double u = ( std::log( ekin.dbl() ) - logemin ) * invdu;
+    const std::size_t nbins = values.size() / nelem - 1;
+    std::size_t i = std::min<std::size_t>( static_cast<std::size_t>( std::max( 0.0, u ) ), nbins - 1 );
+    f = ncclamp( u - i, 0.0, 1.0 );
+    return &values[ i * nelem ];
+  }
+};
+
 NC::ElIncXS::ElIncXS( const VectD& elm_msd,
                       const VectD& elm_bixs,
                       const VectD& elm_scale )
@@ -72,6 +97,7 @@ void NC::ElIncXS::set( const VectD& elm_msd,
     nc_assert_always(elm_scale.at(i)>=0.0&&elm_scale.at(i)<=1e6);
   }
 
+  m_tab = nullptr;
   m_elm_data.clear();//releases all memory since it is SmallVector
   m_elm_data.reserve_hint(elm_bixs.size());
   for ( auto i : ncrange( elm_msd.size() ) )
@@ -116,6 +142,11 @@ NC::CosineScatAngle NC::ElIncXS::sampleMuMonoAtomic( RNG& rng, NeutronEnergy eki
 
 NC::CrossSect NC::ElIncXS::evaluate(NeutronEnergy ekin) const
 {
+  if ( m_tab && m_tab->inRange( ekin ) ) {
+    double f;
+    const double * v = m_tab->locate( ekin, f ) + ( m_tab->nelem - 1 );
+    return CrossSect{ v[0] + f * ( v[m_tab->nelem] - v[0] ) };
+  }
   //NB: The cross-section code here must be consistent with code in
   //evalXSContribsCommul(), evaluateMany(), and
   //evalXSContribsCommul().
@@ -131,13 +162,91 @@ NC::SmallVector<double,32> NC::ElIncXS::evalXSContribsCommul( NeutronEnergy ekin
 {
   SmallVector<double,32> res;
   res.resize( m_elm_data.size() );
+  if ( m_tab && m_tab->inRange( ekin ) ) {
+    double f;
+    const double * v0 = m_tab->locate( ekin, f );
+    const double * v1 = v0 + m_tab->nelem;
+    for ( auto i : ncrange( m_tab->nelem ) )
+      res[i] = v0[i] + f * ( v1[i] - v0[i] );
+  } else {
+    evalXSContribsCommulExact( ekin, res.data() );
+  }
+  return res;
+}
+
+void NC::ElIncXS::evalXSContribsCommulExact( NeutronEnergy ekin, double* tgt ) const
+{
   constexpr double kkk = 16.0 * kPiSq * ekin2wlsqinv(1.0);
   double e = kkk*ekin.dbl();
   double xs = 0.0;
-  unsigned i = 0;
   for ( auto& elmdata : m_elm_data )
-    res[i++] = ( xs += elmdata.second * eval_1mexpmtdivt( elmdata.first * e ) );
-  return res;
+    *tgt++ = ( xs += elmdata.second * eval_1mexpmtdivt( elmdata.first * e ) );
+}
+
+void NC::ElIncXS::enableTabulation( double rel_tolerance )
+{
+  nc_assert_always( rel_tolerance > 0.0 && rel_tolerance < 1.0 );
+  m_tab = nullptr;
+  if ( m_elm_data.empty() )
+    return;
+
+  //The exact evaluation only needs std::expm1 for 0.01<=t<=24 (see
+  //eval_1mexpmtdivt), so that is the only region worth tabulating:
+  double msd_min( kInfinity ), msd_max( 0.0 );
+  for ( auto& elmdata : m_elm_data ) {
+    if ( elmdata.first > 0.0 ) {
+      msd_min = std::min( msd_min, elmdata.first );
+      msd_max = std::max( msd_max, elmdata.first );
+    }
+  }
+  if ( !( msd_max > 0.0 ) )
+    return;//no energy dependency at all
+  constexpr double kkk = 16.0 * kPiSq * ekin2wlsqinv(1.0);
+  const double emin = 0.01 / ( kkk * msd_max );
+  const double emax = 24.0 / ( kkk * msd_min );
+  nc_assert_always( emin < emax );
+  const double logemin = std::log( emin );
+  const double logrange = std::log( emax ) - logemin;
+  const std::size_t nelem = m_elm_data.size();
+
+  SmallVector<double,32> exact;
+  exact.resize( nelem );
+  std::size_t nbins = std::max<std::size_t>( 16, static_cast<std::size_t>( std::ceil( 32.0 * logrange ) ) );
+  while ( true ) {
+    const double du = logrange / nbins;
+    auto tab = std::make_shared<TabData>();
+    tab->emin = emin;
+    tab->emax = emax;
+    tab->logemin = logemin;
+    tab->invdu = 1.0 / du;
+    tab->nelem = nelem;
+    tab->values.resize( ( nbins + 1 ) * nelem );
+    for ( auto i : ncrange( nbins + 1 ) )
+      evalXSContribsCommulExact( NeutronEnergy{ std::exp( logemin + i * du ) },
+                                 &tab->values[ i * nelem ] );
+
+    //Check interpolation errors at bin midpoints (where they are largest):
+    double maxerr = 0.0;
+    for ( auto i : ncrange( nbins ) ) {
+      evalXSContribsCommulExact( NeutronEnergy{ std::exp( logemin + ( i + 0.5 ) * du ) },
+                                 exact.data() );
+      const double xstot = exact.back();
+      if ( !( xstot > 0.0 ) )
+        continue;
+      const double * v0 = &tab->values[ i * nelem ];
+      const double * v1 = v0 + nelem;
+      for ( auto j : ncrange( nelem ) )
+        maxerr = std::max( maxerr, ncabs( 0.5 * ( v0[j] + v1[j] ) - exact[j] ) / xstot );
+    }
+    if ( maxerr <= rel_tolerance ) {
+      m_tab = std::move( tab );
+      return;
+    }
+    if ( nbins > 1000000 )
+      NCRYSTAL_THROW2(CalcError,"ElIncXS: Unable to reach requested tabulation"
+                      " tolerance of "<<rel_tolerance<<" (reached "<<maxerr<<")");
+    nbins *= 2;
+  }
 }
 
 void NC::ElIncXS::evaluateMany( Span<const double> ekin, Span<double> tgt) const
@@ -153,6 +262,12 @@ void NC::ElIncXS::evaluateMany( Span<const double> ekin, Span<double> tgt) const
   const double * ekin_ptr = ekin.data();
   double * tgt_ptr = tgt.data();
 
+  if ( m_tab ) {
+    for ( auto i : ncrange(n) )
+      tgt_ptr[i] = evaluate( NeutronEnergy{ ekin_ptr[i] } ).dbl();
+    return;
+  }
+
   std::fill( tgt_ptr, tgt_ptr + n, 0.0 );
 
   std::size_t nleft = n;
@@ -144,51 +144,147 @@ double NC::GaussMos::calcRawCrossSectionValueInit(InteractionPars& ip, double co
   }
 }
 
+inline void NC::GaussMos::addNormalContribs( InteractionPars& ip,
+                                             const double dot,
+                                             const NC::Vector& normal,
+                                             double xsoffset, double& xssum,
+                                             std::vector<NC::GaussMos::ScatCache>& cache,
+                                             VectD& xs_commul ) const
+{
+  const double cptsq = ip.m_cos_perfect_theta_sq;
+  const double cta = m_gos.getCosTruncangle();
+  double sdotcptsq = (1.0 - dot * dot)*cptsq;
+  double ds = dot * ip.m_sin_perfect_theta;
+
+  //First a combined check, which usually allows us to skip both normal and
+  //anti-normal:
+  double A0 = ncmax( 0.0, cta - ncabs(ds) );
+  if ( sdotcptsq <= A0*A0 )
+    return;
+
+  //At least one of the two normals should contribute, so deal with them:
+  double Am = ncmax( 0.0, cta - ds );
+  if ( sdotcptsq > Am*Am ) {
+    //anti-normal is within truncated Gauss
+    double xs = calcRawCrossSectionValue(ip, dot );
+    if (xs) {
+      xs_commul.push_back(xsoffset + (xssum += xs));
+      cache.emplace_back(-normal, ip.m_inv2dsp);
+    }
+  }
+  double Ap = ncmax( 0.0, cta + ds );
+  if ( sdotcptsq > Ap*Ap ) {
+    //normal is within truncated Gauss
+    double xs = calcRawCrossSectionValue(ip, -dot );
+    if (xs) {
+      xs_commul.push_back(xsoffset + (xssum += xs));
+      cache.emplace_back(normal, ip.m_inv2dsp);
+    }
+  }
+}
+
+namespace NCRYSTAL_NAMESPACE {
+  namespace {
+    //Number of demi-normals handled together in GaussMos::addBlockContribs:
+    constexpr std::size_t GaussMos_blocksize = 64;
+  }
+}
+
+void NC::GaussMos::addBlockContribs( InteractionPars& ip,
+                                     const NC::Vector& indir,
+                                     std::size_t n,
+                                     const double * x,
+                                     const double * y,
+                                     const double * z,
+                                     double xsoffset, double& xssum,
+                                     std::vector<NC::GaussMos::ScatCache>& cache,
+                                     VectD& xs_commul ) const
+{
+  //Typically only a small fraction of the demi-normals pass the truncation
+  //test. So first calculate dot products and apply the combined truncation test
+  //of addNormalContribs for the whole block, in simple branch-free loops over
+  //plain arrays which compilers can auto-vectorise. Only the few surviving
+  //normals are then passed on to addNormalContribs (in the original order, so
+  //results do not depend on the blocking):
+  nc_assert( n <= GaussMos_blocksize );
+  const double ix(indir[0]), iy(indir[1]), iz(indir[2]);
+  const double cptsq = ip.m_cos_perfect_theta_sq;
+  const double spt = ip.m_sin_perfect_theta;
+  const double cta = m_gos.getCosTruncangle();
+  double dots[GaussMos_blocksize];
+  unsigned char pass[GaussMos_blocksize];
+  for ( std::size_t i = 0; i < n; ++i ) {
+    const double dot = x[i]*ix + y[i]*iy + z[i]*iz;
+    dots[i] = dot;
+    const double sdotcptsq = (1.0 - dot * dot)*cptsq;
+    const double A0 = std::max( 0.0, cta - std::fabs( dot * spt ) );
+    //Slightly looser than the test in addNormalContribs, which remains the
+    //authoritative one (thus no dependency on how the compiler might fuse
+    //floating point operations differently in the two places):
+    pass[i] = ( sdotcptsq > A0*A0*(1.0-1e-9) ? 1 : 0 );
+  }
+  std::uint32_t sel[GaussMos_blocksize];
+  std::size_t nsel(0);
+  for ( std::size_t i = 0; i < n; ++i ) {
+    sel[nsel] = static_cast<std::uint32_t>(i);
+    nsel += pass[i];
+  }
+  for ( std::size_t j = 0; j < nsel; ++j ) {
+    const auto i = sel[j];
+    addNormalContribs( ip, dots[i], Vector( x[i], y[i], z[i] ),
+                       xsoffset, xssum, cache, xs_commul );
+  }
+}
+
 double NC::GaussMos::calcCrossSections( InteractionPars& ip,
                                         const NC::Vector& indir,
-                                        const std::vector<NC::Vector>& deminormals,
+                                        const DemiNormals& deminormals,
                                         std::vector<NC::GaussMos::ScatCache>& cache,
                                         VectD& xs_commul ) const
 {
   nc_assert(ip.isValid()&&ip.m_wl>0);
   nc_assert(indir.isUnitVector());
-  std::vector<Vector>::const_iterator it(deminormals.begin()), itE(deminormals.end());
   double xsoffset = xs_commul.empty() ? 0.0 : xs_commul.back();
   double xssum(0.0);
-  const double cptsq = ip.m_cos_perfect_theta_sq;
-  const double cta = m_gos.getCosTruncangle();
-  for(;it!=itE;++it) {
-    const Vector& normal = *it;
-    const double dot = normal.dot(indir);
-    double sdotcptsq = (1.0 - dot * dot)*cptsq;
-    double ds = dot * ip.m_sin_perfect_theta;
-
-    //First a combined check, which usually allows us to skip both normal and
-    //anti-normal:
-    double A0 = ncmax( 0.0, cta - ncabs(ds) );
-    if ( sdotcptsq <= A0*A0 )
-      continue;
+  const std::size_t ntot = deminormals.size();
+  const double * x = deminormals.xData();
+  const double * y = deminormals.yData();
+  const double * z = deminormals.zData();
+  for ( std::size_t i = 0; i < ntot; i += GaussMos_blocksize ) {
+    addBlockContribs( ip, indir, std::min( GaussMos_blocksize, ntot - i ),
+                      x + i, y + i, z + i, xsoffset, xssum, cache, xs_commul );
+  }
+  return xssum;
+}
 
-    //At least one of the two normals should contribute, so deal with them:
-    double Am = ncmax( 0.0, cta - ds );
-    if ( sdotcptsq > Am*Am ) {
-      //anti-normal is within truncated Gauss
-      double xs = calcRawCrossSectionValue(ip, dot );
-      if (xs) {
-        xs_commul.push_back(xsoffset + (xssum += xs));
-        cache.emplace_back(-normal, ip.m_inv2dsp);
-      }
-    }
-    double Ap = ncmax( 0.0, cta + ds );
-    if ( sdotcptsq > Ap*Ap ) {
-      //normal is within truncated Gauss
-      double xs = calcRawCrossSectionValue(ip, -dot );
-      if (xs) {
-        xs_commul.push_back(xsoffset + (xssum += xs));
-        cache.emplace_back(normal, ip.m_inv2dsp);
-      }
+double NC::GaussMos::calcCrossSections( InteractionPars& ip,
+                                        const NC::Vector& indir,
+                                        const DemiNormals& deminormals,
+                                        Span<const std::uint32_t> indices,
+                                        std::vector<NC::GaussMos::ScatCache>& cache,
+                                        VectD& xs_commul ) const
+{
+  nc_assert(ip.isValid()&&ip.m_wl>0);
+  nc_assert(indir.isUnitVector());
+  double xsoffset = xs_commul.empty() ? 0.0 : xs_commul.back();
+  double xssum(0.0);
+  //Gather selected normals into contiguous blocks:
+  double bx[GaussMos_blocksize], by[GaussMos_blocksize], bz[GaussMos_blocksize];
+  const double * x = deminormals.xData();
+  const double * y = deminormals.yData();
+  const double * z = deminormals.zData();
+  auto it = indices.begin();
+  auto itE = indices.end();
+  while ( it != itE ) {
+    std::size_t n(0);
+    for ( ; it != itE && n < GaussMos_blocksize; ++it, ++n ) {
+      const auto idx = *it;
+      nc_assert( idx < deminormals.size() );
+      bx[n] = x[idx];
+      by[n] = y[idx];
+      bz[n] = z[idx];
     }
-
+    addBlockContribs( ip, indir, n, bx, by, bz, xsoffset, xssum, cache, xs_commul );
   }
   return xssum;
 }
@@ -22,12 +22,14 @@
 #include "NCrystal/internal/utils/NCMath.hh"
 #include "NCrystal/internal/utils/NCRandUtils.hh"
 #include "NCrystal/internal/utils/NCString.hh"
+#include "NCrystal/interfaces/NCCacheStats.hh"
 #include <functional>//std::greater
 
 namespace NC = NCrystal;
 namespace NCRYSTAL_NAMESPACE {
   namespace {
     constexpr double dspacing_merge_tolerance = 1e-11;
+    static CacheStats::Category s_cachestats("PowderBragg");
     class CachePowderBragg : public CacheBase {
     public:
       void invalidateCache() override { ekin.dbl() = -1.0; }
@@ -38,6 +40,16 @@ namespace NCRYSTAL_NAMESPACE {
         nc_assert( std::isfinite(eee.dbl()) );
         return eee == ekin;
       }
+      template<class TFindLVPI>
+      void ensureValid( NeutronEnergy eee, TFindLVPI&& findLastValidPlaneIdx )
+      {
+        if ( cacheOK( eee ) ) {
+          s_cachestats.recordHit();
+        } else {
+          CacheStats::Category::MissScope missrecorder( s_cachestats );
+          updateCache( eee, findLastValidPlaneIdx( eee ) );
+        }
+      }
       void updateCache( NeutronEnergy eee,
                         std::size_t lvpi )
       {
@@ -107,6 +119,34 @@ void NC::PowderBragg::init( double v0_times_natoms, VectDFM&& origdata )
   VectD(fdm_commul.begin(),fdm_commul.end()).swap(m_fdm_commul);
   VectD(v2dE.begin(),v2dE.end()).swap(m_2dE);
   nc_assert( m_threshold.get() > 0.0 );
+  initGuideTable();
+}
+
+void NC::PowderBragg::initGuideTable()
+{
+  //Guide table (a.k.a. index table) for m_fdm_commul: Dividing the range
+  //[0,m_fdm_commul.back()] into nbins equal bins, the guide table holds for
+  //each bin the index of the first entry in m_fdm_commul which is not below
+  //the lower edge of the bin. Thus, genScatterMu can jump directly to (or very
+  //close to) the result of a binary search, with on average O(1) entries to
+  //step through afterwards.
+  m_fdm_guide.clear();
+  m_fdm_guide_scale = 0.0;
+  const std::size_t n = m_fdm_commul.size();
+  if ( n < 32 || n > std::numeric_limits<std::uint32_t>::max() )
+    return;//binary search is fine (and no overflow concerns)
+  const double total = m_fdm_commul.back();
+  nc_assert_always( total > 0.0 );
+  const std::size_t nbins = n;
+  m_fdm_guide_scale = nbins / total;
+  m_fdm_guide.reserve( nbins );
+  std::size_t idx = 0;
+  for ( auto ibin : ncrange( nbins ) ) {
+    const double lowedge = ibin * ( total / nbins );
+    while ( idx + 1 < n && m_fdm_commul[idx] < lowedge )
+      ++idx;
+    m_fdm_guide.push_back( static_cast<std::uint32_t>( idx ) );
+  }
 }
 
 NC::PowderBragg::PowderBragg( const StructureInfo& si, VectDFM&&  data)
@@ -169,8 +209,7 @@ NC::CrossSect NC::PowderBragg::crossSectionIsotropic( NC::CachePtr& cp,
   if ( ekin < m_threshold || !std::isfinite(ekin.dbl()) )
     return CrossSect{0.0};
   auto& cache = accessCache<CachePowderBragg>(cp);
-  if (!cache.cacheOK(ekin))
-    cache.updateCache( ekin, findLastValidPlaneIdx(ekin) );
+  cache.ensureValid( ekin, [this]( NeutronEnergy ee ) { return findLastValidPlaneIdx(ee); } );
   nc_assert(cache.lastValidPlaneIdx<m_fdm_commul.size());
   return CrossSect{ m_fdm_commul[cache.lastValidPlaneIdx] * cache.inv_ekin };
 }
@@ -185,10 +224,28 @@ NC::CosineScatAngle NC::PowderBragg::genScatterMu( RNG& rng,
 
   //randomly select one plane by contribution:
   VectD::const_iterator itFCUpper = std::next( m_fdm_commul.begin(), last_valid_idx );
-  VectD::const_iterator itFC = std::lower_bound( m_fdm_commul.begin(),
-                                                 itFCUpper,
-                                                 rng.generate() * (*itFCUpper) );
-  std::size_t idx_rand = (std::size_t)( itFC - m_fdm_commul.begin() );
+  const double target = rng.generate() * (*itFCUpper);
+  std::size_t idx_rand;
+  if ( m_fdm_guide.empty() ) {
+    VectD::const_iterator itFC = std::lower_bound( m_fdm_commul.begin(),
+                                                   itFCUpper,
+                                                   target );
+    idx_rand = (std::size_t)( itFC - m_fdm_commul.begin() );
+  } else {
+    //Start from guide table entry and step to the exact same result as the
+    //std::lower_bound call above would provide (stepping backwards only
+    //happens due to rounding issues in the bin calculation):
+    const std::size_t ibin = std::min<std::size_t>( static_cast<std::size_t>( target * m_fdm_guide_scale ),
+                                                    m_fdm_guide.size() - 1 );
+    idx_rand = m_fdm_guide[ibin];
+    while ( idx_rand > 0 && m_fdm_commul[idx_rand-1] >= target )
+      --idx_rand;
+    while ( idx_rand < last_valid_idx && m_fdm_commul[idx_rand] < target )
+      ++idx_rand;
+    nc_assert( idx_rand == (std::size_t)( std::lower_bound( m_fdm_commul.begin(),
+                                                            itFCUpper,
+                                                            target ) - m_fdm_commul.begin() ) );
+  }
   nc_assert(idx_rand<m_2dE.size());
   double sin_theta_bragg_squared = m_2dE[idx_rand] / ekin.get();
 
@@ -209,8 +266,7 @@ NC::ScatterOutcomeIsotropic NC::PowderBragg::sampleScatterIsotropic( NC::CachePt
     return { ekin, CosineScatAngle{1.0} };
   } else {
     auto& cache = accessCache<CachePowderBragg>(cp);
-    if (!cache.cacheOK(ekin))
-      cache.updateCache( ekin, findLastValidPlaneIdx(ekin) );
+    cache.ensureValid( ekin, [this]( NeutronEnergy ee ) { return findLastValidPlaneIdx(ee); } );
     return { ekin, genScatterMu(rng,ekin,cache.lastValidPlaneIdx) };
   }
 }
@@ -230,6 +286,7 @@ std::shared_ptr<NC::ProcImpl::Process> NC::PowderBragg::createMerged( const Proc
   auto fixThreshold = [&result]()
   {
     result->m_threshold = NeutronEnergy{ result->m_2dE.front() };
+    result->initGuideTable();
   };
 
   //transfer "a" (2dE) and "b" (fdm_commul) vectors, sorted by a:
@@ -367,8 +424,7 @@ NC::PowderBragg::evalXSAndSampleScatter( CachePtr& cp, RNG& rng,
              { ekin, dir } };
   } else {
     auto& cache = accessCache<CachePowderBragg>(cp);
-    if (!cache.cacheOK(ekin))
-      cache.updateCache( ekin, findLastValidPlaneIdx(ekin) );
+    cache.ensureValid( ekin, [this]( NeutronEnergy ee ) { return findLastValidPlaneIdx(ee); } );
     auto mu = genScatterMu(rng,ekin,cache.lastValidPlaneIdx);
     auto outdir = randNeutronDirectionGivenScatterMu( rng,
                                                       mu.dbl(),
@@ -389,8 +445,7 @@ NC::PowderBragg::evalXSAndSampleScatterIsotropic(CachePtr& cp, RNG& rng,
              { ekin, CosineScatAngle{1.0} } };
   } else {
     auto& cache = accessCache<CachePowderBragg>(cp);
-    if (!cache.cacheOK(ekin))
-      cache.updateCache( ekin, findLastValidPlaneIdx(ekin) );
+    cache.ensureValid( ekin, [this]( NeutronEnergy ee ) { return findLastValidPlaneIdx(ee); } );
     return { CrossSect{ m_fdm_commul[cache.lastValidPlaneIdx] * cache.inv_ekin },
              { ekin, genScatterMu(rng,ekin,cache.lastValidPlaneIdx) } };
   }
@@ -400,15 +455,67 @@ void NC::PowderBragg::evalManyXSIsotropic( CachePtr&, const double* ekin,
                                            std::size_t N,
                                            double* out_xs ) const
 {
+  //Same search as in findLastValidPlaneIdx, but using the previous result as a
+  //hint. For sorted energies this walks the plane list monotonically:
+  if ( m_2dE.empty() ) {
+    for ( std::size_t i = 0; i < N; ++i )
+      out_xs[i] = 0.0;
+    return;
+  }
+  auto itB = std::next( m_2dE.begin() );
+  auto itE = m_2dE.end();
+  auto itHint = itB;
   for ( std::size_t i = 0; i < N; ++i ) {
     if ( ekin[i] < m_threshold.dbl() || !std::isfinite(ekin[i]) ) {
       nc_assert( ekin[i] >= 0.0 );
       out_xs[i] = 0.0;
     } else {
-      std::size_t idx = findLastValidPlaneIdx(NeutronEnergy{ekin[i]});
+      itHint = upperBoundWithHint( itB, itE, itHint, ekin[i] );
+      std::size_t idx = std::distance( m_2dE.begin(), itHint ) - 1;
+      nc_assert( idx == findLastValidPlaneIdx(NeutronEnergy{ekin[i]}) );
       nc_assert(idx<m_fdm_commul.size());
       out_xs[i] = m_fdm_commul[idx] / ekin[i];
     }
   }
 }
+
+void NC::PowderBragg::sampleScatterMany( CachePtr& cp, RNG& rng, const double* ekin,
+                                         const double* ux, const double* uy, const double* uz,
+                                         std::size_t N,
+                                         double* out_ekin, double* out_ux,
+                                         double* out_uy, double* out_uz ) const
+{
+  //Sample scattering angles in chunks, then rotate all directions at once:
+  auto& cache = accessCache<CachePowderBragg>(cp);
+  constexpr std::size_t nbuf = 256;
+  double mu[nbuf];
+  for ( std::size_t i0 = 0; i0 < N; i0 += nbuf ) {
+    const std::size_t n = std::min<std::size_t>( nbuf, N - i0 );
+    for ( std::size_t j = 0; j < n; ++j ) {
+      //elastic: ekin unchanged
+      NeutronEnergy e{ ekin[i0+j] };
+      out_ekin[i0+j] = e.dbl();
+      if ( e < m_threshold || !std::isfinite(e.dbl()) ) {
+        //scatterings not possible here (mu=1 passes directions through):
+        nc_assert( e.dbl()>=0.0 );
+        mu[j] = 1.0;
+        continue;
+      }
+      cache.ensureValid( e, [this]( NeutronEnergy ee ) { return findLastValidPlaneIdx(ee); } );
+      mu[j] = genScatterMu(rng,e,cache.lastValidPlaneIdx).dbl();
+    }
+    randDirectionsGivenScatterMu( rng, n, mu, ux + i0, uy + i0, uz + i0,
+                                  out_ux + i0, out_uy + i0, out_uz + i0 );
+  }
+}
+
+void NC::PowderBragg::evalXSAndSampleScatterMany( CachePtr& cp, RNG& rng, const double* ekin,
+                                                  const double* ux, const double* uy, const double* uz,
+                                                  std::size_t N, double* out_xs,
+                                                  double* out_ekin, double* out_ux,
+                                                  double* out_uy, double* out_uz ) const
+{
+  evalManyXSIsotropic( cp, ekin, N, out_xs );
+  sampleScatterMany( cp, rng, ekin, ux, uy, uz, N, out_ekin, out_ux, out_uy, out_uz );
+}
 #endif
@@ -28,10 +28,10 @@ namespace NC = NCrystal;
 namespace NCRYSTAL_NAMESPACE {
   namespace SAB {
 
-    //Cache key is (sabdata uid, egrid uid, sabdata ptr):
+    //Cache key is (sabdata uid, egrid uid, egrid tolerance, sabdata ptr):
     //TODO: we should use new thin-key support instead of these
     //shared_obj<const NC::SABData>* pointers!
-    typedef std::tuple<UniqueIDValue,UniqueIDValue,shared_obj<const NC::SABData>*> ScatHelperCacheKey;
+    typedef std::tuple<UniqueIDValue,UniqueIDValue,double,shared_obj<const NC::SABData>*> ScatHelperCacheKey;
 
     class ScatterHelperFactory : public NC::CachedFactoryBase<ScatHelperCacheKey,SABScatterHelper> {
     public:
@@ -39,16 +39,19 @@ namespace NCRYSTAL_NAMESPACE {
       std::string keyToString( const ScatHelperCacheKey& key ) const final
       {
         std::ostringstream ss;
-        ss<<"(SABData id="<<std::get<0>(key).value<<";egrid id="<<std::get<1>(key).value<<")";
+        ss<<"(SABData id="<<std::get<0>(key).value<<";egrid id="<<std::get<1>(key).value;
+        if ( std::get<2>(key) > 0.0 )
+          ss<<";egridtol="<<std::get<2>(key);
+        ss<<")";
         return ss.str();
       }
     protected:
       virtual ShPtr actualCreate( const ScatHelperCacheKey& key ) const final
       {
-        auto sabdata_shptr = *std::get<2>(key);
+        auto sabdata_shptr = *std::get<3>(key);
         nc_assert( sabdata_shptr->getUniqueID() == std::get<0>(key) );
         auto egrid_shptr = egridFromUniqueID(std::get<1>(key));
-        return createScatterHelper(std::move(sabdata_shptr),std::move(egrid_shptr));
+        return createScatterHelper(std::move(sabdata_shptr),std::move(egrid_shptr),std::get<2>(key));
       }
     };
 
@@ -57,10 +60,12 @@ namespace NCRYSTAL_NAMESPACE {
 }
 
 std::unique_ptr<const NC::SAB::SABScatterHelper> NC::SAB::createScatterHelper( shared_obj<const NC::SABData> data,
-                                                                               std::shared_ptr<const VectD> energyGrid )
+                                                                               std::shared_ptr<const VectD> energyGrid,
+                                                                               double egridTolerance )
 {
   nc_assert(!!data);
   SABIntegrator si(data,energyGrid.get());
+  si.setEGridTolerance( egridTolerance );
   auto sh = si.createScatterHelper();
   return std::make_unique<SABScatterHelper>(std::move(sh));
 }
@@ -70,12 +75,14 @@ void NC::SAB::clearScatterHelperCache() {
 }
 
 NC::shared_obj<const NC::SAB::SABScatterHelper> NC::SAB::createScatterHelperWithCache( shared_obj<const NC::SABData> dataptr,
-                                                                                       std::shared_ptr<const VectD> egrid )
+                                                                                       std::shared_ptr<const VectD> egrid,
+                                                                                       double egridTolerance )
 {
   nc_assert_always(!!dataptr);
 
   ScatHelperCacheKey key( dataptr->getUniqueID(),
                           egridToUniqueID( egrid ),
+                          egridTolerance,
                           &dataptr );
 
   return s_scathelperfact.create(key);
@@ -22,6 +22,7 @@
 #include "NCrystal/internal/sab/NCSABSamplerModels.hh"
 #include "NCrystal/internal/sab/NCSABUtils.hh"
 #include "NCrystal/internal/fact_utils/NCFactoryUtils.hh"
+#include "NCrystal/internal/fact_utils/NCFactoryJobs.hh"
 #include "NCrystal/internal/utils/NCIter.hh"
 #include "NCrystal/internal/utils/NCString.hh"
 #include "NCrystal/internal/utils/NCMsg.hh"
@@ -37,11 +38,12 @@ struct NC::SAB::SABIntegrator::Impl : private NoCopyMove {
   void doit(SABXSProvider *, SABSampler*, Optional<std::string>*);
   double determineEMax( const double ) const;
   double determineEMin( const double ) const;
-  void setupEnergyGrid();
+  unsigned setupEnergyGrid();
 
   //Input data:
   shared_obj<const SABData> m_data;
   VectD m_egrid;
+  bool m_hasDefaultExtender;
   std::shared_ptr<const SABExtender> m_extender;
 
   //Data derived from m_data:
@@ -49,6 +51,8 @@ struct NC::SAB::SABIntegrator::Impl : private NoCopyMove {
 
   //Setting;
   SABSampler::EGridMargin m_egridMargin;
+  bool m_compactSamplers;
+  double m_egridTolerance = 0.0;
 
   typedef std::unique_ptr<SABSamplerAtE> SamplerAtE_uptr;
   std::pair<SamplerAtE_uptr,double> analyseEnergyPoint(double ekin, bool doSampler ) const;
@@ -58,6 +62,18 @@ struct NC::SAB::SABIntegrator::Impl : private NoCopyMove {
     return analyseEnergyPoint( ekin, false ).second;
   }
 
+  void analyseEnergyPoints( const VectD& energies, bool doSampler, VectD& xsvals, std::vector<SamplerAtE_uptr>& ) const;
+  void analyseAllEnergyPoints( bool doSampler, VectD& xsvals, std::vector<SamplerAtE_uptr>& samplers ) const
+  {
+    analyseEnergyPoints( m_egrid, doSampler, xsvals, samplers );
+  }
+  void analyseAdaptiveEnergyPoints( unsigned refineStep, bool doSampler, VectD& xsvals, std::vector<SamplerAtE_uptr>& );
+
+  //Persistent cache support (serialisation returns false for unsupported
+  //sampler types):
+  bool serialiseResults( PersistentCache::Writer&, const VectD& xsvals, const std::vector<SamplerAtE_uptr>& ) const;
+  void deserialiseResults( PersistentCache::Reader&, bool doSampler, VectD& xsvals, std::vector<SamplerAtE_uptr>& );
+
 };
 
 NS::SABIntegrator::~SABIntegrator() = default;
@@ -69,6 +85,18 @@ NS::SABIntegrator::SABIntegrator( shared_obj<const SABData> data,
 {
 }
 
+void NS::SABIntegrator::setCompactSamplers( bool b )
+{
+  m_impl->m_compactSamplers = b;
+}
+
+void NS::SABIntegrator::setEGridTolerance( double tol )
+{
+  if ( !( tol >= 0.0 ) || !( tol < 1.0 ) )
+    NCRYSTAL_THROW2(BadInput,"SABIntegrator invalid energy grid tolerance: "<<tol);
+  m_impl->m_egridTolerance = tol;
+}
+
 void NS::SABIntegrator::doit(SABXSProvider * out_xs, SABSampler* out_sampler, Optional<std::string>* json)
 {
   m_impl->doit(out_xs,out_sampler,json);
@@ -79,8 +107,10 @@ NS::SABIntegrator::Impl::Impl( shared_obj<const SABData> data,
                                std::shared_ptr<const SABExtender> sabextender )
   : m_data(std::move(data)),
     m_egrid((egrid&&!egrid->empty())?*egrid:VectD()),
+    m_hasDefaultExtender(!sabextender),
     m_extender(!sabextender?std::make_unique<SABFGExtender>(m_data->temperature(),m_data->elementMassAMU(),m_data->boundXS()):std::move(sabextender)),
-    m_egridMargin{ 1.05 }
+    m_egridMargin{ 1.05 },
+    m_compactSamplers( []() { static bool s_compact = ncgetenv_bool("SAB_COMPACT"); return s_compact; }() )
 {
 }
 
@@ -196,9 +226,14 @@ double NS::SABIntegrator::Impl::determineEMax(const double eUpperLimit) const
   return 0.0;
 }
 
-void NS::SABIntegrator::Impl::setupEnergyGrid()
+unsigned NS::SABIntegrator::Impl::setupEnergyGrid()
 {
   //Three numbers: emin (-1 means auto), emax (-1 means auto), npts (-1 means auto).
+  //
+  //Returns the refinement step for adaptive grids (see
+  //analyseAdaptiveEnergyPoints), or 0 if the grid is fixed.
+
+  unsigned refineStep = 0;
 
   if (m_egrid.size()>3) {
     //assume user already passed in a correct grid
@@ -266,6 +301,16 @@ void NS::SABIntegrator::Impl::setupEnergyGrid()
     nc_assert_always(emin>0.0);
     nc_assert_always(emax>emin);
     nc_assert_always(npts>=2);
+    if ( m_egridTolerance > 0.0 && npts >= 10 ) {
+      //Adaptive mode. The initial coarse grid consists of every refineStep'th
+      //point of a fine grid with at most npts points (so the adaptive grid is
+      //never finer than the non-adaptive one), and must have at least 10
+      //points itself:
+      refineStep = 16;
+      while ( refineStep > 1 && ( npts - 1 ) / refineStep < 9 )
+        refineStep /= 2;
+      npts = refineStep * ( ( npts - 1 ) / refineStep ) + 1;
+    }
     m_egrid = NC::geomspace(emin,emax,npts);
   }
 
@@ -275,6 +320,274 @@ void NS::SABIntegrator::Impl::setupEnergyGrid()
   if ( !(m_egrid.front()>0.0) || !nc_is_grid(m_egrid) )
     NCRYSTAL_THROW(BadInput,"SABIntegrator invalid energy grid - must be sorted with non-repeated and positive values.");
 
+  return refineStep;
+}
+
+namespace NCRYSTAL_NAMESPACE {
+  namespace SAB {
+    namespace {
+      //Number of energy points analysed per (potentially concurrent) job:
+      constexpr std::size_t egrid_chunksize = 8;
+    }
+  }
+}
+
+void NS::SABIntegrator::Impl::analyseEnergyPoints( const VectD& energies,
+                                                   bool doSampler,
+                                                   VectD& xsvals,
+                                                   std::vector<SamplerAtE_uptr>& samplers ) const
+{
+  //Analyse all energy points. They are independent, so we process them in
+  //chunks which might run concurrently via FactoryJobs. Results are stored by
+  //index (and any exceptions rethrown in chunk order), so the outcome does not
+  //depend on the number of threads used:
+  const std::size_t npts = energies.size();
+  samplers.clear();
+  samplers.resize( doSampler ? npts : 0 );
+  xsvals.assign( npts, 0.0 );
+  const std::size_t nchunks = ( npts + egrid_chunksize - 1 ) / egrid_chunksize;
+  std::vector<std::exception_ptr> chunkErrors( nchunks );
+  {
+    FactoryJobs jobs;
+    for ( auto ichunk : ncrange( nchunks ) ) {
+      jobs.queue( [this,ichunk,npts,doSampler,&energies,&samplers,&xsvals,&chunkErrors]()
+      {
+        try {
+          const std::size_t iend = std::min<std::size_t>( npts, ( ichunk + 1 ) * egrid_chunksize );
+          for ( std::size_t i = ichunk * egrid_chunksize; i < iend; ++i ) {
+            const double energy = energies[i];
+            nc_assert(energy>0.0);
+            auto sampleruptr_and_xs = analyseEnergyPoint( energy, doSampler );
+            if ( doSampler )
+              samplers[i] = std::move(sampleruptr_and_xs.first);
+            xsvals[i] = sampleruptr_and_xs.second;
+          }
+        } catch ( ... ) {
+          chunkErrors[ichunk] = std::current_exception();
+        }
+      } );
+    }
+    jobs.waitAll();
+  }
+  for ( auto& e : chunkErrors )
+    if ( e )
+      std::rethrow_exception( e );
+}
+
+void NS::SABIntegrator::Impl::analyseAdaptiveEnergyPoints( unsigned refineStep,
+                                                           bool doSampler,
+                                                           VectD& xsvals,
+                                                           std::vector<SamplerAtE_uptr>& samplers )
+{
+  //Adaptive selection of points from the fine grid in m_egrid. Starting with
+  //every refineStep'th point, intervals are repeatedly bisected (in index
+  //space, so midpoints are geometric midpoints). The midpoint and the quarter
+  //points of each interval are analysed (a single midpoint can miss kinks near
+  //the interval edges). If the cross sections at these points are reproduced
+  //by linear interpolation within the tolerance, and sampling at the lower
+  //edge with the tables of the upper edge is reasonably efficient, the
+  //interior points are discarded and the interval is final. Otherwise both
+  //halves are processed further (their midpoints being the quarter points
+  //already analysed), until the resolution of the fine grid is reached. All
+  //points needed at a given refinement level are analysed together (possibly
+  //concurrently).
+  nc_assert_always( refineStep >= 1 && ( refineStep & ( refineStep - 1 ) ) == 0 );
+  const VectD& finegrid = m_egrid;
+  nc_assert_always( finegrid.size() >= 10 && ( finegrid.size() - 1 ) % refineStep == 0 );
+
+  struct PointResult {
+    double xs;
+    SamplerAtE_uptr sampler;
+  };
+  std::map<std::size_t,PointResult> results;//fine grid index -> result
+  auto analyseIndices = [this,&finegrid,doSampler,&results]( const std::vector<std::size_t>& indices )
+  {
+    VectD energies, xs;
+    std::vector<SamplerAtE_uptr> smplrs;
+    energies.reserve( indices.size() );
+    for ( auto idx : indices )
+      energies.push_back( finegrid.at( idx ) );
+    analyseEnergyPoints( energies, doSampler, xs, smplrs );
+    for ( auto i : ncrange( indices.size() ) )
+      results[indices[i]] = PointResult{ xs[i], doSampler ? std::move(smplrs[i]) : nullptr };
+  };
+
+  //Initial coarse grid:
+  std::vector<std::pair<std::size_t,std::size_t>> intervals;
+  {
+    std::vector<std::size_t> indices;
+    for ( std::size_t i = 0; i < finegrid.size(); i += refineStep ) {
+      indices.push_back( i );
+      if ( i > 0 && refineStep > 1 )
+        intervals.emplace_back( i - refineStep, i );
+    }
+    analyseIndices( indices );
+  }
+
+  //Sampling at energy E with tables prepared at energy E'>E uses rejection
+  //sampling with an acceptance rate of roughly E*xs(E)/(E'*xs(E')). Keep that
+  //above:
+  constexpr double minAcceptance = 0.5;
+  const double tol = m_egridTolerance;
+  std::size_t nanalysed = results.size();
+
+  while ( !intervals.empty() ) {
+    std::vector<std::size_t> needed;
+    for ( auto& iv : intervals ) {
+      const std::size_t width = iv.second - iv.first;
+      for ( std::size_t i = 1; i < 4; ++i ) {
+        if ( width < 4 && i != 2 )
+          continue;
+        const std::size_t idx = iv.first + ( i * width ) / 4;
+        if ( !results.count( idx ) )
+          needed.push_back( idx );
+      }
+    }
+    analyseIndices( needed );
+    nanalysed += needed.size();
+    std::vector<std::pair<std::size_t,std::size_t>> next_intervals;
+    for ( auto& iv : intervals ) {
+      const double ea = finegrid[iv.first];
+      const double eb = finegrid[iv.second];
+      const double xa = results.at( iv.first ).xs;
+      const double xb = results.at( iv.second ).xs;
+      auto itB = results.upper_bound( iv.first );
+      auto itE = results.lower_bound( iv.second );
+      bool accept = ( ea * xa >= minAcceptance * eb * xb );
+      for ( auto it = itB; accept && it != itE; ++it ) {
+        const double e = finegrid[it->first];
+        const double x = it->second.xs;
+        const double x_interp = xa + ( xb - xa ) * ( e - ea ) / ( eb - ea );
+        accept = ncabs( x - x_interp ) <= tol * ncabs( x );
+      }
+      if ( accept ) {
+        results.erase( itB, itE );
+        continue;
+      }
+      const std::size_t im = ( iv.first + iv.second ) / 2;
+      if ( im - iv.first > 1 ) {
+        next_intervals.emplace_back( iv.first, im );
+        next_intervals.emplace_back( im, iv.second );
+      }
+    }
+    intervals.swap( next_intervals );
+  }
+
+  //Collect results:
+  VectD egrid;
+  egrid.reserve( results.size() );
+  xsvals.clear();
+  xsvals.reserve( results.size() );
+  samplers.clear();
+  if ( doSampler )
+    samplers.reserve( results.size() );
+  for ( auto& e : results ) {
+    egrid.push_back( finegrid[e.first] );
+    xsvals.push_back( e.second.xs );
+    if ( doSampler )
+      samplers.push_back( std::move( e.second.sampler ) );
+  }
+
+  static bool s_verbose = ncgetenv_bool("DEBUG_SAB");
+  if ( s_verbose )
+    NCRYSTAL_MSG("SABIntegrator: adaptive energy grid (tolerance "<<tol<<") has "
+                 <<egrid.size()<<" points (analysed "<<nanalysed<<" of "
+                 <<finegrid.size()<<" candidate points)");
+  m_egrid = std::move( egrid );
+}
+
+bool NS::SABIntegrator::Impl::serialiseResults( PersistentCache::Writer& w,
+                                                const VectD& xsvals,
+                                                const std::vector<SamplerAtE_uptr>& samplers ) const
+{
+  w.addVect( m_egrid );
+  w.addVect( xsvals );
+  w.addU64( samplers.size() );
+  for ( const auto& sampler : samplers ) {
+    if ( dynamic_cast<const SABSamplerAtE_NoScatter*>( sampler.get() ) ) {
+      w.addU64( 0 );
+      continue;
+    }
+    auto alg1 = dynamic_cast<const SABSamplerAtE_Alg1*>( sampler.get() );
+    if ( !alg1 || alg1->isCompact() )
+      return false;//unknown sampler type (or reduced precision)
+    w.addU64( 1 );
+    w.addU64( alg1->ibetaOffset() );
+    w.addDbl( alg1->firstBinKinematicEndpointValue() );
+    w.addVect( alg1->betaSampler().getXVals() );
+    w.addVect( alg1->betaSampler().getYVals() );
+    w.addVect( alg1->betaSampler().getCDF() );
+    w.addU64( alg1->alphaSampleInfos().size() );
+    for ( const auto& info : alg1->alphaSampleInfos() ) {
+      for ( const auto* pt : { &info.pt_front, &info.pt_back } ) {
+        w.addDbl( pt->alpha );
+        w.addDbl( pt->sval );
+        w.addDbl( pt->logsval );
+        w.addU64( pt->alpha_idx );
+      }
+      w.addDbl( info.prob_front );
+      w.addDbl( info.prob_notback );
+    }
+  }
+  return true;
+}
+
+void NS::SABIntegrator::Impl::deserialiseResults( PersistentCache::Reader& r,
+                                                  bool doSampler,
+                                                  VectD& xsvals,
+                                                  std::vector<SamplerAtE_uptr>& samplers )
+{
+  auto invalid = []() { NCRYSTAL_THROW(DataLoadError,"Invalid SAB integration results"); };
+  VectD egrid = r.getVect();
+  xsvals = r.getVect();
+  if ( egrid.size() < 10 || !( egrid.front() > 0.0 ) || !nc_is_grid( egrid )
+       || xsvals.size() != egrid.size() )
+    invalid();
+  const std::size_t nsamplers = r.getSize( sizeof(std::uint64_t) );
+  if ( nsamplers != ( doSampler ? egrid.size() : 0 ) )
+    invalid();
+  const std::size_t nalpha = m_data->alphaGrid().size();
+  const std::size_t nbeta = m_data->betaGrid().size();
+  samplers.clear();
+  samplers.reserve( nsamplers );
+  for ( std::size_t i = 0; i < nsamplers; ++i ) {
+    const std::uint64_t type = r.getU64();
+    if ( type == 0 ) {
+      samplers.emplace_back( std::make_unique<SABSamplerAtE_NoScatter>() );
+      continue;
+    }
+    if ( type != 1 )
+      invalid();
+    const std::uint64_t ibetaOffset = r.getU64();
+    const double firstBinKinematicEndpointValue = r.getDbl();
+    VectD x = r.getVect();
+    VectD y = r.getVect();
+    VectD cdf = r.getVect();
+    const std::size_t ninfos = r.getSize( 10*sizeof(double) );
+    if ( x.size() != ninfos + 1 || ibetaOffset > nbeta || ibetaOffset + x.size() != nbeta + 1 )
+      invalid();
+    std::vector<SABSamplerAtE_Alg1::AlphaSampleInfo> infos( ninfos );
+    for ( auto& info : infos ) {
+      for ( auto* pt : { &info.pt_front, &info.pt_back } ) {
+        pt->alpha = r.getDbl();
+        pt->sval = r.getDbl();
+        pt->logsval = r.getDbl();
+        const std::uint64_t alpha_idx = r.getU64();
+        if ( alpha_idx >= nalpha )
+          invalid();
+        pt->alpha_idx = static_cast<unsigned>( alpha_idx );
+      }
+      info.prob_front = r.getDbl();
+      info.prob_notback = r.getDbl();
+    }
+    PointwiseDist betaSampler( PointwiseDist::internal_state_t(), std::move(x), std::move(y), std::move(cdf) );
+    samplers.emplace_back( std::make_unique<SABSamplerAtE_Alg1>( m_derivedData,
+                                                                 std::move(betaSampler),
+                                                                 std::move(infos),
+                                                                 static_cast<std::size_t>( ibetaOffset ),
+                                                                 firstBinKinematicEndpointValue ) );
+  }
+  m_egrid = std::move(egrid);
 }
 
 void NS::SABIntegrator::Impl::doit(SABXSProvider * out_xs, SABSampler* out_sampler, Optional<std::string>* json)
@@ -285,30 +598,78 @@ void NS::SABIntegrator::Impl::doit(SABXSProvider * out_xs, SABSampler* out_sampl
 
   const bool doSampler = out_sampler!=nullptr;
 
-  //Prepare and validate energy grid:
-  setupEnergyGrid();
-
-  SABSampler::SABSamplerAtEList energyPointSamplers;
-  if ( doSampler )
-    energyPointSamplers.reserve_hint(m_egrid.size());
+  std::vector<SamplerAtE_uptr> samplers;
   VectD xsvals;
-  xsvals.reserve(m_egrid.size());
 
-  for (const auto& energy : m_egrid ) {
-    nc_assert(energy>0.0);
-    auto sampleruptr_and_xs =  analyseEnergyPoint(energy, doSampler );
-    if ( doSampler )
-      energyPointSamplers.emplace_back(std::move(sampleruptr_and_xs.first));
-    xsvals.emplace_back( sampleruptr_and_xs.second );
+  //Results for the default extender can be reused via the persistent cache (if
+  //enabled). The key is based on the input energy grid (before it is
+  //completed by setupEnergyGrid):
+  Optional<PersistentCache::Key> pckey;
+  if ( m_hasDefaultExtender && PersistentCache::isEnabled() ) {
+    PersistentCache::Key key("sabinteg");
+    SABUtils::addToPersistentCacheKey( key, *m_data );
+    key.addVect( m_egrid )
+      .addDbl( m_egridMargin.value )
+      .addDbl( m_egridTolerance )
+      .addU64( doSampler ? 1 : 0 );
+    pckey = key;
+  }
+
+  if ( !pckey.has_value()
+       || !PersistentCache::load( pckey.value(),
+                                  [this,doSampler,&xsvals,&samplers]( PersistentCache::Reader& r )
+                                  { this->deserialiseResults( r, doSampler, xsvals, samplers ); } ) )
+  {
+    //Prepare and validate energy grid:
+    const unsigned refineStep = setupEnergyGrid();
+
+    //Do the actual work:
+    if ( refineStep > 0 )
+      analyseAdaptiveEnergyPoints( refineStep, doSampler, xsvals, samplers );
+    else
+      analyseAllEnergyPoints( doSampler, xsvals, samplers );
+
+    if ( pckey.has_value() ) {
+      PersistentCache::Writer w;
+      if ( serialiseResults( w, xsvals, samplers ) )
+        PersistentCache::store( pckey.value(), w );
+    }
+  }
+
+  const std::size_t npts = m_egrid.size();
+  nc_assert_always( xsvals.size() == npts );
+
+  //Optionally reduce memory usage of sampling tables (only done after storing
+  //full precision results in the persistent cache above):
+  std::size_t ncompact = 0;
+  if ( doSampler && m_compactSamplers ) {
+    for ( auto& e : samplers ) {
+      auto alg1 = dynamic_cast<SABSamplerAtE_Alg1*>( e.get() );
+      if ( alg1 && alg1->compactify() )
+        ++ncompact;
+    }
+  }
+
+  SABSampler::SABSamplerAtEList energyPointSamplers;
+  if ( doSampler ) {
+    energyPointSamplers.reserve_hint(npts);
+    for ( auto& e : samplers )
+      energyPointSamplers.emplace_back( std::move(e) );
   }
 
   energyPointSamplers.shrink_to_fit();
 
-  if ( doSampler )
+  if ( doSampler ) {
     out_sampler->setData( m_data->temperature(),
                           VectD(m_egrid.begin(),m_egrid.end()),
                           std::move(energyPointSamplers),
                           m_extender, xsvals.back(), m_egridMargin );
+    static bool s_verbose = ncgetenv_bool("DEBUG_SAB");
+    if ( s_verbose )
+      NCRYSTAL_MSG("SABIntegrator: sampling tables at "<<npts<<" energy points use "
+                   <<out_sampler->memoryUsage()*1e-6<<"MB"
+                   <<" (compact tables at "<<ncompact<<" of these)");
+  }
   if ( out_xs )
     out_xs->setData( VectD(m_egrid.begin(),m_egrid.end()),
                      std::move(xsvals),
@@ -323,6 +684,10 @@ void NS::SABIntegrator::Impl::doit(SABXSProvider * out_xs, SABSampler* out_sampl
       tmp << ";T="<<m_data->temperature();
       tmp << ";M="<<m_data->elementMassAMU();
       tmp << ";sigma_free="<<m_data->boundXS().free(m_data->elementMassAMU());
+      if ( doSampler && m_compactSamplers )
+        tmp << ";compactsampler";
+      if ( m_egridTolerance > 0.0 )
+        tmp << ";egridtol="<<m_egridTolerance;
       streamJSONDictEntry( ss, "summarystr", tmp.str(), JSONDictPos::FIRST );
     }
     streamJSONDictEntry( ss, "Emax", m_egrid.back()  );
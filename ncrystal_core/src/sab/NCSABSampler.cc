@@ -46,6 +46,7 @@ void NC::SABSampler::setData( Temperature temperature,
                               EGridMargin egridMargin )
 {
   m_egrid = std::move(egrid);
+  m_egridIndex = LogGridIndex( m_egrid );
   m_samplers = std::move(samplers);
   m_kT = temperature.kT();
   m_extender = std::move(extender);
@@ -56,6 +57,14 @@ void NC::SABSampler::setData( Temperature temperature,
   m_egridMargin = egridMargin;
 }
 
+std::size_t NC::SABSampler::memoryUsage() const
+{
+  std::size_t res = sizeof(*this) + m_egrid.capacity() * sizeof(double);
+  for ( const auto& s : m_samplers )
+    res += s->memoryUsage();
+  return res;
+}
+
 NC::PairDD NC::SABSampler::sampleHighE(NeutronEnergy ekin, RNG& rng) const
 {
   const double emax = m_egrid.back();
@@ -162,7 +171,8 @@ NC::PairDD NC::SABSampler::sampleAlphaBeta(NeutronEnergy ekin, RNG& rng) const
 
   decltype(m_samplers.begin()) itSampler;
 
-  auto itEkinUpper = std::upper_bound ( m_egrid.begin(), m_egrid.end(), ekin.dbl() );
+  auto itEkinUpper = std::next( m_egrid.begin(), m_egridIndex.upperBoundIdx( m_egrid, ekin.dbl() ) );
+  nc_assert( itEkinUpper == std::upper_bound( m_egrid.begin(), m_egrid.end(), ekin.dbl() ) );
 
   bool ultra_small_ekin_mode = false;
   const double ultra_small_ekin = m_egrid.front();
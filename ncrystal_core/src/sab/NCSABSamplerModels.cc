@@ -31,8 +31,8 @@ NC::SAB::SABSamplerAtE_Alg1::SABSamplerAtE_Alg1( std::shared_ptr<const CommonCac
                                                  std::size_t ibetaOffset,
                                                  double firstBinKinematicEndpointValue )
   : m_common( std::move(common) ),
-    m_betaSampler(VectD(betaVals.begin(),betaVals.end()),//todo: in principle no need to copy here.
-                  VectD(betaWeights.begin(),betaWeights.end()) ),
+    m_betaSampler( PointwiseDist( VectD(betaVals.begin(),betaVals.end()),//todo: in principle no need to copy here.
+                                  VectD(betaWeights.begin(),betaWeights.end()) ) ),
     m_alphaSamplerInfos( std::move(alphaSamplerInfos) ),
     m_ibetaOffset( ibetaOffset ),
     m_firstBinKinematicEndpointValue(firstBinKinematicEndpointValue)
@@ -45,6 +45,181 @@ NC::SAB::SABSamplerAtE_Alg1::SABSamplerAtE_Alg1( std::shared_ptr<const CommonCac
   nc_assert( ibetaOffset+betaVals.size() == m_common->data->betaGrid().size()+1 );
 }
 
+NC::SAB::SABSamplerAtE_Alg1::SABSamplerAtE_Alg1( std::shared_ptr<const CommonCache> common,
+                                                 PointwiseDist&& betaSampler,
+                                                 std::vector<AlphaSampleInfo>&& alphaSamplerInfos,
+                                                 std::size_t ibetaOffset,
+                                                 double firstBinKinematicEndpointValue )
+  : m_common( std::move(common) ),
+    m_betaSampler( std::move(betaSampler) ),
+    m_alphaSamplerInfos( std::move(alphaSamplerInfos) ),
+    m_ibetaOffset( ibetaOffset ),
+    m_firstBinKinematicEndpointValue(firstBinKinematicEndpointValue)
+{
+  nc_assert( !!m_common );
+  nc_assert( m_alphaSamplerInfos.size()+1 == m_betaSampler.value().getXVals().size() );
+  nc_assert( ibetaOffset+m_betaSampler.value().getXVals().size() == m_common->data->betaGrid().size()+1 );
+}
+
+std::size_t NC::SAB::SABSamplerAtE_Alg1::betaSamplerNVals() const
+{
+  return m_compact ? m_compact->cdf.size() : m_betaSampler.value().getXVals().size();
+}
+
+double NC::SAB::SABSamplerAtE_Alg1::betaSamplerXVal( std::size_t i ) const
+{
+  if ( !m_compact )
+    return vectAt( m_betaSampler.value().getXVals(), i );
+  nc_assert( i < m_compact->cdf.size() );
+  return i ? vectAt( m_common->data->betaGrid(), m_ibetaOffset + i - 1 ) : m_compact->beta_first;
+}
+
+std::pair<double,unsigned> NC::SAB::SABSamplerAtE_Alg1::sampleBetaWithIndex( double p ) const
+{
+  if ( !m_compact )
+    return m_betaSampler.value().percentileWithIndex( p );
+
+  //Same algorithm as in PointwiseDist::percentileWithIndex, but using the
+  //compact tables:
+  nc_assert(p>=0.&&p<=1.0);
+  const auto& cdf = m_compact->cdf;
+  const auto& y = m_compact->y;
+  const std::size_t n = cdf.size();
+  if ( p == 1. )
+    return { betaSamplerXVal( n-1 ), static_cast<unsigned>( n-2 ) };
+  auto cdfLessThan = []( float encoded_cdf, double pp ) { return CompactTables::decodeCDF( encoded_cdf ) < pp; };
+  std::size_t i = std::max<std::size_t>(std::min<std::size_t>(std::lower_bound(cdf.begin(), cdf.end(), p, cdfLessThan)-cdf.begin(),n-1),1);
+  nc_assert( i>0 && i < n );
+  const double x0 = betaSamplerXVal( i-1 );
+  const double x1 = betaSamplerXVal( i );
+  double dx = x1-x0;
+  double c = ncmax( 0.0, p - CompactTables::decodeCDF( cdf[i-1] ) );
+  double a = y[i-1];
+  double d = double(y[i]) - a;
+  double zdx;
+  if (!a) {
+    zdx = d>0.0 ? std::sqrt( ( 2.0 * c * dx ) / d ) : 0.5*dx;
+  } else {
+    double e = d * c / ( dx * a * a );
+    if (ncabs(e)>1e-7) {
+      zdx = ( std::sqrt( 1.0 + 2.0 * e ) - 1.0 ) * dx * a / d;
+    } else {
+      zdx = ( 1 + 0.5 * e * ( e - 1.0 ) ) * c / a;
+    }
+  }
+  return { ncclamp(x0 + zdx,x0,x1), static_cast<unsigned>( i-1 ) };
+}
+
+float NC::SAB::SABSamplerAtE_Alg1::CompactTables::encodeCDF( double cdf )
+{
+  return ( cdf < 0.5
+           ? static_cast<float>( cdf )
+           : -static_cast<float>( 1.0 - cdf ) );
+}
+
+double NC::SAB::SABSamplerAtE_Alg1::CompactTables::decodeCDF( float v )
+{
+  return std::signbit( v ) ? 1.0 + double(v) : double(v);
+}
+
+NC::SAB::SABSamplerAtE_Alg1::AlphaSampleInfo NC::SAB::SABSamplerAtE_Alg1::CompactTables::expand( std::size_t i ) const
+{
+  const auto& c = vectAt( infos, i );
+  AlphaSampleInfo info;
+  auto expandPt = []( AlphaSampleInfo::SAPoint& pt, double alpha, float logsval, std::uint32_t alpha_idx )
+  {
+    pt.alpha = alpha;
+    pt.alpha_idx = alpha_idx;
+    if ( std::isinf( logsval ) ) {
+      //Same lower limit as used in SABUtils::createTailedBreakdown:
+      pt.sval = 0.0;
+      pt.logsval = std::log( std::numeric_limits<double>::min() );
+    } else {
+      pt.logsval = logsval;
+      pt.sval = std::exp( pt.logsval );
+    }
+  };
+  expandPt( info.pt_front, c.alpha_front, c.logsval_front, c.alpha_idx_front );
+  expandPt( info.pt_back, c.alpha_back, c.logsval_back, c.alpha_idx_back );
+  info.prob_front = c.prob_front;
+  info.prob_notback = 1.0 - double(c.prob_back);
+  return info;
+}
+
+bool NC::SAB::SABSamplerAtE_Alg1::compactify()
+{
+  if ( m_compact )
+    return true;
+  const auto& bs = m_betaSampler.value();
+  const auto& xvals = bs.getXVals();
+  const auto& betaGrid = m_common->data->betaGrid();
+  const std::size_t n = xvals.size();
+  nc_assert_always( m_ibetaOffset + n == betaGrid.size() + 1 );
+  for ( std::size_t i = 1; i < n; ++i )
+    if ( xvals[i] != betaGrid[m_ibetaOffset + i - 1] )
+      return false;//beta values not shared with grid (unexpected)
+
+  auto ct = std::make_unique<CompactTables>();
+  ct->beta_first = xvals.front();
+  ct->cdf.reserve( n );
+  ct->y.reserve( n );
+  if ( bs.getCDF().back() != 1.0 )
+    return false;
+  for ( auto e : bs.getCDF() )
+    ct->cdf.push_back( CompactTables::encodeCDF( e ) );
+  for ( auto e : bs.getYVals() )
+    ct->y.push_back( static_cast<float>( e ) );
+  nc_assert( CompactTables::decodeCDF( ct->cdf.back() ) == 1.0 );
+
+  auto toFloatLogS = []( const AlphaSampleInfo::SAPoint& pt )
+  {
+    return pt.sval > 0.0 ? static_cast<float>( pt.logsval ) : -std::numeric_limits<float>::infinity();
+  };
+  ct->infos.reserve( m_alphaSamplerInfos.size() );
+  for ( const auto& info : m_alphaSamplerInfos ) {
+    CompactAlphaSampleInfo c;
+    c.alpha_front = info.pt_front.alpha;
+    c.alpha_back = info.pt_back.alpha;
+    c.logsval_front = toFloatLogS( info.pt_front );
+    c.logsval_back = toFloatLogS( info.pt_back );
+    c.alpha_idx_front = info.pt_front.alpha_idx;
+    c.alpha_idx_back = info.pt_back.alpha_idx;
+    c.prob_front = static_cast<float>( info.prob_front );
+    c.prob_back = static_cast<float>( 1.0 - info.prob_notback );
+    if ( c.prob_front == 1.0f && info.prob_front != 1.0 ) {
+      //Must not be confused with the special value 1.0 indicating narrow
+      //ranges:
+      c.prob_front = std::nextafter( 1.0f, 0.0f );
+    }
+    ct->infos.push_back( c );
+  }
+  ct->cdf.shrink_to_fit();
+  ct->y.shrink_to_fit();
+  ct->infos.shrink_to_fit();
+
+  m_compact = std::move(ct);
+  m_betaSampler.reset();
+  m_alphaSamplerInfos.clear();
+  m_alphaSamplerInfos.shrink_to_fit();
+  return true;
+}
+
+std::size_t NC::SAB::SABSamplerAtE_Alg1::memoryUsage() const
+{
+  std::size_t res = sizeof(*this);
+  res += m_alphaSamplerInfos.capacity() * sizeof(AlphaSampleInfo);
+  if ( m_betaSampler.has_value() ) {
+    const auto& bs = m_betaSampler.value();
+    res += ( bs.getXVals().capacity() + bs.getYVals().capacity() + bs.getCDF().capacity() ) * sizeof(double);
+  }
+  if ( m_compact ) {
+    res += sizeof(CompactTables);
+    res += ( m_compact->cdf.capacity() + m_compact->y.capacity() ) * sizeof(float);
+    res += m_compact->infos.capacity() * sizeof(CompactAlphaSampleInfo);
+  }
+  return res;
+}
+
 NC::PairDD NC::SAB::SABSamplerAtE_Alg1::sampleAlphaBeta(double ekin_div_kT, RNG&rng) const
 {
   nc_assert(!!m_common);
@@ -60,11 +235,11 @@ NC::PairDD NC::SAB::SABSamplerAtE_Alg1::sampleAlphaBeta(double ekin_div_kT, RNG&
   while (--iloopmax) {
     double beta;
     unsigned ibetaSampled;
-    std::tie(beta,ibetaSampled) = m_betaSampler.percentileWithIndex( rng() );
+    std::tie(beta,ibetaSampled) = sampleBetaWithIndex( rng() );
 
     nc_assert( !ncisnan(beta) );
     nc_assert( beta <= betaGrid.back() );
-    nc_assert( ibetaSampled < m_betaSampler.getXVals().size() );
+    nc_assert( ibetaSampled < betaSamplerNVals() );
 
     if ( ibetaSampled == 0 && m_firstBinKinematicEndpointValue <= 0.0 ) {
       //Resample the first starting at m_firstBinKinematicEndpointValue rather
@@ -75,10 +250,10 @@ NC::PairDD NC::SAB::SABSamplerAtE_Alg1::sampleAlphaBeta(double ekin_div_kT, RNG&
       //sampler. Beta is then sampled uniformly, and we discard values outside
       //the kinematic boundary.
       const double b0 = m_firstBinKinematicEndpointValue;
-      const double b1 = vectAt(m_betaSampler.getXVals(),1);
+      const double b1 = betaSamplerXVal(1);
       if ( b1 < -ekin_div_kT )
         continue;//reject no matter what
-      nc_assert( b0 > m_betaSampler.getXVals().at(0) );//because we moved m_betaSampler.getXVals()[0] down by 4/3*(b1-b0)
+      nc_assert( b0 > betaSamplerXVal(0) );//because we moved betaSamplerXVal(0) down by 4/3*(b1-b0)
       const double delta_beta = b1 - b0;
       nc_assert(delta_beta>0.0);
       double alphaval;
@@ -123,7 +298,7 @@ NC::PairDD NC::SAB::SABSamplerAtE_Alg1::sampleAlphaBeta(double ekin_div_kT, RNG&
     std::size_t ibeta;
 
     double rand_percentile = rng.generate();
-    nc_assert ( beta >= m_betaSampler.getXVals().at(1) );
+    nc_assert ( beta >= betaSamplerXVal(1) );
     ibeta = m_ibetaOffset + ibetaSampled;
     nc_assert( ibeta>0 );
     bl = betaGrid.at(ibeta-1);
@@ -157,7 +332,10 @@ NC::PairDD NC::SAB::SABSamplerAtE_Alg1::sampleAlphaBeta(double ekin_div_kT, RNG&
 double NC::SAB::SABSamplerAtE_Alg1::sampleAlpha(std::size_t ibeta, double rand_percentile) const
 {
   nc_assert( ibeta >= m_ibetaOffset );
-  const auto& info = vectAt(m_alphaSamplerInfos,ibeta-m_ibetaOffset);
+  AlphaSampleInfo expandedInfo;
+  if ( m_compact )
+    expandedInfo = m_compact->expand( ibeta-m_ibetaOffset );
+  const auto& info = ( m_compact ? expandedInfo : vectAt(m_alphaSamplerInfos,ibeta-m_ibetaOffset) );
 
   const auto& cd = m_common->data;
   auto nalpha = cd->alphaGrid().size();
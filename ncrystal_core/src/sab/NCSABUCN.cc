@@ -550,6 +550,7 @@ namespace NCRYSTAL_NAMESPACE {
         ShortStrDbl ucnthr_str;
         shared_obj<const SABData> sabData;
         UCNScatter_ThinnedKey thin() const { return {sabuid,ucnthr_str}; }
+        std::size_t shardHash() const { return static_cast<std::size_t>(sabuid.value); }
       };
       struct UCNScatter_KeyThinner {
         using key_type = UCNScatter_FullKey;
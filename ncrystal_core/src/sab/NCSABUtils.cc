@@ -631,3 +631,46 @@ NC::SABUtils::TailedBreakdown NC::SABUtils::createTailedBreakdown( const NC::Spa
                    : 0.0 );
   return tb;
 }
+
+void NC::SABUtils::addToPersistentCacheKey( PersistentCache::Key& key, const SABData& data )
+{
+  key.addVect( data.alphaGrid() )
+    .addVect( data.betaGrid() )
+    .addVect( data.sab() )
+    .addDbl( data.temperature().dbl() )
+    .addDbl( data.boundXS().dbl() )
+    .addDbl( data.elementMassAMU().dbl() )
+    .addDbl( data.suggestedEmax() );
+}
+
+void NC::SABUtils::serialiseSABData( PersistentCache::Writer& w, const SABData& data )
+{
+  w.addVect( data.alphaGrid() );
+  w.addVect( data.betaGrid() );
+  w.addVect( data.sab() );
+  w.addDbl( data.temperature().dbl() );
+  w.addDbl( data.boundXS().dbl() );
+  w.addDbl( data.elementMassAMU().dbl() );
+  w.addDbl( data.suggestedEmax() );
+}
+
+NC::SABData NC::SABUtils::deserialiseSABData( PersistentCache::Reader& r )
+{
+  VectD alphaGrid = r.getVect();
+  VectD betaGrid = r.getVect();
+  VectD sab = r.getVect();
+  const double temperature = r.getDbl();
+  const double boundXS = r.getDbl();
+  const double elementMass = r.getDbl();
+  const double suggestedEmax = r.getDbl();
+  if ( alphaGrid.size() < 2 || betaGrid.size() < 2
+       || alphaGrid.size() >= std::numeric_limits<std::uint16_t>::max()
+       || betaGrid.size() >= std::numeric_limits<std::uint16_t>::max()
+       || alphaGrid.size() * betaGrid.size() != sab.size()
+       || !( temperature > 0.0 ) || !( boundXS >= 0.0 ) || !( elementMass > 0.0 )
+       || !( suggestedEmax >= 0.0 ) )
+    NCRYSTAL_THROW(DataLoadError,"Invalid SABData");
+  return SABData( std::move(alphaGrid), std::move(betaGrid), std::move(sab),
+                  Temperature{ temperature }, SigmaBound{ boundXS },
+                  AtomMass{ elementMass }, suggestedEmax );
+}
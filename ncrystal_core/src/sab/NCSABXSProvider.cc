@@ -19,6 +19,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "NCrystal/internal/sab/NCSABXSProvider.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
 
 namespace NC = NCrystal;
 
@@ -42,6 +43,7 @@ void NC::SABXSProvider::setData( VectD&& egrid,
   nc_assert_always(!!m_extender);
   nc_assert_always(!m_egrid.empty());
   nc_assert_always(!m_xs.empty());
+  m_egridIndex = LogGridIndex( m_egrid );
 
   const double emax = m_egrid.back();
   const double extenderXS_emax = m_extender->crossSection(NeutronEnergy{emax}).dbl();
@@ -54,15 +56,39 @@ void NC::SABXSProvider::setData( VectD&& egrid,
 NC::CrossSect NC::SABXSProvider::crossSection( NeutronEnergy ekin ) const
 {
   nc_assert( ! m_xs.empty() && m_xs.size() == m_egrid.size() );
+  auto itEkinUpper = std::next( m_egrid.begin(), m_egridIndex.upperBoundIdx( m_egrid, ekin.dbl() ) );
+  nc_assert( itEkinUpper == std::upper_bound( m_egrid.begin(), m_egrid.end(), ekin.dbl() ) );
+  return CrossSect{ evalAt( itEkinUpper, ekin.dbl() ) };
+}
 
-  auto itEkinUpper = std::upper_bound ( m_egrid.begin(), m_egrid.end(), ekin.dbl() );
+void NC::SABXSProvider::evaluateMany( Span<const double> ekin, Span<double> tgt ) const
+{
+  nc_assert( ! m_xs.empty() && m_xs.size() == m_egrid.size() );
+  nc_assert_always( ekin.size() == tgt.size() );
+  auto itB = m_egrid.begin();
+  auto itE = m_egrid.end();
+  auto itUpper = itB;
+  auto itTgt = tgt.begin();
+  for ( auto e : ekin ) {
+    //Reuse interval [*(itUpper-1),*itUpper) if e is inside it, otherwise look
+    //up via the index:
+    if ( !( ( itUpper == itB || !( e < *std::prev(itUpper) ) )
+            && ( itUpper == itE || e < *itUpper ) ) )
+      itUpper = std::next( itB, m_egridIndex.upperBoundIdx( m_egrid, e ) );
+    nc_assert( itUpper == std::upper_bound( itB, itE, e ) );
+    *itTgt++ = evalAt( itUpper, e );
+  }
+}
+
+double NC::SABXSProvider::evalAt( VectD::const_iterator itEkinUpper, double ekin ) const
+{
   if ( itEkinUpper == m_egrid.end()) {
     //  integral_E(S) = (tableintegral_Emax(S)-extenderintegral_Emax(S))+extenderintegral_E(S)
     //  Now, in general XS(E) = [C/E] * integral_E(S),   C=sigmaB*kT/4. So:
     //    XS_E = [C/E] * integral_E(S)
     //            = [Emax/E]*([C/Emax]*tableintegral_Emax(S)-[C/Emax]*extenderintegral_Emax(S))+[C/E]*extenderintegral_E(S)
     //            = [Emax/E] *(tableXS_Emax-extenderXS_Emax) + extenderXS_E = k / E + extenderXS_E
-    return CrossSect{ m_kExtension / ekin.dbl() + m_extender->crossSection( ekin ).dbl() };
+    return m_kExtension / ekin + m_extender->crossSection( NeutronEnergy{ ekin } ).dbl();
   } else if ( itEkinUpper == m_egrid.begin() ) {
 
     //Energy is below lowest tabulated energy. At very small energies, the
@@ -77,7 +103,7 @@ NC::CrossSect NC::SABXSProvider::crossSection( NeutronEnergy ekin ) const
     //will decrease as 1/sqrt(E) for small energies (we have thus essentially
     //derived, or at least argued for, the "1/v law").
 
-    return CrossSect { ekin.dbl() > 0.0 ? std::sqrt( m_egrid.front() / ekin.dbl() ) * m_xs.front() : kInfinity };
+    return ekin > 0.0 ? std::sqrt( m_egrid.front() / ekin ) * m_xs.front() : kInfinity;
   } else {
     //linear interpolation in grid
     auto itEkinLower = std::prev(itEkinUpper);
@@ -86,10 +112,10 @@ NC::CrossSect NC::SABXSProvider::crossSection( NeutronEnergy ekin ) const
     const double dXS = *itXSUpper - *itXSLower;
     const double dEkin = *itEkinUpper - *itEkinLower;
     nc_assert(dEkin>0.0);
-    double xs = *itXSLower + dXS * ( ekin.dbl() - *itEkinLower ) / dEkin;
+    double xs = *itXSLower + dXS * ( ekin - *itEkinLower ) / dEkin;
     nc_assert(xs>=std::min<double>(*itXSLower,*itXSUpper));
     nc_assert(xs<=std::max<double>(*itXSLower,*itXSUpper));
-    return CrossSect{ xs };
+    return xs;
   }
 }
 
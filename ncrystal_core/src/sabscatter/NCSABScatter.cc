@@ -23,6 +23,7 @@
 #include "NCrystal/internal/dyninfoutils/NCDynInfoUtils.hh"
 #include "NCrystal/internal/sab/NCSABFactory.hh"
 #include "NCrystal/internal/utils/NCRandUtils.hh"
+#include "NCrystal/internal/utils/NCString.hh"
 #include "NCrystal/internal/vdos/NCVDOSToScatKnl.hh"
 namespace NC = NCrystal;
 
@@ -77,9 +78,11 @@ NC::SABScatter::SABScatter( SABData && sabdata_, const VectD& energyGrid )
 {
 }
 NC::SABScatter::SABScatter( shared_obj<const SABData> sabdata_shptr,
-                            std::shared_ptr<const VectD> egrid_shptr )
+                            std::shared_ptr<const VectD> egrid_shptr,
+                            double egridTolerance )
   : SABScatter( SAB::createScatterHelper( std::move(sabdata_shptr),
-                                          std::move(egrid_shptr) ) )
+                                          std::move(egrid_shptr),
+                                          egridTolerance ) )
 {
 }
 
@@ -100,3 +103,99 @@ NC::Optional<std::string> NC::SABScatter::specificJSONDescription() const
 {
   return m_sh->specificJSONDescription;
 }
+
+#ifdef NCRYSTAL_ALLOW_ABI_BREAKAGE
+void NC::SABScatter::evalManyXSIsotropic( CachePtr&, const double* ekin, std::size_t N, double* out_xs ) const
+{
+  m_sh->xsprovider.evaluateMany( Span<const double>( ekin, ekin + N ),
+                                 Span<double>( out_xs, out_xs + N ) );
+}
+
+void NC::SABScatter::sampleScatterMany( CachePtr&, RNG& rng, const double* ekin,
+                                        const double* ux, const double* uy, const double* uz,
+                                        std::size_t N,
+                                        double* out_ekin, double* out_ux,
+                                        double* out_uy, double* out_uz ) const
+{
+  //Sample energy transfers and scattering angles in chunks, then rotate all
+  //directions at once:
+  const auto& sampler = m_sh->sampler;
+  constexpr std::size_t nbuf = 256;
+  double mu[nbuf];
+  for ( std::size_t i0 = 0; i0 < N; i0 += nbuf ) {
+    const std::size_t n = std::min<std::size_t>( nbuf, N - i0 );
+    for ( std::size_t j = 0; j < n; ++j ) {
+      const double e = ekin[i0+j];
+      double delta_e;
+      std::tie(delta_e,mu[j]) = sampler.sampleDeltaEMu(NeutronEnergy{e}, rng);
+      nc_assert( mu[j] >= -1.0 && mu[j] <= 1.0 );
+      out_ekin[i0+j] = ncmax(0.0,e+delta_e);
+    }
+    randDirectionsGivenScatterMu( rng, n, mu, ux + i0, uy + i0, uz + i0,
+                                  out_ux + i0, out_uy + i0, out_uz + i0 );
+  }
+}
+
+void NC::SABScatter::evalXSAndSampleScatterMany( CachePtr& cp, RNG& rng, const double* ekin,
+                                                 const double* ux, const double* uy, const double* uz,
+                                                 std::size_t N, double* out_xs,
+                                                 double* out_ekin, double* out_ux,
+                                                 double* out_uy, double* out_uz ) const
+{
+  evalManyXSIsotropic( cp, ekin, N, out_xs );
+  sampleScatterMany( cp, rng, ekin, ux, uy, uz, N, out_ekin, out_ux, out_uy, out_uz );
+}
+#endif
+
+NC::SABTempInterpScatter::SABTempInterpScatter( Temperature T,
+                                                Temperature T_lo,
+                                                shared_obj<const SAB::SABScatterHelper> sh_lo,
+                                                Temperature T_hi,
+                                                shared_obj<const SAB::SABScatterHelper> sh_hi )
+  : m_temp(T), m_temp_lo(T_lo), m_temp_hi(T_hi),
+    m_sh_lo(std::move(sh_lo)), m_sh_hi(std::move(sh_hi))
+{
+  T.validate();
+  T_lo.validate();
+  T_hi.validate();
+  if ( !( T_lo.dbl() < T_hi.dbl() ) || !( T.dbl() >= T_lo.dbl() ) || !( T.dbl() <= T_hi.dbl() ) )
+    NCRYSTAL_THROW2(BadInput,"SABTempInterpScatter requires T_lo <= T <= T_hi and T_lo < T_hi"
+                    " (got T="<<T<<", T_lo="<<T_lo<<", T_hi="<<T_hi<<")");
+  m_w_hi = ( T.dbl() - T_lo.dbl() ) / ( T_hi.dbl() - T_lo.dbl() );
+  m_w_lo = 1.0 - m_w_hi;
+}
+
+NC::SABTempInterpScatter::~SABTempInterpScatter() = default;
+
+NC::CrossSect NC::SABTempInterpScatter::crossSectionIsotropic( CachePtr&, NeutronEnergy ekin ) const
+{
+  return CrossSect{ m_w_lo * m_sh_lo->xsprovider.crossSection(ekin).dbl()
+                    + m_w_hi * m_sh_hi->xsprovider.crossSection(ekin).dbl() };
+}
+
+NC::ScatterOutcomeIsotropic NC::SABTempInterpScatter::sampleScatterIsotropic( CachePtr&, RNG& rng, NeutronEnergy ekin ) const
+{
+  const double xs_lo = m_w_lo * m_sh_lo->xsprovider.crossSection(ekin).dbl();
+  const double xs_hi = m_w_hi * m_sh_hi->xsprovider.crossSection(ekin).dbl();
+  const double xs_tot = xs_lo + xs_hi;
+  const bool use_lo = ( xs_tot > 0.0 ? rng.generate() * xs_tot < xs_lo : m_w_lo >= m_w_hi );
+  const auto& sampler = ( use_lo ? m_sh_lo : m_sh_hi )->sampler;
+  double delta_e, mu;
+  std::tie(delta_e,mu) = sampler.sampleDeltaEMu(ekin, rng);
+  nc_assert( mu >= -1.0 && mu <= 1.0 );
+  return { NeutronEnergy{ncmax(0.0,ekin.get()+delta_e)}, CosineScatAngle{mu} };
+}
+
+NC::Optional<std::string> NC::SABTempInterpScatter::specificJSONDescription() const
+{
+  std::ostringstream ss;
+  {
+    std::ostringstream tmp;
+    tmp << "T="<<m_temp<<";T_lo="<<m_temp_lo<<";T_hi="<<m_temp_hi;
+    streamJSONDictEntry( ss, "summarystr", tmp.str(), JSONDictPos::FIRST );
+  }
+  streamJSONDictEntry( ss, "temperature", m_temp.dbl() );
+  streamJSONDictEntry( ss, "temperature_lo", m_temp_lo.dbl() );
+  streamJSONDictEntry( ss, "temperature_hi", m_temp_hi.dbl(), JSONDictPos::LAST );
+  return ss.str();
+}
@@ -27,6 +27,8 @@
 #include "NCrystal/internal/utils/NCString.hh"
 #include "NCrystal/internal/extd_utils/NCOrientUtils.hh"
 #include "NCrystal/internal/extd_utils/NCPlaneProvider.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
+#include "NCrystal/interfaces/NCCacheStats.hh"
 #include <functional>//std::greater
 namespace NC=NCrystal;
 
@@ -36,7 +38,7 @@ struct NC::SCBragg::pimpl {
   public:
     //A familiy is here taken to be all planes sharing d-spacing and fsquared.
 
-    std::vector<Vector> deminormals;
+    GaussMos::DemiNormals deminormals;
     double xsfact;// = fsquared / (unit_cell_volume * unit_cell_natoms)
     double inv2d;
 
@@ -60,16 +62,37 @@ struct NC::SCBragg::pimpl {
 
   pimpl( const NC::Info&, MosaicityFWHM, double dd,
          const SCOrientation&, PlaneProvider * plane_provider,
-         double prec, double ntrunc );
+         double prec, double ntrunc, unsigned ncacheentries );
 
   double setupFamilies( const Info& cinfo,
                         const RotMatrix& cry2lab,
                         PlaneProvider * plane_provider,
                         double V0numAtom );
 
-  class Cache : public CacheBase {
-  public:
-    void invalidateCache() override { ekin = -1.0; }
+  //Angular index of the lab-frame demi-normals of all families. The normals
+  //are binned in the cells of a cube-map, and for each cell we keep the
+  //(normalised) mean direction of its normals and the maximal angle between
+  //that direction and any of the normals. For a given neutron direction, this
+  //gives a range of possible angles between the neutron and the normals in a
+  //cell, from which we can in turn bound the range of d-spacings for which
+  //those normals can possibly be within the truncated mosaicity distribution
+  //of the Bragg cone. Entries in each cell are encoded as (famidx<<32)+idx,
+  //idx being the index into the deminormals of family number famidx, and are
+  //kept sorted. The index is not used for crystals with few normals, where it
+  //would not bring any benefit.
+  struct AngularIndexCell {
+    Vector center;
+    double radius;
+    std::vector<std::uint64_t> entries;
+  };
+  std::vector<AngularIndexCell> m_angidx;
+  void setupAngularIndex();
+  void collectCandidates( double wl, const Vector& dir,
+                          std::size_t nfam_max, std::vector<std::uint64_t>& ) const;
+
+  //The cache keeps the results for up to m_ncacheentries recent neutron states
+  //(least recently used entries are recycled first, reusing their buffers):
+  struct CacheEntry {
     //cache signature:
     double ekin = -1.0;//Start with invalid cache
     Vector dir;
@@ -77,11 +100,30 @@ struct NC::SCBragg::pimpl {
     double wl;
     VectD xs_commul;
     std::vector<GaussMos::ScatCache> scatcache;
+    //for LRU bookkeeping:
+    std::uint64_t lastused = 0;
+  };
+
+  class Cache : public CacheBase {
+  public:
+    void invalidateCache() override
+    {
+      for ( auto& e : entries ) {
+        e.ekin = -1.0;
+        e.lastused = 0;
+      }
+    }
+    std::vector<CacheEntry> entries;
+    std::uint64_t usecount = 0;
+    //work buffers for the angular index:
+    std::vector<std::uint64_t> candidates;
+    std::vector<std::uint32_t> famcandidates;
   };
 
-  void genScat( Cache&, RNG&, Vector& outdir ) const;
-  void updateCache( Cache&, NeutronEnergy, const Vector& ) const;
+  void genScat( const CacheEntry&, RNG&, Vector& outdir ) const;
+  const CacheEntry& updateCache( Cache&, NeutronEnergy, const Vector& ) const;
 
+  std::size_t m_ncacheentries;
   double m_threshold_ekin;
   std::vector<ReflectionFamily> m_reflfamilies;
   GaussMos m_gm;
@@ -89,12 +131,16 @@ struct NC::SCBragg::pimpl {
 
 NC::SCBragg::pimpl::pimpl(const NC::Info& cinfo, MosaicityFWHM mosaicity,
                           double dd, const SCOrientation& sco, PlaneProvider * plane_provider,
-                          double prec, double ntrunc)
-  : m_threshold_ekin(kInfinity),
+                          double prec, double ntrunc, unsigned ncacheentries)
+  : m_ncacheentries(ncacheentries),
+    m_threshold_ekin(kInfinity),
     m_gm(mosaicity,prec,ntrunc)
 {
   m_gm.setDSpacingSpread(dd);
 
+  if ( !( m_ncacheentries >= 1 && m_ncacheentries <= 1024 ) )
+    NCRYSTAL_THROW2(BadInput,"SCBragg: invalid number of cache entries requested: "<<m_ncacheentries);
+
   //Always needs structure info:
   if (!cinfo.hasStructureInfo())
     NCRYSTAL_THROW(MissingInfo,"Passed Info object lacks Structure information.");
@@ -108,6 +154,8 @@ NC::SCBragg::pimpl::pimpl(const NC::Info& cinfo, MosaicityFWHM mosaicity,
 
   m_threshold_ekin = wl2ekin(maxdsp * 2.0);
 
+  if ( !ncgetenv_bool("SCBRAGG_NOANGULARINDEX") )
+    setupAngularIndex();
 }
 
 NC::SCBragg::SCBragg( const NC::Info& cinfo,
@@ -115,8 +163,9 @@ NC::SCBragg::SCBragg( const NC::Info& cinfo,
                       MosaicityFWHM mosaicity,
                       double dd,
                       PlaneProvider * plane_provider,
-                      double prec, double ntrunc)
-  : m_pimpl(std::make_unique<pimpl>(cinfo,mosaicity,dd,sco,plane_provider,prec,ntrunc))
+                      double prec, double ntrunc,
+                      unsigned ncacheentries )
+  : m_pimpl(std::make_unique<pimpl>(cinfo,mosaicity,dd,sco,plane_provider,prec,ntrunc,ncacheentries))
 {
 }
 
@@ -221,7 +270,127 @@ double NC::SCBragg::pimpl::setupFamilies( const NC::Info& cinfo,
 }
 
 
+void NC::SCBragg::pimpl::setupAngularIndex()
+{
+  nc_assert(m_angidx.empty());
+  std::size_t ntot(0);
+  for ( auto& fam : m_reflfamilies )
+    ntot += fam.deminormals.size();
+  //Not worth the overhead for small number of normals:
+  if ( ntot < 256 || m_reflfamilies.size() > std::numeric_limits<std::uint32_t>::max() )
+    return;
+
+  //Cube-map with nside*nside cells on each face, aiming for ~8 normals per
+  //cell:
+  const std::size_t nside = static_cast<std::size_t>( ncclamp( std::sqrt( ntot / 48.0 ), 1.0, 64.0 ) );
+  std::vector<AngularIndexCell> cells( 6 * nside * nside );
+  auto faceCoordToBin = [nside](double x)
+  {
+    //x in [-1,1] -> [0,nside-1]
+    return static_cast<std::size_t>( ncclamp( ( x + 1.0 ) * 0.5 * nside, 0.0, nside - 0.5 ) );
+  };
+  for ( auto famidx : ncrange( m_reflfamilies.size() ) ) {
+    auto& normals = m_reflfamilies.at(famidx).deminormals;
+    for ( auto idx : ncrange( normals.size() ) ) {
+      const Vector n = normals[idx];
+      nc_assert( n.isUnitVector() );
+      const double ax(ncabs(n[0])), ay(ncabs(n[1])), az(ncabs(n[2]));
+      std::size_t face, k;
+      if ( ax >= ay && ax >= az ) {
+        face = ( n[0] > 0.0 ? 0 : 1 );
+        k = faceCoordToBin( n[1] / ax ) * nside + faceCoordToBin( n[2] / ax );
+      } else if ( ay >= az ) {
+        face = ( n[1] > 0.0 ? 2 : 3 );
+        k = faceCoordToBin( n[0] / ay ) * nside + faceCoordToBin( n[2] / ay );
+      } else {
+        face = ( n[2] > 0.0 ? 4 : 5 );
+        k = faceCoordToBin( n[0] / az ) * nside + faceCoordToBin( n[1] / az );
+      }
+      auto& cell = cells.at( face * nside * nside + k );
+      cell.center += n;
+      cell.entries.push_back( ( static_cast<std::uint64_t>( famidx ) << 32 )
+                              + static_cast<std::uint64_t>( idx ) );
+    }
+  }
+
+  for ( auto& cell : cells ) {
+    if ( cell.entries.empty() )
+      continue;
+    //Entries were added in sorted order:
+    nc_assert( std::is_sorted( cell.entries.begin(), cell.entries.end() ) );
+    const double mag = cell.center.mag();
+    if ( mag > 1e-6 ) {
+      cell.center /= mag;
+    } else {
+      const auto e = cell.entries.front();
+      cell.center = m_reflfamilies.at( e >> 32 ).deminormals[ e & 0xFFFFFFFF ];
+    }
+    double rmax(0.0);
+    for ( auto e : cell.entries )
+      rmax = ncmax( rmax, cell.center.angle_highres( m_reflfamilies[ e >> 32 ].deminormals[ e & 0xFFFFFFFF ] ) );
+    cell.radius = rmax;
+    cell.entries.shrink_to_fit();
+    m_angidx.push_back( std::move(cell) );
+  }
+  m_angidx.shrink_to_fit();
+}
+
+void NC::SCBragg::pimpl::collectCandidates( double wl, const NC::Vector& dir,
+                                            std::size_t nfam_max,
+                                            std::vector<std::uint64_t>& candidates ) const
+{
+  //For a demi-normal at angle alpha (folded into [0,pi/2], since both normal
+  //and anti-normal are considered) to the neutron direction, the truncated
+  //mosaicity distribution can only overlap the Bragg cone if
+  //|pi/2-theta_bragg-alpha|<truncangle. As sin(theta_bragg)=wl/(2d), a range
+  //of possible alpha values translates directly into a range of 1/2d
+  //values. To make sure that no contributions are missed due to numerical
+  //imprecision, we add a generous safety margin - any surplus candidates will
+  //anyway be rejected by the exact checks in GaussMos.
+  nc_assert( wl > 0.0 && dir.isUnitVector() );
+  candidates.clear();
+  const double anglemargin = 1e-6;
+  const double truncangle = m_gm.mosaicityTruncationAngle() + anglemargin;
+  const double inv_wl = 1.0 / wl;
+  auto itFamB = m_reflfamilies.begin();
+  auto itFamE = std::next( itFamB, nfam_max );
+  for ( auto& cell : m_angidx ) {
+    const double a = std::acos( ncclamp( cell.center.dot( dir ), -1.0, 1.0 ) );
+    const double amin = ncmax( 0.0, a - cell.radius - anglemargin );
+    const double amax = ncmin( kPi, a + cell.radius + anglemargin );
+    double fmin, fmax;//folded
+    if ( amax < kPiHalf ) {
+      fmin = amin;
+      fmax = amax;
+    } else if ( amin > kPiHalf ) {
+      fmin = kPi - amax;
+      fmax = kPi - amin;
+    } else {
+      fmin = ncmin( amin, kPi - amax );
+      fmax = kPiHalf;
+    }
+    const double inv2d_low = std::cos( ncmin( kPiHalf, fmax + truncangle ) ) * inv_wl * ( 1.0 - 1e-9 );
+    const double inv2d_high = std::cos( ncmax( 0.0, fmin - truncangle ) ) * inv_wl * ( 1.0 + 1e-9 );
+    auto itLow = std::lower_bound( itFamB, itFamE, inv2d_low,
+                                   []( const ReflectionFamily& f, double v ) { return f.inv2d < v; } );
+    auto itHigh = std::upper_bound( itLow, itFamE, inv2d_high,
+                                    []( double v, const ReflectionFamily& f ) { return v < f.inv2d; } );
+    if ( itLow == itHigh )
+      continue;
+    const auto keyLow = static_cast<std::uint64_t>( std::distance( itFamB, itLow ) ) << 32;
+    const auto keyHigh = static_cast<std::uint64_t>( std::distance( itFamB, itHigh ) ) << 32;
+    auto itE = std::lower_bound( cell.entries.begin(), cell.entries.end(), keyHigh );
+    auto it = std::lower_bound( cell.entries.begin(), itE, keyLow );
+    candidates.insert( candidates.end(), it, itE );
+  }
+  //Sort, so normals will be visited in the same order as without the index:
+  std::sort( candidates.begin(), candidates.end() );
+}
+
 namespace NCRYSTAL_NAMESPACE {
+  namespace {
+    static CacheStats::Category s_scbragg_cachestats("SCBragg");
+  }
   inline double SCBragg_cacheRound(double x) {
     //Cut off input at 15 decimals, which should be a negligible effect on any
     //realistic value of ekin in eV, but ensures that we don't
@@ -230,7 +399,7 @@ namespace NCRYSTAL_NAMESPACE {
   }
 }
 
-void NC::SCBragg::pimpl::updateCache( Cache& cache, NeutronEnergy ekin_raw, const NC::Vector& dir ) const
+const NC::SCBragg::pimpl::CacheEntry& NC::SCBragg::pimpl::updateCache( Cache& cache, NeutronEnergy ekin_raw, const NC::Vector& dir ) const
 {
   //We check the cache validity on the rounded ekin value, but for simplicity we
   //keep the direction as it is. We could consider rounding the direction as
@@ -239,42 +408,85 @@ void NC::SCBragg::pimpl::updateCache( Cache& cache, NeutronEnergy ekin_raw, cons
   //actually numerically imprecise for small angles, leading to occurances of
   //cache validity where it should have been invalid.
   double ekin = SCBragg_cacheRound(ekin_raw.get());
-  if ( cache.ekin==ekin && dir.angle_highres(cache.dir)<1.0e-12 ) {
-    //cache already valid!
-    return;
+  const std::uint64_t usecount = ++cache.usecount;
+  for ( auto& e : cache.entries ) {
+    if ( e.ekin==ekin && dir.angle_highres(e.dir)<1.0e-12 ) {
+      //cache already valid!
+      s_scbragg_cachestats.recordHit();
+      e.lastused = usecount;
+      return e;
+    }
   }
-
-  //Cache not valid!
-  cache.dir = dir;
-  cache.dir.normalise();
+  CacheStats::Category::MissScope missrecorder( s_scbragg_cachestats );
+
+  //Cache not valid! Add a new entry if there is still room, otherwise reuse
+  //the least recently used entry (invalidated entries have lastused=0):
+  if ( cache.entries.size() < m_ncacheentries ) {
+    if ( cache.entries.empty() )
+      cache.entries.reserve( m_ncacheentries );
+    cache.entries.emplace_back();
+  }
+  auto itEntry = std::min_element( cache.entries.begin(), cache.entries.end(),
+                                   []( const CacheEntry& a, const CacheEntry& b )
+                                   { return a.lastused < b.lastused; } );
+  CacheEntry& entry = *itEntry;
+  entry.lastused = usecount;
+  entry.dir = dir;
+  entry.dir.normalise();
 
   //Energy or direction is new, we must recalculate.
 
-  cache.ekin = ekin;
-  cache.wl = ekin2wl(ekin);
-  nc_assert(cache.wl>=0);
-  cache.scatcache.clear();
-  cache.xs_commul.clear();
-  if (cache.wl==0)
-    return;//done, all cross-sections will be zero
+  entry.ekin = ekin;
+  entry.wl = ekin2wl(ekin);
+  nc_assert(entry.wl>=0);
+  entry.scatcache.clear();
+  entry.xs_commul.clear();
+  if (entry.wl==0)
+    return entry;//done, all cross-sections will be zero
 
   std::vector<ReflectionFamily>::const_iterator it(m_reflfamilies.begin()), itE(m_reflfamilies.end());
 
-  double inv2dcutoff = (1.0-2*std::numeric_limits<double>::epsilon())/cache.wl;
+  double inv2dcutoff = (1.0-2*std::numeric_limits<double>::epsilon())/entry.wl;
 
   GaussMos::InteractionPars interactionpars;
+
+  if ( !m_angidx.empty() ) {
+    //Only visit candidate normals found with the angular index:
+    auto itCut = std::lower_bound( it, itE, inv2dcutoff,
+                                   []( const ReflectionFamily& f, double v ) { return f.inv2d < v; } );
+    auto& candidates = cache.candidates;
+    collectCandidates( entry.wl, entry.dir, std::distance( it, itCut ), candidates );
+    auto itCand = candidates.begin();
+    auto itCandE = candidates.end();
+    auto& famcands = cache.famcandidates;
+    while ( itCand != itCandE ) {
+      const std::size_t famidx = static_cast<std::size_t>( (*itCand) >> 32 );
+      famcands.clear();
+      for ( ; itCand != itCandE && ( (*itCand) >> 32 ) == famidx; ++itCand )
+        famcands.push_back( static_cast<std::uint32_t>( (*itCand) & 0xFFFFFFFF ) );
+      const ReflectionFamily& fam = m_reflfamilies[famidx];
+      nc_assert( fam.inv2d < inv2dcutoff );
+      interactionpars.set(entry.wl, fam.inv2d, fam.xsfact);
+      m_gm.calcCrossSections( interactionpars, entry.dir, fam.deminormals,
+                              famcands, entry.scatcache, entry.xs_commul );
+    }
+    nc_assert(entry.xs_commul.empty()||entry.xs_commul.back()>0.0);
+    return entry;
+  }
+
   for( ; it!=itE; ++it) {
     const ReflectionFamily& fam = *it;
     if( fam.inv2d >= inv2dcutoff )
       break;//stop here, no more families fulfill w<2d requirement.
-    interactionpars.set(cache.wl, fam.inv2d, fam.xsfact);
-    m_gm.calcCrossSections(interactionpars, cache.dir, fam.deminormals, cache.scatcache,cache.xs_commul);
+    interactionpars.set(entry.wl, fam.inv2d, fam.xsfact);
+    m_gm.calcCrossSections(interactionpars, entry.dir, fam.deminormals, entry.scatcache,entry.xs_commul);
   }
 
-  nc_assert(cache.xs_commul.empty()||cache.xs_commul.back()>0.0);
+  nc_assert(entry.xs_commul.empty()||entry.xs_commul.back()>0.0);
+  return entry;
 }
 
-void NC::SCBragg::pimpl::genScat( Cache& cache, RNG& rng, NC::Vector& outdir ) const
+void NC::SCBragg::pimpl::genScat( const CacheEntry& cache, RNG& rng, NC::Vector& outdir ) const
 {
   nc_assert(!cache.xs_commul.empty());
   nc_assert(cache.xs_commul.back()>0.0);
@@ -282,7 +494,7 @@ void NC::SCBragg::pimpl::genScat( Cache& cache, RNG& rng, NC::Vector& outdir ) c
 
   std::size_t idx = pickRandIdxByWeight(rng,cache.xs_commul);
   nc_assert(idx<cache.scatcache.size());
-  GaussMos::ScatCache& chosen_scatcache = cache.scatcache[idx];
+  const GaussMos::ScatCache& chosen_scatcache = cache.scatcache[idx];
 
   m_gm.genScat( rng, chosen_scatcache, cache.wl, cache.dir, outdir );
 }
@@ -296,8 +508,7 @@ NC::CrossSect NC::SCBragg::crossSection(CachePtr& cp, NeutronEnergy ekin, const
 {
   if ( ekin.get() <= m_pimpl->m_threshold_ekin )
     return CrossSect{ 0.0 };
-  auto& cache = accessCache<pimpl::Cache>(cp);
-  m_pimpl->updateCache( cache, ekin, dir.as<Vector>() );
+  auto& cache = m_pimpl->updateCache( accessCache<pimpl::Cache>(cp), ekin, dir.as<Vector>() );
   return CrossSect{ cache.xs_commul.empty() ? 0.0 : cache.xs_commul.back() };
 }
 
@@ -309,8 +520,7 @@ NC::ScatterOutcome NC::SCBragg::sampleScatter( CachePtr& cp, RNG& rng, NeutronEn
     return { ekin, indir };
   }
 
-  auto& cache = accessCache<pimpl::Cache>(cp);
-  m_pimpl->updateCache( cache, ekin, indir.as<Vector>() );
+  auto& cache = m_pimpl->updateCache( accessCache<pimpl::Cache>(cp), ekin, indir.as<Vector>() );
 
   if ( cache.xs_commul.empty() || cache.xs_commul.back()<=0.0 ) {
     //Again, scatterings are not actually possible here:
@@ -50,6 +50,32 @@ namespace NC = NCrystal;
 
 namespace NCRYSTAL_NAMESPACE {
 
+  namespace {
+    unsigned braggCacheSize()
+    {
+      //Number of neutron states for which SCBragg/LCBragg keeps results in
+      //each cache object (default 1). Can be increased by applications which
+      //interleave calls for a handful of different neutron states.
+      //
+      //This is deliberately not a cfg-variable, since it only trades memory
+      //for speed and never affects results (and cfg-variables are part of the
+      //keys by which created physics objects are shared). Consequently, it
+      //can not be set per material: the NCRYSTAL_BRAGG_CACHE_SIZE environment
+      //variable is read once, on first use, and the value then applies to all
+      //single crystal and layered crystal scatter objects created by this
+      //factory for the rest of the process:
+      static const unsigned s_val = []()
+      {
+        int val = ncgetenv_int("BRAGG_CACHE_SIZE",1);
+        if ( !( val >= 1 && val <= 1024 ) )
+          NCRYSTAL_THROW2(BadInput,"Invalid value of NCRYSTAL_BRAGG_CACHE_SIZE"
+                          " environment variable (must be in range 1..1024): "<<val);
+        return static_cast<unsigned>(val);
+      }();
+      return s_val;
+    }
+  }
+
   class PlaneProviderWCutOff : public PlaneProvider {
   public:
 
@@ -113,6 +139,8 @@ namespace NCRYSTAL_NAMESPACE {
       const auto& inelas = ana.inelas;
       const auto ucnmode = cfg.get_ucnmode();
       const auto vdoslux = cfg.get_vdoslux();
+      const double sabtempstep = cfg.get_sabtempstep();
+      const double sabegridtol = cfg.get_sabegridtol();
 
       nc_assert_always(isOneOf(inelas,"0","external","dyninfo","vdosdebye","freegas"));
 
@@ -167,10 +195,12 @@ namespace NCRYSTAL_NAMESPACE {
             SCOrientation sco = cfg.createSCOrientation();
             if (cfg.isLayeredCrystal()) {
               cl.emplace_back(makeSO<LCBragg>( info, sco, cfg.get_mos(), cfg.get_lcaxis(), cfg.get_lcmode(),
-                                               0,sc_pp.get(),cfg.get_mosprec(),0.0 ));
+                                               0,sc_pp.get(),cfg.get_mosprec(),0.0,
+                                               braggCacheSize() ));
             } else {
               cl.emplace_back(makeSO<SCBragg>( info, sco,cfg.get_mos(),0.0,
-                                               sc_pp.get(),cfg.get_mosprec(),0.));
+                                               sc_pp.get(),cfg.get_mosprec(),0.,
+                                               braggCacheSize() ));
 
 
             }
@@ -254,19 +284,59 @@ namespace NCRYSTAL_NAMESPACE {
             vdos2sabExcludeFlag = mode + 4*low + 40000*high;
           }
 
+          if ( sabtempstep > 0.0 && ucnmode.has_value() )
+            NCRYSTAL_THROW(BadInput,"sabtempstep is not supported in combination with ucnmode");
+          const bool useTempLadder = ( sabtempstep > 0.0 && vdos2sabExcludeFlag == 0 );
+
           for (auto& di : info.getDynamicInfoList()) {
             const DI_ScatKnl* di_scatknl = dynamic_cast<const DI_ScatKnl*>(di.get());
             if (di_scatknl) {
-              components.addfct_cl([di_scatknl,vdoslux,vdos2sabExcludeFlag,ucnmode]()
+              components.addfct_cl([di_scatknl,vdoslux,vdos2sabExcludeFlag,ucnmode,useTempLadder,sabtempstep,sabegridtol]()
               {
                 ProcImpl::ProcComposition::ComponentList complist;
                 const double scale = di_scatknl->fraction();
 
+                if ( useTempLadder ) {
+                  //Kernels are only expanded at temperatures T_k=k*sabtempstep,
+                  //and shared between all materials using them:
+                  const double T = di_scatknl->temperature().dbl();
+                  const double k_lo = std::floor( T / sabtempstep * ( 1.0 + 1e-12 ) );
+                  if ( k_lo >= 1.0 ) {
+                    const Temperature T_lo{ k_lo * sabtempstep };
+                    const Temperature T_hi{ ( k_lo + 1.0 ) * sabtempstep };
+                    auto sabdata_lo = extractSABDataFromDynInfoAtTemperature( di_scatknl, T_lo, vdoslux );
+                    if ( sabdata_lo != nullptr ) {
+                      if ( !sabdata_lo->boundXS() )
+                        return complist;
+                      auto sh_lo = SAB::createScatterHelperWithCache( sabdata_lo, di_scatknl->energyGrid(), sabegridtol );
+                      if ( T - T_lo.dbl() <= 1e-9 * T ) {
+                        //On the ladder, no interpolation needed:
+                        complist.emplace_back(scale,makeSO<SABScatter>(std::move(sh_lo)));
+                        return complist;
+                      }
+                      auto sabdata_hi = extractSABDataFromDynInfoAtTemperature( di_scatknl, T_hi, vdoslux );
+                      nc_assert_always( sabdata_hi != nullptr );
+                      auto sh_hi = SAB::createScatterHelperWithCache( sabdata_hi, di_scatknl->energyGrid(), sabegridtol );
+                      complist.emplace_back(scale,makeSO<SABTempInterpScatter>( Temperature{T},
+                                                                                T_lo, std::move(sh_lo),
+                                                                                T_hi, std::move(sh_hi) ));
+                      return complist;
+                    }
+                  }
+                  //Below the first ladder step, or for kernels which can not
+                  //be re-expanded at other temperatures, fall through to the
+                  //standard treatment.
+                }
+
                 auto sabdata = extractSABDataFromDynInfo( di_scatknl, vdoslux, true/*use cache*/, vdos2sabExcludeFlag );
                 if ( !sabdata->boundXS() )
                   return complist;
 
-                auto sab_scatter = makeSO<SABScatter>( sabdata, di_scatknl->energyGrid() );
+                //Kernels might be shared between materials (cf.
+                //extractSABDataFromDynInfo), so also share the derived tables:
+                auto sab_scatter = makeSO<SABScatter>( SAB::createScatterHelperWithCache( sabdata,
+                                                                                          di_scatknl->energyGrid(),
+                                                                                          sabegridtol ) );
                 if ( !ucnmode.has_value() ) {
                   complist.emplace_back(scale,std::move(sab_scatter));
                   return complist;
@@ -317,7 +387,7 @@ namespace NCRYSTAL_NAMESPACE {
             ntot += ai.numberPerUnitCell();
           for ( auto& ai_orig : info.getAtomInfos() ) {
             auto * ai_ptr = &ai_orig;
-            components.addfct_cl([&info,ai_ptr,vdoslux,ntot]()
+            components.addfct_cl([&info,ai_ptr,vdoslux,ntot,sabegridtol]()
             {
               ProcImpl::ProcComposition::ComponentList complist;
               auto& ai = *ai_ptr;
@@ -327,7 +397,7 @@ namespace NCRYSTAL_NAMESPACE {
                                                                 ai.atomData().scatteringXS(),
                                                                 ai.atomData().averageMassAMU(),
                                                                 vdoslux );
-              auto scathelper = SAB::createScatterHelperWithCache( std::move(sabdata) );
+              auto scathelper = SAB::createScatterHelperWithCache( std::move(sabdata), nullptr, sabegridtol );
               complist.emplace_back(ai.numberPerUnitCell()*1.0/ntot,makeSO<SABScatter>(std::move(scathelper)));
               return complist;
             });
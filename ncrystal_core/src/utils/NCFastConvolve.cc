@@ -135,6 +135,9 @@ namespace NCRYSTAL_NAMESPACE {
     shared_obj<WTable> m_w;
     shared_obj<SwapPatternCache> m_swap;
 
+    //Work buffer, kept to avoid memory allocations in repeated convolutions:
+    std::vector<std::complex<double>> m_buf;
+
     //The actual fast-fourier transform algorithm:
     template<bool is_forward>
     void fft( std::vector<std::complex<double> > &inout,unsigned minimum_output_size );
@@ -152,6 +155,72 @@ namespace NCRYSTAL_NAMESPACE {
                (a.first*b.second+a.second*b.first) };
     }
 
+    //FFT butterflies on complex values stored as (real,imag) double pairs. The
+    //twiddle factors w are complex conjugated for inverse transforms. Naive and
+    //simple arithmetic is faster than std::complex multiplication (which takes
+    //care of inf/nan/overflow).
+
+    template<bool is_forward>
+    inline void fftMultTwiddle( const double * x, const double * w, double& r, double& i ) noexcept
+    {
+      const double c = w[0];
+      const double d = ( is_forward ? w[1] : -w[1] );
+      r = x[0]*c - x[1]*d;
+      i = x[0]*d + x[1]*c;
+    }
+
+    //Radix-2 butterfly with upper = data[j-half] and lower = data[j]:
+    template<bool is_forward>
+    inline void fftButterfly( double * upper, double * lower, const double * w ) noexcept
+    {
+      double jr, ji;
+      fftMultTwiddle<is_forward>( lower, w, jr, ji );
+      double& sr = upper[0];
+      double& si = upper[1];
+      lower[0] = sr - jr;
+      lower[1] = si - ji;
+      sr += jr;
+      si += ji;
+    }
+
+    //Radix-4 butterfly, replacing two consecutive radix-2 stages (with half
+    //sizes h and 2h) for the four elements x_q = data[base+q*h+k], q=0..3. With
+    //W=exp(+-i*2pi/(4h)), s=W^h=+-i, u1=W^2k*x1, u2=W^k*x2 and u3=W^3k*x3, the
+    //results are:
+    //
+    //   y0 = (x0+u1) + (u2+u3)      y1 = (x0-u1) + s*(u2-u3)
+    //   y2 = (x0+u1) - (u2+u3)      y3 = (x0-u1) - s*(u2-u3)
+    //
+    //This needs three twiddle multiplications rather than the four of the two
+    //radix-2 stages (and multiplication by s is merely a swap and a sign flip):
+    template<bool is_forward>
+    inline void fftRadix4Butterfly( double * x0, double * x1, double * x2, double * x3,
+                                    const double * w1, const double * w2,
+                                    const double * w3 ) noexcept
+    {
+      double u1r, u1i, u2r, u2i, u3r, u3i;
+      fftMultTwiddle<is_forward>( x1, w2, u1r, u1i );
+      fftMultTwiddle<is_forward>( x2, w1, u2r, u2i );
+      fftMultTwiddle<is_forward>( x3, w3, u3r, u3i );
+      const double ar = x0[0] + u1r;
+      const double ai = x0[1] + u1i;
+      const double br = x0[0] - u1r;
+      const double bi = x0[1] - u1i;
+      const double cr = u2r + u3r;
+      const double ci = u2i + u3i;
+      //s*(u2-u3), with s=i for forward and s=-i for inverse transforms:
+      const double dr = ( is_forward ? u3i - u2i : u2i - u3i );
+      const double di = ( is_forward ? u2r - u3r : u3r - u2r );
+      x0[0] = ar + cr;
+      x0[1] = ai + ci;
+      x2[0] = ar - cr;
+      x2[1] = ai - ci;
+      x1[0] = br + dr;
+      x1[1] = bi + di;
+      x3[0] = br - dr;
+      x3[1] = bi - di;
+    }
+
     // //According to cppreference.com, the layout of std::complex<double> MUST be
     // //the same as a double[2] array. Hence, faster access is provided with:
     // inline double* complexAsArray( std::complex<double>& v ) noexcept { return reinterpret_cast<double*>(&v); }
@@ -226,28 +295,58 @@ void NC::FastConvolve::Impl::convolve( const NC::VectD& a1, const NC::VectD& a2,
 {
   const int minimum_out_size = a1.size() + a2.size() - 1;
 
-  //Note: We could calculate the next two fft calls concurrently, but it was
-  //attempted and did not work as well, as instead employing concurrency in
-  //NCVDOSGn.cc, so we keep that for now.
-
-  std::vector<std::complex<double> > b1(a1.begin(),a1.end());
+  //Both inputs are real, so rather than carrying out two complex FFTs we pack
+  //them into a single complex array, b = a1 + i*a2, and transform that. With
+  //B=FFT(b) and B*[k] = conj(B[N-k]), the transforms of the inputs are then
+  //A1=(B+B*)/2 and A2=(B-B*)/(2i), and their product is A1*A2 = -i/4*(B^2-B*^2).
+
+  std::vector<std::complex<double>>& b1 = m_buf;
+  b1.clear();//keeps capacity
+  b1.resize( std::max( a1.size(), a2.size() ) );
+  {
+    double * raw = reinterpret_cast<double*>( b1.data() );
+    for ( auto v : a1 ) {
+      *raw = v;
+      raw += 2;
+    }
+    raw = reinterpret_cast<double*>( b1.data() ) + 1;
+    for ( auto v : a2 ) {
+      *raw = v;
+      raw += 2;
+    }
+  }
   fft<true>(b1,minimum_out_size);
-  std::vector<std::complex<double> > b2(a2.begin(),a2.end());
-  fft<true>(b2,minimum_out_size);
 
-  nc_assert(b1.size()==b2.size());
-  std::vector<std::complex<double> >::iterator itb1(b1.begin()), itb1E(b1.end()), itb2(b2.begin());
-  while (itb1!=itb1E)
-    *itb1++ *= *itb2++;
+  {
+    const std::size_t N = b1.size();
+    nc_assert( N > 0 && ( N & (N-1) ) == 0 );
+    double * raw = reinterpret_cast<double*>( b1.data() );
+    for ( std::size_t ik = 0; ik <= N/2; ++ik ) {
+      const std::size_t im = ( N - ik ) & ( N - 1 );
+      double * bk = raw + 2*ik;
+      double * bm = raw + 2*im;
+      const double a(bk[0]), b(bk[1]), c(bm[0]), d(bm[1]);
+      //B[k]^2 - conj(B[m])^2 = (a^2-b^2-c^2+d^2) + i*(2ab+2cd), then multiply
+      //by -i/4, and similarly with k and m swapped:
+      const double re_k = a*a - b*b - c*c + d*d;
+      const double im_k = 2.0 * ( a*b + c*d );
+      bk[0] = 0.25 * im_k;
+      bk[1] = -0.25 * re_k;
+      if ( im != ik ) {
+        //re_m = -re_k and im_m = im_k:
+        bm[0] = 0.25 * im_k;
+        bm[1] = 0.25 * re_k;
+      }
+    }
+  }
 
   fft<false>(b1,minimum_out_size);
 
   y.resize(minimum_out_size);
   const double k = dt/b1.size();
-  nc_assert(b1.size()==b2.size());
   nc_assert(y.size()<=b1.size());
   VectD::iterator ity(y.begin()), ityE(y.end());
-  itb1 = b1.begin();
+  auto itb1 = b1.begin();
 #ifdef NCRYSTAL_FASTCONVOLVE_EXTRASAFEMATH
   for(;ity!=ityE;++ity,++itb1) {
     //use std::abs which calls std::hypot behind the scenes (expensive but can avoid overflows)
@@ -368,94 +467,63 @@ void NC::FastConvolve::Impl::fft( std::vector<std::complex<double>> &data,
 #endif
 
   nc_assert_always(wtable.size()%output_size==0);
-  const int jump = wtable.size()/output_size;
-#ifndef NCRYSTAL_FASTCONVOLVE_EXTRASAFEMATH
-  //const double convfact = (is_forward?1.0:-1.0);
-#endif
-
-#ifndef NCRYSTAL_FASTCONVOLVE_EXTRASAFEMATH
-  double * rawdata = reinterpret_cast<double*>( data.data() );
-  const double * raww = reinterpret_cast<const double*>( wtable.data() );
-#endif
-  for(int i=0;i<output_log_size;++i){
-    int z=0;
-    const int i1 = (1<<i);
-#ifndef NCRYSTAL_FASTCONVOLVE_EXTRASAFEMATH
-    auto twoi1 = i1*2;
-#endif
-
-    const int i1m1 = i1-1;
-    const int i2 = 1<<(output_log_size-i-1);
-
-    for(int j=0;j<output_size;++j){
+  const std::size_t jump = wtable.size()/output_size;
 
-#if 0
-      //original (integer division very expensive!):
-      if((j/i1)%2) {
-#else
-      //NB: j/i1=j>>i since i1=(1<<i):
-      if( (j>>i)%2 ) {
-        //Todo: Perhaps we can figure out a bit mask for the check (j>>i)%2
-        //instead of doing it each time?
-        nc_assert( j/i1 == j>>i );
-#endif
 #ifdef NCRYSTAL_FASTCONVOLVE_EXTRASAFEMATH
-        std::complex<double>& data_j = data[j];
-        std::complex<double>& data_sympos = data[j-i1];
+  //Plain radix-2 stages using std::complex arithmetic:
+  for ( int i = 0; i < output_log_size; ++i ) {
+    const std::size_t h = std::size_t(1) << i;
+    const std::size_t tw = jump * ( output_size / ( 2 * h ) );
+    for ( std::size_t base = 0; base < (std::size_t)output_size; base += 2 * h ) {
+      for ( std::size_t k = 0; k < h; ++k ) {
+        std::complex<double>& data_j = data[base + h + k];
+        std::complex<double>& data_sympos = data[base + k];
         //std::complex<> multiplication is slow since it takes care of proper inf/nan/overflow
-        data_j *= ((!is_forward)?std::conj(wtable[z*jump]):wtable[z*jump]);
-        //and the -=,+= operators seems to carry significant overhead for some reason:
+        data_j *= ( (!is_forward) ? std::conj(wtable[k*tw]) : wtable[k*tw] );
         std::complex<double> temp = data_sympos;
         data_sympos += data_j;
         temp -= data_j;
         data_j = temp;
-#else
-        //naive and simple is faster:
-#  if 1
-        //v2:
-        auto twoj = j*2;
-        double* rawdata_j = std::next(rawdata,twoj);
-        double* rawdata_sympos = std::next(rawdata,twoj-twoi1);
-        const double* rawdata_wzjump = std::next(raww,z*jump*2);
-        //const auto& w_zjump = wtable[z*jump];
-        double& a = *rawdata_j;// accessReal( data_j );
-        double& b = *std::next(rawdata_j); //accessImag( data_j );
-        const double& c = *rawdata_wzjump;//accessReal( w_zjump );
-        const double d = ( is_forward
-                           ? (*std::next(rawdata_wzjump))//accessImag( w_zjump );
-                           : -(*std::next(rawdata_wzjump)) );//accessImag( w_zjump );
-        //const double d = convfact * (*std::next(rawdata_wzjump));//accessImag( w_zjump );
-        const double jr(a*c-b*d);
-        const double ji(a*d+b*c);
-        double& sr = *rawdata_sympos;//accessReal(data_sympos);
-        double& si = *std::next(rawdata_sympos);//accessImag(data_sympos);
-        a = sr - jr;
-        b = si - ji;
-        sr += jr;
-        si += ji;
-#  else
-        //v1:
-        const std::complex<double>& w_zjump = wtable[z*jump];
-        const double a(data_j.real()), b(data_j.imag()), c(w_zjump.real());
-        const double d = ( is_forward ? w_zjump.imag() : - w_zjump.imag() );
-        const double jr(a*c-b*d);
-        const double ji(a*d+b*c);
-        const double sr(data_sympos.real());//no by-ref access to real/imag parts
-        const double si(data_sympos.imag());
-        data_j.real( sr - jr );
-        data_j.imag( si - ji );
-        data_sympos.real( sr + jr );
-        data_sympos.imag( si + ji );
-#  endif
-#endif
-        z += i2;
-      } else {
-        z = 0;
-        //will be the same result for the next i1-1 loops, so skip ahead:
-        j += i1m1;
       }
     }
   }
+#else
+  //Butterfly passes. Pairs of consecutive radix-2 stages are carried out as
+  //single radix-4 passes, which halves the number of sweeps through the data
+  //and saves a quarter of the twiddle multiplications. An odd number of
+  //stages is completed with a final radix-2 pass:
+  double * rawdata = reinterpret_cast<double*>( data.data() );
+  const double * raww = reinterpret_cast<const double*>( wtable.data() );
+  const std::size_t N = output_size;
+  int i = 0;
+  for ( ; i + 1 < output_log_size; i += 2 ) {
+    const std::size_t h = std::size_t(1) << i;
+    const std::size_t tw = jump * ( N / ( 4 * h ) );//W^k is at raww[2*k*tw]
+    for ( std::size_t base = 0; base < N; base += 4 * h ) {
+      double * d0 = rawdata + 2 * base;
+      double * d1 = d0 + 2 * h;
+      double * d2 = d1 + 2 * h;
+      double * d3 = d2 + 2 * h;
+      for ( std::size_t k = 0; k < h; ++k )
+        fftRadix4Butterfly<is_forward>( d0 + 2 * k, d1 + 2 * k, d2 + 2 * k, d3 + 2 * k,
+                                        raww + 2 * k * tw,
+                                        raww + 4 * k * tw,
+                                        raww + 6 * k * tw );
+    }
+  }
+  if ( i < output_log_size ) {
+    //Odd number of stages, final radix-2 pass:
+    nc_assert( i + 1 == output_log_size );
+    const std::size_t h = std::size_t(1) << i;
+    const std::size_t tw = jump * ( N / ( 2 * h ) );
+    for ( std::size_t base = 0; base < N; base += 2 * h ) {
+      double * d0 = rawdata + 2 * base;
+      double * d1 = d0 + 2 * h;
+      for ( std::size_t k = 0; k < h; ++k )
+        fftButterfly<is_forward>( d0 + 2 * k, d1 + 2 * k, raww + 2 * k * tw );
+    }
+  }
+#endif
 }
 
 NC::PairDD NC::FastConvolve::calcPhase(unsigned k, unsigned n)
@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "NCrystal/internal/utils/NCLogGridIndex.hh"
+
+namespace NC = NCrystal;
+
+NC::LogGridIndex::LogGridIndex( Span<const double> grid )
+{
+  if ( grid.empty() )
+    NCRYSTAL_THROW(BadInput,"LogGridIndex: empty grid");
+  if ( !( grid.front() > 0.0 ) || !std::isfinite( grid.back() ) )
+    NCRYSTAL_THROW(BadInput,"LogGridIndex: grid values must be positive and finite");
+  if ( !std::is_sorted( grid.begin(), grid.end() ) )
+    NCRYSTAL_THROW(BadInput,"LogGridIndex: grid is not sorted");
+  if ( grid.size() >= std::numeric_limits<std::uint32_t>::max() )
+    NCRYSTAL_THROW(BadInput,"LogGridIndex: grid too large");
+
+  //Aim for roughly 4 buckets per grid point (bits of positive doubles are
+  //monotonically increasing with the value):
+  m_bitsLow = bits( grid.front() );
+  const std::uint64_t bitrange = bits( grid.back() ) - m_bitsLow;
+  const std::uint64_t nbuckets_target = 4 * static_cast<std::uint64_t>( grid.size() );
+  m_shift = 0;
+  while ( ( bitrange >> m_shift ) >= nbuckets_target )
+    ++m_shift;
+  const std::size_t nbuckets = static_cast<std::size_t>( bitrange >> m_shift ) + 1;
+
+  //m_bucketStart[i] is the number of grid points in buckets before bucket i:
+  m_bucketStart.reserve( nbuckets + 1 );
+  std::size_t igrid = 0;
+  for ( std::size_t ibucket = 0; ibucket <= nbuckets; ++ibucket ) {
+    while ( igrid < grid.size()
+            && ( ( bits( grid[igrid] ) - m_bitsLow ) >> m_shift ) < ibucket )
+      ++igrid;
+    m_bucketStart.push_back( static_cast<std::uint32_t>( igrid ) );
+  }
+  nc_assert_always( m_bucketStart.back() == grid.size() );
+}
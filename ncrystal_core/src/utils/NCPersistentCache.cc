@@ -0,0 +1,565 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/internal/utils/NCPersistentCache.hh"
+#include "NCrystal/internal/utils/NCFileUtils.hh"
+#include "NCrystal/internal/utils/NCString.hh"
+#include "NCrystal/internal/utils/NCMsg.hh"
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <chrono>
+
+#if defined(__unix__) || (defined (__APPLE__) && defined (__MACH__))
+#  define NCRYSTAL_PCACHE_USE_MMAP
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <sys/types.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+namespace NC = NCrystal;
+namespace NPC = NCrystal::PersistentCache;
+
+namespace NCRYSTAL_NAMESPACE {
+  namespace PersistentCache {
+    namespace {
+
+      //Increment whenever the layout of the files or of any of the payloads
+      //changes:
+      constexpr std::uint64_t fileFormatVersion = 1;
+      constexpr const char * fileMagic = "NCPCACHE";//8 chars
+      constexpr std::uint64_t endianMarker = 0x0102030405060708ull;
+      constexpr const char * fileExtension = ".ncpcache";
+
+      struct CacheDirState {
+        std::mutex mtx;
+        bool initialised = false;
+        std::string dir;
+      };
+
+      CacheDirState& cacheDirState()
+      {
+        static CacheDirState s;
+        return s;
+      }
+
+      bool ensureDirExists( const std::string& dir )
+      {
+#ifdef NCRYSTAL_PCACHE_USE_MMAP
+        struct stat st;
+        if ( ::stat( dir.c_str(), &st ) == 0 )
+          return S_ISDIR(st.st_mode);
+        return ::mkdir( dir.c_str(), 0777 ) == 0 || errno == EEXIST;
+#else
+        //No portable way to check or create directories in C++11, so simply
+        //assume that it exists (if not, failures to write entries will result
+        //in warnings):
+        (void)dir;
+        return true;
+#endif
+      }
+
+      std::string setupCacheDir( std::string dir )
+      {
+        if ( dir.empty() )
+          return dir;
+        if ( !ensureDirExists( dir ) ) {
+          NCRYSTAL_WARN("Persistent cache disabled since the directory \""<<dir
+                        <<"\" does not exist and could not be created.");
+          return std::string();
+        }
+        return dir;
+      }
+
+      std::uint64_t mix64( std::uint64_t z )
+      {
+        //Finaliser from splitmix64:
+        z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+        z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebull;
+        return z ^ ( z >> 31 );
+      }
+
+      std::uint64_t dblBits( double v )
+      {
+        std::uint64_t u;
+        static_assert(sizeof(u)==sizeof(v),"");
+        std::memcpy( &u, &v, sizeof(u) );
+        return u;
+      }
+
+      std::string entryPath( const Key& key )
+      {
+        const std::string dir = cacheDir();
+        if ( dir.empty() )
+          return dir;
+        return path_join( dir, std::string(key.category()) + "_" + key.hexDigest() + fileExtension );
+      }
+
+      class FileData : private NoCopyMove {
+        //Read-only access to the contents of a file, memory mapped when
+        //possible.
+        const char * m_data = nullptr;
+        std::size_t m_size = 0;
+        std::string m_buf;
+#ifdef NCRYSTAL_PCACHE_USE_MMAP
+        void * m_map = nullptr;
+#endif
+      public:
+        FileData( const std::string& path )
+        {
+#ifdef NCRYSTAL_PCACHE_USE_MMAP
+          int fd = ::open( path.c_str(), O_RDONLY );
+          if ( fd < 0 )
+            return;
+          struct stat st;
+          if ( ::fstat( fd, &st ) == 0 && st.st_size > 0 ) {
+            void * p = ::mmap( nullptr, static_cast<std::size_t>(st.st_size),
+                               PROT_READ, MAP_PRIVATE, fd, 0 );
+            if ( p != MAP_FAILED ) {
+              m_map = p;
+              m_data = static_cast<const char*>(p);
+              m_size = static_cast<std::size_t>(st.st_size);
+            }
+          }
+          ::close( fd );
+#else
+          std::ifstream fh( path, std::ios::binary );
+          if ( !fh.good() )
+            return;
+          m_buf.assign( std::istreambuf_iterator<char>(fh), std::istreambuf_iterator<char>() );
+          if ( fh.bad() )
+            return;
+          m_data = m_buf.data();
+          m_size = m_buf.size();
+#endif
+        }
+        ~FileData()
+        {
+#ifdef NCRYSTAL_PCACHE_USE_MMAP
+          if ( m_map )
+            ::munmap( m_map, m_size );
+#endif
+        }
+        bool valid() const { return m_data != nullptr; }
+        const char * data() const { return m_data; }
+        std::size_t size() const { return m_size; }
+      };
+
+      std::string uniqueTmpSuffix()
+      {
+        static std::atomic<std::uint64_t> s_counter( 0 );
+        std::uint64_t v = static_cast<std::uint64_t>( std::chrono::steady_clock::now().time_since_epoch().count() );
+        v ^= mix64( ++s_counter );
+        v ^= mix64( static_cast<std::uint64_t>( reinterpret_cast<std::uintptr_t>( &s_counter ) ) );
+#ifdef NCRYSTAL_PCACHE_USE_MMAP
+        v ^= mix64( static_cast<std::uint64_t>( ::getpid() ) + 0x1234567ull );
+#endif
+        std::ostringstream ss;
+        ss << ".tmp" << std::hex << mix64(v);
+        return ss.str();
+      }
+
+      void warnWriteFailure( const std::string& path )
+      {
+        //Only warn once, to avoid flooding output when e.g. the directory is
+        //read-only:
+        static std::atomic<bool> s_warned( false );
+        if ( !s_warned.exchange( true ) )
+          NCRYSTAL_WARN("Failed to write entry to persistent cache: \""<<path
+                        <<"\" (further such warnings will be suppressed).");
+      }
+
+      std::uint64_t magicValue()
+      {
+        std::uint64_t magic;
+        std::memcpy( &magic, fileMagic, sizeof(magic) );
+        return magic;
+      }
+
+      Writer createHeader( const Key& key, const std::string& data )
+      {
+        const auto digest = key.digest();
+        Writer hdr;
+        hdr.addU64( magicValue() );
+        hdr.addU64( endianMarker );
+        hdr.addU64( fileFormatVersion );
+        hdr.addU64( static_cast<std::uint64_t>( NCRYSTAL_VERSION ) );
+        hdr.addU64( digest.first );
+        hdr.addU64( digest.second );
+        const std::size_t ncat = std::strlen( key.category() );
+        hdr.addU64( ncat );
+        {
+          std::string padded( key.category() );
+          padded.resize( ( ( ncat + 7 ) / 8 ) * 8, '\0' );
+          for ( std::size_t i = 0; i < padded.size(); i += 8 ) {
+            std::uint64_t w;
+            std::memcpy( &w, padded.data() + i, 8 );
+            hdr.addU64( w );
+          }
+        }
+        hdr.addU64( data.size() );
+        hdr.addU64( checksum( data.data(), data.size() ) );
+        return hdr;
+      }
+
+      //Validate complete entry (header+payload) and deserialise payload. If
+      //invalid, a warning is emitted and false is returned:
+      bool loadEntry( const Key& key, const char * entrydata, std::size_t entrysize,
+                      const std::function<void(Reader&)>& deserialise,
+                      const std::string& location )
+      {
+        const auto digest = key.digest();
+        const std::size_t ncat = std::strlen( key.category() );
+        try {
+          Reader hdr( entrydata, entrysize );
+          if ( hdr.getU64() != magicValue()
+               || hdr.getU64() != endianMarker
+               || hdr.getU64() != fileFormatVersion
+               || hdr.getU64() != static_cast<std::uint64_t>( NCRYSTAL_VERSION )
+               || hdr.getU64() != digest.first
+               || hdr.getU64() != digest.second
+               || hdr.getSize( 1 ) != ncat )
+            NCRYSTAL_THROW(DataLoadError,"Invalid header");
+          //Category name (padded to multiple of 8 bytes):
+          for ( std::size_t i = 0; i < ( ncat + 7 ) / 8; ++i ) {
+            std::uint64_t w = hdr.getU64();
+            char buf[8];
+            std::memcpy( buf, &w, 8 );
+            for ( std::size_t j = 0; j < 8; ++j ) {
+              const std::size_t ic = i*8+j;
+              if ( buf[j] != ( ic < ncat ? key.category()[ic] : '\0' ) )
+                NCRYSTAL_THROW(DataLoadError,"Invalid category in header");
+            }
+          }
+          const std::size_t payload_size = hdr.getSize( 1 );
+          const std::uint64_t payload_checksum = hdr.getU64();
+          const std::size_t payload_offset = sizeof(std::uint64_t) * ( 9 + ( ncat + 7 ) / 8 );
+          if ( entrysize != payload_offset + payload_size
+               || checksum( entrydata + payload_offset, payload_size ) != payload_checksum )
+            NCRYSTAL_THROW(DataLoadError,"Invalid payload");
+          Reader payload( entrydata + payload_offset, payload_size );
+          deserialise( payload );
+          if ( !payload.atEnd() )
+            NCRYSTAL_THROW(DataLoadError,"Trailing data in payload");
+        } catch ( Error::Exception& e ) {
+          NCRYSTAL_WARN("Ignoring invalid entry in persistent cache (\""<<location<<"\"): "<<e.what());
+          return false;
+        }
+        return true;
+      }
+
+    }
+  }
+}
+
+std::string NPC::cacheDir()
+{
+  auto& s = cacheDirState();
+  NCRYSTAL_LOCK_GUARD(s.mtx);
+  if ( !s.initialised ) {
+    s.initialised = true;
+    s.dir = setupCacheDir( ncgetenv("CACHE_DIR") );
+  }
+  return s.dir;
+}
+
+bool NPC::isEnabled()
+{
+  return !cacheDir().empty();
+}
+
+void NPC::setCacheDir( std::string dir )
+{
+  dir = setupCacheDir( std::move(dir) );
+  auto& s = cacheDirState();
+  NCRYSTAL_LOCK_GUARD(s.mtx);
+  s.initialised = true;
+  s.dir = std::move(dir);
+}
+
+NPC::Key::Key( const char * category )
+  : m_category(category),
+    m_h1( 0x243f6a8885a308d3ull ),
+    m_h2( 0x13198a2e03707344ull )
+{
+  nc_assert_always( category && *category );
+  addStr( category );
+  addU64( fileFormatVersion );
+  addU64( static_cast<std::uint64_t>( NCRYSTAL_VERSION ) );
+}
+
+void NPC::Key::absorb( std::uint64_t w )
+{
+  //Two independently mixed 64 bit lanes:
+  ++m_n;
+  m_h1 = ( m_h1 ^ w ) * 0x9e3779b97f4a7c15ull;
+  m_h1 ^= ( m_h1 >> 29 );
+  m_h2 = ( m_h2 + w ) * 0xc2b2ae3d27d4eb4full;
+  m_h2 = ( m_h2 << 31 ) | ( m_h2 >> 33 );
+}
+
+NPC::Key& NPC::Key::addU64( std::uint64_t v )
+{
+  absorb( v );
+  return *this;
+}
+
+NPC::Key& NPC::Key::addDbl( double v )
+{
+  absorb( dblBits( v ) );
+  return *this;
+}
+
+NPC::Key& NPC::Key::addStr( const std::string& s )
+{
+  absorb( static_cast<std::uint64_t>( s.size() ) );
+  std::size_t i = 0;
+  for ( ; i + 8 <= s.size(); i += 8 ) {
+    std::uint64_t w;
+    std::memcpy( &w, s.data() + i, 8 );
+    absorb( w );
+  }
+  if ( i < s.size() ) {
+    std::uint64_t w = 0;
+    std::memcpy( &w, s.data() + i, s.size() - i );
+    absorb( w );
+  }
+  return *this;
+}
+
+NPC::Key& NPC::Key::addVect( Span<const double> v )
+{
+  absorb( static_cast<std::uint64_t>( v.size() ) );
+  for ( auto e : v )
+    absorb( dblBits( e ) );
+  return *this;
+}
+
+std::pair<std::uint64_t,std::uint64_t> NPC::Key::digest() const
+{
+  return { mix64( m_h1 ^ mix64( m_n ) ), mix64( m_h2 + m_h1 ) };
+}
+
+std::string NPC::Key::hexDigest() const
+{
+  auto d = digest();
+  char buf[33];
+  std::snprintf( buf, sizeof(buf), "%016llx%016llx",
+                 static_cast<unsigned long long>(d.first),
+                 static_cast<unsigned long long>(d.second) );
+  return std::string( buf, 32 );
+}
+
+namespace NCRYSTAL_NAMESPACE {
+  namespace PersistentCache {
+    namespace {
+      //Explicit little-endian (de)serialisation of 64 bit words. Compilers
+      //turn these into plain loads and stores on little-endian platforms:
+      inline void storeLE64( char * p, std::uint64_t v ) noexcept
+      {
+        unsigned char b[8];
+        for ( unsigned i = 0; i < 8; ++i )
+          b[i] = static_cast<unsigned char>( ( v >> ( 8 * i ) ) & 0xFF );
+        std::memcpy( p, b, 8 );
+      }
+
+      inline std::uint64_t loadLE64( const char * p ) noexcept
+      {
+        unsigned char b[8];
+        std::memcpy( b, p, 8 );
+        std::uint64_t v = 0;
+        for ( unsigned i = 0; i < 8; ++i )
+          v |= static_cast<std::uint64_t>( b[i] ) << ( 8 * i );
+        return v;
+      }
+
+      inline double dblFromBits( std::uint64_t v ) noexcept
+      {
+        double d;
+        std::memcpy( &d, &v, sizeof(d) );
+        return d;
+      }
+    }
+  }
+}
+
+std::uint64_t NPC::checksum( const char * data, std::size_t n )
+{
+  std::uint64_t h = 0x6a09e667f3bcc908ull ^ n;
+  std::size_t i = 0;
+  for ( ; i + 8 <= n; i += 8 ) {
+    h = ( h ^ loadLE64( data + i ) ) * 0x9e3779b97f4a7c15ull;
+    h ^= ( h >> 32 );
+  }
+  std::uint64_t tail = 0;
+  for ( unsigned j = 0; i + j < n; ++j )
+    tail |= static_cast<std::uint64_t>( static_cast<unsigned char>( data[i+j] ) ) << ( 8 * j );
+  return mix64( h ^ tail );
+}
+
+void NPC::Writer::addU64( std::uint64_t v )
+{
+  char buf[8];
+  storeLE64( buf, v );
+  m_data.append( buf, sizeof(buf) );
+}
+
+void NPC::Writer::addDbl( double v )
+{
+  addU64( dblBits( v ) );
+}
+
+void NPC::Writer::addVect( Span<const double> v )
+{
+  addU64( static_cast<std::uint64_t>( v.size() ) );
+  if ( v.empty() )
+    return;
+  const std::size_t offset = m_data.size();
+  m_data.resize( offset + v.size() * sizeof(double) );
+  char * p = &m_data[offset];
+  for ( std::size_t i = 0; i < v.size(); ++i )
+    storeLE64( p + i * sizeof(double), dblBits( v[i] ) );
+}
+
+void NPC::Writer::addStr( const std::string& s )
+{
+  addU64( static_cast<std::uint64_t>( s.size() ) );
+  m_data.append( s );
+}
+
+const char * NPC::Reader::consume( std::size_t n )
+{
+  if ( n > m_size - m_pos )
+    NCRYSTAL_THROW(DataLoadError,"Unexpected end of serialised data");
+  const char * p = m_data + m_pos;
+  m_pos += n;
+  return p;
+}
+
+std::uint64_t NPC::Reader::getU64()
+{
+  return loadLE64( consume( sizeof(std::uint64_t) ) );
+}
+
+double NPC::Reader::getDbl()
+{
+  return dblFromBits( getU64() );
+}
+
+std::size_t NPC::Reader::getSize( std::size_t elementsize )
+{
+  nc_assert( elementsize > 0 );
+  std::uint64_t n = getU64();
+  if ( n > ( m_size - m_pos ) / elementsize )
+    NCRYSTAL_THROW(DataLoadError,"Invalid array size in serialised data");
+  return static_cast<std::size_t>( n );
+}
+
+NC::VectD NPC::Reader::getVect()
+{
+  std::size_t n = getSize( sizeof(double) );
+  VectD v;
+  if ( n ) {
+    v.resize( n );
+    const char * p = consume( n * sizeof(double) );
+    for ( std::size_t i = 0; i < n; ++i )
+      v[i] = dblFromBits( loadLE64( p + i * sizeof(double) ) );
+  }
+  return v;
+}
+
+std::string NPC::Reader::getStr()
+{
+  std::size_t n = getSize( 1 );
+  return n ? std::string( consume( n ), n ) : std::string();
+}
+
+namespace NCRYSTAL_NAMESPACE {
+  namespace PersistentCache {
+    namespace {
+      std::atomic<std::uint64_t> s_nhits( 0 );
+      std::atomic<std::uint64_t> s_nmisses( 0 );
+      std::atomic<std::uint64_t> s_nstores( 0 );
+
+      bool loadImpl( const Key& key, const std::function<void(Reader&)>& deserialise )
+      {
+        const std::string path = entryPath( key );
+        if ( path.empty() )
+          return false;
+        FileData fd( path );
+        if ( !fd.valid() )
+          return false;//not in cache
+        if ( !loadEntry( key, fd.data(), fd.size(), deserialise, path ) )
+          return false;
+        return true;
+      }
+    }
+  }
+}
+
+bool NPC::load( const Key& key, const std::function<void(Reader&)>& deserialise )
+{
+  if ( !isEnabled() )
+    return false;
+  const bool ok = loadImpl( key, deserialise );
+  ++( ok ? s_nhits : s_nmisses );
+  return ok;
+}
+
+NPC::Stats NPC::getStats()
+{
+  Stats st;
+  st.nhits = s_nhits.load();
+  st.nmisses = s_nmisses.load();
+  st.nstores = s_nstores.load();
+  return st;
+}
+
+void NPC::store( const Key& key, const Writer& payload )
+{
+  if ( !isEnabled() )
+    return;
+  ++s_nstores;
+  const std::string& data = payload.data();
+  Writer hdr = createHeader( key, data );
+
+  const std::string path = entryPath( key );
+  if ( path.empty() )
+    return;
+  const std::string tmppath = path + uniqueTmpSuffix();
+  bool ok = false;
+  {
+    std::ofstream fh( tmppath, std::ios::binary | std::ios::trunc );
+    fh.write( hdr.data().data(), static_cast<std::streamsize>( hdr.data().size() ) );
+    fh.write( data.data(), static_cast<std::streamsize>( data.size() ) );
+    fh.close();
+    ok = !fh.fail();
+  }
+  if ( ok && std::rename( tmppath.c_str(), path.c_str() ) == 0 )
+    return;
+  std::remove( tmppath.c_str() );
+  //Renaming onto an existing file is not possible on all platforms, so it is
+  //not a problem if another process already provided the entry:
+  if ( !( ok && file_exists( path ) ) )
+    warnWriteFailure( path );
+}
@@ -73,6 +73,17 @@ NC::PointwiseDist::PointwiseDist( VectD&& xvals, VectD&& yvals )
   m_cdf.back() = 1.0;
 }
 
+NC::PointwiseDist::PointwiseDist( internal_state_t, VectD&& xvals, VectD&& yvals, VectD&& cdf )
+  : m_cdf(std::move(cdf)), m_x(std::move(xvals)), m_y(std::move(yvals))
+{
+  if ( m_x.size() != m_y.size() || m_x.size() != m_cdf.size() || m_y.size() < 2 )
+    NCRYSTAL_THROW(CalcError, "input vector size error.");
+  if ( !std::is_sorted(m_x.begin(),m_x.end()) || !std::is_sorted(m_cdf.begin(),m_cdf.end()) )
+    NCRYSTAL_THROW(CalcError, "points of the distribution are not sorted.");
+  if ( m_cdf.front() != 0.0 || m_cdf.back() != 1.0 )
+    NCRYSTAL_THROW(CalcError, "invalid CDF.");
+}
+
 std::pair<double,unsigned> NC::PointwiseDist::percentileWithIndex(double p ) const
 {
   nc_assert(p>=0.&&p<=1.0);
@@ -20,6 +20,7 @@
 
 #include "NCrystal/internal/utils/NCRandUtils.hh"
 #include "NCrystal/internal/utils/NCMath.hh"
+#include <cstring>
 namespace NC=NCrystal;
 
 NC::Vector NC::randIsotropicDirection( RNG& rng )
@@ -76,6 +77,53 @@ NC::Vector NC::randDirectionGivenScatterMu( RNG& rng, double mu, const Vector& i
   return { u.x()+k*xx, u.y()+k*yy, u.z()+k*zz };
 }
 
+void NC::randDirectionsGivenScatterMu( RNG& rng, std::size_t N, const double* mu,
+                                       const double* ux, const double* uy, const double* uz,
+                                       double* out_ux, double* out_uy, double* out_uz )
+{
+  //Rather than using rejection sampling to find a random vector perpendicular
+  //to each input direction, the azimuthal angles are sampled directly (one
+  //random number per entry, generated in bulk) and applied in an orthonormal
+  //basis constructed without branches from the input direction.
+  //
+  //Reference for the basis: Duff et al., "Building an Orthonormal Basis,
+  //Revisited", JCGT 6(1), 2017.
+
+  constexpr std::size_t nbuf = 256;
+  double buf[nbuf];
+  for ( std::size_t i0 = 0; i0 < N; i0 += nbuf ) {
+    const std::size_t n = std::min<std::size_t>( nbuf, N - i0 );
+#ifdef NCRYSTAL_ALLOW_ABI_BREAKAGE
+    rng.generateMany( n, buf );
+#else
+    for ( std::size_t j = 0; j < n; ++j )
+      buf[j] = rng.generate();
+#endif
+    for ( std::size_t j = 0; j < n; ++j ) {
+      const std::size_t i = i0 + j;
+      const double m = mu[i];
+      nc_assert(ncabs(m)<=1.);
+      const double m2 = ux[i]*ux[i] + uy[i]*uy[i] + uz[i]*uz[i];
+      const double invm = ( ncabs(m2-1.0)<1e-12 ? 1.0 : 1.0/std::sqrt(m2) );
+      const double x = ux[i]*invm;
+      const double y = uy[i]*invm;
+      const double z = uz[i]*invm;
+      //Basis vectors e1=(1+s*x*x*a,s*b,-s*x) and e2=(b,s+y*y*a,-y):
+      const double s = std::copysign( 1.0, z );
+      const double a = -1.0 / ( s + z );
+      const double b = x * y * a;
+      double cosphi, sinphi;
+      sincos_02pi( k2Pi * buf[j], cosphi, sinphi );
+      const double k = std::sqrt( ncmax( 0.0, 1.0 - m * m ) );
+      const double k1 = k * cosphi;
+      const double k2 = k * sinphi;
+      out_ux[i] = m * x + k1 * ( 1.0 + s * x * x * a ) + k2 * b;
+      out_uy[i] = m * y + k1 * ( s * b ) + k2 * ( s + y * y * a );
+      out_uz[i] = m * z - k1 * ( s * x ) - k2 * y;
+    }
+  }
+}
+
 NC::PairDD NC::randPointOnUnitCircle( RNG& rng )
 {
   //Sample a random point on the unit circle. This is equivalent to sampling phi
@@ -551,9 +599,203 @@ void NC::RandXRSRImpl::genmanyimpl(int n, double* tgt) ncnoexceptndebug
     tgt[i] = randUInt64ToFP01(buf[i]);
 }
 
+namespace NCRYSTAL_NAMESPACE {
+  namespace {
+
+    class XRSRLaneAdvancer final : private NoCopyMove {
+      //The xoroshiro128+ state transition is linear over GF(2), so advancing a
+      //state by a fixed number of steps is a 128x128 bit matrix
+      //multiplication. We precompute that matrix for genmany_lanelength steps,
+      //stored as lookup tables for each 4-bit nibble of the state, so applying
+      //it only costs 32 table lookups.
+    public:
+      XRSRLaneAdvancer()
+      {
+        uint64_t cols[128][2];
+        for ( unsigned ibit = 0; ibit < 128; ++ibit ) {
+          RandXRSRImpl::state_t st = { ( ibit < 64 ? (uint64_t(1) << ibit) : 0 ),
+                                       ( ibit < 64 ? 0 : (uint64_t(1) << (ibit-64)) ) };
+          RandXRSRImpl rng( st );
+          for ( unsigned i = 0; i < RandXRSRImpl::genmany_lanelength; ++i )
+            rng.genUInt64WithBadLowerBits();
+          cols[ibit][0] = rng.state()[0];
+          cols[ibit][1] = rng.state()[1];
+        }
+        for ( unsigned inibble = 0; inibble < 32; ++inibble ) {
+          for ( unsigned val = 0; val < 16; ++val ) {
+            uint64_t t0(0), t1(0);
+            for ( unsigned b = 0; b < 4; ++b ) {
+              if ( val & (1u << b) ) {
+                t0 ^= cols[inibble*4+b][0];
+                t1 ^= cols[inibble*4+b][1];
+              }
+            }
+            m_tables[inibble][val][0] = t0;
+            m_tables[inibble][val][1] = t1;
+          }
+        }
+      }
+
+      void advance( uint64_t& s0, uint64_t& s1 ) const noexcept
+      {
+        uint64_t t0(0), t1(0);
+        for ( unsigned i = 0; i < 16; ++i ) {
+          const auto& e = m_tables[i][(s0 >> (4*i)) & 0xF];
+          t0 ^= e[0];
+          t1 ^= e[1];
+        }
+        for ( unsigned i = 0; i < 16; ++i ) {
+          const auto& e = m_tables[16+i][(s1 >> (4*i)) & 0xF];
+          t0 ^= e[0];
+          t1 ^= e[1];
+        }
+        s0 = t0;
+        s1 = t1;
+      }
+
+    private:
+      uint64_t m_tables[32][16][2];
+    };
+
+    const XRSRLaneAdvancer& xrsrLaneAdvancer()
+    {
+      static XRSRLaneAdvancer s_adv;
+      return s_adv;
+    }
+
+    constexpr unsigned xrsr_nlanes = RandXRSRImpl::genmany_nlanes;
+
+    void xrsrLanesGenerate( uint64_t * ncrestrict ls0,
+                            uint64_t * ncrestrict ls1,
+                            uint64_t * ncrestrict tgt,
+                            unsigned nrows ) noexcept
+    {
+      //Advance all lanes nrows times, writing the raw (lane-interleaved)
+      //output to tgt. With GCC-compatible compilers we use generic vector
+      //types, which are lowered to AVX2, SSE2, NEON, ... as available (the
+      //auto-vectoriser does not manage this on its own). Otherwise we simply
+      //rely on the instruction level parallelism of the independent lanes.
+#if defined(__GNUC__)
+      typedef uint64_t v4_t __attribute__((vector_size(32)));
+      constexpr unsigned nvec = xrsr_nlanes / 4;
+      static_assert( nvec * 4 == xrsr_nlanes, "" );
+      v4_t s0[nvec], s1[nvec];
+      std::memcpy( &s0[0], ls0, sizeof(s0) );
+      std::memcpy( &s1[0], ls1, sizeof(s1) );
+      for ( unsigned r = 0; r < nrows; ++r ) {
+        for ( unsigned j = 0; j < nvec; ++j ) {
+          const v4_t a = s0[j];
+          v4_t b = s1[j];
+          const v4_t res = a + b;
+          std::memcpy( tgt + r * xrsr_nlanes + j * 4, &res, sizeof(res) );
+          b ^= a;
+          s0[j] = ( ( a << 55 ) | ( a >> 9 ) ) ^ b ^ ( b << 14 );
+          s1[j] = ( b << 36 ) | ( b >> 28 );
+        }
+      }
+      std::memcpy( ls0, &s0[0], sizeof(s0) );
+      std::memcpy( ls1, &s1[0], sizeof(s1) );
+#else
+      uint64_t s0[xrsr_nlanes], s1[xrsr_nlanes];
+      for ( unsigned k = 0; k < xrsr_nlanes; ++k ) {
+        s0[k] = ls0[k];
+        s1[k] = ls1[k];
+      }
+      for ( unsigned r = 0; r < nrows; ++r ) {
+        for ( unsigned k = 0; k < xrsr_nlanes; ++k ) {
+          const uint64_t a = s0[k];
+          uint64_t b = s1[k];
+          tgt[r * xrsr_nlanes + k] = a + b;
+          b ^= a;
+          s0[k] = ( ( a << 55 ) | ( a >> 9 ) ) ^ b ^ ( b << 14 );
+          s1[k] = ( b << 36 ) | ( b >> 28 );
+        }
+      }
+      for ( unsigned k = 0; k < xrsr_nlanes; ++k ) {
+        ls0[k] = s0[k];
+        ls1[k] = s1[k];
+      }
+#endif
+    }
+
+    void xrsrConvertToFP01( const uint64_t * ncrestrict in,
+                            double * ncrestrict out,
+                            unsigned n ) noexcept
+    {
+      //Gives results identical to randUInt64ToFP01, but avoids the
+      //uint64->double conversions (which can not be vectorised without
+      //AVX-512) by the usual trick of or'ing integers < 2^52 into the mantissa
+      //of 2^52. Only the highest bit of (x>>11) does not fit, and is added
+      //separately.
+      constexpr uint64_t bits_two52 = 0x4330000000000000ull;
+      constexpr double two52 = 4503599627370496.0;
+      constexpr double two_m53 = 1.1102230246251565404236316680908203125e-16;
+      constexpr double two_m64 = 5.42101086242752217003726400434970855712890625e-20;
+      for ( unsigned i = 0; i < n; ++i ) {
+        const uint64_t x = in[i];
+        const uint64_t b_low52 = bits_two52 | ( ( x >> 11 ) & 0xFFFFFFFFFFFFFull );
+        const uint64_t b_high = ( uint64_t(0) - ( x >> 63 ) ) & bits_two52;
+        const uint64_t b_low11 = bits_two52 | ( x & 0x7FF );
+        double low52, high, low11;
+        std::memcpy( &low52, &b_low52, sizeof(double) );
+        std::memcpy( &high, &b_high, sizeof(double) );
+        std::memcpy( &low11, &b_low11, sizeof(double) );
+        const double r1 = ( ( low52 - two52 ) + high ) * two_m53;
+        const double r2 = ( low11 - two52 ) * two_m64;
+        out[i] = ( 1.0 - r1 ) - r2;
+      }
+    }
+  }
+}
+
+void NC::RandXRSRImpl::genmanylanes( double* tgt ) ncnoexceptndebug
+{
+  //Lane k starts k*genmany_lanelength steps ahead of the current state, so the
+  //final state of the last lane is exactly the state after generating the
+  //whole block with genUInt64WithBadLowerBits:
+  static_assert( xrsr_nlanes == genmany_nlanes, "" );
+  uint64_t ls0[xrsr_nlanes];
+  uint64_t ls1[xrsr_nlanes];
+  ls0[0] = m_s[0];
+  ls1[0] = m_s[1];
+  const auto& adv = xrsrLaneAdvancer();
+  for ( unsigned k = 1; k < xrsr_nlanes; ++k ) {
+    ls0[k] = ls0[k-1];
+    ls1[k] = ls1[k-1];
+    adv.advance( ls0[k], ls1[k] );
+  }
+
+  //Work in chunks of rows to keep the raw buffers small. The lanes produce
+  //lane-interleaved rows, which are transposed so lane k fills
+  //tgt[k*genmany_lanelength,(k+1)*genmany_lanelength[, making the output
+  //identical to that of sequential generate() calls:
+  constexpr unsigned nrows_chunk = 64;
+  static_assert( genmany_lanelength % nrows_chunk == 0, "" );
+  uint64_t buf[nrows_chunk * xrsr_nlanes];
+  double dbuf[nrows_chunk * xrsr_nlanes];
+  for ( unsigned r = 0; r < genmany_lanelength; r += nrows_chunk ) {
+    xrsrLanesGenerate( ls0, ls1, buf, nrows_chunk );
+    xrsrConvertToFP01( buf, dbuf, nrows_chunk * xrsr_nlanes );
+    for ( unsigned k = 0; k < xrsr_nlanes; ++k ) {
+      double * ncrestrict lanetgt = tgt + k * genmany_lanelength + r;
+      for ( unsigned i = 0; i < nrows_chunk; ++i )
+        lanetgt[i] = dbuf[i * xrsr_nlanes + k];
+    }
+  }
+
+  m_s[0] = ls0[xrsr_nlanes-1];
+  m_s[1] = ls1[xrsr_nlanes-1];
+}
+
 void NC::RandXRSRImpl::generateMany(std::size_t n, double* tgt) ncnoexceptndebug
 {
   nc_assert( n>0 );
+  constexpr std::size_t nblock = genmany_nlanes * genmany_lanelength;
+  while ( n >= nblock ) {
+    this->genmanylanes(tgt);
+    tgt += nblock;
+    n -= nblock;
+  }
   constexpr int nvect = 1024;
   while ( n >= nvect ) {
     this->genmanyimpl(nvect,tgt);
@@ -564,3 +806,147 @@ void NC::RandXRSRImpl::generateMany(std::size_t n, double* tgt) ncnoexceptndebug
   if ( n )
     this->genmanyimpl(n,tgt);
 }
+
+namespace NCRYSTAL_NAMESPACE {
+  namespace {
+    constexpr uint32_t philox_m0 = 0xD2511F53;
+    constexpr uint32_t philox_m1 = 0xCD9E8D57;
+    constexpr uint32_t philox_w0 = 0x9E3779B9;//golden ratio
+    constexpr uint32_t philox_w1 = 0xBB67AE85;//sqrt(3)-1
+
+    inline void philoxRounds( uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3,
+                              uint32_t k0, uint32_t k1 ) noexcept
+    {
+      for ( unsigned iround = 0; iround < 10; ++iround ) {
+        if ( iround ) {
+          k0 += philox_w0;
+          k1 += philox_w1;
+        }
+        const uint64_t p0 = uint64_t(philox_m0) * c0;
+        const uint64_t p1 = uint64_t(philox_m1) * c2;
+        const uint32_t n0 = static_cast<uint32_t>( p1 >> 32 ) ^ c1 ^ k0;
+        const uint32_t n2 = static_cast<uint32_t>( p0 >> 32 ) ^ c3 ^ k1;
+        c0 = n0;
+        c1 = static_cast<uint32_t>( p1 );
+        c2 = n2;
+        c3 = static_cast<uint32_t>( p0 );
+      }
+    }
+
+    void philoxBlocks( uint64_t key, uint64_t streamid, uint64_t firstblock,
+                       unsigned nblocks, uint64_t * ncrestrict out ) noexcept
+    {
+      //Generate nblocks consecutive blocks, two words each. Written as
+      //independent iterations to allow vectorisation:
+      const uint32_t k0 = static_cast<uint32_t>( key );
+      const uint32_t k1 = static_cast<uint32_t>( key >> 32 );
+      const uint32_t c2 = static_cast<uint32_t>( streamid );
+      const uint32_t c3 = static_cast<uint32_t>( streamid >> 32 );
+      for ( unsigned i = 0; i < nblocks; ++i ) {
+        const uint64_t b = firstblock + i;
+        uint32_t x0 = static_cast<uint32_t>( b );
+        uint32_t x1 = static_cast<uint32_t>( b >> 32 );
+        uint32_t x2 = c2;
+        uint32_t x3 = c3;
+        philoxRounds( x0, x1, x2, x3, k0, k1 );
+        out[2*i] = ( uint64_t(x1) << 32 ) | x0;
+        out[2*i+1] = ( uint64_t(x3) << 32 ) | x2;
+      }
+    }
+
+    inline uint64_t philoxMix64( uint64_t x ) noexcept
+    {
+      //Bijective mixing of 64 bit values (splitmix64 finaliser):
+      x = ( x ^ ( x >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+      x = ( x ^ ( x >> 27 ) ) * 0x94d049bb133111ebull;
+      return x ^ ( x >> 31 );
+    }
+  }
+}
+
+NC::RandPhiloxImpl::block_t NC::RandPhiloxImpl::philox4x32_10( block_t ctr, uint64_t key ) noexcept
+{
+  philoxRounds( ctr[0], ctr[1], ctr[2], ctr[3],
+                static_cast<uint32_t>( key ), static_cast<uint32_t>( key >> 32 ) );
+  return ctr;
+}
+
+NC::RandPhiloxImpl::RandPhiloxImpl( uint64_t theseed )
+{
+  //As for RandXRSRImpl, the seed is passed through splitmix64 to get a well
+  //mixed key:
+  setState( { RandXRSRImpl::splitmix64( theseed ), 0, 0 } );
+}
+
+NC::RandPhiloxImpl::RandPhiloxImpl( const state_t& st )
+{
+  setState( st );
+}
+
+void NC::RandPhiloxImpl::setState( const state_t& st )
+{
+  m_s = st;
+  if ( m_s[2] & 1 )
+    fillBuffer();
+}
+
+void NC::RandPhiloxImpl::fillBuffer() noexcept
+{
+  philoxBlocks( m_s[0], m_s[1], m_s[2] >> 1, 1, m_buf );
+}
+
+namespace NCRYSTAL_NAMESPACE {
+  namespace {
+    constexpr uint64_t philox_domain_byidx = 0x6a09e667f3bcc909ull;
+    constexpr uint64_t philox_domain_jumped = 0xbb67ae8584caa73bull;
+    constexpr uint64_t philox_jumped_streamid_bit = 0x8000000000000000ull;
+
+    RandPhiloxImpl::state_t philoxDeriveState( const RandPhiloxImpl::state_t& s,
+                                               uint64_t domain,
+                                               uint64_t idx ) noexcept
+    {
+      //Hash (key,streamid,domain,idx) into a new (key,streamid) pair:
+      const uint64_t h = philoxMix64( philoxMix64( s[1] ^ domain ) ^ idx );
+      const uint64_t newkey = philoxMix64( s[0] ^ h );
+      const uint64_t newstreamid = philoxMix64( newkey ^ philoxMix64( h + 0x3c6ef372fe94f82bull ) );
+      return { newkey, newstreamid, 0 };
+    }
+  }
+}
+
+NC::RandPhiloxImpl::state_t NC::RandPhiloxImpl::deriveStreamState( uint64_t idx ) const noexcept
+{
+  auto st = philoxDeriveState( m_s, philox_domain_byidx, idx );
+  st[1] &= ~philox_jumped_streamid_bit;
+  return st;
+}
+
+NC::RandPhiloxImpl::state_t NC::RandPhiloxImpl::deriveJumpedState() const noexcept
+{
+  auto st = philoxDeriveState( m_s, philox_domain_jumped, 0 );
+  st[1] |= philox_jumped_streamid_bit;
+  return st;
+}
+
+void NC::RandPhiloxImpl::generateMany(std::size_t n, double* tgt) ncnoexceptndebug
+{
+  nc_assert( n>0 );
+  if ( m_s[2] & 1 ) {
+    //Finish the current block first:
+    *tgt++ = generate();
+    --n;
+  }
+  constexpr unsigned nblocks_chunk = 256;
+  uint64_t buf[2*nblocks_chunk];
+  while ( n >= 2 ) {
+    const unsigned nblocks = static_cast<unsigned>( std::min<std::size_t>( n / 2, nblocks_chunk ) );
+    philoxBlocks( m_s[0], m_s[1], m_s[2] >> 1, nblocks, buf );
+    for ( unsigned i = 0; i < 2*nblocks; ++i )
+      tgt[i] = randUInt64ToFP01( buf[i] );
+    tgt += 2*nblocks;
+    n -= 2*nblocks;
+    m_s[2] += 2*nblocks;
+  }
+  if ( n )
+    *tgt = generate();
+}
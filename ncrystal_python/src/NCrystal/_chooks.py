@@ -502,6 +502,31 @@ def _load(nclib_filename, ncrystal_namespace_protection ):
         #NB: returning the ekin object itself is important in order to keep a reference to it after the call:
         return ndarray_to_dblp(ekin),len(ekin),repeat,ekin
 
+    def _prepare_manystates(ekin,direction):
+        #Array interface for independent neutron states, triggered when either
+        #ekin is an array or direction is an array of shape (N,3). Returns None
+        #in the scalar case, otherwise (shape,N,ekin,ux,uy,uz) where shape is
+        #the broadcast shape of the ekin array and the directions (which
+        #results should be reshaped to), and the last four entries are
+        #contiguous flat numpy arrays of length N:
+        if not hasattr(ekin,'__len__') and not hasattr(direction[0],'__len__'):
+            return None
+        _ensure_numpy()
+        ekin = _np.asarray(ekin,dtype=float)
+        direction = _np.asarray(direction,dtype=float)
+        if direction.ndim not in (1,2) or direction.shape[-1] != 3:
+            raise NCBadInput('Directions must be provided either as a single'
+                             ' (ux,uy,uz) vector or as an array of shape (N,3)')
+        try:
+            shape = _np.broadcast_shapes(ekin.shape,direction.shape[:-1])
+        except ValueError:
+            raise NCBadInput('Incompatible shapes of energy and direction arrays')
+        def _prep(a):
+            return _np.ascontiguousarray(_np.broadcast_to(a,shape),dtype=float).ravel()
+        ekin = _prep(ekin)
+        return ( shape, len(ekin), ekin, _prep(direction[...,0]),
+                 _prep(direction[...,1]), _prep(direction[...,2]) )
+
     _raw_xs_no = _wrap('ncrystal_crosssection_nonoriented',None,(ncrystal_process_t,_dbl,_dblp),hide=True)
     _raw_xs_no_many = _wrap('ncrystal_crosssection_nonoriented_many',None,(ncrystal_process_t,_dblp,_ulong,
                                                                            _ulong,_dblp),hide=True)
@@ -555,7 +580,23 @@ def _load(nclib_filename, ncrystal_namespace_protection ):
             return ekin_final,mu
     functions['ncrystal_samplesct_iso'] = ncrystal_samplesct_iso
 
+    _raw_samplescat_manystates = _wrap('ncrystal_samplescatter_manystates',None,
+                                       ( ncrystal_scatter_t,_dblp,_dblp,_dblp,_dblp,_ulong,
+                                         _dblp,_dblp,_dblp,_dblp),hide=True)
     def ncrystal_samplesct(scat, ekin, direction, repeat):
+        many = _prepare_manystates(ekin,direction)
+        if many is not None:
+            if repeat is not None:
+                raise NCBadInput('The repeat parameter can not be used when'
+                                 ' providing arrays of energies or directions')
+            shape, n, ekin_nparr, ux, uy, uz = many
+            res = [ _create_numpy_double_array(n) for i in range(4) ]
+            if n:
+                _raw_samplescat_manystates(scat,ndarray_to_dblp(ekin_nparr),ndarray_to_dblp(ux),
+                                           ndarray_to_dblp(uy),ndarray_to_dblp(uz),n,
+                                           *(ct for _,ct in res))
+            res_ekin,res_ux,res_uy,res_uz = (a.reshape(shape) for a,_ in res)
+            return res_ekin,(res_ux,res_uy,res_uz)
         cdir = (_dbl * 3)(*direction)
         if not repeat:
             res_dir = (_dbl * 3)(0,0,0)
@@ -573,21 +614,45 @@ def _load(nclib_filename, ncrystal_namespace_protection ):
     functions['ncrystal_samplesct']=ncrystal_samplesct
 
     _raw_xs = _wrap('ncrystal_crosssection',None,(ncrystal_process_t,_dbl,_dbl*3,_dblp),hide=True)
+    _raw_xs_many = _wrap('ncrystal_crosssection_many',None,(ncrystal_process_t,_dblp,_dblp,_dblp,_dblp,
+                                                            _ulong,_dblp),hide=True)
     def ncrystal_crosssection( proc, ekin, direction):
-        res = _dbl()
-        cdir = (_dbl * 3)(*direction)
-        if hasattr(ekin,'__len__'):
-            #Todo: this vectorises on the Python side which is slow!
-            _ensure_numpy()
-            def e2xs(e):
-                _raw_xs(proc,e,cdir,res)
-                return res.value
-            return _np.vectorize(e2xs)(ekin)
-        else:
+        many = _prepare_manystates(ekin,direction)
+        if many is None:
+            res = _dbl()
+            cdir = (_dbl * 3)(*direction)
             _raw_xs(proc,ekin,cdir,res)
             return res.value
+        shape, n, ekin_nparr, ux, uy, uz = many
+        xs, xs_ct = _create_numpy_double_array(n)
+        if n:
+            _raw_xs_many(proc,ndarray_to_dblp(ekin_nparr),ndarray_to_dblp(ux),
+                         ndarray_to_dblp(uy),ndarray_to_dblp(uz),n,xs_ct)
+        return xs.reshape(shape)
     functions['ncrystal_crosssection'] = ncrystal_crosssection
 
+    _raw_xs_samplescat_many = _wrap('ncrystal_crosssection_and_samplescatter_manystates',None,
+                                    (ncrystal_scatter_t,_dblp,_dblp,_dblp,_dblp,_ulong,
+                                     _dblp,_dblp,_dblp,_dblp,_dblp),hide=True)
+    def ncrystal_xs_and_samplesct( scat, ekin, direction ):
+        many = _prepare_manystates(ekin,direction)
+        if many is None:
+            ux,uy,uz = direction
+            c_in = [ _dbl(ekin), _dbl(ux), _dbl(uy), _dbl(uz) ]
+            c_out = [ _dbl() for i in range(5) ]
+            _raw_xs_samplescat_many(scat,*c_in,1,*c_out)
+            xs,ekin_final,ux,uy,uz = (e.value for e in c_out)
+            return xs,ekin_final,(ux,uy,uz)
+        shape, n, ekin_nparr, ux, uy, uz = many
+        res = [ _create_numpy_double_array(n) for i in range(5) ]
+        if n:
+            _raw_xs_samplescat_many(scat,ndarray_to_dblp(ekin_nparr),ndarray_to_dblp(ux),
+                                    ndarray_to_dblp(uy),ndarray_to_dblp(uz),n,
+                                    *(ct for _,ct in res))
+        xs,ekin_final,ux,uy,uz = (a.reshape(shape) for a,_ in res)
+        return xs,ekin_final,(ux,uy,uz)
+    functions['ncrystal_xs_and_samplesct'] = ncrystal_xs_and_samplesct
+
     #Obsolete:
     _raw_gs_no = _wrap('ncrystal_genscatter_nonoriented',None,(ncrystal_scatter_t,_dbl,_dblp,_dblp),hide=True)
     _raw_gs_no_many = _wrap('ncrystal_genscatter_nonoriented_many',None,(ncrystal_scatter_t,_dblp,_ulong,
@@ -672,6 +737,8 @@ def _load(nclib_filename, ncrystal_namespace_protection ):
     _wrap('ncrystal_decodecfg_vdoslux',_uint,(_cstr,))
     _wrap('ncrystal_has_factory',_int,(_cstr,))
     _wrap('ncrystal_clear_caches',None,tuple())
+    _wrap('ncrystal_cachestats_enable',None,(_int,))
+    _wrap('ncrystal_cachestats_reset',None,tuple())
 
     _wrap('ncrystal_rngsupportsstatemanip_ofscatter',_int,( ncrystal_scatter_t, ))
     _wrap('ncrystal_setrngstate_ofscatter',None,(ncrystal_scatter_t, _cstr))
@@ -705,6 +772,12 @@ def _load(nclib_filename, ncrystal_namespace_protection ):
         return json.loads( _decode_and_dealloc_raw_str( _raw_dbg_process( rawprocobj ) ) )
     functions['nc_dbg_proc']=nc_dbg_proc
 
+    _raw_cachestats_json = _wrap('ncrystal_cachestats_json',_charptr,tuple(),hide=True)
+    def nc_cachestats():
+        import json
+        return json.loads( _decode_and_dealloc_raw_str( _raw_cachestats_json() ) )
+    functions['nc_cachestats']=nc_cachestats
+
     _raw_decodecfg_json = _wrap('ncrystal_decodecfg_json',_charptr,(_cstr,),hide=True)
     def nc_cfgstr2json(cfgstr):
         return _decode_and_dealloc_raw_str( _raw_decodecfg_json(_str2cstr(cfgstr) ) )
@@ -715,6 +788,7 @@ def _load(nclib_filename, ncrystal_namespace_protection ):
         return _decode_and_dealloc_raw_str( _raw_ncmat2json(_str2cstr(tdname) ) )
     functions['nc_ncmat2json']=nc_ncmat2json
 
+
     raw_proc_uid = _wrap('ncrystal_process_uid',_charptr,(ncrystal_process_t,),hide=True)
     functions['procuid'] = lambda rawproc : int(_decode_and_dealloc_raw_str(raw_proc_uid(rawproc)))
     raw_info_uid = _wrap('ncrystal_info_uid',_charptr,(ncrystal_info_t,),hide=True)
@@ -187,6 +187,10 @@ examples:
                         help='List currently enabled loaded plugins.')
     parser.add_argument('-b','--browse', action='store_true',
                         help='List data available in standard locations (e.g. the files in the current directory or search path)')
+    parser.add_argument('--cachestats', action='store_true',
+                        help='''Collect statistics of cache hits and misses in the physics
+                        processes while producing plots, and print them at the end (can be
+                        used to see if simulations are dominated by cache thrashing).''')
     parser.add_argument('--extract', type=str, default=None, metavar="DATANAME",
                         help='''Extract contents of DATANAME (e.g. a file name) using the same lookup mechanism as used for data
                         specified in NCrystal cfg strings. This can therefore also be used to inspect
@@ -356,6 +360,9 @@ def std_main( progname, arglist ):
 
     _mpldpi[0] = args.dpi
 
+    if args.cachestats:
+        nccore.enableCacheStats()
+
     cfgs=[Cfg(e,args.common) for e in args.input_cfgs]
     cfgs_normalisedstrings = [c.cfgstr for c in cfgs]
     for cstr in set(cfgs_normalisedstrings):
@@ -410,6 +417,24 @@ def std_main( progname, arglist ):
         pdf.close()
         print("created %s"%_pdffilename)
 
+    if args.cachestats:
+        print_cachestats()
+
+def print_cachestats():
+    from . import core as nccore
+    stats = nccore.getCacheStats()
+    print('==> Cache statistics:')
+    if not stats:
+        print('      (no caches were used)')
+        return
+    w = max(len(e['name']) for e in stats)
+    print('      %s %14s %14s %10s %16s'%('Cache'.ljust(w),'Hits','Misses','Hit rate','Recalc. time'))
+    for e in stats:
+        ntot = e['hits'] + e['misses']
+        hitrate = ( '%.1f%%'%(100.0*e['hits']/ntot) ) if ntot else 'n/a'
+        t = 0.0 if _is_unittest() else e['recalc_time']
+        print('      %s %14i %14i %10s %15.3gs'%(e['name'].ljust(w),e['hits'],e['misses'],hitrate,t))
+
 def create_ekins(npoints,range_override):
     from ._numpy import _np_geomspace
     if range_override:
@@ -39,7 +39,26 @@ def runsim_diffraction_pattern( cfgstr, *,
     This is highly experimental, and not yet fully documented.
 
     Example geomcfg: 'sphere;r=0.1'. This describes a 0.1m=10cm radius sphere
-    centered at (0,0,0).
+    centered at (0,0,0). Other available volumes are 'box' (dx, dy, dz),
+    'slab' (dz) and 'cylinder' (r, dy, with the axis along y). All volumes can
+    be placed elsewhere with the x, y and z parameters (rotations are not
+    supported).
+
+    Several volumes (e.g. a sample inside a container) are described by
+    separating the volumes with '|', listing each volume before the volume it
+    is placed inside, and ending with the outermost volume. In that case
+    cfgstr can also contain one material per volume separated by '|', with
+    'vacuum' indicating an empty volume. Each volume is placed inside the
+    first volume listed after it which completely contains it, and volumes
+    placed inside the same volume can be side-by-side but must not overlap
+    (their bounding boxes must not overlap). Partially overlapping volumes are
+    not supported. Examples:
+
+      geomcfg='sphere;r=0.005|cylinder;r=0.006;dy=0.05'
+      cfgstr='Al_sg225.ncmat|V_sg229.ncmat'
+
+      geomcfg='box;dz=0.01;z=-0.005|box;dz=0.01;z=0.005|box;dx=0.1;dy=0.1;dz=0.1'
+      cfgstr='Al_sg225.ncmat|V_sg229.ncmat|vacuum'
 
     Example srccfg: 'constant;ekin=0.025;n=1e6;z=-0.1'. This starts 1e6 0.025eV
     neutrons at (0,0,-10cm) with a direction (0,0,1).
@@ -1255,7 +1255,18 @@ class Process(RCBase):
         """Check if process is oriented and results depend on the incident direction of the neutron"""
         return not self.isNonOriented()
     def crossSection( self, ekin, direction ):
-        """Access cross sections."""
+        """Access cross sections.
+
+        For efficiency it is possible to provide the ekin parameter as a numpy
+        array of energies and/or the direction parameter as a numpy array of
+        shape (N,3), in order to evaluate cross sections for N independent
+        neutron states at once. A single energy or direction will in this case
+        be reused for all N neutrons, and a numpy array with cross sections is
+        returned. The shape of this array is that of the ekin array (broadcast
+        against the N directions), so multi-dimensional ekin arrays are
+        supported as well.
+
+        """
         return _rawfct['ncrystal_crosssection'](self._rawobj,ekin, direction)
     def crossSectionIsotropic( self, ekin, repeat = None ):
         """Access cross sections (should not be called for oriented processes).
@@ -1468,9 +1479,30 @@ class Scatter(Process):
         causing the scattering to be sampled that many times and numpy arrays
         with results returned.
 
+        Alternatively, scatterings for N independent neutron states can be
+        sampled at once by providing the ekin parameter as a numpy array of
+        energies and/or the direction parameter as a numpy array of shape
+        (N,3). In this case ekin_final, ux, uy and uz are all returned as numpy
+        arrays of length N (or more generally with the shape of the ekin array
+        broadcast against the N directions).
+
         """
         return _rawfct['ncrystal_samplesct'](self._rawobj_scat,ekin,direction,repeat)
 
+    def crossSectionAndSampleScatter( self, ekin, direction ):
+        """Evaluate cross sections and randomly generate scatterings at once.
+
+        This is more efficient than calling crossSection and sampleScatter
+        separately. Returns tuple(xs,ekin_final,direction_final), where
+        direction_final is itself a tuple (ux,uy,uz). As for the sampleScatter
+        method, the ekin parameter can be a numpy array of energies and/or the
+        direction parameter a numpy array of shape (N,3), in which case all
+        results are returned as numpy arrays of length N (or more generally with
+        the shape of the ekin array broadcast against the N directions).
+
+        """
+        return _rawfct['ncrystal_xs_and_samplesct'](self._rawobj_scat,ekin,direction)
+
 
     def sampleScatterIsotropic( self, ekin, repeat = None ):
         """Randomly generate scatterings (should not be called for oriented processes).
@@ -1913,3 +1945,23 @@ def enableFactoryThreads( nthreads = 'auto' ):
     """
     nt = 9999 if nthreads=='auto' else min(9999,max(1,int(nthreads)))
     _rawfct['ncrystal_enable_factory_threadpool'](nt)
+
+def enableCacheStats( flag = True ):
+    """Enable (or disable) collection of statistics of hits, misses and time
+    spent recalculating after misses, for the caches used by physics processes
+    such as SCBragg, LCBragg, PowderBragg or compositions of processes. This can
+    also be enabled by setting the environment variable NCRYSTAL_CACHESTATS=1
+    before NCrystal is loaded. See also getCacheStats() and resetCacheStats().
+    """
+    _rawfct['ncrystal_cachestats_enable'](1 if flag else 0)
+
+def resetCacheStats():
+    """Reset all counters collected after enableCacheStats() was called."""
+    _rawfct['ncrystal_cachestats_reset']()
+
+def getCacheStats():
+    """Return cache statistics collected after enableCacheStats() was called,
+    as a list of dictionaries with keys 'name', 'hits', 'misses' and
+    'recalc_time' (the latter in seconds). Counts are summed over all threads.
+    """
+    return _rawfct['nc_cachestats']()
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+
+################################################################################
+##                                                                            ##
+##  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   ##
+##                                                                            ##
+##  Copyright 2015-2025 NCrystal developers                                   ##
+##                                                                            ##
+##  Licensed under the Apache License, Version 2.0 (the "License");           ##
+##  you may not use this file except in compliance with the License.          ##
+##  You may obtain a copy of the License at                                   ##
+##                                                                            ##
+##      http://www.apache.org/licenses/LICENSE-2.0                            ##
+##                                                                            ##
+##  Unless required by applicable law or agreed to in writing, software       ##
+##  distributed under the License is distributed on an "AS IS" BASIS,         ##
+##  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  ##
+##  See the License for the specific language governing permissions and       ##
+##  limitations under the License.                                            ##
+##                                                                            ##
+################################################################################
+
+# NEEDS: numpy
+
+# Test array interfaces for independent neutron states with per-neutron
+# energies and directions.
+
+import NCTestUtils.enable_fpe # noqa F401
+import NCrystalDev as NC
+import numpy as np
+
+def random_dirs( rng, n ):
+    d = rng.normal(size=(n,3))
+    return d / np.linalg.norm(d,axis=1)[:,np.newaxis]
+
+def test_xs( cfgstr ):
+    print(f'Testing cross sections for "{cfgstr}"')
+    sc = NC.createScatter(cfgstr)
+    rng = np.random.default_rng(1234)
+    n = 1000
+    ekin = rng.uniform(0.001,0.1,size=n)
+    dirs = random_dirs( rng, n )
+    xs = sc.crossSection( ekin, dirs )
+    assert xs.shape == (n,)
+    xs_loop = np.asarray([ sc.crossSection( e, tuple(d) ) for e,d in zip(ekin,dirs) ])
+    assert np.allclose( xs, xs_loop, rtol=1e-10, atol=1e-14 )
+    #Broadcasting of single energy or direction:
+    xs1 = sc.crossSection( 0.02, dirs )
+    assert np.allclose( xs1, [ sc.crossSection( 0.02, tuple(d) ) for d in dirs ],
+                        rtol=1e-10, atol=1e-14 )
+    xs2 = sc.crossSection( ekin, (0.0,0.0,1.0) )
+    assert np.allclose( xs2, [ sc.crossSection( e, (0.0,0.0,1.0) ) for e in ekin ],
+                        rtol=1e-10, atol=1e-14 )
+    assert sc.crossSection( np.zeros(0), dirs[:0] ).shape == (0,)
+    #Multi-dimensional energy arrays keep their shape:
+    xs3 = sc.crossSection( ekin.reshape(20,50), (0.0,0.0,1.0) )
+    assert xs3.shape == (20,50)
+    assert np.array_equal( xs3.ravel(), xs2 )
+    xs4 = sc.crossSection( ekin[:50].reshape(2,25,1), dirs[:25] )
+    assert xs4.shape == (2,25,25)
+    assert xs4[1,3,7] == sc.crossSection( ekin[28], tuple(dirs[7]) )
+    try:
+        sc.crossSection( ekin[:10], dirs[:20] )
+    except NC.NCBadInput:
+        pass
+    else:
+        raise SystemExit('Expected NCBadInput')
+
+def test_scatter( cfgstr ):
+    print(f'Testing scatterings for "{cfgstr}"')
+    sc = NC.createScatter(cfgstr)
+    rng = np.random.default_rng(4321)
+    n = 1000
+    ekin = rng.uniform(0.001,0.1,size=n)
+    dirs = random_dirs( rng, n )
+    ekin_final,(ux,uy,uz) = sc.sampleScatter( ekin, dirs )
+    for a in (ekin_final,ux,uy,uz):
+        assert a.shape == (n,)
+    assert np.all( ekin_final >= 0.0 )
+    assert np.allclose( ux**2+uy**2+uz**2, 1.0, rtol=1e-10 )
+    ekin_final,(ux,uy,uz) = sc.sampleScatter( ekin.reshape(10,100), (0.0,0.0,1.0) )
+    for a in (ekin_final,ux,uy,uz):
+        assert a.shape == (10,100)
+    xs,ekin_final,(ux,uy,uz) = sc.crossSectionAndSampleScatter( ekin.reshape(10,100), (0.0,0.0,1.0) )
+    for a in (xs,ekin_final,ux,uy,uz):
+        assert a.shape == (10,100)
+    xs,ekin_final,(ux,uy,uz) = sc.crossSectionAndSampleScatter( ekin, dirs )
+    assert np.allclose( xs, sc.crossSection( ekin, dirs ), rtol=1e-10, atol=1e-14 )
+    assert np.all( ekin_final >= 0.0 )
+    assert np.allclose( ux**2+uy**2+uz**2, 1.0, rtol=1e-10 )
+    #Scalar versions:
+    xs,ekin_final,(ux,uy,uz) = sc.crossSectionAndSampleScatter( 0.02, (0.0,0.0,1.0) )
+    assert xs == sc.crossSection( 0.02, (0.0,0.0,1.0) )
+    assert ekin_final >= 0.0 and abs(ux**2+uy**2+uz**2-1.0) < 1e-10
+    #Array inputs can not be combined with the repeat parameter:
+    try:
+        sc.sampleScatter( ekin, dirs, repeat = 10 )
+    except NC.NCBadInput:
+        pass
+    else:
+        raise SystemExit('Expected NCBadInput')
+
+def main():
+    test_xs("stdlib::Al_sg225.ncmat;dcutoff=0.5")
+    test_xs("stdlib::Ge_sg227.ncmat;dcutoff=0.5;mos=40.0arcmin;dir1=@crys_hkl:5,1,1"
+            "@lab:0,0,1;dir2=@crys_hkl:0,-1,1@lab:0,1,0")
+    test_scatter("stdlib::Al_sg225.ncmat;dcutoff=0.5;comp=bragg")
+    test_scatter("stdlib::Al_sg225.ncmat;dcutoff=0.5;vdoslux=1")
+    test_scatter("stdlib::Ge_sg227.ncmat;dcutoff=0.5;mos=40.0arcmin;dir1=@crys_hkl:5,1,1"
+                 "@lab:0,0,1;dir2=@crys_hkl:0,-1,1@lab:0,1,0")
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/NCrystal.hh"
+#include "NCrystal/internal/scbragg/NCSCBragg.hh"
+#include "NCrystal/internal/lcbragg/NCLCBragg.hh"
+#include "NCrystal/internal/utils/NCRandUtils.hh"
+#include <iostream>
+
+namespace NC = NCrystal;
+
+namespace {
+
+  //Create SCBragg (lcmode unset) or LCBragg instances with a given number of
+  //cache entries:
+  NC::ProcImpl::ProcPtr createBragg( const std::string& cfgstr,
+                                     unsigned ncacheentries,
+                                     NC::Optional<int> lcmode = NC::NullOpt )
+  {
+    NC::MatCfg cfg(cfgstr);
+    auto info = NC::FactImpl::createInfo(cfg);
+    if ( !lcmode.has_value() )
+      return NC::makeSO<NC::SCBragg>( info, cfg.createSCOrientation(),
+                                      cfg.get_mos(), 0.0, nullptr,
+                                      cfg.get_mosprec(), 0.0, ncacheentries );
+    return NC::makeSO<NC::LCBragg>( info, cfg.createSCOrientation(),
+                                    cfg.get_mos(), cfg.get_lcaxis(),
+                                    lcmode.value(), 0.0, nullptr,
+                                    cfg.get_mosprec(), 0.0, ncacheentries );
+  }
+
+  void compare( const std::string& cfgstr, NC::Optional<int> lcmode = NC::NullOpt )
+  {
+    std::cout<<">>> Comparing "<<(lcmode.has_value()?"LCBragg":"SCBragg")
+             <<" with cache sizes 1 and 4 for \""<<cfgstr<<"\""<<std::endl;
+    auto p1 = createBragg( cfgstr, 1, lcmode );
+    auto p4 = createBragg( cfgstr, 4, lcmode );
+
+    //A handful of neutron states which are visited in an interleaved manner
+    //(sometimes more than fit in the cache):
+    auto rng = NC::createBuiltinRNG(123);
+    std::vector<std::pair<NC::NeutronEnergy,NC::NeutronDirection>> states;
+    for ( unsigned i = 0; i < 6; ++i ) {
+      NC::NeutronEnergy ekin{ NC::NeutronWavelength{ 1.0 + 4.0 * rng->generate() } };
+      states.emplace_back( ekin, NC::randIsotropicDirection( *rng ).as<NC::NeutronDirection>() );
+    }
+
+    auto rng1 = NC::createBuiltinRNG(456);
+    auto rng4 = NC::createBuiltinRNG(456);
+    NC::CachePtr cp1, cp4;
+    for ( unsigned i = 0; i < 3000; ++i ) {
+      //First half cycles through 3 states (fits in the cache), second half
+      //picks randomly among all 6:
+      auto istate = ( i < 1500 ? i % 3 : static_cast<unsigned>( rng->generate() * 6 ) % 6 );
+      const auto& st = states.at(istate);
+      auto xs1 = p1->crossSection( cp1, st.first, st.second );
+      auto xs4 = p4->crossSection( cp4, st.first, st.second );
+      nc_assert_always( xs1.dbl() == xs4.dbl() );
+      auto o1 = p1->sampleScatter( cp1, *rng1, st.first, st.second );
+      auto o4 = p4->sampleScatter( cp4, *rng4, st.first, st.second );
+      nc_assert_always( o1.ekin.dbl() == o4.ekin.dbl() );
+      nc_assert_always( o1.direction[0] == o4.direction[0] );
+      nc_assert_always( o1.direction[1] == o4.direction[1] );
+      nc_assert_always( o1.direction[2] == o4.direction[2] );
+    }
+    std::cout<<"    ... all identical"<<std::endl;
+  }
+}
+
+int main()
+{
+  const char * orient = ";dir1=@crys_hkl:0,0,1@lab:0,0,1;dir2=@crys_hkl:1,0,0@lab:1,0,0";
+  compare( std::string("Al_sg225.ncmat;mos=2deg") + orient );
+  compare( std::string("Al2O3_sg167_Corundum.ncmat;dcutoff=0.6;mos=1deg") + orient );
+  const std::string pg = std::string("C_sg194_pyrolytic_graphite.ncmat;mos=3deg;lcaxis=0,0,1") + orient;
+  compare( pg, 0 );
+  compare( pg, 5 );
+  return 0;
+}
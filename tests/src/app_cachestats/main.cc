@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/NCrystal.hh"
+#include <iostream>
+#include <thread>
+
+namespace NC = NCrystal;
+namespace CS = NCrystal::CacheStats;
+
+namespace {
+  CS::Entry getEntry( const char * name )
+  {
+    for ( auto& e : CS::getStats() )
+      if ( e.name == name )
+        return e;
+    std::cout<<"Missing cache stats entry: "<<name<<std::endl;
+    nc_assert_always(false);
+    return {};
+  }
+
+  void doPowderCalls( NC::Scatter& sc )
+  {
+    //1 miss followed by 9 hits, and then 5 misses:
+    for ( int i = 0; i < 10; ++i )
+      (void)sc.crossSectionIsotropic( NC::NeutronWavelength{ 2.0 } );
+    for ( int i = 0; i < 5; ++i )
+      (void)sc.crossSectionIsotropic( NC::NeutronWavelength{ 1.0 + 0.1 * i } );
+  }
+}
+
+int main()
+{
+  CS::enable(false);
+  nc_assert_always( !CS::isEnabled() );
+
+  auto sc = NC::createScatter("Al_sg225.ncmat;comp=bragg");
+  nc_assert_always( sc.underlying().name() == std::string("PowderBragg") );
+
+  //Nothing recorded while disabled:
+  doPowderCalls( sc );
+  nc_assert_always( getEntry("PowderBragg").hits == 0 );
+  nc_assert_always( getEntry("PowderBragg").misses == 0 );
+
+  CS::enable();
+  nc_assert_always( CS::isEnabled() );
+  doPowderCalls( sc );
+  auto e = getEntry("PowderBragg");
+  std::cout<<"PowderBragg: hits="<<e.hits<<" misses="<<e.misses<<std::endl;
+  nc_assert_always( e.hits == 9 );
+  nc_assert_always( e.misses == 6 );
+  nc_assert_always( e.recalcTime >= 0.0 );
+
+  //Counts from other threads (which have ended) are included:
+  {
+    auto sc2 = sc.clone();
+    std::thread t( [&sc2](){ doPowderCalls( sc2 ); } );
+    t.join();
+  }
+  e = getEntry("PowderBragg");
+  nc_assert_always( e.hits == 18 );
+  nc_assert_always( e.misses == 12 );
+
+  //Single crystals, with hits when repeating the same state (the SCBragg
+  //process is wrapped in a ProcComposition, which has its own cache for
+  //repeated calls):
+  auto scsc = NC::createScatter("Ge_sg227.ncmat;comp=bragg;mos=40.0arcsec"
+                                ";dir1=@crys_hkl:5,1,1@lab:0,0,1"
+                                ";dir2=@crys_hkl:0,-1,1@lab:0,1,0");
+  NC::NeutronDirection dir{ 0.0, 0.6, 0.8 };
+  for ( int i = 0; i < 4; ++i )
+    (void)scsc.crossSection( NC::NeutronWavelength{ 1.5 }, dir );
+  e = getEntry("SCBragg");
+  auto ecomp = getEntry("ProcComposition");
+  std::cout<<"SCBragg: hits="<<e.hits<<" misses="<<e.misses<<std::endl;
+  std::cout<<"ProcComposition: hits="<<ecomp.hits<<" misses="<<ecomp.misses<<std::endl;
+  nc_assert_always( e.misses == 1 );
+  nc_assert_always( e.hits + ecomp.hits == 3 );
+
+  std::cout<<CS::getStatsJSON()<<std::endl;
+
+  CS::reset();
+  for ( auto& ee : CS::getStats() ) {
+    nc_assert_always( ee.hits == 0 );
+    nc_assert_always( ee.misses == 0 );
+    nc_assert_always( ee.recalcTime == 0.0 );
+  }
+  CS::enable(false);
+  return 0;
+}
@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/NCrystal.hh"
+#include "NCrystal/internal/phys_utils/NCElIncXS.hh"
+#include "NCrystal/internal/elincscatter/NCElIncScatter.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
+#include <iostream>
+
+namespace NC = NCrystal;
+
+namespace {
+  void testElIncXS( const NC::VectD& msd, const NC::VectD& bixs, const NC::VectD& scale )
+  {
+    const double tol = 1e-6;
+    NC::ElIncXS exact( msd, bixs, scale );
+    NC::ElIncXS tab( msd, bixs, scale );
+    tab.enableTabulation( tol );
+    nc_assert_always( !exact.isTabulated() );
+    nc_assert_always( tab.isTabulated() );
+    const auto egrid = NC::geomspace( 1e-7, 1e3, 20011 );
+    NC::VectD xs_many( egrid.size() );
+    tab.evaluateMany( egrid, xs_many );
+    double maxerr = 0.0;
+    for ( auto i : NC::ncrange( egrid.size() ) ) {
+      NC::NeutronEnergy ekin{ egrid.at(i) };
+      const double xs_exact = exact.evaluate( ekin ).dbl();
+      const double xs_tab = tab.evaluate( ekin ).dbl();
+      nc_assert_always( xs_tab == xs_many.at(i) );
+      auto a_exact = exact.analyseEnergyPoint( ekin );
+      auto a_tab = tab.analyseEnergyPoint( ekin );
+      nc_assert_always( a_tab.data.size() == a_exact.data.size() );
+      nc_assert_always( a_tab.getXS().dbl() == xs_tab );
+      for ( auto j : NC::ncrange( a_tab.data.size() ) ) {
+        maxerr = std::max( maxerr, NC::ncabs( a_tab.data[j] - a_exact.data[j] ) / xs_exact );
+        if ( j > 0 )
+          nc_assert_always( a_tab.data[j] >= a_tab.data[j-1] );
+      }
+    }
+    std::cout << "Tabulated ElIncXS with "<<msd.size()<<" elements: max rel. deviation "
+              << ( maxerr < tol ? "below" : "ABOVE" ) << " tolerance" << std::endl;
+    nc_assert_always( maxerr < tol );
+  }
+}
+
+int main()
+{
+  testElIncXS( { 0.01 }, { 1.5 }, { 1.0 } );
+  testElIncXS( { 0.005, 0.02, 0.008, 0.0 }, { 0.1, 5.0, 0.0, 2.0 }, { 0.2, 0.3, 0.4, 0.1 } );
+  testElIncXS( { 0.0035, 0.0061 }, { 0.0085, 0.0082 }, { 0.4, 0.6 } );
+
+  //Via ElIncScatter, based on Info objects:
+  auto info = NC::createInfo( "stdlib::Al2O3_sg167_Corundum.ncmat" );
+  NC::ElIncScatter sc_exact( info );
+  NC::ElIncScatterCfg cfg;
+  cfg.tabulate = true;
+  NC::ElIncScatter sc_tab( info, cfg );
+  NC::CachePtr cp_exact, cp_tab;
+  for ( auto e : NC::geomspace( 1e-5, 10.0, 1000 ) ) {
+    NC::NeutronEnergy ekin{ e };
+    const double xs_exact = sc_exact.crossSectionIsotropic( cp_exact, ekin ).dbl();
+    const double xs_tab = sc_tab.crossSectionIsotropic( cp_tab, ekin ).dbl();
+    nc_assert_always( NC::floateq( xs_exact, xs_tab, 1e-6, 0.0 ) );
+  }
+  std::cout << "ElIncScatter cross sections agree with and without tabulation" << std::endl;
+  return 0;
+}
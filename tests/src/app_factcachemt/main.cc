@@ -0,0 +1,201 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/internal/fact_utils/NCFactoryUtils.hh"
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+namespace NC = NCrystal;
+
+namespace {
+
+  std::atomic<unsigned> s_nconstruct{0};
+
+  //Constructions of keys 100-107 only finish once all 8 of them are in
+  //progress at the same time (or after a generous timeout, in which case
+  //s_barrierTimeout is set), which can only happen if constructions of
+  //different keys do not block each other:
+  std::mutex s_barrierMtx;
+  std::condition_variable s_barrierCV;
+  unsigned s_barrierCount = 0;
+  std::atomic<bool> s_barrierTimeout{false};
+
+  void waitAtBarrier()
+  {
+    std::unique_lock<std::mutex> lock(s_barrierMtx);
+    if ( ++s_barrierCount == 8 ) {
+      s_barrierCV.notify_all();
+      return;
+    }
+    if ( !s_barrierCV.wait_for( lock, std::chrono::seconds(60),
+                                [](){ return s_barrierCount >= 8; } ) )
+      s_barrierTimeout = true;
+  }
+
+  //Slow factory, key k -> value k*k. Negative keys gives errors, and keys
+  //above 1000 depend on the value of the key 1000 lower (to test nested
+  //requests):
+  class SlowFactory final : public NC::CachedFactoryBase<int,int,3> {
+  public:
+    const char* factoryName() const final { return "SlowFactory"; }
+    std::string keyToString( const int& key ) const final { return std::to_string(key); }
+  protected:
+    ShPtr actualCreate( const int& key ) const final
+    {
+      ++s_nconstruct;
+      if ( key >= 100 && key < 108 )
+        waitAtBarrier();
+      else
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      if ( key < 0 )
+        NCRYSTAL_THROW(BadInput,"negative key");
+      int v = key*key;
+      if ( key >= 1000 )
+        v = *const_cast<SlowFactory*>(this)->create(key-1000) + 1;
+      return std::make_shared<int>(v);
+    }
+  };
+
+  SlowFactory s_fact;
+
+  template<class TFct>
+  void runInThreads( unsigned nthreads, TFct fct )
+  {
+    std::vector<std::thread> threads;
+    for ( unsigned i = 0; i < nthreads; ++i )
+      threads.emplace_back( [&fct,i](){ fct(i); } );
+    for ( auto& t : threads )
+      t.join();
+  }
+
+  struct KeyWithHash {
+    std::size_t shardHash() const { return 12345; }
+  };
+  struct KeyWithoutHash {};
+}
+
+int main()
+{
+  constexpr unsigned nthreads = 32;
+
+  //Concurrent requests for the same key are deduplicated:
+  {
+    std::vector<std::shared_ptr<const int>> results(nthreads);
+    runInThreads( nthreads, [&results](unsigned i){ results.at(i) = s_fact.create(7); } );
+    nc_assert_always( s_nconstruct == 1 );
+    for ( auto& r : results ) {
+      nc_assert_always( r != nullptr && *r == 49 );
+      nc_assert_always( r == results.front() );
+    }
+  }
+
+  //Concurrent requests for different keys do not block each other:
+  {
+    s_nconstruct = 0;
+    runInThreads( 8, [](unsigned i){ nc_assert_always( *s_fact.create(100+(int)i) == (100+(int)i)*(100+(int)i) ); } );
+    nc_assert_always( s_nconstruct == 8 );
+    nc_assert_always( s_barrierCount == 8 );
+    nc_assert_always( !s_barrierTimeout );
+  }
+
+  //Failed constructions are reported to all threads (each of which will try
+  //again), and do not leave the key blocked:
+  {
+    std::atomic<unsigned> nerrors{0};
+    runInThreads( 4, [&nerrors](unsigned)
+    {
+      try {
+        s_fact.create(-2);
+      } catch ( NC::Error::BadInput& ) {
+        ++nerrors;
+      }
+    } );
+    nc_assert_always( nerrors == 4 );
+  }
+
+  //Nested requests from within constructions:
+  {
+    s_nconstruct = 0;
+    std::vector<std::shared_ptr<const int>> results(nthreads);
+    runInThreads( nthreads, [&results](unsigned i)
+    {
+      results.at(i) = s_fact.create( i%2 ? 1003 : 3 );
+    } );
+    for ( unsigned i = 0; i < nthreads; ++i )
+      nc_assert_always( *results.at(i) == ( i%2 ? 10 : 9 ) );
+    //Nested requests never wait for other threads, so the key 3 might
+    //be constructed twice:
+    nc_assert_always( s_nconstruct == 2 || s_nconstruct == 3 );
+  }
+
+  //Cleanup while constructions are ongoing:
+  {
+    std::vector<std::shared_ptr<const int>> results(nthreads);
+    runInThreads( nthreads, [&results](unsigned i)
+    {
+      if ( i == 0 ) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        s_fact.cleanup();
+      } else {
+        results.at(i) = s_fact.create(11);
+      }
+    } );
+    for ( unsigned i = 1; i < nthreads; ++i )
+      nc_assert_always( *results.at(i) == 121 );
+  }
+
+  //Strong refs are kept to the 3 most recently accessed objects:
+  {
+    s_fact.cleanup();
+    std::weak_ptr<const int> w1 = s_fact.create(1);
+    std::weak_ptr<const int> w2 = s_fact.create(2);
+    std::weak_ptr<const int> w3 = s_fact.create(3);
+    s_fact.create(1);
+    s_fact.create(4);//evicts 2
+    nc_assert_always( !w1.expired() );
+    nc_assert_always( w2.expired() );
+    nc_assert_always( !w3.expired() );
+    s_fact.create(3);
+    s_fact.create(5);//evicts 1
+    nc_assert_always( w1.expired() );
+    nc_assert_always( !w3.expired() );
+    auto stats = s_fact.currentStats();
+    nc_assert_always( stats.nstrongrefs == 3 );
+    nc_assert_always( stats.nweakrefs == 5 );
+    s_fact.cleanup();
+    nc_assert_always( w3.expired() );
+    stats = s_fact.currentStats();
+    nc_assert_always( stats.nstrongrefs == 0 && stats.nweakrefs == 0 );
+  }
+
+  //Shard hashes:
+  nc_assert_always( NC::cachedFactoryShardHash( KeyWithHash() ) == 12345 );
+  nc_assert_always( NC::cachedFactoryShardHash( KeyWithoutHash() ) == 0 );
+  nc_assert_always( NC::cachedFactoryShardHash( 17 ) == 17 );
+  nc_assert_always( NC::cachedFactoryShardHash( std::make_tuple(17u,KeyWithoutHash()) ) == 17 );
+  nc_assert_always( NC::cachedFactoryShardHash( std::make_pair(KeyWithHash(),1) ) == 12345 );
+  nc_assert_always( NC::cachedFactoryShardHash( std::string("abc") )
+                    == std::hash<std::string>()("abc") );
+
+  std::cout<<"All tests OK"<<std::endl;
+  return 0;
+}
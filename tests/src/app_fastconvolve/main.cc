@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/internal/utils/NCFastConvolve.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
+#include <iostream>
+
+namespace NC = NCrystal;
+
+namespace {
+
+  NC::VectD makeInput( std::size_t n, double phase )
+  {
+    //Smooth non-negative input, with some structure:
+    NC::VectD v;
+    v.reserve( n );
+    for ( std::size_t i = 0; i < n; ++i ) {
+      const double s = std::sin( phase + 0.37 * i );
+      v.push_back( 0.1 + s * s * std::exp( -0.002 * i ) );
+    }
+    return v;
+  }
+
+  NC::VectD directConvolve( const NC::VectD& a1, const NC::VectD& a2, double dt )
+  {
+    NC::VectD y( a1.size() + a2.size() - 1, 0.0 );
+    for ( std::size_t i = 0; i < a1.size(); ++i )
+      for ( std::size_t j = 0; j < a2.size(); ++j )
+        y[i+j] += a1[i] * a2[j];
+    for ( auto& e : y )
+      e *= dt;
+    return y;
+  }
+
+  double maxAbsDiff( const NC::VectD& a, const NC::VectD& b )
+  {
+    nc_assert_always( a.size() == b.size() );
+    double res = 0.0;
+    for ( std::size_t i = 0; i < a.size(); ++i )
+      res = NC::ncmax( res, NC::ncabs( a[i] - b[i] ) );
+    return res;
+  }
+
+  void testVsDirect( NC::FastConvolve& fc, std::size_t n1, std::size_t n2, double dt )
+  {
+    const auto a1 = makeInput( n1, 0.3 );
+    const auto a2 = makeInput( n2, 1.1 );
+    NC::VectD y;
+    fc.convolve( a1, a2, y, dt );
+    const auto yref = directConvolve( a1, a2, dt );
+    const double ymax = *std::max_element( yref.begin(), yref.end() );
+    const double diff = maxAbsDiff( y, yref );
+    std::cout << "FastConvolve n1=" << n1 << " n2=" << n2
+              << " : max deviation from direct convolution relative to max value "
+              << ( diff / ymax < 1e-13 ? "<1e-13" : "TOO LARGE" ) << std::endl;
+    nc_assert_always( diff <= 1e-13 * ymax );
+
+    //Results do not depend on the state left over from previous convolutions:
+    NC::FastConvolve fc_fresh;
+    NC::VectD y_fresh;
+    fc_fresh.convolve( a1, a2, y_fresh, dt );
+    nc_assert_always( y == y_fresh );
+  }
+
+  void testVsPreviousImplementation()
+  {
+    //Reference values produced by the original implementation (two separate
+    //complex FFTs with plain radix-2 stages), for two cases with an even
+    //respectively odd number of FFT stages:
+    struct RefCase {
+      std::size_t n1, n2;
+      double dt;
+      std::vector<std::pair<std::size_t,double>> refvals;
+    };
+    const std::vector<RefCase> cases = {
+      { 1000, 700, 0.01,
+        { { 0, 0.0016752191783245963 },
+          { 1, 0.0063737824552895367 },
+          { 17, 0.041725129060409961 },
+          { 566, 1.0355698363679642 },
+          { 849, 0.57131457086748716 },
+          { 1697, 0.0011628624507753927 },
+          { 1698, 0.00046683379909403302 } } },
+      { 3001, 2000, 0.5,
+        { { 0, 0.083760958916228034 },
+          { 1, 0.31868912276448658 },
+          { 17, 2.0862564530205097 },
+          { 1666, 37.930184515217277 },
+          { 2500, 29.140158836381755 },
+          { 4998, 0.011284825566171719 },
+          { 4999, 0.0054928018589563976 } } }
+    };
+    NC::FastConvolve fc;
+    for ( auto& c : cases ) {
+      NC::VectD y;
+      fc.convolve( makeInput( c.n1, 0.3 ), makeInput( c.n2, 1.1 ), y, c.dt );
+      nc_assert_always( y.size() == c.n1 + c.n2 - 1 );
+      const double ymax = *std::max_element( y.begin(), y.end() );
+      for ( auto& e : c.refvals )
+        nc_assert_always( NC::ncabs( y.at( e.first ) - e.second ) <= 1e-13 * ymax );
+    }
+    std::cout << "FastConvolve agrees with reference values from previous implementation" << std::endl;
+  }
+}
+
+int main()
+{
+  NC::FastConvolve fc;
+  //Cover both even and odd numbers of FFT stages (the latter needing a final
+  //radix-2 pass), and reuse the same object for different sizes:
+  testVsDirect( fc, 1, 1, 1.0 );
+  testVsDirect( fc, 2, 1, 1.0 );
+  testVsDirect( fc, 2, 3, 0.5 );
+  testVsDirect( fc, 5, 7, 2.0 );
+  testVsDirect( fc, 100, 37, 0.1 );
+  testVsDirect( fc, 1000, 1000, 0.01 );
+  testVsDirect( fc, 40, 5, 1.0 );
+  testVsDirect( fc, 4097, 10, 0.3 );
+  testVsDirect( fc, 3000, 1500, 0.02 );
+  testVsPreviousImplementation();
+  return 0;
+}
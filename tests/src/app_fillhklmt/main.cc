@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/NCrystal.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
+#include <iostream>
+#include <sstream>
+
+namespace NC = NCrystal;
+
+namespace {
+  //Textual dump of all HKL planes (including explicit HKL lists) with full
+  //floating point precision:
+  std::string dumpHKLList( const char * cfgstr )
+  {
+    std::ostringstream ss;
+    ss.precision(17);
+    auto info = NC::createInfo( cfgstr );
+    for ( auto& e : info->hklList() ) {
+      ss << e.hkl.h << ' ' << e.hkl.k << ' ' << e.hkl.l << ' '
+         << e.multiplicity << ' ' << e.dspacing << ' ' << e.fsquared;
+      if ( e.explicitValues && e.explicitValues->list.has_value<std::vector<NC::HKL>>() )
+        for ( auto& x : e.explicitValues->list.get<std::vector<NC::HKL>>() )
+          ss << ' ' << x.h << ',' << x.k << ',' << x.l;
+      ss << '\n';
+    }
+    return ss.str();
+  }
+}
+
+int main()
+{
+  //Check that the HKL lists do not depend on the number of factory threads
+  //used, both with and without space group symmetry:
+  NC::DataSources::registerInMemoryFileData(
+    "nosg.ncmat",
+    "NCMAT v5\n"
+    "@CELL\n lengths 4.5 5.1 6.2\n angles 90 95 100\n"
+    "@ATOMPOSITIONS\n Al 0 0 0\n O 0.1 0.2 0.3\n O 0.4 0.7 0.9\n Si 0.25 0.6 0.15\n"
+    "@DEBYETEMPERATURE\n Al 400\n O 500\n Si 450\n" );
+  const char * cfgstrs[] = { "Al2O3_sg167_Corundum.ncmat;dcutoff=0.3",
+                             "Y2SiO5_sg15_YSO.ncmat;dcutoff=0.3",
+                             "nosg.ncmat;dcutoff=0.3" };
+  for ( auto cfgstr : cfgstrs ) {
+    NC::clearCaches();
+    NC::FactoryThreadPool::enable( NC::ThreadCount{ 0 } );
+    auto res_st = dumpHKLList( cfgstr );
+    NC::clearCaches();
+    NC::FactoryThreadPool::enable( NC::ThreadCount{ 4 } );
+    auto res_mt = dumpHKLList( cfgstr );
+    NC::FactoryThreadPool::enable( NC::ThreadCount{ 0 } );
+    if ( res_st != res_mt ) {
+      std::cout<<"HKL lists differ with and without factory threads for \""<<cfgstr<<"\""<<std::endl;
+      return 1;
+    }
+    std::cout<<"HKL list for \""<<cfgstr<<"\" identical with and without factory threads ("
+             <<res_st.size()<<" bytes)"<<std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/interfaces/NCRNG.hh"
+#include "NCrystal/internal/utils/NCLogGridIndex.hh"
+#include "NCrystal/internal/utils/NCRandUtils.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
+#include <iostream>
+
+namespace NC = NCrystal;
+
+namespace {
+  void testGrid( const NC::VectD& grid, NC::RNG& rng )
+  {
+    NC::LogGridIndex idx( grid );
+    nc_assert_always( idx.isValid() );
+    auto check = [&grid,&idx]( double x )
+    {
+      const std::size_t expected = std::upper_bound( grid.begin(), grid.end(), x ) - grid.begin();
+      const std::size_t res = idx.upperBoundIdx( grid, x );
+      if ( res != expected ) {
+        std::cout<<"Mismatch for x="<<x<<": "<<res<<" vs. "<<expected<<std::endl;
+        nc_assert_always(false);
+      }
+    };
+    //Grid points themselves and their neighbours:
+    for ( auto g : grid ) {
+      check( g );
+      check( std::nextafter( g, 0.0 ) );
+      check( std::nextafter( g, NC::kInfinity ) );
+    }
+    //Outside and edge cases:
+    for ( double x : { 0.0, -1.0, 1e-300, NC::kInfinity, -NC::kInfinity, std::nan("") } )
+      check( x );
+    //Random values across the range (uniform in log):
+    const double lmin = std::log( grid.front() ) - 1.0;
+    const double lmax = std::log( grid.back() ) + 1.0;
+    for ( unsigned i = 0; i < 100000; ++i )
+      check( std::exp( lmin + ( lmax - lmin ) * rng.generate() ) );
+  }
+}
+
+int main()
+{
+  auto rng = NC::createBuiltinRNG(1234);
+  testGrid( { 1.0 }, *rng );
+  testGrid( { 1e-5, 1e-5, 2e-5 }, *rng );
+  testGrid( NC::logspace( -5, 1, 300 ), *rng );
+  testGrid( NC::linspace( 0.01, 10.0, 1000 ), *rng );
+  {
+    //Irregular grid with clusters and duplicates:
+    NC::VectD v;
+    for ( unsigned i = 0; i < 500; ++i )
+      v.push_back( std::exp( -20.0 + 25.0 * rng->generate() * rng->generate() ) );
+    v.push_back( v.front() );
+    v.push_back( v.back() );
+    std::sort( v.begin(), v.end() );
+    testGrid( v, *rng );
+  }
+  std::cout<<"All LogGridIndex lookups agree with std::upper_bound"<<std::endl;
+  return 0;
+}
@@ -0,0 +1,106 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#include "NCrystal/internal/minimc/NCMMC_BasketMgr.hh"
+#include "NCrystal/internal/minimc/NCMMC_Basket.hh"
+#include <iostream>
+#include <thread>
+#include <algorithm>
+
+namespace NC = NCrystal;
+namespace NCMMC = NCrystal::MiniMC;
+
+namespace {
+  struct NoCache {
+    void copyEntryFromOther( const NoCache&, std::size_t, std::size_t ) noexcept {}
+    void copyEntriesFromOther( const NoCache&, std::size_t,
+                               std::size_t, std::size_t ) noexcept {}
+  };
+  using basket_t = NCMMC::CachedNeutronBasket<NoCache>;
+  using basketmgr_t = NCMMC::BasketMgr<basket_t>;
+
+  //Each thread adds a number of partially filled pending baskets, with the x
+  //coordinate of each neutron holding a unique id, and then takes (possibly
+  //merged or stolen) baskets until none are left. All ids must be seen exactly
+  //once in the end.
+  void doWork( basketmgr_t& mgr, unsigned ithread, unsigned nbaskets,
+               std::vector<unsigned>& ids_seen, std::size_t& nmerged_out )
+  {
+    auto rng = NC::createBuiltinRNG( 1000 + ithread );
+    for ( auto ib : NC::ncrange( nbaskets ) ) {
+      auto bh = mgr.allocateBasket();
+      auto& n = bh.basket().neutrons;
+      n.nused = 1 + static_cast<std::size_t>( rng->generate() * 1500 );
+      for ( auto i : NC::ncrange( n.nused ) )
+        n.x[i] = double( ( ithread * nbaskets + ib ) * NCMMC::basket_N + i );
+      mgr.addPendingBasket( std::move(bh) );
+    }
+    while ( true ) {
+      auto bh = mgr.getPendingBasketOrAllocateEmpty( NC::ThreadCount{ 4 } );
+      nc_assert_always( bh.valid() );
+      if ( bh.basket().empty() ) {
+        mgr.deallocateBasket( std::move(bh) );
+        return;
+      }
+      nc_assert_always( bh.basket().size() <= NCMMC::basket_N );
+      for ( auto i : NC::ncrange( bh.basket().size() ) )
+        ids_seen.push_back( static_cast<unsigned>( bh.basket().neutrons.x[i] ) );
+      nmerged_out += bh.basket().size();
+      mgr.deallocateBasket( std::move(bh) );
+    }
+  }
+}
+
+int main()
+{
+  const unsigned nthreads = 4;
+  const unsigned nbaskets = 50;
+  basketmgr_t mgr;
+  std::vector<std::vector<unsigned>> ids_seen( nthreads );
+  std::vector<std::size_t> ntaken( nthreads, 0 );
+  std::vector<std::thread> threads;
+  for ( auto ithread : NC::ncrange( nthreads ) )
+    threads.emplace_back( [&mgr,&ids_seen,&ntaken,ithread,nbaskets]()
+    {
+      doWork( mgr, ithread, nbaskets, ids_seen.at(ithread), ntaken.at(ithread) );
+    } );
+  for ( auto& t : threads )
+    t.join();
+
+  //Nothing should be left behind:
+  nc_assert_always( !mgr.getPendingBasket().valid() );
+  std::vector<unsigned> ids;
+  for ( auto& v : ids_seen )
+    ids.insert( ids.end(), v.begin(), v.end() );
+  std::sort( ids.begin(), ids.end() );
+  nc_assert_always( std::adjacent_find( ids.begin(), ids.end() ) == ids.end() );
+
+  //Count expected number of neutrons, by redoing the basket sizes:
+  std::size_t nexpected = 0;
+  for ( auto ithread : NC::ncrange( nthreads ) ) {
+    auto rng = NC::createBuiltinRNG( 1000 + ithread );
+    for ( auto ib : NC::ncrange( nbaskets ) ) {
+      (void)ib;
+      nexpected += 1 + static_cast<std::size_t>( rng->generate() * 1500 );
+    }
+  }
+  nc_assert_always( ids.size() == nexpected );
+  std::cout<<"All "<<nexpected<<" neutrons retrieved exactly once"<<std::endl;
+  return 0;
+}
@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#include "NCrystal/internal/minimc/NCMMC_RunSim.hh"
+#include "NCrystal/internal/minimc/NCMMC_StdEngine.hh"
+#include "NCrystal/internal/minimc/NCMMC_StdTallies.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
+#include <iostream>
+
+namespace NC = NCrystal;
+namespace NCMMC = NCrystal::MiniMC;
+
+namespace {
+  struct Result {
+    double wtot = 0.0;//total weight of exiting neutrons
+    double wscat = 0.0;//part of that with exit angles above 1 degree
+  };
+
+  Result runSim( const char * geomcfg, const char * matcfgs )
+  {
+    using basket_t = NCMMC::StdEngine::basket_t;
+    auto tally = NC::makeSO<NCMMC::Tally_ExitAngle<basket_t>>();
+    NCMMC::runSim_StdEngine( NC::ThreadCount{ 2 },
+                             NCMMC::createGeometry( geomcfg ),
+                             NCMMC::createSource( "constant;n=20000;z=-0.2;wl=1.8" ),
+                             tally,
+                             NCMMC::createMatDefs( matcfgs ) );
+    Result res;
+    auto ct = tally->getExitAngleBinned().getContents();
+    for ( auto i : NC::ncrange( ct.size() ) ) {
+      res.wtot += ct[i];
+      if ( i >= 10 )//10 bins per degree
+        res.wscat += ct[i];
+    }
+    std::cout<<"Geom \""<<geomcfg<<"\" with materials \""<<matcfgs<<"\": "
+             <<"wtot="<<NC::fmt(res.wtot)<<" wscat="<<NC::fmt(res.wscat)<<std::endl;
+    return res;
+  }
+
+  void checkCompatible( const Result& a, const Result& b )
+  {
+    nc_assert_always( NC::floateq( a.wtot, b.wtot, 0.02, 0.0 ) );
+    nc_assert_always( NC::floateq( a.wscat, b.wscat, 0.05, 0.0 ) );
+  }
+}
+
+int main()
+{
+  const char * mat = "Al_sg225.ncmat;comp=elas";
+
+  //Splitting a volume into layers of the same material, or adding a vacuum
+  //layer around it, should not change the results:
+  auto ref = runSim( "sphere;r=0.01", mat );
+  nc_assert_always( ref.wscat > 0.05 * ref.wtot );
+  checkCompatible( ref, runSim( "sphere;r=0.005|sphere;r=0.01",
+                                "Al_sg225.ncmat;comp=elas|Al_sg225.ncmat;comp=elas" ) );
+  checkCompatible( ref, runSim( "sphere;r=0.004|sphere;r=0.007|sphere;r=0.01", mat ) );
+  checkCompatible( ref, runSim( "sphere;r=0.01|box;dx=0.1;dy=0.1;dz=0.1",
+                                "Al_sg225.ncmat;comp=elas|vacuum" ) );
+  checkCompatible( ref, runSim( "sphere;r=0.01|cylinder;r=0.02;dy=0.1|slab;dz=0.3",
+                                "Al_sg225.ncmat;comp=elas|vacuum|vacuum" ) );
+
+  //A vacuum gap inside the sphere must reduce the scattering, and a vacuum
+  //sphere should not scatter at all:
+  auto gap = runSim( "sphere;r=0.005|sphere;r=0.01",
+                     "vacuum|Al_sg225.ncmat;comp=elas" );
+  nc_assert_always( gap.wscat < 0.95 * ref.wscat );
+  auto empty = runSim( "sphere;r=0.01", "vacuum" );
+  nc_assert_always( empty.wscat == 0.0 );
+  nc_assert_always( NC::floateq( empty.wtot, 20000.0 ) );
+
+  //Displacing the sphere along the beam inside a vacuum box should not change
+  //the results, but displacing it sideways out of the beam removes all
+  //scattering:
+  checkCompatible( ref, runSim( "sphere;r=0.01;z=0.05|box;dx=0.1;dy=0.1;dz=0.2",
+                                "Al_sg225.ncmat;comp=elas|vacuum" ) );
+  auto missed = runSim( "sphere;r=0.01;x=0.02|box;dx=0.1;dy=0.1;dz=0.2",
+                        "Al_sg225.ncmat;comp=elas|vacuum" );
+  nc_assert_always( missed.wscat == 0.0 );
+
+  //Splitting a box into two adjacent boxes (one of which has a sphere placed
+  //inside it) of the same material should not change the results, while
+  //making one of them vacuum should reduce the scattering:
+  auto refbox = runSim( "box;dx=0.02;dy=0.02;dz=0.02", mat );
+  const char * adjgeom = ( "sphere;r=0.004;z=-0.005"
+                           "|box;dx=0.02;dy=0.02;dz=0.01;z=-0.005"
+                           "|box;dx=0.02;dy=0.02;dz=0.01;z=0.005"
+                           "|box;dx=0.1;dy=0.1;dz=0.1" );
+  checkCompatible( refbox, runSim( adjgeom, "Al_sg225.ncmat;comp=elas|Al_sg225.ncmat;comp=elas"
+                                   "|Al_sg225.ncmat;comp=elas|vacuum" ) );
+  auto halfbox = runSim( adjgeom, "Al_sg225.ncmat;comp=elas|Al_sg225.ncmat;comp=elas"
+                         "|vacuum|vacuum" );
+  nc_assert_always( halfbox.wscat < 0.8 * refbox.wscat );
+  nc_assert_always( halfbox.wscat > 0.2 * refbox.wscat );
+
+  //Volumes which are not completely contained in a volume listed after them,
+  //or which overlap other volumes placed in the same volume, must be
+  //rejected:
+  for ( auto badgeom : { "sphere;r=0.02|sphere;r=0.01",
+                         "sphere;r=0.01|box;dx=0.02;dy=0.02;dz=0.015",
+                         "box;dx=0.02;dy=0.02;dz=0.02|sphere;r=0.015",
+                         "cylinder;r=0.01;dy=0.1|box;dx=0.1;dy=0.05;dz=0.1",
+                         "cylinder;r=0.01;dy=0.02|sphere;r=0.0141",
+                         "sphere;r=0.005|slab;dz=0.01|sphere;r=600",
+                         "sphere;r=0.01;x=0.045|box;dx=0.1;dy=0.1;dz=0.1",
+                         "cylinder;r=0.01;dy=0.02;y=0.045|box;dx=0.1;dy=0.1;dz=0.1",
+                         "sphere;r=0.01;x=-0.005|sphere;r=0.01;x=0.005|box;dx=0.1;dy=0.1;dz=0.1",
+                         "box;dx=0.05;dy=0.05;dz=0.05|sphere;r=0.01|box;dx=0.1;dy=0.1;dz=0.1" } ) {
+    bool rejected = false;
+    try {
+      NCMMC::createGeometry( badgeom );
+    } catch ( NC::Error::BadInput& e ) {
+      std::cout<<"Rejected geom \""<<badgeom<<"\": "<<e.what()<<std::endl;
+      rejected = true;
+    }
+    nc_assert_always( rejected );
+  }
+  //Touching boundaries are fine:
+  NCMMC::createGeometry( "sphere;r=0.01|box;dx=0.02;dy=0.02;dz=0.02" );
+  NCMMC::createGeometry( "cylinder;r=0.01;dy=0.02|sphere;r=0.0142" );
+  NCMMC::createGeometry( "sphere;r=0.01;x=0.04|box;dx=0.1;dy=0.1;dz=0.1" );
+  NCMMC::createGeometry( "box;dx=0.02;dy=0.02;dz=0.02;x=-0.01"
+                         "|box;dx=0.02;dy=0.02;dz=0.02;x=0.01"
+                         "|cylinder;r=0.03;dy=0.02;z=0.001" );
+
+  //Simple (non-layered) boxes and cylinders:
+  runSim( "box;dx=0.02;dy=0.02;dz=0.02", mat );
+  runSim( "cylinder;r=0.01;dy=0.05", mat );
+  return 0;
+}
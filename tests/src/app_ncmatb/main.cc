@@ -0,0 +1,189 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/NCrystal.hh"
+#include "NCrystal/internal/ncmat/NCNCMATB.hh"
+#include "NCrystal/internal/ncmat/NCParseNCMAT.hh"
+#include "NCrystal/internal/ncmat/NCLoadNCMAT.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
+#include <chrono>
+#include <iostream>
+
+namespace NC = NCrystal;
+
+namespace {
+
+  //Cross sections and sampled scatterings:
+  NC::VectD getResults( const std::string& cfgstr )
+  {
+    NC::VectD res;
+    auto sc = NC::createScatter( cfgstr );
+    auto& proc = sc.underlying();
+    NC::CachePtr cp;
+    auto rng = NC::createBuiltinRNG(12345);
+    for ( double e : NC::logspace( -5, 1, 20 ) ) {
+      NC::NeutronEnergy ekin{ e };
+      res.push_back( proc.crossSectionIsotropic( cp, ekin ).dbl() );
+      for ( int i = 0; i < 5; ++i ) {
+        auto outcome = proc.sampleScatterIsotropic( cp, *rng, ekin );
+        res.push_back( outcome.ekin.dbl() );
+        res.push_back( outcome.mu.dbl() );
+      }
+    }
+    auto info = NC::createInfo( cfgstr );
+    res.push_back( info->getTemperature().dbl() );
+    res.push_back( info->getDensity().dbl() );
+    return res;
+  }
+
+  std::string lastLine( const std::string& s )
+  {
+    nc_assert_always( !s.empty() && s.back() == '\n' );
+    return s.substr( s.rfind( '\n', s.size() - 2 ) + 1 );
+  }
+
+  void testFile( const std::string& name )
+  {
+    std::cout << "Testing " << name << std::endl;
+    auto td = NC::FactImpl::createTextData( name );
+    const std::string binary = NC::convertNCMATToNCMATB( td );
+    const std::string binname = name.substr( 0, name.rfind('.') ) + "_converted.ncmatb";
+    NC::DataSources::registerInMemoryFileData( binname, std::string( binary ) );
+    auto td_bin = NC::FactImpl::createTextData( binname );
+    nc_assert_always( td_bin->dataType() == "ncmatb" );
+
+    //Decoded data must be identical to the parsed text data:
+    auto data_bin = NC::parseNCMATBData( td_bin );
+    auto data_txt = NC::parseNCMATData( td );
+    data_bin.sourceDescription = data_txt.sourceDescription;
+    nc_assert_always( lastLine( NC::encodeNCMATB( data_txt ) )
+                      == lastLine( NC::encodeNCMATB( data_bin ) ) );
+
+    //As must the resulting physics:
+    auto res_txt = getResults( name );
+    auto res_bin = getResults( binname );
+    nc_assert_always( res_txt.size() == res_bin.size() );
+    for ( auto i : NC::ncrange( res_txt.size() ) ) {
+      if ( res_txt[i] != res_bin[i] ) {
+        std::cout << "Results differ at index " << i << ": "
+                  << res_txt[i] << " vs. " << res_bin[i] << std::endl;
+        std::exit(1);
+      }
+    }
+    std::cout << "  Results identical (" << res_txt.size() << " values)" << std::endl;
+  }
+
+  //Best of several timings of a function (in seconds):
+  template<class TFct>
+  double bestTime( TFct fct )
+  {
+    double best = -1.0;
+    for ( int i = 0; i < 5; ++i ) {
+      auto t0 = std::chrono::steady_clock::now();
+      fct();
+      const double dt = std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+      if ( best < 0.0 || dt < best )
+        best = dt;
+    }
+    return best;
+  }
+
+  //The whole point of the NCMATB format is to avoid the time spent parsing
+  //large @DYNINFO sections, so check that it actually does so:
+  void testParseTime( const std::string& name )
+  {
+    auto td = NC::FactImpl::createTextData( name );
+    const std::string binname = name.substr( 0, name.rfind('.') ) + "_timing.ncmatb";
+    NC::DataSources::registerInMemoryFileData( binname, NC::convertNCMATToNCMATB( td ) );
+    auto td_bin = NC::FactImpl::createTextData( binname );
+    std::size_t ntxt(0), nbin(0);
+    const double t_txt = bestTime( [&td,&ntxt](){ ntxt += NC::parseNCMATData( td ).dyninfos.size(); } );
+    const double t_bin = bestTime( [&td_bin,&nbin](){ nbin += NC::parseNCMATBData( td_bin ).dyninfos.size(); } );
+    nc_assert_always( ntxt == nbin && ntxt > 0 );
+    std::cout << "Parse time of " << name << ": " << NC::fmt( t_txt*1e3 ) << " ms (NCMAT) vs. "
+              << NC::fmt( t_bin*1e3 ) << " ms (NCMATB), speedup "
+              << NC::fmt( t_txt / t_bin ) << "x" << std::endl;
+    //Generous margin to avoid sporadic failures on busy machines (the actual
+    //speedup is typically much larger):
+    nc_assert_always( t_bin < 0.5 * t_txt );
+  }
+
+  void expectBadInput( const std::string& content, const char * name )
+  {
+    NC::DataSources::registerInMemoryFileData( name, std::string( content ) );
+    try {
+      NC::createInfo( name );
+    } catch ( NC::Error::BadInput& e ) {
+      std::cout << "Got expected error: " << e.what() << std::endl;
+      return;
+    }
+    std::cout << "Did not get expected error for " << name << std::endl;
+    std::exit(1);
+  }
+
+}
+
+int main()
+{
+  NC::setNCMATWarnOnCustomSections( false );
+
+  NC::DataSources::registerInMemoryFileData( "custom.ncmat",
+                                             "NCMAT v7\n"
+                                             "# NCRYSTALMATCFG[temp=250K]\n"
+                                             "@STATEOFMATTER\n"
+                                             "  gas\n"
+                                             "@DENSITY\n"
+                                             "  0.5 kg_per_m3\n"
+                                             "@ATOMDB\n"
+                                             "  He 10u 5fm 1b 2b\n"
+                                             "@DYNINFO\n"
+                                             "  element He\n"
+                                             "  fraction 1\n"
+                                             "  type freegas\n"
+                                             "@CUSTOM_TESTDATA\n"
+                                             "  hello world\n"
+                                             "  1 2 3\n" );
+
+  testFile( "Al_sg225.ncmat" );
+  testFile( "LiquidHeavyWaterD2O_T293.6K.ncmat" );
+  testFile( "C_sg194_pyrolytic_graphite.ncmat" );
+  testFile( "custom.ncmat" );
+
+  testParseTime( "LiquidHeavyWaterD2O_T293.6K.ncmat" );
+
+  //Embedded cfg-strings must be retained:
+  nc_assert_always( NC::createInfo( "custom_converted.ncmatb" )->getTemperature().dbl() == 250.0 );
+
+  //Problems must be detected:
+  const std::string binary = NC::convertNCMATToNCMATB( NC::FactImpl::createTextData( "Al_sg225.ncmat" ) );
+  {
+    std::string corrupted = binary;
+    auto& c = corrupted[ corrupted.size() - 20 ];
+    c = ( c == 'A' ? 'B' : 'A' );
+    expectBadInput( corrupted, "corrupted.ncmatb" );
+  }
+  expectBadInput( binary.substr( 0, binary.size() - 9 ) + "\n", "truncated.ncmatb" );
+  {
+    std::string wrongversion = binary;
+    wrongversion[ 8 ] = '9';
+    expectBadInput( wrongversion, "wrongversion.ncmatb" );
+  }
+  return 0;
+}
@@ -0,0 +1,221 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/NCrystal.hh"
+#include "NCrystal/internal/utils/NCPersistentCache.hh"
+#include "NCrystal/internal/utils/NCFileUtils.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
+#include <fstream>
+#include <iostream>
+
+namespace NC = NCrystal;
+namespace NPC = NCrystal::PersistentCache;
+
+namespace {
+
+  //Cross sections and sampled scatterings:
+  NC::VectD getResults( const char * cfgstr )
+  {
+    NC::VectD res;
+    auto sc = NC::createScatter( cfgstr );
+    auto& proc = sc.underlying();
+    NC::CachePtr cp;
+    auto rng = NC::createBuiltinRNG(12345);
+    for ( double e : NC::logspace( -5, 1, 50 ) ) {
+      NC::NeutronEnergy ekin{ e };
+      res.push_back( proc.crossSectionIsotropic( cp, ekin ).dbl() );
+      for ( int i = 0; i < 10; ++i ) {
+        auto outcome = proc.sampleScatterIsotropic( cp, *rng, ekin );
+        res.push_back( outcome.ekin.dbl() );
+        res.push_back( outcome.mu.dbl() );
+      }
+    }
+    return res;
+  }
+
+  void requireIdentical( const NC::VectD& a, const NC::VectD& b, const char * what )
+  {
+    nc_assert_always( a.size() == b.size() );
+    for ( auto i : NC::ncrange( a.size() ) ) {
+      if ( a[i] != b[i] ) {
+        std::cout<<what<<": results differ at index "<<i<<": "<<a[i]<<" vs. "<<b[i]<<std::endl;
+        std::exit(1);
+      }
+    }
+    std::cout<<what<<": results identical ("<<a.size()<<" values)"<<std::endl;
+  }
+
+  NPC::Key testKey( double x )
+  {
+    NPC::Key key("test");
+    key.addU64(17).addDbl(x).addStr("hello").addVect( NC::VectD{ 1.0, 2.0, 3.0 } );
+    return key;
+  }
+
+  bool loadTestEntry( const NPC::Key& key, NC::VectD& out )
+  {
+    return NPC::load( key, [&out]( NPC::Reader& r )
+    {
+      nc_assert_always( r.getU64() == 42 );
+      nc_assert_always( r.getDbl() == 0.125 );
+      out = r.getVect();
+    } );
+  }
+
+  std::size_t countEntries( const std::string& dir, const char * category )
+  {
+    return NC::ncglob( NC::path_join( dir, std::string(category) + "_*.ncpcache" ) ).size();
+  }
+
+  void removeCacheDir( const std::string& dir )
+  {
+    for ( auto& f : NC::ncglob( NC::path_join( dir, "*" ) ) )
+      std::remove( f.c_str() );
+    std::remove( dir.c_str() );
+  }
+
+  std::string testEntryPath( const NPC::Key& key )
+  {
+    return NC::path_join( NPC::cacheDir(),
+                          std::string(key.category()) + "_" + key.hexDigest() + ".ncpcache" );
+  }
+
+}
+
+int main()
+{
+  //Keys must depend on all inputs:
+  nc_assert_always( testKey(1.0).digest() == testKey(1.0).digest() );
+  nc_assert_always( testKey(1.0).digest() != testKey(-1.0).digest() );
+  nc_assert_always( NPC::Key("a").addDbl(0.0).digest() != NPC::Key("a").addDbl(-0.0).digest() );
+  nc_assert_always( NPC::Key("a").addStr("ab").addStr("c").digest()
+                    != NPC::Key("a").addStr("a").addStr("bc").digest() );
+
+  //Writer/Reader round-trip, including overruns:
+  {
+    NPC::Writer w;
+    w.addU64( 123456789012345ull );
+    w.addDbl( -1.5e-300 );
+    w.addVect( NC::VectD{ 1.0, 2.5, -3.0 } );
+    NPC::Reader r( w.data().data(), w.data().size() );
+    nc_assert_always( r.getU64() == 123456789012345ull );
+    nc_assert_always( r.getDbl() == -1.5e-300 );
+    nc_assert_always( r.getVect() == NC::VectD({ 1.0, 2.5, -3.0 }) );
+    nc_assert_always( r.atEnd() );
+    bool gotError = false;
+    try {
+      r.getU64();
+    } catch ( NC::Error::DataLoadError& ) {
+      gotError = true;
+    }
+    nc_assert_always( gotError );
+  }
+
+  //Serialised data and checksums are the same on all platforms (numbers are
+  //always written in little-endian byte order):
+  {
+    NPC::Writer w;
+    w.addU64( 0x0102030405060708ull );
+    w.addDbl( 1.0 );//0x3ff0000000000000
+    const std::string expected( "\x08\x07\x06\x05\x04\x03\x02\x01"
+                                "\x00\x00\x00\x00\x00\x00\xf0\x3f", 16 );
+    nc_assert_always( w.data() == expected );
+    const std::string s = "NCrystal checksum test";
+    nc_assert_always( NPC::checksum( s.data(), s.size() ) == 0xf0b6db1da3d71a14ull );
+  }
+
+  //Reference results without the cache:
+  NPC::setCacheDir( "" );
+  nc_assert_always( !NPC::isEnabled() );
+  const char * cfg_inelas = "Al_sg225.ncmat;comp=inelas;vdoslux=1";
+  const char * cfg_bragg = "Al_sg225.ncmat;comp=coh_elas";
+  auto ref_inelas = getResults( cfg_inelas );
+  auto ref_bragg = getResults( cfg_bragg );
+
+  const std::string testdir = NC::path_join( NC::ncgetcwd(), "ncpcache_testdir" );
+  removeCacheDir( testdir );//in case of leftovers from a previous failed run
+  NPC::setCacheDir( testdir );
+  nc_assert_always( NPC::isEnabled() );
+
+  //Store and load an entry, and check that corrupted or truncated files are
+  //simply treated as cache misses:
+  {
+    auto key = testKey( 2.0 );
+    NC::VectD v;
+    NPC::Writer w;
+    w.addU64( 42 );
+    w.addDbl( 0.125 );
+    w.addVect( NC::VectD{ 5.0, 6.0 } );
+    NPC::store( key, w );
+    nc_assert_always( loadTestEntry( key, v ) );
+    nc_assert_always( v == NC::VectD({ 5.0, 6.0 }) );
+    nc_assert_always( !loadTestEntry( testKey( 3.0 ), v ) );
+
+    const std::string path = testEntryPath( key );
+    std::string content;
+    {
+      std::ifstream fh( path, std::ios::binary );
+      content.assign( std::istreambuf_iterator<char>(fh), std::istreambuf_iterator<char>() );
+    }
+    nc_assert_always( content.size() > 16 );
+    auto writeFile = [&path]( const std::string& data )
+    {
+      std::ofstream fh( path, std::ios::binary | std::ios::trunc );
+      fh.write( data.data(), data.size() );
+    };
+    std::string corrupted = content;
+    corrupted[corrupted.size()-3] ^= 0x10;
+    writeFile( corrupted );
+    nc_assert_always( !loadTestEntry( key, v ) );
+    writeFile( content.substr( 0, content.size() - 8 ) );
+    nc_assert_always( !loadTestEntry( key, v ) );
+    writeFile( content );
+    nc_assert_always( loadTestEntry( key, v ) );
+  }
+
+  //Results must be identical when objects are calculated and stored in the
+  //cache, and when they are loaded from it:
+  for ( int i = 0; i < 2; ++i ) {
+    NC::clearCaches();
+    std::cout<<( i == 0 ? "Populating cache" : "Using cache" )<<std::endl;
+    const auto stats0 = NPC::getStats();
+    requireIdentical( ref_inelas, getResults( cfg_inelas ), "inelas" );
+    requireIdentical( ref_bragg, getResults( cfg_bragg ), "bragg" );
+    const auto stats1 = NPC::getStats();
+    const auto nhits = stats1.nhits - stats0.nhits;
+    const auto nmisses = stats1.nmisses - stats0.nmisses;
+    const auto nstores = stats1.nstores - stats0.nstores;
+    std::cout<<"  hits="<<nhits<<" misses="<<nmisses<<" stores="<<nstores<<std::endl;
+    if ( i == 0 ) {
+      //Everything calculated and stored, HKL and SAB entries present:
+      nc_assert_always( nhits == 0 && nmisses > 0 && nstores == nmisses );
+      nc_assert_always( countEntries( testdir, "hkl" ) > 0 );
+      nc_assert_always( countEntries( testdir, "vdos2sab" ) > 0 );
+      nc_assert_always( countEntries( testdir, "sabinteg" ) > 0 );
+    } else {
+      //Everything loaded from the cache:
+      nc_assert_always( nhits > 0 && nmisses == 0 && nstores == 0 );
+    }
+  }
+  NPC::setCacheDir( "" );
+  removeCacheDir( testdir );
+  nc_assert_always( NC::ncglob( NC::path_join( testdir, "*" ) ).empty() );
+  return 0;
+}
@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/internal/powderbragg/NCPowderBragg.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
+#include <iostream>
+
+namespace NC = NCrystal;
+
+namespace {
+
+  //Check that planes are selected by PowderBragg with frequencies matching
+  //their contributions (for enough planes to trigger the guide table):
+  void testSelection( unsigned nplanes )
+  {
+    std::cout<<">>> Testing plane selection with "<<nplanes<<" planes"<<std::endl;
+    auto rng_weights = NC::createBuiltinRNG(1234);
+    NC::PowderBragg::VectDFM data;
+    NC::VectD dsp;
+    for ( unsigned i = 0; i < nplanes; ++i ) {
+      const double d = 0.5 + 4.5 * i / nplanes;
+      //Include some vanishing and some dominating contributions:
+      const double r = rng_weights->generate();
+      const double fsqmult = ( i % 17 == 3 ? 0.0 : ( i % 53 == 7 ? 100.0 * r : r ) );
+      data.emplace_back( d, fsqmult );
+      dsp.push_back( d );
+    }
+    auto pb = std::make_shared<NC::PowderBragg>( 10.0, NC::PowderBragg::VectDFM( data ) );
+    auto rng = NC::createBuiltinRNG(5678);
+    NC::CachePtr cp;
+    for ( double wl : { 9.5, 6.0, 3.3, 1.5 } ) {
+      NC::NeutronEnergy ekin{ NC::NeutronWavelength{ wl } };
+      std::vector<double> expected( nplanes, 0.0 );
+      double wsum(0.0);
+      for ( unsigned i = 0; i < nplanes; ++i ) {
+        if ( wl <= 2.0 * dsp[i] ) {
+          expected[i] = dsp[i] * data[i].second;
+          wsum += expected[i];
+        }
+      }
+      if ( wsum == 0.0 )
+        continue;//wavelength above Bragg cutoff
+      std::vector<unsigned> counts( nplanes, 0 );
+      const unsigned nsample = 200000;
+      for ( unsigned j = 0; j < nsample; ++j ) {
+        auto outcome = pb->sampleScatterIsotropic( cp, *rng, ekin );
+        //mu = 1-2*sin^2(theta) and wl = 2*d*sin(theta):
+        const double sintheta = std::sqrt( 0.5 * ( 1.0 - outcome.mu.dbl() ) );
+        const double d = wl / ( 2.0 * sintheta );
+        const auto idx = static_cast<unsigned>( std::lround( ( d - 0.5 ) * nplanes / 4.5 ) );
+        nc_assert_always( idx < nplanes );
+        nc_assert_always( NC::ncabs( dsp[idx] - d ) < 1e-6 );
+        ++counts[idx];
+      }
+      double maxdev(0.0);
+      for ( unsigned i = 0; i < nplanes; ++i ) {
+        const double nexp = nsample * expected[i] / wsum;
+        if ( nexp == 0.0 ) {
+          nc_assert_always( counts[i] == 0 );
+          continue;
+        }
+        const double dev = NC::ncabs( counts[i] - nexp ) / std::sqrt( nexp + 1.0 );
+        maxdev = NC::ncmax( maxdev, dev );
+      }
+      std::cout<<"    wl="<<wl<<"Aa: max deviation in sigmas: "
+               <<( maxdev < 6.0 ? "OK (<6)" : "NOT OK" )<<std::endl;
+      nc_assert_always( maxdev < 6.0 );
+    }
+  }
+}
+
+int main()
+{
+  testSelection( 10 );
+  testSelection( 500 );
+  testSelection( 5000 );
+  return 0;
+}
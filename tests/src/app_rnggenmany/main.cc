@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/internal/utils/NCRandUtils.hh"
+#include "NCrystal/internal/extd_utils/NCABIUtils.hh"
+#include "NCrystal/interfaces/NCRNG.hh"
+#include <algorithm>
+#include <iostream>
+namespace NC = NCrystal;
+
+namespace {
+  void testGenMany( std::size_t n, std::uint64_t seed )
+  {
+    //generateMany must give exactly the numbers of n calls to generate(), in
+    //the same order:
+    NC::RandXRSRImpl rng_many( seed );
+    NC::RandXRSRImpl rng_ref( seed );
+    std::vector<double> v_many( n ), v_ref( n );
+    rng_many.generateMany( n, v_many.data() );
+    for ( auto& e : v_ref )
+      e = rng_ref.generate();
+    nc_assert_always( rng_many.state() == rng_ref.state() );
+
+    nc_assert_always( v_many == v_ref );
+    for ( auto e : v_many )
+      nc_assert_always( e > 0.0 && e <= 1.0 );
+  }
+
+  void testGenManyChunked( std::size_t n, std::uint64_t seed )
+  {
+    //The output must not depend on how the numbers are split into calls:
+    NC::RandXRSRImpl rng_single( seed );
+    std::vector<double> v_single( n );
+    rng_single.generateMany( n, v_single.data() );
+    for ( std::size_t nchunk : { 1, 1000, 2047, 2048, 3000, 4097 } ) {
+      NC::RandXRSRImpl rng_chunked( seed );
+      std::vector<double> v_chunked( n );
+      for ( std::size_t i = 0; i < n; i += nchunk )
+        rng_chunked.generateMany( std::min( nchunk, n - i ), v_chunked.data() + i );
+      nc_assert_always( rng_chunked.state() == rng_single.state() );
+      nc_assert_always( v_chunked == v_single );
+    }
+    //Explicitly: 1000 followed by 2000 is the same as 3000 at once:
+    NC::RandXRSRImpl rng_split( seed );
+    std::vector<double> v_split( 3000 );
+    rng_split.generateMany( 1000, v_split.data() );
+    rng_split.generateMany( 2000, v_split.data() + 1000 );
+    NC::RandXRSRImpl rng_3000( seed );
+    std::vector<double> v_3000( 3000 );
+    rng_3000.generateMany( 3000, v_3000.data() );
+    nc_assert_always( v_split == v_3000 );
+  }
+}
+
+int main()
+{
+  for ( std::size_t n : { 1, 7, 1023, 1024, 1025, 2047, 2048, 2049, 4096, 5000, 20000 } )
+    for ( std::uint64_t seed : { 0, 1, 123456789 } )
+      testGenMany( n, seed );
+  for ( std::uint64_t seed : { 0, 987654321 } )
+    testGenManyChunked( 10000, seed );
+
+  //The extreme values of the uint64->double conversion:
+  NC::RandXRSRImpl::state_t st_max = { 0xFFFFFFFFFFFFFFFFull, 0 };
+  NC::RandXRSRImpl::state_t st_zero = { 0, 0 };
+  for ( auto st : { st_max, st_zero } ) {
+    NC::RandXRSRImpl rng( st );
+    std::vector<double> v( 2048 );
+    rng.generateMany( v.size(), v.data() );
+    nc_assert_always( v.front() == NC::randUInt64ToFP01( st[0] + st[1] ) );
+  }
+
+  //Same through the RNGStream interface:
+  auto rng1 = NC::createBuiltinRNG( 42 );
+  auto rng2 = NC::createBuiltinRNG( 42 );
+  std::vector<double> v1( 3000 );
+  NC::NewABI::generateMany( rng1, v1.size(), v1.data() );
+  std::vector<double> v2( 3000 );
+  for ( auto& e : v2 )
+    e = rng2->generate();
+  nc_assert_always( rng1->getState() == rng2->getState() );
+  nc_assert_always( v1 == v2 );
+  std::cout<<"All ok"<<std::endl;
+  return 0;
+}
@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/interfaces/NCRNG.hh"
+#include "NCrystal/internal/utils/NCRandUtils.hh"
+#include "NCrystal/internal/extd_utils/NCABIUtils.hh"
+#include <iostream>
+namespace NC = NCrystal;
+
+namespace {
+  void testKnownAnswers()
+  {
+    //Known answer tests from the Random123 distribution (kat_vectors):
+    using block_t = NC::RandPhiloxImpl::block_t;
+    auto check = []( block_t ctr, uint64_t key, block_t expected )
+    {
+      auto res = NC::RandPhiloxImpl::philox4x32_10( ctr, key );
+      nc_assert_always( res == expected );
+    };
+    check( { 0, 0, 0, 0 }, 0,
+           { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 } );
+    check( { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, 0xffffffffffffffffull,
+           { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd } );
+    check( { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, 0x299f31d0a4093822ull,
+           { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } );
+  }
+
+  void testRandomAccess()
+  {
+    //Any position can be set directly, and generateMany gives the same numbers
+    //as generate():
+    NC::RandPhiloxImpl rng( 1234 );
+    std::vector<double> ref( 1001 );
+    for ( auto& e : ref )
+      e = rng.generate();
+    for ( std::size_t offset : { 0, 1, 2, 7, 500 } ) {
+      auto st = rng.state();
+      st[2] = offset;
+      NC::RandPhiloxImpl rng2( st );
+      nc_assert_always( rng2.generate() == ref.at(offset) );
+      std::vector<double> v( ref.size() - offset - 1 );
+      rng2.generateMany( v.size(), v.data() );
+      for ( auto i : NC::ncrange( v.size() ) )
+        nc_assert_always( v[i] == ref.at( offset + 1 + i ) );
+      nc_assert_always( rng2.state() == rng.state() );
+    }
+  }
+
+  std::vector<NC::RNGStreamState> producedStates( uint64_t seed,
+                                                  const std::vector<uint64_t>& indices )
+  {
+    auto producer = NC::makeSO<NC::RNGProducer>( NC::createCounterBasedRNG( seed ) );
+    //Consume some numbers and streams first, which must not matter:
+    auto rng = producer->produceForCurrentThread();
+    for ( int i = 0; i < 17; ++i )
+      rng->generate();
+    producer->produce();
+    std::vector<NC::RNGStreamState> res;
+    for ( auto idx : indices )
+      res.push_back( producer->produceByIdx( NC::RNGStreamIndex{ idx } )->getState() );
+    return res;
+  }
+}
+
+int main()
+{
+  testKnownAnswers();
+  testRandomAccess();
+
+  //Streams by index do not depend on the order of production:
+  auto s1 = producedStates( 42, { 0, 1, 2, 3, 1000000000 } );
+  auto s2 = producedStates( 42, { 1000000000, 3, 2, 1, 0 } );
+  for ( auto i : NC::ncrange( s1.size() ) ) {
+    nc_assert_always( s1[i] == s2[s2.size()-1-i] );
+    nc_assert_always( NC::stateIsFromBuiltinRNG( s1[i] ) );
+    for ( auto j : NC::ncrange( i ) )
+      nc_assert_always( s1[i] != s1[j] );
+  }
+  //But do depend on the seed:
+  nc_assert_always( producedStates( 43, { 0 } ).front() != s1.front() );
+
+  //State round-trip, also via createBuiltinRNG:
+  auto rng = NC::createCounterBasedRNG( 7 );
+  rng->generate();
+  auto st = rng->getState();
+  auto rng_copy = NC::createBuiltinRNG( st );
+  nc_assert_always( rng_copy->getState() == st );
+  std::vector<double> v( 2500 );
+  NC::NewABI::generateMany( rng, v.size(), v.data() );
+  for ( auto e : v )
+    nc_assert_always( e == rng_copy->generate() );
+  nc_assert_always( rng->getState() == rng_copy->getState() );
+
+  //Jumped streams differ from each other and from the original:
+  auto rng_j1 = rng->createJumped();
+  auto rng_j2 = rng_j1->createJumped();
+  nc_assert_always( rng_j1->generate64RndmBits() != rng_j2->generate64RndmBits() );
+  nc_assert_always( rng_j1->getState() != rng->getState() );
+
+  //Jumped streams (as used by RNGProducer::produce()) never coincide with
+  //streams produced by index, not even for the top index:
+  {
+    auto producer = NC::makeSO<NC::RNGProducer>( NC::createCounterBasedRNG( 42 ) );
+    std::vector<NC::RNGStreamState> jumped;
+    for ( int i = 0; i < 4; ++i )
+      jumped.push_back( producer->produce()->getState() );
+    for ( uint64_t idx : { uint64_t(0), uint64_t(1), uint64_t(2), uint64_t(3),
+                           uint64_t(0x7fffffffffffffffull),
+                           uint64_t(0xffffffffffffffffull) } ) {
+      auto st_idx = producer->produceByIdx( NC::RNGStreamIndex{ idx } )->getState();
+      for ( auto& st_j : jumped )
+        nc_assert_always( st_j != st_idx );
+    }
+    NC::RandPhiloxImpl root( 42 );
+    for ( uint64_t idx : { uint64_t(0), uint64_t(0xffffffffffffffffull) } ) {
+      nc_assert_always( root.deriveJumpedState() != root.deriveStreamState( idx ) );
+      nc_assert_always( ( root.deriveStreamState( idx )[1] >> 63 ) == 0 );
+    }
+    nc_assert_always( ( root.deriveJumpedState()[1] >> 63 ) == 1 );
+  }
+
+  std::cout<<"Stream #3 state: "<<s1.at(3)<<std::endl;
+  return 0;
+}
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/NCrystal.hh"
+#include "NCrystal/internal/dyninfoutils/NCDynInfoUtils.hh"
+#include "NCrystal/internal/sab/NCSABIntegrator.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
+#include <iostream>
+
+namespace NC = NCrystal;
+
+namespace {
+  //RNG which returns a fixed first value (used for the beta sampling), and
+  //then continues with a standard random stream:
+  class FirstValueRNG final : public NC::RNG {
+    double m_first;
+    bool m_used = false;
+    NC::shared_obj<NC::RNGStream> m_rng;
+  public:
+    FirstValueRNG( double first, std::uint64_t seed )
+      : m_first(first), m_rng( NC::createBuiltinRNG( seed ) ) {}
+    bool coinflip() override { return m_rng->coinflip(); }
+    std::uint64_t generate64RndmBits() override { return m_rng->generate64RndmBits(); }
+    std::uint32_t generate32RndmBits() override { return m_rng->generate32RndmBits(); }
+  protected:
+    double actualGenerate() override
+    {
+      if ( m_used )
+        return m_rng->generate();
+      m_used = true;
+      return m_first;
+    }
+  };
+}
+
+int main()
+{
+  auto info = NC::createInfo( "stdlib::Al_sg225.ncmat" );
+  const NC::DI_ScatKnl* di = nullptr;
+  for ( auto& e : info->getDynamicInfoList() )
+    if ( ( di = dynamic_cast<const NC::DI_ScatKnl*>( e.get() ) ) )
+      break;
+  nc_assert_always( di != nullptr );
+  auto sabdata = NC::extractSABDataFromDynInfo( di, 1 );
+
+  NC::SAB::SABIntegrator si_full( sabdata );
+  si_full.setCompactSamplers( false );
+  auto sampler_full = si_full.createSampler();
+  NC::SAB::SABIntegrator si_compact( sabdata );
+  si_compact.setCompactSamplers( true );
+  auto sampler_compact = si_compact.createSampler();
+
+  const auto mem_full = sampler_full.memoryUsage();
+  const auto mem_compact = sampler_compact.memoryUsage();
+  std::cout << "Compact sampling tables use "
+            << ( mem_compact * 2 < mem_full ? "less" : "MORE" )
+            << " than half of the memory" << std::endl;
+  nc_assert_always( mem_compact * 2 < mem_full );
+
+  //Using identical random numbers, the vast majority of sampled values should
+  //be identical up to small numerical differences (occasionally a different
+  //decision in the rejection sampling might lead to completely different
+  //values):
+  unsigned nsame(0), ntot(0);
+  double maxdiff_same = 0.0;
+  for ( double e : NC::logspace( -4, 0, 40 ) ) {
+    for ( std::uint64_t seed = 1; seed <= 250; ++seed ) {
+      auto rng_full = NC::createBuiltinRNG( seed );
+      auto rng_compact = NC::createBuiltinRNG( seed );
+      auto ab_full = sampler_full.sampleAlphaBeta( NC::NeutronEnergy{ e }, *rng_full );
+      auto ab_compact = sampler_compact.sampleAlphaBeta( NC::NeutronEnergy{ e }, *rng_compact );
+      const double da = NC::ncabs( ab_full.first - ab_compact.first ) / ( 1.0 + NC::ncabs( ab_full.first ) );
+      const double db = NC::ncabs( ab_full.second - ab_compact.second ) / ( 1.0 + NC::ncabs( ab_full.second ) );
+      ++ntot;
+      if ( da < 1e-4 && db < 1e-4 ) {
+        ++nsame;
+        maxdiff_same = std::max( maxdiff_same, std::max( da, db ) );
+      }
+    }
+  }
+  std::cout << "Compact tables give near identical samples in "
+            << ( nsame > 0.995 * ntot ? "more" : "LESS" ) << " than 99.5% of cases"
+            << " (max deviation "<< ( maxdiff_same < 1e-5 ? "below" : "ABOVE" )<<" 1e-5)" << std::endl;
+  nc_assert_always( nsame > 0.995 * ntot );
+  nc_assert_always( maxdiff_same < 1e-5 );
+
+  //The far tails of the beta distribution (with bins of tiny probabilities
+  //near CDF=0 and CDF=1) must be preserved:
+  unsigned ntail_same(0), ntail_tot(0);
+  for ( double e : NC::logspace( -4, 0, 20 ) ) {
+    for ( double p : { 1e-12, 1e-10, 1e-9, 1e-8, 3e-8, 1.0-1e-8, 1.0-3e-8, 1.0-1e-7, 1.0-3e-7 } ) {
+      for ( std::uint64_t seed = 1; seed <= 5; ++seed ) {
+        FirstValueRNG rng_full( p, seed );
+        FirstValueRNG rng_compact( p, seed );
+        auto ab_full = sampler_full.sampleAlphaBeta( NC::NeutronEnergy{ e }, rng_full );
+        auto ab_compact = sampler_compact.sampleAlphaBeta( NC::NeutronEnergy{ e }, rng_compact );
+        ++ntail_tot;
+        if ( NC::ncabs( ab_full.second - ab_compact.second ) < 1e-4 * ( 1.0 + NC::ncabs( ab_full.second ) ) )
+          ++ntail_same;
+      }
+    }
+  }
+  std::cout << "Compact tables give near identical beta values in the far tails in "
+            << ( ntail_same > 0.99 * ntail_tot ? "more" : "LESS" ) << " than 99% of cases" << std::endl;
+  nc_assert_always( ntail_same > 0.99 * ntail_tot );
+  return 0;
+}
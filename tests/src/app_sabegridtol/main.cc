@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/NCrystal.hh"
+#include "NCrystal/internal/dyninfoutils/NCDynInfoUtils.hh"
+#include "NCrystal/internal/sab/NCSABIntegrator.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
+#include <iostream>
+
+namespace NC = NCrystal;
+
+namespace {
+
+  void testFile( const char * filename, double tol )
+  {
+    auto info = NC::createInfo( filename );
+    for ( auto& di : info->getDynamicInfoList() ) {
+      auto di_sk = dynamic_cast<const NC::DI_ScatKnl*>( di.get() );
+      if ( !di_sk )
+        continue;
+      auto sabdata = NC::extractSABDataFromDynInfo( di_sk, 1 );
+      NC::SAB::SABIntegrator si_fixed( sabdata, di_sk->energyGrid().get() );
+      auto xs_fixed = si_fixed.createXSProvider();
+      NC::SAB::SABIntegrator si_adaptive( sabdata, di_sk->energyGrid().get() );
+      si_adaptive.setEGridTolerance( tol );
+      auto xs_adaptive = si_adaptive.createXSProvider();
+
+      const auto& egrid_fixed = xs_fixed.internalEGrid();
+      const auto& egrid_adaptive = xs_adaptive.internalEGrid();
+      nc_assert_always( egrid_adaptive.size() >= 10 );
+      nc_assert_always( egrid_adaptive.size() < egrid_fixed.size() );
+      nc_assert_always( NC::floateq( egrid_adaptive.front(), egrid_fixed.front() ) );
+      nc_assert_always( NC::floateq( egrid_adaptive.back(), egrid_fixed.back() ) );
+
+      //Compare with a much denser grid. Deviations must not be significantly
+      //larger than those of the fixed grid, since the tolerance is only
+      //checked at selected points and the adaptive grid is never finer than
+      //the fixed one:
+      NC::VectD egrid_dense{ egrid_fixed.front(), egrid_fixed.back(), 3000 };
+      NC::SAB::SABIntegrator si_dense( sabdata, &egrid_dense );
+      auto xs_dense = si_dense.createXSProvider();
+      double maxreldiff_fixed = 0.0;
+      double maxreldiff = 0.0;
+      for ( double e : NC::geomspace( egrid_fixed.front() * 0.5, egrid_fixed.back() * 2.0, 5000 ) ) {
+        const double ref = xs_dense.crossSection( NC::NeutronEnergy{ e } ).dbl();
+        const double a = xs_fixed.crossSection( NC::NeutronEnergy{ e } ).dbl();
+        const double b = xs_adaptive.crossSection( NC::NeutronEnergy{ e } ).dbl();
+        maxreldiff_fixed = NC::ncmax( maxreldiff_fixed, NC::ncabs( a - ref ) / ref );
+        maxreldiff = NC::ncmax( maxreldiff, NC::ncabs( b - ref ) / ref );
+      }
+      const bool ok = maxreldiff < maxreldiff_fixed + 3.0 * tol;
+      std::cout << filename << " [" << di_sk->atomData().elementName() << "]: "
+                << egrid_adaptive.size() << " instead of " << egrid_fixed.size()
+                << " energy points with tolerance " << tol
+                << ( ok ? " (cross sections OK)" : " (cross sections BAD)" )
+                << std::endl;
+      nc_assert_always( ok );
+    }
+  }
+
+  double meanEnergyTransfer( const char * cfgstr, double ekin )
+  {
+    auto sc = NC::createScatter( cfgstr );
+    auto rng = NC::createBuiltinRNG( 1234 );
+    NC::CachePtr cp;
+    const unsigned n = 40000;
+    double sum = 0.0;
+    for ( unsigned i = 0; i < n; ++i )
+      sum += sc.underlying().sampleScatterIsotropic( cp, *rng, NC::NeutronEnergy{ ekin } ).ekin.dbl() - ekin;
+    return sum / n;
+  }
+
+}
+
+int main()
+{
+  testFile( "stdlib::Al_sg225.ncmat", 1e-3 );
+  testFile( "stdlib::Polyethylene_CH2.ncmat", 1e-3 );
+  testFile( "stdlib::Polyethylene_CH2.ncmat", 1e-2 );
+
+  //Via the cfg parameter (sampling is exact due to rejection sampling, so
+  //distributions must be statistically compatible):
+  for ( double ekin : { 0.001, 0.025, 0.3 } ) {
+    const double de_fixed = meanEnergyTransfer( "stdlib::Polyethylene_CH2.ncmat;comp=inelas;vdoslux=1", ekin );
+    const double de_adaptive = meanEnergyTransfer( "stdlib::Polyethylene_CH2.ncmat;comp=inelas;vdoslux=1;sabegridtol=0.001", ekin );
+    const double scale = NC::ncmax( ekin, NC::ncabs( de_fixed ) );
+    const bool ok = NC::ncabs( de_fixed - de_adaptive ) < 0.05 * scale;
+    std::cout << "Mean energy transfer at " << ekin << " eV "
+              << ( ok ? "compatible" : "INCOMPATIBLE" ) << std::endl;
+    nc_assert_always( ok );
+  }
+  return 0;
+}
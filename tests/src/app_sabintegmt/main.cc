@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/NCrystal.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
+#include <iostream>
+
+namespace NC = NCrystal;
+
+namespace {
+  //Cross sections and sampled scatterings for an inelastic (S(alpha,beta)
+  //based) physics process:
+  NC::VectD getResults( const char * cfgstr )
+  {
+    NC::VectD res;
+    auto sc = NC::createScatter( cfgstr );
+    auto& proc = sc.underlying();
+    NC::CachePtr cp;
+    auto rng = NC::createBuiltinRNG(12345);
+    for ( double e : NC::logspace( -5, 1, 50 ) ) {
+      NC::NeutronEnergy ekin{ e };
+      res.push_back( proc.crossSectionIsotropic( cp, ekin ).dbl() );
+      for ( int i = 0; i < 10; ++i ) {
+        auto outcome = proc.sampleScatterIsotropic( cp, *rng, ekin );
+        res.push_back( outcome.ekin.dbl() );
+        res.push_back( outcome.mu.dbl() );
+      }
+    }
+    return res;
+  }
+}
+
+int main()
+{
+  //Check that results of SAB integration do not depend on the number of
+  //factory threads used:
+  const char * cfgstr = "Al_sg225.ncmat;comp=inelas;vdoslux=1";
+  auto res_st = getResults( cfgstr );
+  NC::clearCaches();
+  NC::FactoryThreadPool::enable( NC::ThreadCount{ 4 } );
+  auto res_mt = getResults( cfgstr );
+  NC::FactoryThreadPool::enable( NC::ThreadCount{ 0 } );
+  nc_assert_always( res_st.size() == res_mt.size() );
+  for ( auto i : NC::ncrange( res_st.size() ) ) {
+    if ( res_st[i] != res_mt[i] ) {
+      std::cout<<"Results differ at index "<<i<<": "<<res_st[i]<<" vs. "<<res_mt[i]<<std::endl;
+      return 1;
+    }
+  }
+  std::cout<<"Results identical with and without factory threads ("<<res_st.size()<<" values)"<<std::endl;
+  return 0;
+}
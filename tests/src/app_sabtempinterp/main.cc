@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/NCrystal.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
+#include <iostream>
+
+namespace NC = NCrystal;
+
+namespace {
+  const char * basecfg = "stdlib::Al_sg225.ncmat;incoh_elas=0;coh_elas=0;vdoslux=1";
+  NC::Scatter getScatter( double temp, double sabtempstep )
+  {
+    std::ostringstream ss;
+    ss << basecfg << ";temp="<<temp<<"K";
+    if ( sabtempstep > 0.0 )
+      ss << ";sabtempstep="<<sabtempstep;
+    return NC::createScatter( ss.str() );
+  }
+  NC::VectD getXS( double temp, double sabtempstep, const NC::VectD& egrid )
+  {
+    auto sc = getScatter( temp, sabtempstep );
+    NC::VectD res;
+    res.reserve( egrid.size() );
+    for ( auto e : egrid )
+      res.push_back( sc.crossSectionIsotropic( NC::NeutronEnergy{ e } ).dbl() );
+    return res;
+  }
+}
+
+int main()
+{
+  const auto egrid = NC::geomspace( 1e-5, 5.0, 200 );
+
+  //On the ladder (or below the first step), results must be identical to the
+  //standard treatment:
+  const auto xs_200 = getXS( 200.0, 0.0, egrid );
+  const auto xs_300 = getXS( 300.0, 0.0, egrid );
+  nc_assert_always( getXS( 200.0, 100.0, egrid ) == xs_200 );
+  nc_assert_always( getXS( 300.0, 100.0, egrid ) == xs_300 );
+  nc_assert_always( getXS( 50.0, 100.0, egrid ) == getXS( 50.0, 0.0, egrid ) );
+  std::cout << "Cross sections on temperature ladder agree with standard treatment" << std::endl;
+
+  //In between, cross sections are linearly interpolated between the (shared)
+  //kernels of the bracketing temperatures:
+  for ( double temp : { 220.0, 250.0, 293.15 } ) {
+    const double w_hi = ( temp - 200.0 ) / 100.0;
+    const auto xs_interp = getXS( temp, 100.0, egrid );
+    const auto xs_direct = getXS( temp, 0.0, egrid );
+    double maxreldiff = 0.0;
+    for ( auto i : NC::ncrange( egrid.size() ) ) {
+      const double expected = ( 1.0 - w_hi ) * xs_200.at(i) + w_hi * xs_300.at(i);
+      nc_assert_always( NC::floateq( xs_interp.at(i), expected, 1e-12, 1e-300 ) );
+      maxreldiff = std::max( maxreldiff, NC::ncabs( xs_interp.at(i) - xs_direct.at(i) ) / xs_direct.at(i) );
+    }
+    std::cout << "T="<<temp<<"K: interpolated cross sections within "
+              << ( maxreldiff < 0.02 ? "2%" : "NOT WITHIN 2%" ) << " of direct calculation" << std::endl;
+    nc_assert_always( maxreldiff < 0.02 );
+  }
+
+  //Sampling from the interpolated process should give sane outcomes, with mean
+  //energy transfers between those at the bracketing temperatures:
+  auto meanEnergyTransfer = []( NC::Scatter sc, NC::NeutronEnergy ekin )
+  {
+    const unsigned n = 20000;
+    double sum = 0.0;
+    for ( unsigned i = 0; i < n; ++i ) {
+      auto outcome = sc.sampleScatterIsotropic( ekin );
+      nc_assert_always( outcome.ekin.dbl() >= 0.0 );
+      nc_assert_always( outcome.mu.dbl() >= -1.0 && outcome.mu.dbl() <= 1.0 );
+      sum += outcome.ekin.dbl() - ekin.dbl();
+    }
+    return sum / n;
+  };
+  const NC::NeutronEnergy ekin{ 0.0253 };
+  const double de_200 = meanEnergyTransfer( getScatter( 200.0, 0.0 ), ekin );
+  const double de_250 = meanEnergyTransfer( getScatter( 250.0, 100.0 ), ekin );
+  const double de_300 = meanEnergyTransfer( getScatter( 300.0, 0.0 ), ekin );
+  const bool ordered = ( std::min( de_200, de_300 ) < de_250 && de_250 < std::max( de_200, de_300 ) );
+  std::cout << "Mean energy transfer at T=250K is "
+            << ( ordered ? "between" : "NOT between" ) << " values at T=200K and T=300K" << std::endl;
+  nc_assert_always( ordered );
+
+  //Bad values are rejected:
+  bool caught = false;
+  try {
+    NC::createScatter( std::string(basecfg) + ";sabtempstep=-1" );
+  } catch ( NC::Error::BadInput& ) {
+    caught = true;
+  }
+  nc_assert_always( caught );
+  return 0;
+}
@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/NCrystal.hh"
+#include "NCrystal/internal/extd_utils/NCABIUtils.hh"
+#include "NCrystal/internal/utils/NCMath.hh"
+#include "NCrystal/internal/utils/NCRandUtils.hh"
+#include <iostream>
+
+namespace NC = NCrystal;
+namespace NCPI = NCrystal::ProcImpl;
+
+namespace {
+
+  void testBatchedScatter( const char * cfgstr )
+  {
+    std::cout<<">>> Testing batched scatterings for \""<<cfgstr<<"\""<<std::endl;
+    auto proc = NC::FactImpl::createScatter(cfgstr);
+    auto rng = NC::createBuiltinRNG(12345);
+    const bool is_elastic = NCPI::NewABI::isPureElasticScatter(proc);
+
+    //Mixture of energies (including some below Bragg thresholds) and
+    //directions:
+    constexpr std::size_t N = 5000;
+    NC::VectD ekin(N), ux(N), uy(N), uz(N);
+    for ( std::size_t i = 0; i < N; ++i ) {
+      ekin[i] = ( i % 7 == 0 ? 1e-5 : 0.001 + 0.2 * rng->generate() );
+      auto d = NC::randIsotropicDirection(rng);
+      ux[i] = d[0];
+      uy[i] = d[1];
+      uz[i] = d[2];
+    }
+
+    NC::VectD out_xs(N), out_ekin(N), out_ux(N), out_uy(N), out_uz(N);
+    NC::CachePtr cp;
+    NCPI::NewABI::evalXSAndSampleScatterMany( proc, cp, rng,
+                                              ekin.data(), ux.data(), uy.data(), uz.data(), N,
+                                              out_xs.data(), out_ekin.data(), out_ux.data(),
+                                              out_uy.data(), out_uz.data() );
+    NC::CachePtr cp2;
+    for ( std::size_t i = 0; i < N; ++i ) {
+      NC::NeutronDirection indir{ ux[i], uy[i], uz[i] };
+      double xs = proc->crossSection( cp2, NC::NeutronEnergy{ekin[i]}, indir ).dbl();
+      nc_assert_always( NC::floateq( xs, out_xs[i], 1e-10, 1e-14 ) );
+      nc_assert_always( out_ekin[i] >= 0.0 );
+      if ( is_elastic )
+        nc_assert_always( out_ekin[i] == ekin[i] );
+      if ( xs == 0.0 ) {
+        //Neutrons which can not scatter must pass through unchanged:
+        nc_assert_always( out_ekin[i] == ekin[i] );
+        nc_assert_always( out_ux[i] == ux[i] && out_uy[i] == uy[i] && out_uz[i] == uz[i] );
+      }
+      double mag2 = out_ux[i]*out_ux[i] + out_uy[i]*out_uy[i] + out_uz[i]*out_uz[i];
+      nc_assert_always( NC::ncabs( mag2 - 1.0 ) < 1e-10 );
+    }
+
+    //Same without cross sections:
+    NCPI::NewABI::sampleScatterMany( proc, cp, rng,
+                                     ekin.data(), ux.data(), uy.data(), uz.data(), N,
+                                     out_ekin.data(), out_ux.data(),
+                                     out_uy.data(), out_uz.data() );
+    for ( std::size_t i = 0; i < N; ++i ) {
+      nc_assert_always( out_ekin[i] >= 0.0 );
+      if ( is_elastic )
+        nc_assert_always( out_ekin[i] == ekin[i] );
+      double mag2 = out_ux[i]*out_ux[i] + out_uy[i]*out_uy[i] + out_uz[i]*out_uz[i];
+      nc_assert_always( NC::ncabs( mag2 - 1.0 ) < 1e-10 );
+    }
+  }
+
+  void testBatchedDirections()
+  {
+    std::cout<<">>> Testing batched direction sampling"<<std::endl;
+    auto rng = NC::createBuiltinRNG(4321);
+    constexpr std::size_t N = 20000;
+    NC::VectD mu(N), ux(N), uy(N), uz(N), out_ux(N), out_uy(N), out_uz(N);
+    for ( std::size_t i = 0; i < N; ++i ) {
+      mu[i] = ( i % 5 == 0 ? 1.0 : -1.0 + 2.0 * rng->generate() );
+      auto d = NC::randIsotropicDirection(rng);
+      if ( i % 11 == 0 )
+        d = NC::Vector{ 0.0, 0.0, ( i % 2 ? 1.0 : -1.0 ) };//poles
+      const double scale = ( i % 3 == 0 ? 2.5 : 1.0 );//not normalised
+      ux[i] = d[0] * scale;
+      uy[i] = d[1] * scale;
+      uz[i] = d[2] * scale;
+    }
+    NC::randDirectionsGivenScatterMu( rng, N, mu.data(), ux.data(), uy.data(), uz.data(),
+                                      out_ux.data(), out_uy.data(), out_uz.data() );
+    //Azimuthal angles around the z-axis for neutrons moving along it must be
+    //flat:
+    double sum_cx(0.0), sum_cy(0.0);
+    std::size_t n_pole(0);
+    for ( std::size_t i = 0; i < N; ++i ) {
+      NC::Vector indir{ ux[i], uy[i], uz[i] };
+      NC::Vector outdir{ out_ux[i], out_uy[i], out_uz[i] };
+      nc_assert_always( NC::ncabs( outdir.mag2() - 1.0 ) < 1e-12 );
+      nc_assert_always( NC::ncabs( outdir.dot( indir.unit() ) - mu[i] ) < 1e-12 );
+      if ( mu[i] == 1.0 && i % 3 != 0 )
+        nc_assert_always( out_ux[i] == ux[i] && out_uy[i] == uy[i] && out_uz[i] == uz[i] );
+      if ( i % 11 == 0 && mu[i] < 1.0 ) {
+        double sinth = std::sqrt( 1.0 - mu[i] * mu[i] );
+        if ( sinth > 0.1 ) {
+          sum_cx += out_ux[i] / sinth;
+          sum_cy += out_uy[i] / sinth;
+          ++n_pole;
+        }
+      }
+    }
+    nc_assert_always( n_pole > 1000 );
+    nc_assert_always( NC::ncabs( sum_cx / n_pole ) < 0.1 );
+    nc_assert_always( NC::ncabs( sum_cy / n_pole ) < 0.1 );
+  }
+
+  void testManyXSIsotropic( const char * cfgstr )
+  {
+    std::cout<<">>> Testing batched cross sections for \""<<cfgstr<<"\""<<std::endl;
+    auto proc = NC::FactImpl::createScatter(cfgstr);
+    //Sorted grid (exercising the sorted fast path), followed by a shuffled
+    //copy:
+    auto egrid = NC::geomspace(1e-5,10.0,20000);
+    NC::VectD eshuffled = egrid;
+    auto rng = NC::createBuiltinRNG(123);
+    for ( std::size_t i = eshuffled.size(); i > 1; --i )
+      std::swap( eshuffled[i-1], eshuffled[ static_cast<std::size_t>( rng->generate() * i ) % i ] );
+    for ( auto& energies : { egrid, eshuffled } ) {
+      NC::VectD out_xs( energies.size() );
+      NC::CachePtr cp, cp2;
+      NCPI::NewABI::evalManyXSIsotropic( proc, cp, energies.data(), energies.size(), out_xs.data() );
+      for ( std::size_t i = 0; i < energies.size(); ++i ) {
+        double xs = proc->crossSectionIsotropic( cp2, NC::NeutronEnergy{energies[i]} ).dbl();
+        nc_assert_always( NC::floateq( xs, out_xs[i], 1e-10, 1e-14 ) );
+      }
+    }
+  }
+}
+
+int main()
+{
+  testBatchedDirections();
+  testManyXSIsotropic("stdlib::Al_sg225.ncmat;dcutoff=0.5");
+  testManyXSIsotropic("stdlib::Al_sg225.ncmat;dcutoff=0.5;vdoslux=1");
+  testManyXSIsotropic("stdlib::Polyethylene_CH2.ncmat;vdoslux=1");
+  testManyXSIsotropic("phases<0.3*Al_sg225.ncmat;dcutoff=0.5&0.7*MgO_sg225_Periclase.ncmat;dcutoff=0.5>");
+  testBatchedScatter("stdlib::Al_sg225.ncmat;dcutoff=0.5;comp=bragg");
+  testBatchedScatter("stdlib::Al_sg225.ncmat;dcutoff=0.5;comp=bragg,elas");
+  testBatchedScatter("stdlib::Al_sg225.ncmat;dcutoff=0.5;vdoslux=1");
+  testBatchedScatter("stdlib::Polyethylene_CH2.ncmat;vdoslux=1");
+  testBatchedScatter("gasmix::air");
+  testBatchedScatter("stdlib::Ge_sg227.ncmat;dcutoff=0.5;mos=40.0arcmin;dir1=@crys_hkl:5,1,1"
+                     "@lab:0,0,1;dir2=@crys_hkl:0,-1,1@lab:0,1,0");
+  return 0;
+}
@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/NCrystal.hh"
+#include "NCrystal/internal/scbragg/NCSCBragg.hh"
+#include "NCrystal/internal/utils/NCRandUtils.hh"
+#include <cstdlib>
+#include <iostream>
+
+namespace NC = NCrystal;
+
+namespace {
+
+  void disableAngularIndex()
+  {
+    //NB: Only works in builds without namespaced environment variables, in
+    //which case the test below is simply comparing the index with itself.
+#ifdef _WIN32
+    _putenv_s("NCRYSTAL_SCBRAGG_NOANGULARINDEX","1");
+#else
+    setenv("NCRYSTAL_SCBRAGG_NOANGULARINDEX","1",1);
+#endif
+  }
+
+  struct TestCase {
+    std::string cfgstr;
+    std::unique_ptr<NC::SCBragg> scbragg_idx;
+    std::unique_ptr<NC::SCBragg> scbragg_noidx;
+  };
+
+  std::unique_ptr<NC::SCBragg> createSCBragg( const std::string& cfgstr )
+  {
+    NC::MatCfg cfg(cfgstr);
+    auto info = NC::FactImpl::createInfo(cfg);
+    return std::make_unique<NC::SCBragg>( info, cfg.createSCOrientation(),
+                                          cfg.get_mos(), 0.0, nullptr,
+                                          cfg.get_mosprec() );
+  }
+
+  void compare( const TestCase& tc )
+  {
+    std::cout<<">>> Comparing SCBragg with/without angular index for \""
+             <<tc.cfgstr<<"\""<<std::endl;
+    auto rng = NC::createBuiltinRNG(123);
+    auto rng_idx = NC::createBuiltinRNG(456);
+    auto rng_noidx = NC::createBuiltinRNG(456);
+    NC::CachePtr cp_idx, cp_noidx;
+    unsigned nnonzero(0);
+    for ( unsigned i = 0; i < 4000; ++i ) {
+      NC::NeutronEnergy ekin{ NC::NeutronWavelength{ 0.5 + 5.0 * rng->generate() } };
+      auto dir = NC::randIsotropicDirection( *rng ).as<NC::NeutronDirection>();
+      auto xs_idx = tc.scbragg_idx->crossSection( cp_idx, ekin, dir );
+      auto xs_noidx = tc.scbragg_noidx->crossSection( cp_noidx, ekin, dir );
+      if ( xs_idx.dbl() != xs_noidx.dbl() ) {
+        std::cout<<"Mismatch in cross sections: "<<xs_idx<<" vs. "<<xs_noidx<<std::endl;
+        nc_assert_always(false);
+      }
+      if ( xs_idx.dbl() > 0.0 )
+        ++nnonzero;
+      auto outcome_idx = tc.scbragg_idx->sampleScatter( cp_idx, *rng_idx, ekin, dir );
+      auto outcome_noidx = tc.scbragg_noidx->sampleScatter( cp_noidx, *rng_noidx, ekin, dir );
+      nc_assert_always( outcome_idx.ekin.dbl() == outcome_noidx.ekin.dbl() );
+      nc_assert_always( outcome_idx.direction[0] == outcome_noidx.direction[0] );
+      nc_assert_always( outcome_idx.direction[1] == outcome_noidx.direction[1] );
+      nc_assert_always( outcome_idx.direction[2] == outcome_noidx.direction[2] );
+    }
+    std::cout<<"    ... all identical ("<<nnonzero<<" non-vanishing cross sections)"<<std::endl;
+    nc_assert_always( nnonzero > 0 );
+  }
+}
+
+int main()
+{
+  const char * orient = ";dir1=@crys_hkl:0,0,1@lab:0,0,1;dir2=@crys_hkl:1,0,0@lab:1,0,0";
+  std::vector<std::string> cfgs = {
+    std::string("Al2O3_sg167_Corundum.ncmat;dcutoff=0.4;mos=2deg") + orient,
+    std::string("Al2O3_sg167_Corundum.ncmat;dcutoff=0.6;mos=10arcsec") + orient,
+    std::string("Al_sg225.ncmat;dcutoff=0.3;mos=0.5deg") + orient,
+    //Too few normals for the index to be used:
+    std::string("Al_sg225.ncmat;mos=0.5deg") + orient,
+  };
+  std::vector<TestCase> testcases;
+  for ( auto& c : cfgs ) {
+    testcases.emplace_back();
+    testcases.back().cfgstr = c;
+    testcases.back().scbragg_idx = createSCBragg( c );
+  }
+  disableAngularIndex();
+  for ( auto& tc : testcases )
+    tc.scbragg_noidx = createSCBragg( tc.cfgstr );
+  for ( auto& tc : testcases )
+    compare( tc );
+  return 0;
+}
@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  This file is part of NCrystal (see https://mctools.github.io/ncrystal/)   //
+//                                                                            //
+//  Copyright 2015-2025 NCrystal developers                                   //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//      http://www.apache.org/licenses/LICENSE-2.0                            //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NCrystal/NCrystal.hh"
+#include "NCrystal/internal/dyninfoutils/NCDynInfoUtils.hh"
+#include <iostream>
+
+namespace NC = NCrystal;
+
+namespace {
+  std::vector<const NC::DI_VDOS*> getVDOSDIs( const NC::InfoPtr& info )
+  {
+    std::vector<const NC::DI_VDOS*> res;
+    for ( auto& di : info->getDynamicInfoList() ) {
+      auto di_vdos = dynamic_cast<const NC::DI_VDOS*>( di.get() );
+      if ( di_vdos )
+        res.push_back( di_vdos );
+    }
+    nc_assert_always( !res.empty() );
+    return res;
+  }
+}
+
+int main()
+{
+  //Info objects which differ only in parameters unrelated to the dynamics have
+  //separate DI_VDOS objects, but must share kernels:
+  auto info_a = NC::createInfo( "stdlib::Polyethylene_CH2.ncmat;temp=250K" );
+  auto info_b = NC::createInfo( "stdlib::Polyethylene_CH2.ncmat;temp=250K;dcutoff=0.6" );
+  auto info_c = NC::createInfo( "stdlib::Polyethylene_CH2.ncmat;temp=260K" );
+  nc_assert_always( info_a->getUniqueID() != info_b->getUniqueID() );
+  auto dis_a = getVDOSDIs( info_a );
+  auto dis_b = getVDOSDIs( info_b );
+  auto dis_c = getVDOSDIs( info_c );
+  nc_assert_always( dis_a.size() == dis_b.size() && dis_a.size() == dis_c.size() );
+  for ( std::size_t i = 0; i < dis_a.size(); ++i ) {
+    nc_assert_always( dis_a.at(i) != dis_b.at(i) );
+    auto sab_a = NC::extractSABDataFromDynInfo( dis_a.at(i), 1 );
+    auto sab_b = NC::extractSABDataFromDynInfo( dis_b.at(i), 1 );
+    auto sab_c = NC::extractSABDataFromDynInfo( dis_c.at(i), 1 );
+    nc_assert_always( sab_a.get() == sab_b.get() );
+    nc_assert_always( sab_a.get() != sab_c.get() );
+    nc_assert_always( sab_c->temperature() == NC::Temperature{ 260.0 } );
+    //Same kernel object when expanding at the DI temperature explicitly:
+    auto sab_at = NC::extractSABDataFromDynInfoAtTemperature( dis_c.at(i), NC::Temperature{ 250.0 }, 1 );
+    nc_assert_always( sab_at.get() == sab_a.get() );
+    //Kernels with excluded contributions are not shared with full kernels:
+    auto sab_excl = NC::extractSABDataFromDynInfo( dis_a.at(i), 1, true, 1 + 4*1 + 40000*1 );
+    nc_assert_always( sab_excl.get() != sab_a.get() );
+    //Uncached expansion gives identical kernel:
+    auto sab_nocache = NC::extractSABDataFromDynInfo( dis_a.at(i), 1, false );
+    nc_assert_always( sab_nocache.get() != sab_a.get() );
+    nc_assert_always( sab_nocache->sab() == sab_a->sab() );
+    nc_assert_always( sab_nocache->alphaGrid() == sab_a->alphaGrid() );
+    nc_assert_always( sab_nocache->betaGrid() == sab_a->betaGrid() );
+  }
+  std::cout << "Kernels shared for " << dis_a.size() << " VDOS components" << std::endl;
+
+  //Scatter processes from the two Info objects must give identical cross
+  //sections:
+  auto sc_a = NC::createScatter( "stdlib::Polyethylene_CH2.ncmat;temp=250K;comp=inelas;vdoslux=1" );
+  auto sc_b = NC::createScatter( "stdlib::Polyethylene_CH2.ncmat;temp=250K;comp=inelas;vdoslux=1;dcutoff=0.6" );
+  for ( double e : { 1e-4, 0.0253, 0.5 } )
+    nc_assert_always( sc_a.crossSectionIsotropic( NC::NeutronEnergy{ e } )
+                      == sc_b.crossSectionIsotropic( NC::NeutronEnergy{ e } ) );
+  std::cout << "Cross sections identical" << std::endl;
+  return 0;
+}